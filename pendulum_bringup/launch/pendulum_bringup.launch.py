@@ -18,7 +18,7 @@ from launch import LaunchDescription
 from launch.actions import DeclareLaunchArgument
 from launch.conditions import IfCondition
 import launch.substitutions
-from launch.substitutions import LaunchConfiguration
+from launch.substitutions import EnvironmentVariable, LaunchConfiguration
 from launch_ros.actions import Node
 from launch_ros.substitutions import FindPackageShare
 
@@ -65,11 +65,22 @@ def generate_launch_description():
         name='config-child-threads',
         default_value='False',
         description='Configure process child threads (typically DDS threads)')
+    with_standby_param = DeclareLaunchArgument(
+        'standby',
+        default_value='False',
+        description='Launch a hot-standby controller, enable_failover must be set in the driver'
+    )
     with_rviz_param = DeclareLaunchArgument(
         'rviz',
         default_value='False',
         description='Launch RVIZ2 in addition to other nodes'
     )
+    visualization_domain_param = DeclareLaunchArgument(
+        'visualization-domain',
+        default_value=EnvironmentVariable('ROS_DOMAIN_ID', default_value='0'),
+        description='ROS domain of the visualization nodes, use the driver bridge.domain_id'
+    )
+    visualization_env = {'ROS_DOMAIN_ID': LaunchConfiguration('visualization-domain')}
 
     # Node definitions
     pendulum_demo_runner = Node(
@@ -87,11 +98,28 @@ def generate_launch_description():
            ]
     )
 
+    # same node name in its own namespace, so the controller section of the parameter file
+    # applies to it, with the topics shared with the demo mapped back to the root namespace
+    standby_controller_runner = Node(
+        package='pendulum_controller',
+        executable='pendulum_controller_exe',
+        name='pendulum_controller',
+        namespace='standby',
+        output='screen',
+        parameters=[param_file, {'command_topic_name': '/joint_command_standby'}],
+        remappings=[
+            ('pendulum_joint_states', '/pendulum_joint_states'),
+            ('teleop', '/teleop')],
+        arguments=['--autostart', LaunchConfiguration('autostart')],
+        condition=IfCondition(LaunchConfiguration('standby'))
+    )
+
     robot_state_publisher_runner = Node(
         package='robot_state_publisher',
         executable='robot_state_publisher',
         output='screen',
         parameters=[rsp_params],
+        additional_env=visualization_env,
         condition=IfCondition(LaunchConfiguration('rviz'))
     )
 
@@ -100,12 +128,14 @@ def generate_launch_description():
         executable='rviz2',
         name='rviz2',
         arguments=['-d', str(rviz_cfg_path)],
+        additional_env=visualization_env,
         condition=IfCondition(LaunchConfiguration('rviz'))
     )
 
     pendulum_state_publisher_runner = Node(
         package='pendulum_state_publisher',
         executable='pendulum_state_publisher',
+        additional_env=visualization_env,
         condition=IfCondition(LaunchConfiguration('rviz'))
     )
 
@@ -117,9 +147,12 @@ def generate_launch_description():
     ld.add_action(with_lock_memory_param)
     ld.add_action(lock_memory_size_param)
     ld.add_action(config_child_threads_param)
+    ld.add_action(with_standby_param)
     ld.add_action(with_rviz_param)
+    ld.add_action(visualization_domain_param)
     ld.add_action(robot_state_publisher_runner)
     ld.add_action(pendulum_demo_runner)
+    ld.add_action(standby_controller_runner)
     ld.add_action(rviz_runner)
     ld.add_action(pendulum_state_publisher_runner)
 
@@ -0,0 +1,94 @@
+# Copyright 2021 Carlos San Vicente
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+
+from launch import LaunchDescription
+from launch.actions import DeclareLaunchArgument
+from launch.substitutions import LaunchConfiguration
+from launch_ros.actions import Node
+from launch_ros.substitutions import FindPackageShare
+
+
+def generate_launch_description():
+    # Get the bringup directory
+    bringup_dir = FindPackageShare('pendulum_bringup').find('pendulum_bringup')
+
+    # Set parameter file path, the node names match in any namespace
+    param_file_path = os.path.join(bringup_dir, 'params', 'pendulum.param.yaml')
+
+    # Create the launch configuration variables
+    instances_param = DeclareLaunchArgument(
+        name='instances',
+        default_value='4',
+        description='Number of pendulum_demo instances')
+    cores_param = DeclareLaunchArgument(
+        name='cores',
+        default_value='0',
+        description='Cores of the machine, 0 for all')
+    reserved_cores_param = DeclareLaunchArgument(
+        name='reserved-cores',
+        default_value='1',
+        description='First cores left to the system and the supervisor')
+    priority_param = DeclareLaunchArgument(
+        name='priority',
+        default_value='0',
+        description='Set the real-time priority of every instance')
+    lock_memory_size_param = DeclareLaunchArgument(
+        name='lock-memory-size',
+        default_value='0',
+        description='Set the locked memory budget of every instance in MB')
+    params_param = DeclareLaunchArgument(
+        name='params',
+        default_value=param_file_path,
+        description='Parameters file of the instances')
+    duration_param = DeclareLaunchArgument(
+        name='duration',
+        default_value='30.0',
+        description='Run duration in seconds, 0 runs until interrupted')
+    output_param = DeclareLaunchArgument(
+        name='output',
+        default_value='',
+        description='Aggregated report csv path')
+
+    # Node definitions
+    pendulum_fleet_runner = Node(
+        package='pendulum_tools',
+        executable='pendulum_fleet',
+        output='screen',
+        arguments=[
+           '--instances', LaunchConfiguration('instances'),
+           '--cores', LaunchConfiguration('cores'),
+           '--reserved-cores', LaunchConfiguration('reserved-cores'),
+           '--priority', LaunchConfiguration('priority'),
+           '--lock-memory-size', LaunchConfiguration('lock-memory-size'),
+           '--params-file', LaunchConfiguration('params'),
+           '--duration', LaunchConfiguration('duration'),
+           '--output', LaunchConfiguration('output')
+           ]
+    )
+
+    ld = LaunchDescription()
+
+    ld.add_action(instances_param)
+    ld.add_action(cores_param)
+    ld.add_action(reserved_cores_param)
+    ld.add_action(priority_param)
+    ld.add_action(lock_memory_size_param)
+    ld.add_action(params_param)
+    ld.add_action(duration_param)
+    ld.add_action(output_param)
+    ld.add_action(pendulum_fleet_runner)
+
+    return ld
@@ -0,0 +1,95 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief Measures the inference time of MLP policies of different sizes, reporting the mean
+///        and the spread of single calls to show that the execution time does not depend on
+///        the state.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "pendulum_controller/mlp_policy.hpp"
+
+using pendulum::pendulum_controller::MlpPolicy;
+
+namespace
+{
+MlpPolicy make_policy(
+  const std::vector<std::size_t> & hidden, MlpPolicy::Activation activation)
+{
+  std::mt19937 rand_gen(1U);
+  std::uniform_real_distribution<float> dist(-0.5F, 0.5F);
+  std::vector<std::size_t> sizes{MlpPolicy::STATE_DIM};
+  sizes.insert(sizes.end(), hidden.begin(), hidden.end());
+  sizes.push_back(1U);
+  std::vector<MlpPolicy::Layer> layers;
+  for (std::size_t l = 0; l + 1U < sizes.size(); l++) {
+    MlpPolicy::Layer layer{sizes[l], sizes[l + 1U],
+      l + 2U < sizes.size() ? activation : MlpPolicy::Activation::LINEAR, {}, {}};
+    layer.weights.resize(layer.inputs * layer.outputs);
+    layer.bias.resize(layer.outputs);
+    for (auto & w : layer.weights) {
+      w = dist(rand_gen);
+    }
+    for (auto & b : layer.bias) {
+      b = dist(rand_gen);
+    }
+    layers.push_back(layer);
+  }
+  return MlpPolicy(1000.0, layers);
+}
+
+void measure(const char * name, const MlpPolicy & policy)
+{
+  const std::size_t iterations = 200000U;
+  std::mt19937 rand_gen(2U);
+  std::uniform_real_distribution<double> dist(-2.0, 2.0);
+  std::vector<double> samples(iterations);
+  double error[4] = {0.0, 0.0, 0.0, 0.0};
+  double checksum = 0.0;
+  for (std::size_t k = 0; k < iterations; k++) {
+    for (auto & e : error) {
+      e = dist(rand_gen);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    checksum += policy.evaluate(error);
+    const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    samples[k] = elapsed.count();
+  }
+  std::sort(samples.begin(), samples.end());
+  double mean = 0.0;
+  for (const double s : samples) {
+    mean += s / static_cast<double>(iterations);
+  }
+  std::printf(
+    "%-24s mean %8.1f ns  median %8.1f ns  p99 %8.1f ns  min %8.1f ns  (checksum %g)\n",
+    name, mean, samples[iterations / 2U], samples[iterations * 99U / 100U], samples.front(),
+    checksum);
+}
+}  // namespace
+
+int main()
+{
+  measure("4-32-32-1 tanh", make_policy({32U, 32U}, MlpPolicy::Activation::TANH));
+  measure("4-32-32-1 relu", make_policy({32U, 32U}, MlpPolicy::Activation::RELU));
+  measure("4-64-64-1 tanh", make_policy({64U, 64U}, MlpPolicy::Activation::TANH));
+  measure("4-64-64-1 relu", make_policy({64U, 64U}, MlpPolicy::Activation::RELU));
+  measure("4-256-256-1 tanh", make_policy({256U, 256U}, MlpPolicy::Activation::TANH));
+  return 0;
+}
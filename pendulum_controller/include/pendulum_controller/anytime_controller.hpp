@@ -0,0 +1,222 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides a deadline-bounded wrapper for expensive control laws.
+
+#ifndef PENDULUM_CONTROLLER__ANYTIME_CONTROLLER_HPP_
+#define PENDULUM_CONTROLLER__ANYTIME_CONTROLLER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "pendulum_controller/visibility_control.hpp"
+#include "pendulum_utils/latest_value_buffer.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+/// \class This class runs an expensive control law on a worker thread with a deadline.
+///
+///  At every state update the solve is started on the worker thread and the caller polls the
+///  result until it is final or the deadline after the state arrival expires. The law is an
+///  anytime algorithm: it is called repeatedly to refine the force and every completed iteration
+///  is a valid result. When the deadline expires the best available result is used, or the
+///  fallback force if no iteration completed, so a cycle is never missed. A solve which reaches
+///  the deadline is abandoned after its current iteration. The caller never takes a lock held by
+///  the worker: the inputs are passed through two buffers, of which the worker locks one at a
+///  time, and the result through a sequence lock, so a preempted worker can not block the
+///  caller. The worker can run with a real-time priority and be pinned to its own core.
+class PENDULUM_CONTROLLER_PUBLIC AnytimeController
+{
+public:
+  using State = std::array<double, 4>;
+
+  /// Expensive control law, refines the force for a state and reference in place. It is called
+  /// with increasing iteration numbers and returns true when the force is final.
+  using Refinement = std::function<bool (
+        const State & state, const State & reference, std::size_t iteration, double & force)>;
+
+  class PENDULUM_CONTROLLER_PUBLIC Config
+  {
+public:
+    /// \brief Constructor
+    /// \param[in] enabled use the expensive law, otherwise the fallback force is returned
+    /// \param[in] deadline time available for the solve after the state arrival
+    /// \param[in] period period of the state messages
+    /// \param[in] poll_period period at which the caller and the worker poll for new data
+    /// \param[in] priority SCHED_FIFO priority of the worker thread, 0 to not change it
+    /// \param[in] cpu core of the worker thread, negative to not pin it
+    /// \throw std::invalid_argument If the deadline or the poll period is not positive, if the
+    ///  deadline is not shorter than the period, if the priority is not in [0, 98] or if the
+    ///  core can not be set in the affinity mask
+    Config(
+      bool enabled, std::chrono::microseconds deadline, std::chrono::microseconds period,
+      std::chrono::microseconds poll_period, int priority, int cpu);
+
+    /// \brief Gets if the expensive law is enabled
+    /// \return True if enabled
+    bool is_enabled() const;
+
+    /// \brief Gets the time available for the solve after the state arrival
+    /// \return Deadline
+    std::chrono::nanoseconds get_deadline() const;
+
+    /// \brief Gets the period of the state messages
+    /// \return Period
+    std::chrono::nanoseconds get_period() const;
+
+    /// \brief Gets the poll period of the caller and the worker thread
+    /// \return Poll period
+    std::chrono::nanoseconds get_poll_period() const;
+
+    /// \brief Gets the real-time priority of the worker thread
+    /// \return SCHED_FIFO priority, 0 if it is not changed
+    int get_priority() const;
+
+    /// \brief Gets the core of the worker thread
+    /// \return Core index, negative if the thread is not pinned
+    int get_cpu() const;
+
+private:
+    bool enabled;
+    std::chrono::nanoseconds deadline;
+    std::chrono::nanoseconds period;
+    std::chrono::nanoseconds poll_period;
+    int priority;
+    int cpu;
+  };
+
+  /// \brief Constructor
+  /// \param[in] config Deadline configuration
+  /// \param[in] refinement Expensive control law
+  AnytimeController(const Config & config, Refinement refinement);
+
+  /// \brief Destructor, stops the worker thread
+  ~AnytimeController();
+
+  AnytimeController(const AnytimeController &) = delete;
+  AnytimeController & operator=(const AnytimeController &) = delete;
+
+  /// \brief Starts the worker thread if the controller is enabled, the thread applies its
+  ///  priority and affinity before it solves any state
+  /// \throw std::runtime_error If the priority or the affinity can not be set
+  void start();
+
+  /// \brief Stops the worker thread, waiting for the current iteration to finish
+  void stop();
+
+  /// \brief Computes the force command for a new state, never waits for the worker thread
+  /// \param[in] state Pendulum state
+  /// \param[in] reference Pendulum reference
+  /// \param[in] fallback_force Force of the cheap control law, used if no result is ready
+  /// \param[in] arrival_time Arrival time of the state, the deadline is relative to it
+  /// \return Force command in Newton
+  double update(
+    const std::vector<double> & state, const std::vector<double> & reference,
+    double fallback_force, std::chrono::steady_clock::time_point arrival_time);
+
+  /// \brief Gets the configuration
+  /// \return Configuration
+  const Config & get_config() const;
+
+  /// \brief Gets the number of updates with a final result
+  /// \return Number of updates
+  std::uint64_t get_num_final() const;
+
+  /// \brief Gets the number of updates with a partially refined result
+  /// \return Number of updates
+  std::uint64_t get_num_partial() const;
+
+  /// \brief Gets the number of updates which used the fallback force
+  /// \return Number of updates
+  std::uint64_t get_num_fallback() const;
+
+  /// \brief Resets the counters
+  void reset_counters();
+
+private:
+  /// Inputs of a solve
+  struct Job
+  {
+    // number of the job, starting at 1
+    std::uint64_t id;
+    State state;
+    State reference;
+  };
+
+  /// Best result of a job
+  struct Result
+  {
+    std::uint64_t job;
+    double force;
+    bool final;
+  };
+
+  /// \brief Worker thread loop
+  /// \param[in] last_job Last job posted before the worker was started
+  /// \param[in] started Set with 0 once the thread settings are applied, or with the error
+  void run(std::uint64_t last_job, std::promise<int> started);
+
+  /// \brief Applies the priority and the affinity to the calling thread
+  /// \return 0 on success, the error number otherwise
+  int configure_worker_thread() const;
+
+  /// \brief Reads the latest posted job, called by the worker thread
+  /// \param[out] job Job with the highest id, unchanged if no newer one was posted
+  void read_latest_job(Job & job);
+
+  /// \brief Publishes a result, called by the worker thread
+  /// \param[in] result Result
+  void write_result(const Result & result) noexcept;
+
+  /// \brief Reads the last published result without waiting for the worker thread
+  /// \param[out] result Result, unchanged if the worker is publishing a new one
+  /// \return False if the worker is publishing a new result
+  bool read_result(Result & result) const noexcept;
+
+  const Config cfg_;
+  Refinement refinement_;
+
+  std::thread worker_;
+  std::atomic<bool> stop_requested_;
+
+  // the caller uses the second buffer when the worker is copying the first one
+  utils::LatestValueBuffer<Job> jobs_[2];
+  // only used by the caller
+  std::uint64_t job_;
+  // job the worker may refine, 0 after its deadline
+  std::atomic<std::uint64_t> active_job_;
+
+  // result of the worker, an odd sequence means it is being written
+  std::atomic<std::uint32_t> result_sequence_;
+  std::atomic<std::uint64_t> result_job_;
+  std::atomic<double> result_force_;
+  std::atomic<bool> result_final_;
+
+  std::uint64_t num_final_;
+  std::uint64_t num_partial_;
+  std::uint64_t num_fallback_;
+};
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+#endif  // PENDULUM_CONTROLLER__ANYTIME_CONTROLLER_HPP_
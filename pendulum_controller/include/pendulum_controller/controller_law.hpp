@@ -0,0 +1,83 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the interface of the control laws loaded as plugins.
+
+#ifndef PENDULUM_CONTROLLER__CONTROLLER_LAW_HPP_
+#define PENDULUM_CONTROLLER__CONTROLLER_LAW_HPP_
+
+#include <string>
+#include <vector>
+
+#include "rclcpp/node_interfaces/node_parameters_interface.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+/// \class This class is the interface of a control law implementation loaded with pluginlib.
+///
+///  The implementations are created and initialized when the controller node is configured, and
+///  all their memory is allocated then. The compute method is called from the real-time thread
+///  and must not allocate memory or block.
+class ControllerLaw
+{
+public:
+  virtual ~ControllerLaw() = default;
+
+  /// \brief Declares and reads the parameters of the law and allocates its memory
+  /// \param[in] prefix Parameter prefix of this instance, e.g. "controllers.lqr"
+  /// \param[in] parameters Parameters interface of the controller node
+  /// \throw std::exception If the parameters are not valid
+  virtual void initialize(
+    const std::string & prefix,
+    const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr & parameters) = 0;
+
+  /// \brief Resets the internal state of the law
+  virtual void reset() {}
+
+  /// \brief Computes the force command
+  /// \param[in] state Cart position, cart velocity, pole angle and pole velocity
+  /// \param[in] reference Reference of the state
+  /// \return Force command in Newton
+  virtual double compute(
+    const std::vector<double> & state,
+    const std::vector<double> & reference) = 0;
+
+  /// \brief Aligns the internal state of the law with the command of the law it replaces
+  ///
+  ///  Called before the first compute after a switch. Laws with memory, e.g. an integral term,
+  ///  should set it so that their output matches the given force. The remaining mismatch is
+  ///  removed by the switcher.
+  /// \param[in] state Current state
+  /// \param[in] reference Current reference
+  /// \param[in] force Force of the previous law for this state
+  virtual void align(
+    const std::vector<double> & state,
+    const std::vector<double> & reference,
+    double force)
+  {
+    (void)state;
+    (void)reference;
+    (void)force;
+  }
+
+protected:
+  ControllerLaw() = default;
+};
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+#endif  // PENDULUM_CONTROLLER__CONTROLLER_LAW_HPP_
@@ -0,0 +1,87 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the control laws exported as plugins by this package.
+
+#ifndef PENDULUM_CONTROLLER__CONTROLLER_LAWS_HPP_
+#define PENDULUM_CONTROLLER__CONTROLLER_LAWS_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pendulum_controller/controller_law.hpp"
+#include "pendulum_controller/pendulum_controller.hpp"
+#include "pendulum_controller/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+/// \class This class implements a control law with a PendulumController.
+class PENDULUM_CONTROLLER_PUBLIC PendulumControllerLaw : public ControllerLaw
+{
+public:
+  void reset() override;
+
+  double compute(
+    const std::vector<double> & state,
+    const std::vector<double> & reference) override;
+
+protected:
+  /// \brief Creates the controller
+  /// \param[in] config Controller configuration
+  void create_controller(const PendulumController::Config & config);
+
+private:
+  std::unique_ptr<PendulumController> controller_;
+};
+
+/// \class This class implements a full state feedback law.
+///
+///  Parameters: `<prefix>.feedback_matrix`.
+class PENDULUM_CONTROLLER_PUBLIC FeedbackLaw : public PendulumControllerLaw
+{
+public:
+  void initialize(
+    const std::string & prefix,
+    const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr & parameters) override;
+};
+
+/// \class This class implements an explicit MPC law.
+///
+///  Parameters: `<prefix>.explicit_mpc_table`, path of the table.
+class PENDULUM_CONTROLLER_PUBLIC ExplicitMpcLaw : public PendulumControllerLaw
+{
+public:
+  void initialize(
+    const std::string & prefix,
+    const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr & parameters) override;
+};
+
+/// \class This class implements a learned MLP policy.
+///
+///  Parameters: `<prefix>.mlp_policy`, path of the policy weights.
+class PENDULUM_CONTROLLER_PUBLIC MlpPolicyLaw : public PendulumControllerLaw
+{
+public:
+  void initialize(
+    const std::string & prefix,
+    const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr & parameters) override;
+};
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+#endif  // PENDULUM_CONTROLLER__CONTROLLER_LAWS_HPP_
@@ -0,0 +1,128 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides a bumpless switch between preloaded control laws.
+
+#ifndef PENDULUM_CONTROLLER__CONTROLLER_SWITCHER_HPP_
+#define PENDULUM_CONTROLLER__CONTROLLER_SWITCHER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pendulum_controller/controller_law.hpp"
+#include "pendulum_controller/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+/// \class This class switches between control laws at a cycle boundary without a force jump.
+///
+///  All the laws are added at configuration time. A switch is requested from any thread and it
+///  is applied at the start of the next update, where it only changes the active law pointer.
+///  At the switch, the new law is aligned with the force of the previous law for the current
+///  state, and the remaining difference is added as an offset which decreases linearly to zero
+///  over the transfer cycles. The output in the switch cycle matches the previous law and the
+///  new law takes over smoothly.
+class PENDULUM_CONTROLLER_PUBLIC ControllerSwitcher
+{
+public:
+  class PENDULUM_CONTROLLER_PUBLIC Config
+  {
+public:
+    /// \brief Constructor
+    /// \param[in] transfer_cycles cycles to remove the force difference after a switch, 0
+    ///            removes it in the cycle after the switch
+    explicit Config(std::size_t transfer_cycles);
+
+    /// \brief Gets the number of transfer cycles
+    /// \return Transfer cycles
+    std::size_t get_transfer_cycles() const;
+
+private:
+    std::size_t transfer_cycles;
+  };
+
+  /// \brief Constructor
+  /// \param[in] config Switcher configuration
+  explicit ControllerSwitcher(const Config & config);
+
+  /// \brief Adds a law, not thread-safe, the first law added is the active one
+  /// \param[in] name Law name
+  /// \param[in] law Initialized law
+  /// \throw std::invalid_argument If the name is already used or the law is null
+  void add(const std::string & name, std::shared_ptr<ControllerLaw> law);
+
+  /// \brief Removes all the laws, not thread-safe
+  void clear();
+
+  /// \brief Requests a switch at the next update, can be called from any thread
+  /// \param[in] name Name of the law to activate
+  /// \return False if there is no law with this name
+  bool request(const std::string & name);
+
+  /// \brief Computes the force command with the active law, applying a pending switch first
+  /// \param[in] state Cart position, cart velocity, pole angle and pole velocity
+  /// \param[in] reference Reference of the state
+  /// \return Force command in Newton
+  double update(const std::vector<double> & state, const std::vector<double> & reference);
+
+  /// \brief Resets the laws and the transfer offset, keeping the active law
+  void reset();
+
+  /// \brief Checks if any law was added
+  /// \return True if there are no laws
+  bool empty() const;
+
+  /// \brief Gets the name of the active law
+  /// \return Law name
+  const std::string & get_active_name() const;
+
+  /// \brief Gets the index of the active law, in the order the laws were added
+  /// \return Law index
+  std::size_t get_active_index() const;
+
+  /// \brief Gets the names of the laws
+  /// \return Law names
+  const std::vector<std::string> & get_names() const;
+
+  /// \brief Gets the remaining force offset of the last switch
+  /// \return Force offset in Newton
+  double get_transfer_offset() const;
+
+  /// \brief Gets the number of switches applied
+  /// \return Number of switches
+  std::uint64_t get_num_switches() const;
+
+private:
+  const Config cfg_;
+  std::vector<std::string> names_;
+  std::vector<std::shared_ptr<ControllerLaw>> laws_;
+  // index requested by any thread and index used by the update thread
+  std::atomic<std::size_t> requested_;
+  std::atomic<std::size_t> active_index_;
+  ControllerLaw * active_;
+  double transfer_offset_;
+  double transfer_step_;
+  std::atomic<std::uint64_t> num_switches_;
+};
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+#endif  // PENDULUM_CONTROLLER__CONTROLLER_SWITCHER_HPP_
@@ -0,0 +1,115 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the triggering condition for event-based command publishing.
+
+#ifndef PENDULUM_CONTROLLER__EVENT_TRIGGER_HPP_
+#define PENDULUM_CONTROLLER__EVENT_TRIGGER_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "pendulum_controller/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+/// \class This class decides when a new force command has to be published.
+///
+///  A command is published when the force differs from the last published one more than a
+///  threshold, when a state element moved away from its value at the last publication more than
+///  the threshold of that element, or when no command was published during the maximum silence
+///  interval. In between, the driver keeps applying the last received force.
+class PENDULUM_CONTROLLER_PUBLIC EventTrigger
+{
+public:
+  class PENDULUM_CONTROLLER_PUBLIC Config
+  {
+public:
+    /// \brief Constructor
+    /// \param[in] enabled publish only when a triggering condition holds
+    /// \param[in] force_threshold force change in Newton which triggers a publication
+    /// \param[in] state_thresholds change of the cart position (m), cart velocity (m/s), pole
+    ///            angle (rad) and pole angular velocity (rad/s) which triggers a publication,
+    ///            0 disables the condition of that element
+    /// \param[in] max_silence maximum time between two publications
+    /// \throw std::invalid_argument If there are not 4 thresholds or one is negative
+    Config(
+      bool enabled, double force_threshold, const std::vector<double> & state_thresholds,
+      std::chrono::microseconds max_silence);
+
+    /// \brief Gets if the event trigger is enabled
+    /// \return True if enabled
+    bool is_enabled() const;
+
+    /// \brief Gets the force threshold
+    /// \return force threshold in Newton
+    double get_force_threshold() const;
+
+    /// \brief Gets the state thresholds
+    /// \return threshold of every state element, 0 if disabled
+    const std::vector<double> & get_state_thresholds() const;
+
+    /// \brief Gets the maximum silence interval
+    /// \return maximum silence interval
+    std::chrono::microseconds get_max_silence() const;
+
+private:
+    bool enabled;
+    double force_threshold;
+    std::vector<double> state_thresholds;
+    std::chrono::microseconds max_silence;
+  };
+
+  /// \brief Constructor
+  /// \param[in] config Triggering configuration
+  explicit EventTrigger(const Config & config);
+
+  /// \brief Forgets the last publication so the next command is always published
+  void reset();
+
+  /// \brief Evaluates the triggering conditions for a new command
+  /// \param[in] force New force command in Newton
+  /// \param[in] state Pendulum state used to compute the command
+  /// \param[in] now Current time
+  /// \return True if the command has to be published
+  bool update(
+    double force, const std::vector<double> & state,
+    std::chrono::steady_clock::time_point now);
+
+  /// \brief Gets the number of evaluated commands
+  /// \return Number of commands
+  std::uint64_t get_num_commands() const;
+
+  /// \brief Gets the number of commands which had to be published
+  /// \return Number of published commands
+  std::uint64_t get_num_published() const;
+
+private:
+  const Config cfg_;
+  bool has_published_;
+  double last_force_;
+  std::array<double, 4> last_state_;
+  std::chrono::steady_clock::time_point last_publish_time_;
+  std::uint64_t num_commands_;
+  std::uint64_t num_published_;
+};
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+#endif  // PENDULUM_CONTROLLER__EVENT_TRIGGER_HPP_
@@ -0,0 +1,152 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the runtime lookup table of an explicit MPC control law.
+
+#ifndef PENDULUM_CONTROLLER__EXPLICIT_MPC_TABLE_HPP_
+#define PENDULUM_CONTROLLER__EXPLICIT_MPC_TABLE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pendulum_controller/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+/// \class This class stores a precomputed piecewise-affine explicit MPC law.
+///
+///  The state error space is partitioned in polyhedral regions, each one with an affine control
+///  law u = gain * error + offset. To find the active region without searching all of them, the
+///  bounding box of the table is divided in a uniform grid and every cell keeps the list of
+///  regions intersecting it, so a lookup hashes the error to its cell and checks only a few
+///  candidates. Errors outside the box use the nearest region of the closest cell. The lookup
+///  does not allocate memory.
+///
+///  The table is generated offline by the pendulum_explicit_mpc tool and stored in a compact
+///  binary file with single precision coefficients.
+class PENDULUM_CONTROLLER_PUBLIC ExplicitMpcTable
+{
+public:
+  static constexpr std::size_t STATE_DIM = 4U;
+
+  /// Affine control law of a region and the range of its constraints.
+  struct Region
+  {
+    std::array<float, STATE_DIM> gain;
+    float offset;
+    std::uint32_t first_constraint;
+    std::uint32_t num_constraints;
+  };
+
+  /// Half-space normal * error <= bound.
+  struct Constraint
+  {
+    std::array<float, STATE_DIM> normal;
+    float bound;
+  };
+
+  /// Uniform grid over the state error box.
+  struct Grid
+  {
+    std::array<double, STATE_DIM> lower;
+    std::array<double, STATE_DIM> upper;
+    std::array<std::uint32_t, STATE_DIM> cells;
+  };
+
+  /// \brief Constructor
+  /// \param[in] max_force Force limit used to compute the law, the output is clamped to it
+  /// \param[in] grid Lookup grid
+  /// \param[in] regions Regions of the partition
+  /// \param[in] constraints Constraints of all the regions
+  /// \param[in] cell_offsets Start of the candidate list of every cell, plus the end
+  /// \param[in] cell_regions Candidate region indices of all the cells
+  /// \throw std::invalid_argument If the data is not consistent
+  ExplicitMpcTable(
+    double max_force,
+    const Grid & grid,
+    std::vector<Region> regions,
+    std::vector<Constraint> constraints,
+    std::vector<std::uint32_t> cell_offsets,
+    std::vector<std::uint16_t> cell_regions);
+
+  /// \brief Loads a table from a binary file
+  /// \param[in] path File path
+  /// \return Table
+  /// \throw std::runtime_error If the file can not be read or has a wrong format
+  static ExplicitMpcTable load(const std::string & path);
+
+  /// \brief Stores the table in a binary file
+  /// \param[in] path File path
+  /// \throw std::runtime_error If the file can not be written
+  void save(const std::string & path) const;
+
+  /// \brief Deserializes a table
+  /// \param[in] data Binary table
+  /// \return Table
+  /// \throw std::runtime_error If the data has a wrong format
+  static ExplicitMpcTable from_bytes(const std::vector<std::uint8_t> & data);
+
+  /// \brief Serializes the table
+  /// \return Binary table
+  std::vector<std::uint8_t> to_bytes() const;
+
+  /// \brief Finds the region containing a state error
+  /// \param[in] error State error: cart position, cart velocity, pole angle, pole velocity
+  /// \return Region index
+  std::size_t find_region(const double * error) const noexcept;
+
+  /// \brief Evaluates the control law
+  /// \param[in] error State error: cart position, cart velocity, pole angle, pole velocity
+  /// \return Force command in Newton, within the force limits
+  double evaluate(const double * error) const noexcept;
+
+  /// \brief Gets the force limit
+  /// \return Force limit in Newton
+  double get_max_force() const;
+
+  /// \brief Gets the lookup grid
+  /// \return Grid
+  const Grid & get_grid() const;
+
+  /// \brief Gets the regions of the partition
+  /// \return Regions
+  const std::vector<Region> & get_regions() const;
+
+  /// \brief Gets the number of candidate regions stored for all the cells
+  /// \return Number of candidates
+  std::size_t get_num_cell_regions() const;
+
+private:
+  /// \brief Computes the cell index of a state error, clamped to the grid
+  std::size_t cell_index(const double * error) const noexcept;
+
+  double max_force_;
+  Grid grid_;
+  // cells per unit of state error in every dimension
+  std::array<double, STATE_DIM> cell_scale_;
+  std::vector<Region> regions_;
+  std::vector<Constraint> constraints_;
+  std::vector<std::uint32_t> cell_offsets_;
+  std::vector<std::uint16_t> cell_regions_;
+};
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+#endif  // PENDULUM_CONTROLLER__EXPLICIT_MPC_TABLE_HPP_
@@ -0,0 +1,135 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the inference engine of learned multilayer perceptron policies.
+
+#ifndef PENDULUM_CONTROLLER__MLP_POLICY_HPP_
+#define PENDULUM_CONTROLLER__MLP_POLICY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pendulum_controller/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+/// \class This class evaluates a small multilayer perceptron (MLP) control policy.
+///
+///  The network maps the state error (cart position, cart velocity, pole angle, pole velocity)
+///  to the force command through dense layers with linear, tanh or ReLU activations. The
+///  parameters are packed at load time in 16-byte aligned blocks of 4 floats, with the layer
+///  sizes padded with zeros to a multiple of 4, and every layer is computed with 128-bit SIMD
+///  kernels (SSE or NEON, scalar otherwise). The inference does not allocate memory and has no
+///  data dependent branches, tanh uses a clamped rational approximation, so its execution time
+///  only depends on the network shape.
+///
+///  The policy is trained offline and stored in a flat binary file with single precision
+///  weights, see the tutorial for the format.
+class PENDULUM_CONTROLLER_PUBLIC MlpPolicy
+{
+public:
+  static constexpr std::size_t STATE_DIM = 4U;
+  /// maximum number of neurons of a layer, the activations are kept on the stack
+  static constexpr std::size_t MAX_LAYER_SIZE = 256U;
+
+  enum class Activation : std::uint32_t
+  {
+    LINEAR = 0U,
+    TANH = 1U,
+    RELU = 2U
+  };
+
+  /// Dense layer y = activation(weights * x + bias).
+  struct Layer
+  {
+    std::size_t inputs;
+    std::size_t outputs;
+    Activation activation;
+    /// row-major outputs x inputs matrix
+    std::vector<float> weights;
+    std::vector<float> bias;
+  };
+
+  /// \brief Constructor
+  /// \param[in] max_force Force limit, the output is clamped to it
+  /// \param[in] layers Layers from the input to the output, the output layer has one neuron
+  /// \throw std::invalid_argument If the layers are not consistent
+  MlpPolicy(double max_force, const std::vector<Layer> & layers);
+
+  /// \brief Loads a policy from a binary file
+  /// \param[in] path File path
+  /// \return Policy
+  /// \throw std::runtime_error If the file can not be read or has a wrong format
+  static MlpPolicy load(const std::string & path);
+
+  /// \brief Stores the policy in a binary file
+  /// \param[in] path File path
+  /// \throw std::runtime_error If the file can not be written
+  void save(const std::string & path) const;
+
+  /// \brief Deserializes a policy
+  /// \param[in] data Binary policy
+  /// \return Policy
+  /// \throw std::runtime_error If the data has a wrong format
+  static MlpPolicy from_bytes(const std::vector<std::uint8_t> & data);
+
+  /// \brief Serializes the policy
+  /// \return Binary policy
+  std::vector<std::uint8_t> to_bytes() const;
+
+  /// \brief Evaluates the policy
+  /// \param[in] error State error: cart position, cart velocity, pole angle, pole velocity
+  /// \return Force command in Newton, within the force limits
+  double evaluate(const double * error) const noexcept;
+
+  /// \brief Gets the force limit
+  /// \return Force limit in Newton
+  double get_max_force() const;
+
+  /// \brief Gets the layers of the network
+  /// \return Layers
+  const std::vector<Layer> & get_layers() const;
+
+private:
+  /// Four floats aligned for 128-bit loads and stores.
+  struct alignas(16) Block
+  {
+    float values[4];
+  };
+
+  /// Position of the packed parameters of a layer.
+  struct PackedLayer
+  {
+    std::size_t input_blocks;
+    std::size_t output_blocks;
+    Activation activation;
+    std::size_t weights;
+    std::size_t bias;
+  };
+
+  double max_force_;
+  std::vector<Layer> layers_;
+  std::vector<PackedLayer> packed_layers_;
+  // column-major weights and bias of all the layers
+  std::vector<Block> parameters_;
+};
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+#endif  // PENDULUM_CONTROLLER__MLP_POLICY_HPP_
@@ -19,11 +19,14 @@
 #define PENDULUM_CONTROLLER__PENDULUM_CONTROLLER_HPP_
 
 #include <cmath>
+#include <memory>
 #include <vector>
 
 #include "pendulum2_msgs/msg/joint_state.hpp"
 #include "pendulum2_msgs/msg/joint_command.hpp"
 #include "pendulum2_msgs/msg/pendulum_teleop.hpp"
+#include "pendulum_controller/explicit_mpc_table.hpp"
+#include "pendulum_controller/mlp_policy.hpp"
 #include "pendulum_controller/visibility_control.hpp"
 
 namespace pendulum
@@ -35,7 +38,9 @@ namespace pendulum_controller
 ///
 ///  The FSF uses the full internal state of the system to control the system in a closed loop.
 ///  This controller allows to implement both a controller designed using closed loop placement
-///  techniques or a Linear Quadratic Regulator (LQR)
+///  techniques or a Linear Quadratic Regulator (LQR). Optionally, the command is computed with
+///  a precomputed explicit MPC law which takes the force limits into account, or with a learned
+///  MLP policy.
 class PENDULUM_CONTROLLER_PUBLIC PendulumController
 {
 public:
@@ -44,15 +49,34 @@ public:
 public:
     /// \brief Constructor
     /// \param[in] feedback matrix
-    explicit Config(std::vector<double> feedback_matrix);
+    /// \param[in] explicit_mpc_table explicit MPC law used instead of the feedback matrix
+    ///            if not null
+    /// \param[in] mlp_policy learned policy used instead of the feedback matrix if not null
+    /// \throw std::invalid_argument If both the explicit MPC law and the policy are set
+    explicit Config(
+      std::vector<double> feedback_matrix,
+      std::shared_ptr<const ExplicitMpcTable> explicit_mpc_table = nullptr,
+      std::shared_ptr<const MlpPolicy> mlp_policy = nullptr);
 
     /// \brief Gets the feedback matrix
     /// \return feedback matrix array
     const std::vector<double> & get_feedback_matrix() const;
 
+    /// \brief Gets the explicit MPC law
+    /// \return explicit MPC table, null if the feedback matrix is used
+    const std::shared_ptr<const ExplicitMpcTable> & get_explicit_mpc_table() const;
+
+    /// \brief Gets the learned policy
+    /// \return MLP policy, null if the feedback matrix is used
+    const std::shared_ptr<const MlpPolicy> & get_mlp_policy() const;
+
 private:
     /// feedback_matrix Feedback matrix values
     std::vector<double> feedback_matrix;
+    /// explicit_mpc_table Precomputed explicit MPC law
+    std::shared_ptr<const ExplicitMpcTable> explicit_mpc_table;
+    /// mlp_policy Learned control policy
+    std::shared_ptr<const MlpPolicy> mlp_policy;
   };
 
   /// \brief Controller constructor
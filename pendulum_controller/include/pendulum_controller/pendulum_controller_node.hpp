@@ -20,7 +20,9 @@
 
 #include <string>
 #include <climits>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp/publisher.hpp"
@@ -28,9 +30,24 @@
 #include "rclcpp_lifecycle/lifecycle_publisher.hpp"
 #include "lifecycle_msgs/msg/transition_event.hpp"
 #include "lifecycle_msgs/msg/transition.hpp"
+#include "pluginlib/class_loader.hpp"
+#include "pendulum2_msgs/srv/select_controller.hpp"
 
+#include "pendulum_controller/anytime_controller.hpp"
+#include "pendulum_controller/controller_law.hpp"
+#include "pendulum_controller/controller_switcher.hpp"
+#include "pendulum_controller/event_trigger.hpp"
 #include "pendulum_controller/pendulum_controller.hpp"
+#include "pendulum_controller/shadow_controller.hpp"
 #include "pendulum_controller/visibility_control.hpp"
+#include "pendulum_utils/load_shedder.hpp"
+#include "pendulum_utils/instrumentation_log.hpp"
+#include "pendulum_utils/perf_counters.hpp"
+#include "pendulum_utils/persistent_state.hpp"
+#include "pendulum_utils/pre_serialized_message.hpp"
+#include "pendulum_utils/thread_time_accounting.hpp"
+#include "pendulum_utils/trace_marker.hpp"
+#include "pendulum_utils/tsc_clock.hpp"
 
 namespace pendulum
 {
@@ -53,6 +70,26 @@ public:
     const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
 
 private:
+  /// Controller state mirrored in shared memory to resume after a restart
+  struct ControllerSnapshot
+  {
+    // steady clock time of the store in nanoseconds
+    std::int64_t time_ns;
+    std::uint64_t num_cycles;
+    double state[4];
+    double reference[4];
+    double force_command;
+    // hash of the controller parameters and of the table and policy files, a snapshot of
+    // another configuration is not restored
+    std::uint64_t config_fingerprint;
+    // index of the active switcher law, the force command is only continued by the same law
+    std::uint64_t active_law;
+  };
+
+  /// \brief Hashes the parameters of the control laws and the files they load
+  /// \return Configuration fingerprint
+  std::uint64_t get_config_fingerprint() const;
+
   /// \brief Create teleoperation subscription
   void create_teleoperation_subscription();
 
@@ -62,9 +99,28 @@ private:
   /// \brief Create command publisher
   void create_command_publisher();
 
+  /// \brief Create the publisher of the shadow candidate commands
+  void create_shadow_command_publisher();
+
+  /// \brief Create the service selecting the active control law
+  void create_select_controller_service();
+
+  /// \brief Loads and initializes the control law plugins
+  void load_controller_laws();
+
+  /// \brief Loads and initializes the shadow candidate law plugin
+  void load_shadow_controller();
+
   /// \brief Log pendulum controller state
   void log_controller_state();
 
+  /// \brief Stores the controller state in the persistence segment
+  void store_controller_state();
+
+  /// \brief Restores the controller state from the persistence segment if it is recent enough
+  /// \return True if the state was restored
+  bool restore_controller_state();
+
   /// \brief Transition callback for state configuring
   /// \param[in] lifecycle node state
   rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
@@ -97,17 +153,65 @@ private:
   const std::string topic_stats_topic_name_;
   std::chrono::milliseconds topic_stats_publish_period_;
   std::chrono::milliseconds deadline_duration_;
+  bool enable_pre_serialization_;
+  bool enable_persistence_;
+  const std::string persistence_segment_name_;
+  std::chrono::milliseconds persistence_max_age_;
+  const std::string shadow_command_topic_name_;
+  bool enable_perf_counters_;
+  bool enable_thread_time_accounting_;
+  bool enable_trace_marker_;
 
   PendulumController controller_;
+  EventTrigger event_trigger_;
+  // sheds the statistics, instrumentation and shadow evaluation when the state callback runs out
+  // of headroom, configured again from its parameters in every configuration
+  utils::LoadShedder load_shedder_;
+  // cheap feedback law used when the anytime controller has no result
+  PendulumController linear_controller_;
+  AnytimeController anytime_controller_;
+  bool enable_controller_switching_;
+  std::vector<std::string> controller_names_;
+  // the loader must outlive the laws it created
+  std::unique_ptr<pluginlib::ClassLoader<ControllerLaw>> law_loader_;
+  ControllerSwitcher controller_switcher_;
+  std::unique_ptr<utils::PersistentState<ControllerSnapshot>> persistent_state_;
+  // snapshot with the configuration filled in, the state is copied in it every cycle
+  ControllerSnapshot snapshot_;
+  // counters of the thread which activated the node, null if they are disabled
+  std::unique_ptr<utils::PerfCounters> perf_counters_;
+  std::unique_ptr<utils::PerfSection> perf_update_;
+  std::unique_ptr<utils::PerfSection> perf_publish_;
+  // CPU time versus wall time of the state callback
+  utils::ThreadTimeAccounting state_callback_time_;
+  // cycle events in the kernel trace, null if disabled
+  std::unique_ptr<utils::TraceMarker> trace_marker_;
+  std::uint64_t num_cycles_;
 
   std::shared_ptr<rclcpp::Subscription<pendulum2_msgs::msg::JointState>> state_sub_;
   std::shared_ptr<rclcpp::Subscription<pendulum2_msgs::msg::PendulumTeleop>> teleop_sub_;
   std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<
       pendulum2_msgs::msg::JointCommand>> command_pub_;
+  std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<
+      pendulum2_msgs::msg::JointCommand>> shadow_command_pub_;
+  std::shared_ptr<rclcpp::Service<pendulum2_msgs::srv::SelectController>> select_controller_srv_;
   pendulum2_msgs::msg::JointCommand command_message_;
+  // command message serialized once and patched every cycle
+  utils::PreSerializedMessage<pendulum2_msgs::msg::JointCommand> serialized_command_message_;
+  // declared after the loader and the publisher so its thread is stopped before they are destroyed
+  ShadowController shadow_controller_;
 
   uint32_t num_missed_deadlines_pub_;
   uint32_t num_missed_deadlines_sub_;
+
+  // event trigger statistics since the last activation
+  std::chrono::steady_clock::time_point activation_time_;
+  std::chrono::nanoseconds publish_duration_;
+  // publications timed in cycles which were not shed
+  std::uint64_t num_publish_timed_;
+
+  // the state subscription was created without topic statistics because of load shedding
+  bool topic_stats_shed_;
 };
 }  // namespace pendulum_controller
 }  // namespace pendulum
@@ -0,0 +1,170 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the evaluation of a candidate control law on live data.
+
+#ifndef PENDULUM_CONTROLLER__SHADOW_CONTROLLER_HPP_
+#define PENDULUM_CONTROLLER__SHADOW_CONTROLLER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "pendulum_controller/controller_law.hpp"
+#include "pendulum_controller/visibility_control.hpp"
+#include "pendulum_utils/atomic_accumulator.hpp"
+#include "pendulum_utils/latest_value_buffer.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+/// \class This class runs a candidate control law in shadow of the active one.
+///
+///  The control thread submits the state, the reference and the applied force of every cycle
+///  without waiting. A worker thread, optionally pinned to its own core, computes the force of
+///  the candidate law for the same inputs. The candidate force is only reported, never applied.
+///  The difference with the applied force and the candidate compute time are kept in lock-free
+///  accumulators, which can be read from any thread. If the worker is still busy when new
+///  inputs arrive, it evaluates only the latest ones and the others are counted as skipped.
+///  The inputs are passed through two buffers and the worker locks one at a time, so the latest
+///  inputs are never dropped.
+class PENDULUM_CONTROLLER_PUBLIC ShadowController
+{
+public:
+  /// Function called by the worker thread with the candidate and the applied forces
+  using ResultCallback = std::function<void (double candidate_force, double active_force)>;
+
+  class PENDULUM_CONTROLLER_PUBLIC Config
+  {
+public:
+    /// \brief Constructor
+    /// \param[in] enabled run the candidate law
+    /// \param[in] cpu core of the worker thread, negative to not pin it
+    /// \param[in] poll_period period at which the worker checks for new inputs
+    /// \throw std::invalid_argument If the poll period is not positive
+    Config(bool enabled, int cpu, std::chrono::microseconds poll_period);
+
+    /// \brief Gets if the candidate law runs
+    /// \return True if enabled
+    bool is_enabled() const;
+
+    /// \brief Gets the core of the worker thread
+    /// \return Core index, negative if the thread is not pinned
+    int get_cpu() const;
+
+    /// \brief Gets the poll period of the worker thread
+    /// \return Poll period
+    std::chrono::microseconds get_poll_period() const;
+
+private:
+    bool enabled;
+    int cpu;
+    std::chrono::microseconds poll_period;
+  };
+
+  /// \brief Constructor
+  /// \param[in] config Shadow configuration
+  explicit ShadowController(const Config & config);
+
+  /// \brief Destructor, stops the worker thread
+  ~ShadowController();
+
+  ShadowController(const ShadowController &) = delete;
+  ShadowController & operator=(const ShadowController &) = delete;
+
+  /// \brief Sets the candidate law, the worker thread must be stopped
+  /// \param[in] candidate Initialized law
+  /// \param[in] on_result Optional callback called by the worker with every result
+  void set_candidate(std::shared_ptr<ControllerLaw> candidate, ResultCallback on_result = nullptr);
+
+  /// \brief Starts the worker thread if enabled and a candidate is set, the thread pins itself
+  ///  to the configured core before it evaluates any input
+  /// \throw std::runtime_error If the thread can not be pinned to the configured core
+  void start();
+
+  /// \brief Stops the worker thread, waiting for the current evaluation to finish
+  void stop();
+
+  /// \brief Submits the inputs of a cycle, called by the control thread, never waits
+  /// \param[in] state Cart position, cart velocity, pole angle and pole velocity
+  /// \param[in] reference Reference of the state
+  /// \param[in] active_force Force applied by the active law
+  void submit(
+    const std::vector<double> & state, const std::vector<double> & reference,
+    double active_force) noexcept;
+
+  /// \brief Gets the configuration
+  /// \return Configuration
+  const Config & get_config() const;
+
+  /// \brief Gets the statistics of the candidate force minus the applied force
+  /// \return Deviation statistics in Newton
+  const utils::AtomicAccumulator & get_deviation() const;
+
+  /// \brief Gets the statistics of the candidate compute time
+  /// \return Compute time statistics in microseconds
+  const utils::AtomicAccumulator & get_compute_time() const;
+
+  /// \brief Gets the number of submitted inputs that were not evaluated
+  /// \return Number of skipped inputs
+  std::uint64_t get_num_skipped() const;
+
+  /// \brief Resets the statistics, the worker thread must be stopped
+  void reset_statistics();
+
+private:
+  /// Inputs of a cycle
+  struct Sample
+  {
+    // number of the submission, starting at 1
+    std::uint64_t sequence;
+    double state[4];
+    double reference[4];
+    double active_force;
+  };
+
+  /// \brief Worker thread loop
+  /// \param[in] pinned Set with 0 once the thread is pinned, or with the pinning error
+  void run(std::promise<int> pinned);
+
+  /// \brief Reads the latest submitted inputs
+  /// \param[out] sample Inputs with the highest sequence, unchanged if nothing was submitted
+  void read_latest(Sample & sample);
+
+  const Config cfg_;
+  std::shared_ptr<ControllerLaw> candidate_;
+  ResultCallback on_result_;
+  // the writer uses the second buffer when the worker is copying the first one
+  utils::LatestValueBuffer<Sample> inputs_[2];
+  // only used by the control thread
+  std::uint64_t num_submitted_;
+  std::thread worker_;
+  std::atomic<bool> stop_requested_;
+  utils::AtomicAccumulator deviation_;
+  utils::AtomicAccumulator compute_time_;
+  std::atomic<std::uint64_t> num_skipped_;
+  // sequence of the last evaluated inputs, only used by the worker
+  std::uint64_t last_sequence_;
+};
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+#endif  // PENDULUM_CONTROLLER__SHADOW_CONTROLLER_HPP_
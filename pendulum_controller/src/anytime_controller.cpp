@@ -0,0 +1,306 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_controller/anytime_controller.hpp"
+
+#include <sched.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pendulum_utils/rt_thread.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+AnytimeController::Config::Config(
+  bool enabled, std::chrono::microseconds deadline, std::chrono::microseconds period,
+  std::chrono::microseconds poll_period, int priority, int cpu)
+: enabled{enabled},
+  deadline{deadline},
+  period{period},
+  poll_period{poll_period},
+  priority{priority},
+  cpu{cpu}
+{
+  if (deadline.count() <= 0) {
+    throw std::invalid_argument("anytime deadline must be positive");
+  }
+  if (deadline >= period) {
+    throw std::invalid_argument("anytime deadline must be shorter than the period");
+  }
+  if (poll_period.count() <= 0) {
+    throw std::invalid_argument("anytime poll period must be positive");
+  }
+  if (priority < 0 || priority > 98) {
+    throw std::invalid_argument("anytime priority must be in [0, 98]");
+  }
+  // the affinity is set with the 32 bit mask of pendulum_utils
+  if (cpu >= 32) {
+    throw std::invalid_argument("anytime cpu must be lower than 32");
+  }
+}
+
+bool AnytimeController::Config::is_enabled() const
+{
+  return enabled;
+}
+
+std::chrono::nanoseconds AnytimeController::Config::get_deadline() const
+{
+  return deadline;
+}
+
+std::chrono::nanoseconds AnytimeController::Config::get_period() const
+{
+  return period;
+}
+
+std::chrono::nanoseconds AnytimeController::Config::get_poll_period() const
+{
+  return poll_period;
+}
+
+int AnytimeController::Config::get_priority() const
+{
+  return priority;
+}
+
+int AnytimeController::Config::get_cpu() const
+{
+  return cpu;
+}
+
+AnytimeController::AnytimeController(const Config & config, Refinement refinement)
+: cfg_(config),
+  refinement_(std::move(refinement)),
+  stop_requested_{false},
+  job_{0U},
+  active_job_{0U},
+  result_sequence_{0U},
+  result_job_{0U},
+  result_force_{0.0},
+  result_final_{false},
+  num_final_{0U},
+  num_partial_{0U},
+  num_fallback_{0U}
+{}
+
+AnytimeController::~AnytimeController()
+{
+  stop();
+}
+
+void AnytimeController::start()
+{
+  if (!cfg_.is_enabled() || worker_.joinable()) {
+    return;
+  }
+  stop_requested_ = false;
+  // the worker waits for jobs newer than the ones posted before it was started
+  std::promise<int> started;
+  std::future<int> start_error = started.get_future();
+  worker_ = std::thread(&AnytimeController::run, this, job_, std::move(started));
+  const int error = start_error.get();
+  if (error != 0) {
+    worker_.join();
+    throw std::runtime_error(
+            "failed to set the anytime thread priority " + std::to_string(cfg_.get_priority()) +
+            " and cpu " + std::to_string(cfg_.get_cpu()) + ": " + std::strerror(error));
+  }
+}
+
+void AnytimeController::stop()
+{
+  if (worker_.joinable()) {
+    stop_requested_ = true;
+    worker_.join();
+  }
+}
+
+double AnytimeController::update(
+  const std::vector<double> & state, const std::vector<double> & reference,
+  double fallback_force, std::chrono::steady_clock::time_point arrival_time)
+{
+  if (!worker_.joinable()) {
+    num_fallback_++;
+    return fallback_force;
+  }
+  // a new job abandons the previous one if it is still running
+  Job job;
+  job.id = ++job_;
+  job.state.fill(0.0);
+  job.reference.fill(0.0);
+  std::copy_n(state.begin(), std::min(state.size(), job.state.size()), job.state.begin());
+  std::copy_n(
+    reference.begin(), std::min(reference.size(), job.reference.size()), job.reference.begin());
+  // the worker holds at most one buffer, the other one always takes the latest job
+  if (!jobs_[0].write(job)) {
+    jobs_[1].write(job);
+  }
+  active_job_.store(job.id, std::memory_order_release);
+
+  // polled without a lock, the worker thread runs while this one sleeps
+  const auto deadline = arrival_time + cfg_.get_deadline();
+  Result result{0U, 0.0, false};
+  while (true) {
+    if (read_result(result) && result.job == job.id && result.final) {
+      break;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      break;
+    }
+    std::this_thread::sleep_for(
+      std::min<std::chrono::nanoseconds>(cfg_.get_poll_period(), deadline - now));
+  }
+  // the worker stops refining after the deadline
+  active_job_.store(0U, std::memory_order_release);
+
+  if (result.job != job.id) {
+    num_fallback_++;
+    return fallback_force;
+  }
+  if (result.final) {
+    num_final_++;
+  } else {
+    num_partial_++;
+  }
+  return result.force;
+}
+
+int AnytimeController::configure_worker_thread() const
+{
+  // pid 0 is the calling thread, the settings of the other threads are not changed
+  if (cfg_.get_priority() > 0 &&
+    utils::set_thread_priority(0, static_cast<size_t>(cfg_.get_priority()), SCHED_FIFO) != 0)
+  {
+    return errno;
+  }
+  if (cfg_.get_cpu() >= 0 &&
+    utils::set_thread_cpu_affinity(0, 1U << static_cast<std::uint32_t>(cfg_.get_cpu())) != 0)
+  {
+    return errno;
+  }
+  return 0;
+}
+
+void AnytimeController::read_latest_job(Job & job)
+{
+  Job buffered;
+  for (auto & jobs : jobs_) {
+    if (jobs.read(buffered) > 0U && buffered.id > job.id) {
+      job = buffered;
+    }
+  }
+}
+
+void AnytimeController::write_result(const Result & result) noexcept
+{
+  const std::uint32_t sequence = result_sequence_.load(std::memory_order_relaxed);
+  result_sequence_.store(sequence + 1U, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  result_job_.store(result.job, std::memory_order_relaxed);
+  result_force_.store(result.force, std::memory_order_relaxed);
+  result_final_.store(result.final, std::memory_order_relaxed);
+  result_sequence_.store(sequence + 2U, std::memory_order_release);
+}
+
+bool AnytimeController::read_result(Result & result) const noexcept
+{
+  const std::uint32_t sequence = result_sequence_.load(std::memory_order_acquire);
+  if ((sequence & 1U) != 0U) {
+    return false;
+  }
+  const std::uint64_t job = result_job_.load(std::memory_order_relaxed);
+  const double force = result_force_.load(std::memory_order_relaxed);
+  const bool final = result_final_.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (sequence != result_sequence_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  result.job = job;
+  result.force = force;
+  result.final = final;
+  return true;
+}
+
+void AnytimeController::run(std::uint64_t last_job, std::promise<int> started)
+{
+  // configured before the first solve, a failure is reported to start
+  const int error = configure_worker_thread();
+  started.set_value(error);
+  if (error != 0) {
+    return;
+  }
+
+  Job job;
+  while (!stop_requested_.load(std::memory_order_relaxed)) {
+    job.id = last_job;
+    read_latest_job(job);
+    // a job is solved once it is active, it is not if its deadline already expired
+    if (job.id == last_job || active_job_.load(std::memory_order_acquire) != job.id) {
+      std::this_thread::sleep_for(cfg_.get_poll_period());
+      continue;
+    }
+    last_job = job.id;
+
+    Result result{job.id, 0.0, false};
+    for (std::size_t iteration = 0; !result.final; iteration++) {
+      result.final = refinement_(job.state, job.reference, iteration, result.force);
+      if (stop_requested_.load(std::memory_order_relaxed) ||
+        active_job_.load(std::memory_order_acquire) != job.id)
+      {
+        break;
+      }
+      write_result(result);
+    }
+  }
+}
+
+const AnytimeController::Config & AnytimeController::get_config() const
+{
+  return cfg_;
+}
+
+std::uint64_t AnytimeController::get_num_final() const
+{
+  return num_final_;
+}
+
+std::uint64_t AnytimeController::get_num_partial() const
+{
+  return num_partial_;
+}
+
+std::uint64_t AnytimeController::get_num_fallback() const
+{
+  return num_fallback_;
+}
+
+void AnytimeController::reset_counters()
+{
+  num_final_ = 0U;
+  num_partial_ = 0U;
+  num_fallback_ = 0U;
+}
+}  // namespace pendulum_controller
+}  // namespace pendulum
@@ -0,0 +1,109 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_controller/controller_laws.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pluginlib/class_list_macros.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+namespace
+{
+/// \brief Declares a parameter once, the laws are initialized again after a cleanup
+rclcpp::ParameterValue declare_parameter(
+  const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr & parameters,
+  const std::string & name,
+  const rclcpp::ParameterValue & default_value)
+{
+  if (parameters->has_parameter(name)) {
+    return parameters->get_parameter(name).get_parameter_value();
+  }
+  return parameters->declare_parameter(
+    name, default_value, rcl_interfaces::msg::ParameterDescriptor());
+}
+}  // namespace
+
+void PendulumControllerLaw::reset()
+{
+  controller_->reset();
+}
+
+double PendulumControllerLaw::compute(
+  const std::vector<double> & state,
+  const std::vector<double> & reference)
+{
+  controller_->set_state(state[0], state[1], state[2], state[3]);
+  controller_->set_teleop(reference[0], reference[1], reference[2], reference[3]);
+  controller_->update();
+  return controller_->get_force_command();
+}
+
+void PendulumControllerLaw::create_controller(const PendulumController::Config & config)
+{
+  controller_ = std::make_unique<PendulumController>(config);
+}
+
+void FeedbackLaw::initialize(
+  const std::string & prefix,
+  const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr & parameters)
+{
+  create_controller(
+    PendulumController::Config(
+      declare_parameter(
+        parameters, prefix + ".feedback_matrix",
+        rclcpp::ParameterValue(std::vector<double>{-10.0000, -51.5393, 356.8637, 154.4146}))
+      .get<std::vector<double>>()));
+}
+
+void ExplicitMpcLaw::initialize(
+  const std::string & prefix,
+  const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr & parameters)
+{
+  const auto path = declare_parameter(
+    parameters, prefix + ".explicit_mpc_table", rclcpp::ParameterValue(std::string{}))
+    .get<std::string>();
+  create_controller(
+    PendulumController::Config(
+      {}, std::make_shared<const ExplicitMpcTable>(ExplicitMpcTable::load(path))));
+}
+
+void MlpPolicyLaw::initialize(
+  const std::string & prefix,
+  const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr & parameters)
+{
+  const auto path = declare_parameter(
+    parameters, prefix + ".mlp_policy", rclcpp::ParameterValue(std::string{}))
+    .get<std::string>();
+  create_controller(
+    PendulumController::Config(
+      {}, nullptr, std::make_shared<const MlpPolicy>(MlpPolicy::load(path))));
+}
+}  // namespace pendulum_controller
+}  // namespace pendulum
+
+PLUGINLIB_EXPORT_CLASS(
+  pendulum::pendulum_controller::FeedbackLaw,
+  pendulum::pendulum_controller::ControllerLaw)
+PLUGINLIB_EXPORT_CLASS(
+  pendulum::pendulum_controller::ExplicitMpcLaw,
+  pendulum::pendulum_controller::ControllerLaw)
+PLUGINLIB_EXPORT_CLASS(
+  pendulum::pendulum_controller::MlpPolicyLaw,
+  pendulum::pendulum_controller::ControllerLaw)
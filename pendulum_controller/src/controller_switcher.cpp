@@ -0,0 +1,154 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_controller/controller_switcher.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+ControllerSwitcher::Config::Config(std::size_t transfer_cycles)
+: transfer_cycles{transfer_cycles}
+{}
+
+std::size_t ControllerSwitcher::Config::get_transfer_cycles() const
+{
+  return transfer_cycles;
+}
+
+ControllerSwitcher::ControllerSwitcher(const Config & config)
+: cfg_(config),
+  requested_{0U},
+  active_index_{0U},
+  active_{nullptr},
+  transfer_offset_{0.0},
+  transfer_step_{0.0},
+  num_switches_{0U}
+{}
+
+void ControllerSwitcher::add(const std::string & name, std::shared_ptr<ControllerLaw> law)
+{
+  if (!law) {
+    throw std::invalid_argument("controller law '" + name + "' is null");
+  }
+  if (std::find(names_.begin(), names_.end(), name) != names_.end()) {
+    throw std::invalid_argument("controller law '" + name + "' is already added");
+  }
+  names_.push_back(name);
+  laws_.push_back(std::move(law));
+  if (active_ == nullptr) {
+    active_ = laws_.front().get();
+  }
+}
+
+void ControllerSwitcher::clear()
+{
+  names_.clear();
+  laws_.clear();
+  requested_ = 0U;
+  active_index_ = 0U;
+  active_ = nullptr;
+  transfer_offset_ = 0.0;
+  transfer_step_ = 0.0;
+}
+
+bool ControllerSwitcher::request(const std::string & name)
+{
+  const auto it = std::find(names_.begin(), names_.end(), name);
+  if (it == names_.end()) {
+    return false;
+  }
+  requested_ = static_cast<std::size_t>(it - names_.begin());
+  return true;
+}
+
+double ControllerSwitcher::update(
+  const std::vector<double> & state,
+  const std::vector<double> & reference)
+{
+  if (active_ == nullptr) {
+    return 0.0;
+  }
+  const std::size_t requested = requested_.load();
+  if (requested != active_index_.load()) {
+    // the output of this cycle continues the previous law
+    const double previous_force = active_->compute(state, reference) + transfer_offset_;
+    active_ = laws_[requested].get();
+    active_index_ = requested;
+    active_->align(state, reference, previous_force);
+    transfer_offset_ = previous_force - active_->compute(state, reference);
+    transfer_step_ = cfg_.get_transfer_cycles() > 0U ?
+      transfer_offset_ / static_cast<double>(cfg_.get_transfer_cycles()) : transfer_offset_;
+    num_switches_++;
+    return previous_force;
+  }
+  if (transfer_offset_ != 0.0) {
+    transfer_offset_ -= transfer_step_;
+    // avoid a residual offset with the opposite sign due to rounding
+    if ((transfer_step_ > 0.0 && transfer_offset_ < 0.0) ||
+      (transfer_step_ < 0.0 && transfer_offset_ > 0.0))
+    {
+      transfer_offset_ = 0.0;
+    }
+  }
+  return active_->compute(state, reference) + transfer_offset_;
+}
+
+void ControllerSwitcher::reset()
+{
+  for (const auto & law : laws_) {
+    law->reset();
+  }
+  transfer_offset_ = 0.0;
+  transfer_step_ = 0.0;
+}
+
+bool ControllerSwitcher::empty() const
+{
+  return laws_.empty();
+}
+
+const std::string & ControllerSwitcher::get_active_name() const
+{
+  return names_.at(active_index_.load());
+}
+
+std::size_t ControllerSwitcher::get_active_index() const
+{
+  return active_index_.load();
+}
+
+const std::vector<std::string> & ControllerSwitcher::get_names() const
+{
+  return names_;
+}
+
+double ControllerSwitcher::get_transfer_offset() const
+{
+  return transfer_offset_;
+}
+
+std::uint64_t ControllerSwitcher::get_num_switches() const
+{
+  return num_switches_;
+}
+}  // namespace pendulum_controller
+}  // namespace pendulum
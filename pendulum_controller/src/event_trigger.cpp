@@ -0,0 +1,120 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_controller/event_trigger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+EventTrigger::Config::Config(
+  bool enabled, double force_threshold, const std::vector<double> & state_thresholds,
+  std::chrono::microseconds max_silence)
+: enabled{enabled},
+  force_threshold{force_threshold},
+  state_thresholds{state_thresholds},
+  max_silence{max_silence}
+{
+  if (state_thresholds.size() != 4U) {
+    throw std::invalid_argument("event trigger needs one state threshold per state element");
+  }
+  if (std::any_of(
+      state_thresholds.begin(), state_thresholds.end(),
+      [](double threshold) {return threshold < 0.0;}))
+  {
+    throw std::invalid_argument("event trigger state thresholds must not be negative");
+  }
+}
+
+bool EventTrigger::Config::is_enabled() const
+{
+  return enabled;
+}
+
+double EventTrigger::Config::get_force_threshold() const
+{
+  return force_threshold;
+}
+
+const std::vector<double> & EventTrigger::Config::get_state_thresholds() const
+{
+  return state_thresholds;
+}
+
+std::chrono::microseconds EventTrigger::Config::get_max_silence() const
+{
+  return max_silence;
+}
+
+EventTrigger::EventTrigger(const Config & config)
+: cfg_(config),
+  has_published_{false},
+  last_force_{0.0},
+  last_state_{},
+  num_commands_{0U},
+  num_published_{0U}
+{}
+
+void EventTrigger::reset()
+{
+  has_published_ = false;
+  num_commands_ = 0U;
+  num_published_ = 0U;
+}
+
+bool EventTrigger::update(
+  double force, const std::vector<double> & state,
+  std::chrono::steady_clock::time_point now)
+{
+  num_commands_++;
+  bool publish = !cfg_.is_enabled() || !has_published_ ||
+    (std::fabs(force - last_force_) > cfg_.get_force_threshold()) ||
+    (now - last_publish_time_ >= cfg_.get_max_silence());
+  if (!publish) {
+    const auto & thresholds = cfg_.get_state_thresholds();
+    const std::size_t dim = std::min(state.size(), last_state_.size());
+    for (std::size_t i = 0; i < dim; i++) {
+      // the elements have different units, each one has its own threshold
+      if (thresholds[i] > 0.0 && std::fabs(state[i] - last_state_[i]) > thresholds[i]) {
+        publish = true;
+        break;
+      }
+    }
+  }
+  if (publish) {
+    has_published_ = true;
+    last_force_ = force;
+    std::copy_n(state.begin(), std::min(state.size(), last_state_.size()), last_state_.begin());
+    last_publish_time_ = now;
+    num_published_++;
+  }
+  return publish;
+}
+
+std::uint64_t EventTrigger::get_num_commands() const
+{
+  return num_commands_;
+}
+
+std::uint64_t EventTrigger::get_num_published() const
+{
+  return num_published_;
+}
+}  // namespace pendulum_controller
+}  // namespace pendulum
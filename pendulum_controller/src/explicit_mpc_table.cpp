@@ -0,0 +1,331 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_controller/explicit_mpc_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+namespace
+{
+// file identifier and format version, the data is stored in native byte order
+constexpr char TABLE_MAGIC[8] = {'P', 'E', 'M', 'P', 'C', 'T', 'B', 'L'};
+constexpr std::uint32_t TABLE_VERSION = 1U;
+
+template<typename T>
+void write_value(std::vector<std::uint8_t> & data, const T & value)
+{
+  const auto * bytes = reinterpret_cast<const std::uint8_t *>(&value);
+  data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+class Reader
+{
+public:
+  explicit Reader(const std::vector<std::uint8_t> & data)
+  : data_(data), position_(0U) {}
+
+  template<typename T>
+  T read()
+  {
+    if (data_.size() - position_ < sizeof(T)) {
+      throw std::runtime_error("explicit MPC table is truncated");
+    }
+    T value;
+    std::memcpy(&value, data_.data() + position_, sizeof(T));
+    position_ += sizeof(T);
+    return value;
+  }
+
+  bool at_end() const {return position_ == data_.size();}
+
+private:
+  const std::vector<std::uint8_t> & data_;
+  std::size_t position_;
+};
+}  // namespace
+
+ExplicitMpcTable::ExplicitMpcTable(
+  double max_force,
+  const Grid & grid,
+  std::vector<Region> regions,
+  std::vector<Constraint> constraints,
+  std::vector<std::uint32_t> cell_offsets,
+  std::vector<std::uint16_t> cell_regions)
+: max_force_(max_force),
+  grid_(grid),
+  regions_(std::move(regions)),
+  constraints_(std::move(constraints)),
+  cell_offsets_(std::move(cell_offsets)),
+  cell_regions_(std::move(cell_regions))
+{
+  if (!(max_force_ > 0.0)) {
+    throw std::invalid_argument("explicit MPC force limit must be positive");
+  }
+  if (regions_.empty() || regions_.size() > std::numeric_limits<std::uint16_t>::max()) {
+    throw std::invalid_argument("wrong number of explicit MPC regions");
+  }
+  std::size_t num_cells = 1U;
+  for (std::size_t i = 0; i < STATE_DIM; i++) {
+    if (grid_.cells[i] == 0U || !(grid_.upper[i] > grid_.lower[i])) {
+      throw std::invalid_argument("wrong explicit MPC grid");
+    }
+    num_cells *= grid_.cells[i];
+    cell_scale_[i] = static_cast<double>(grid_.cells[i]) / (grid_.upper[i] - grid_.lower[i]);
+  }
+  for (const auto & region : regions_) {
+    if (static_cast<std::size_t>(region.first_constraint) + region.num_constraints >
+      constraints_.size())
+    {
+      throw std::invalid_argument("explicit MPC region constraints out of range");
+    }
+  }
+  if (cell_offsets_.size() != num_cells + 1U || cell_offsets_.front() != 0U ||
+    cell_offsets_.back() != cell_regions_.size())
+  {
+    throw std::invalid_argument("wrong explicit MPC cell offsets");
+  }
+  for (std::size_t cell = 0; cell < num_cells; cell++) {
+    // every cell needs at least one candidate so the lookup always returns a region
+    if (cell_offsets_[cell + 1U] <= cell_offsets_[cell]) {
+      throw std::invalid_argument("explicit MPC cell without regions");
+    }
+  }
+  for (const auto region : cell_regions_) {
+    if (region >= regions_.size()) {
+      throw std::invalid_argument("explicit MPC cell region out of range");
+    }
+  }
+}
+
+ExplicitMpcTable ExplicitMpcTable::load(const std::string & path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("could not open explicit MPC table " + path);
+  }
+  const std::vector<std::uint8_t> data{std::istreambuf_iterator<char>(in),
+    std::istreambuf_iterator<char>()};
+  return from_bytes(data);
+}
+
+void ExplicitMpcTable::save(const std::string & path) const
+{
+  const auto data = to_bytes();
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("could not open explicit MPC table " + path);
+  }
+  out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+  if (!out) {
+    throw std::runtime_error("could not write explicit MPC table " + path);
+  }
+}
+
+std::vector<std::uint8_t> ExplicitMpcTable::to_bytes() const
+{
+  std::vector<std::uint8_t> data;
+  for (const char c : TABLE_MAGIC) {
+    write_value(data, c);
+  }
+  write_value(data, TABLE_VERSION);
+  write_value(data, static_cast<std::uint32_t>(regions_.size()));
+  write_value(data, static_cast<std::uint32_t>(constraints_.size()));
+  write_value(data, static_cast<std::uint32_t>(cell_regions_.size()));
+  write_value(data, max_force_);
+  for (std::size_t i = 0; i < STATE_DIM; i++) {
+    write_value(data, grid_.lower[i]);
+    write_value(data, grid_.upper[i]);
+    write_value(data, grid_.cells[i]);
+  }
+  for (const auto & region : regions_) {
+    for (const float g : region.gain) {
+      write_value(data, g);
+    }
+    write_value(data, region.offset);
+    write_value(data, region.first_constraint);
+    write_value(data, region.num_constraints);
+  }
+  for (const auto & constraint : constraints_) {
+    for (const float a : constraint.normal) {
+      write_value(data, a);
+    }
+    write_value(data, constraint.bound);
+  }
+  for (const auto offset : cell_offsets_) {
+    write_value(data, offset);
+  }
+  for (const auto region : cell_regions_) {
+    write_value(data, region);
+  }
+  return data;
+}
+
+ExplicitMpcTable ExplicitMpcTable::from_bytes(const std::vector<std::uint8_t> & data)
+{
+  Reader reader(data);
+  for (const char c : TABLE_MAGIC) {
+    if (reader.read<char>() != c) {
+      throw std::runtime_error("not an explicit MPC table");
+    }
+  }
+  if (reader.read<std::uint32_t>() != TABLE_VERSION) {
+    throw std::runtime_error("unsupported explicit MPC table version");
+  }
+  const auto num_regions = reader.read<std::uint32_t>();
+  const auto num_constraints = reader.read<std::uint32_t>();
+  const auto num_cell_regions = reader.read<std::uint32_t>();
+  const auto max_force = reader.read<double>();
+  Grid grid;
+  std::size_t num_cells = 1U;
+  for (std::size_t i = 0; i < STATE_DIM; i++) {
+    grid.lower[i] = reader.read<double>();
+    grid.upper[i] = reader.read<double>();
+    grid.cells[i] = reader.read<std::uint32_t>();
+    num_cells *= grid.cells[i];
+    if (num_cells == 0U || num_cells > data.size()) {
+      throw std::runtime_error("wrong explicit MPC grid");
+    }
+  }
+  // the sizes are checked against the data length before allocating
+  const std::size_t expected_size = num_regions * (sizeof(Region::gain) + sizeof(float) +
+    2U * sizeof(std::uint32_t)) + num_constraints * (sizeof(Constraint::normal) + sizeof(float)) +
+    (num_cells + 1U) * sizeof(std::uint32_t) + num_cell_regions * sizeof(std::uint16_t);
+  if (data.size() < expected_size) {
+    throw std::runtime_error("explicit MPC table is truncated");
+  }
+
+  std::vector<Region> regions(num_regions);
+  for (auto & region : regions) {
+    for (auto & g : region.gain) {
+      g = reader.read<float>();
+    }
+    region.offset = reader.read<float>();
+    region.first_constraint = reader.read<std::uint32_t>();
+    region.num_constraints = reader.read<std::uint32_t>();
+  }
+  std::vector<Constraint> constraints(num_constraints);
+  for (auto & constraint : constraints) {
+    for (auto & a : constraint.normal) {
+      a = reader.read<float>();
+    }
+    constraint.bound = reader.read<float>();
+  }
+  std::vector<std::uint32_t> cell_offsets(num_cells + 1U);
+  for (auto & offset : cell_offsets) {
+    offset = reader.read<std::uint32_t>();
+  }
+  std::vector<std::uint16_t> cell_regions(num_cell_regions);
+  for (auto & region : cell_regions) {
+    region = reader.read<std::uint16_t>();
+  }
+  if (!reader.at_end()) {
+    throw std::runtime_error("explicit MPC table has trailing data");
+  }
+  try {
+    return ExplicitMpcTable(
+      max_force, grid, std::move(regions), std::move(constraints),
+      std::move(cell_offsets), std::move(cell_regions));
+  } catch (const std::invalid_argument & e) {
+    throw std::runtime_error(e.what());
+  }
+}
+
+std::size_t ExplicitMpcTable::cell_index(const double * error) const noexcept
+{
+  std::size_t index = 0U;
+  for (std::size_t i = 0; i < STATE_DIM; i++) {
+    const double scaled = (error[i] - grid_.lower[i]) * cell_scale_[i];
+    std::size_t cell = 0U;
+    if (scaled >= static_cast<double>(grid_.cells[i])) {
+      cell = grid_.cells[i] - 1U;
+    } else if (scaled > 0.0) {
+      cell = static_cast<std::size_t>(scaled);
+    }
+    index = index * grid_.cells[i] + cell;
+  }
+  return index;
+}
+
+std::size_t ExplicitMpcTable::find_region(const double * error) const noexcept
+{
+  const std::size_t cell = cell_index(error);
+  std::size_t best_region = cell_regions_[cell_offsets_[cell]];
+  double best_violation = std::numeric_limits<double>::infinity();
+  for (std::uint32_t k = cell_offsets_[cell]; k < cell_offsets_[cell + 1U]; k++) {
+    const Region & region = regions_[cell_regions_[k]];
+    double violation = -std::numeric_limits<double>::infinity();
+    for (std::uint32_t c = 0; c < region.num_constraints; c++) {
+      const Constraint & constraint = constraints_[region.first_constraint + c];
+      double value = -static_cast<double>(constraint.bound);
+      for (std::size_t i = 0; i < STATE_DIM; i++) {
+        value += static_cast<double>(constraint.normal[i]) * error[i];
+      }
+      violation = std::max(violation, value);
+    }
+    if (violation <= 0.0) {
+      return cell_regions_[k];
+    }
+    // outside the grid or on a boundary, keep the region with the smallest violation
+    if (violation < best_violation) {
+      best_violation = violation;
+      best_region = cell_regions_[k];
+    }
+  }
+  return best_region;
+}
+
+double ExplicitMpcTable::evaluate(const double * error) const noexcept
+{
+  const Region & region = regions_[find_region(error)];
+  double force = static_cast<double>(region.offset);
+  for (std::size_t i = 0; i < STATE_DIM; i++) {
+    force += static_cast<double>(region.gain[i]) * error[i];
+  }
+  return std::min(std::max(force, -max_force_), max_force_);
+}
+
+double ExplicitMpcTable::get_max_force() const
+{
+  return max_force_;
+}
+
+const ExplicitMpcTable::Grid & ExplicitMpcTable::get_grid() const
+{
+  return grid_;
+}
+
+const std::vector<ExplicitMpcTable::Region> & ExplicitMpcTable::get_regions() const
+{
+  return regions_;
+}
+
+std::size_t ExplicitMpcTable::get_num_cell_regions() const
+{
+  return cell_regions_.size();
+}
+}  // namespace pendulum_controller
+}  // namespace pendulum
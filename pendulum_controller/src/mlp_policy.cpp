@@ -0,0 +1,393 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_controller/mlp_policy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PENDULUM_MLP_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PENDULUM_MLP_NEON
+#endif
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+namespace
+{
+// file identifier and format version, the data is stored in native byte order
+constexpr char POLICY_MAGIC[8] = {'P', 'E', 'M', 'L', 'P', 'N', 'E', 'T'};
+constexpr std::uint32_t POLICY_VERSION = 1U;
+
+// tanh rounds to 1 in single precision beyond this value
+constexpr float TANH_CLAMP = 9.0F;
+
+template<typename T>
+void write_value(std::vector<std::uint8_t> & data, const T & value)
+{
+  const auto * bytes = reinterpret_cast<const std::uint8_t *>(&value);
+  data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+class Reader
+{
+public:
+  explicit Reader(const std::vector<std::uint8_t> & data)
+  : data_(data), position_(0U) {}
+
+  template<typename T>
+  T read()
+  {
+    if (data_.size() - position_ < sizeof(T)) {
+      throw std::runtime_error("MLP policy is truncated");
+    }
+    T value;
+    std::memcpy(&value, data_.data() + position_, sizeof(T));
+    position_ += sizeof(T);
+    return value;
+  }
+
+  bool at_end() const {return position_ == data_.size();}
+
+private:
+  const std::vector<std::uint8_t> & data_;
+  std::size_t position_;
+};
+
+std::size_t num_blocks(std::size_t size)
+{
+  return (size + 3U) / 4U;
+}
+
+#if defined(PENDULUM_MLP_SSE)
+using Vector = __m128;
+inline Vector load_block(const float * p) {return _mm_load_ps(p);}
+inline void store_block(float * p, Vector v) {_mm_store_ps(p, v);}
+inline Vector broadcast(float x) {return _mm_set1_ps(x);}
+inline Vector add(Vector a, Vector b) {return _mm_add_ps(a, b);}
+inline Vector mul(Vector a, Vector b) {return _mm_mul_ps(a, b);}
+inline Vector div(Vector a, Vector b) {return _mm_div_ps(a, b);}
+inline Vector min(Vector a, Vector b) {return _mm_min_ps(a, b);}
+inline Vector max(Vector a, Vector b) {return _mm_max_ps(a, b);}
+#elif defined(PENDULUM_MLP_NEON)
+using Vector = float32x4_t;
+inline Vector load_block(const float * p) {return vld1q_f32(p);}
+inline void store_block(float * p, Vector v) {vst1q_f32(p, v);}
+inline Vector broadcast(float x) {return vdupq_n_f32(x);}
+inline Vector add(Vector a, Vector b) {return vaddq_f32(a, b);}
+inline Vector mul(Vector a, Vector b) {return vmulq_f32(a, b);}
+inline Vector div(Vector a, Vector b)
+{
+  // reciprocal estimate refined with two Newton steps, vdivq_f32 is only available in AArch64
+  Vector r = vrecpeq_f32(b);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  return vmulq_f32(a, r);
+}
+inline Vector min(Vector a, Vector b) {return vminq_f32(a, b);}
+inline Vector max(Vector a, Vector b) {return vmaxq_f32(a, b);}
+#else
+struct Vector
+{
+  float v[4];
+};
+template<typename F>
+inline Vector apply(Vector a, Vector b, F f)
+{
+  return Vector{{f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3])}};
+}
+inline Vector load_block(const float * p) {return Vector{{p[0], p[1], p[2], p[3]}};}
+inline void store_block(float * p, Vector v) {std::copy(v.v, v.v + 4, p);}
+inline Vector broadcast(float x) {return Vector{{x, x, x, x}};}
+inline Vector add(Vector a, Vector b) {return apply(a, b, [](float x, float y) {return x + y;});}
+inline Vector mul(Vector a, Vector b) {return apply(a, b, [](float x, float y) {return x * y;});}
+inline Vector div(Vector a, Vector b) {return apply(a, b, [](float x, float y) {return x / y;});}
+inline Vector min(Vector a, Vector b)
+{
+  return apply(a, b, [](float x, float y) {return x < y ? x : y;});
+}
+inline Vector max(Vector a, Vector b)
+{
+  return apply(a, b, [](float x, float y) {return x > y ? x : y;});
+}
+#endif
+
+// Computes four blocks of outputs of a dense layer keeping the sums in registers. The weights
+// are stored by columns, with stride blocks between consecutive columns.
+template<typename BlockT>
+inline void dense_four_blocks(
+  const BlockT * weights, std::size_t stride, const BlockT * bias,
+  const BlockT * input, std::size_t num_inputs, BlockT * output)
+{
+  Vector sum0 = load_block(bias[0].values);
+  Vector sum1 = load_block(bias[1].values);
+  Vector sum2 = load_block(bias[2].values);
+  Vector sum3 = load_block(bias[3].values);
+  for (std::size_t j = 0; j < num_inputs; j++) {
+    const Vector x = broadcast(input[j / 4U].values[j % 4U]);
+    const BlockT * column = weights + j * stride;
+    sum0 = add(sum0, mul(load_block(column[0].values), x));
+    sum1 = add(sum1, mul(load_block(column[1].values), x));
+    sum2 = add(sum2, mul(load_block(column[2].values), x));
+    sum3 = add(sum3, mul(load_block(column[3].values), x));
+  }
+  store_block(output[0].values, sum0);
+  store_block(output[1].values, sum1);
+  store_block(output[2].values, sum2);
+  store_block(output[3].values, sum3);
+}
+
+// Computes one block of outputs of a dense layer, used for the remaining blocks.
+template<typename BlockT>
+inline void dense_block(
+  const BlockT * weights, std::size_t stride, const BlockT * bias,
+  const BlockT * input, std::size_t num_inputs, BlockT * output)
+{
+  Vector sum = load_block(bias[0].values);
+  for (std::size_t j = 0; j < num_inputs; j++) {
+    const Vector x = broadcast(input[j / 4U].values[j % 4U]);
+    sum = add(sum, mul(load_block(weights[j * stride].values), x));
+  }
+  store_block(output[0].values, sum);
+}
+
+inline Vector tanh_approximation(Vector x)
+{
+  // [7/6] Pade approximant t = n / d of tanh(x / 2), followed by the double angle formula
+  // tanh(x) = 2 * t / (1 + t^2) = 2 * n * d / (d^2 + n^2). The error is below the single
+  // precision rounding in the clamped range, and the result can not exceed 1.
+  const Vector half = mul(
+    min(max(x, broadcast(-TANH_CLAMP)), broadcast(TANH_CLAMP)), broadcast(0.5F));
+  const Vector x2 = mul(half, half);
+  const Vector n = mul(
+    half, add(
+      broadcast(135135.0F), mul(
+        x2, add(broadcast(17325.0F), mul(x2, add(broadcast(378.0F), x2))))));
+  const Vector d = add(
+    broadcast(135135.0F), mul(
+      x2, add(broadcast(62370.0F), mul(x2, add(broadcast(3150.0F), mul(x2, broadcast(28.0F)))))));
+  return div(mul(broadcast(2.0F), mul(n, d)), add(mul(d, d), mul(n, n)));
+}
+}  // namespace
+
+MlpPolicy::MlpPolicy(double max_force, const std::vector<Layer> & layers)
+: max_force_(max_force),
+  layers_(layers)
+{
+  if (!(max_force_ > 0.0)) {
+    throw std::invalid_argument("MLP policy force limit must be positive");
+  }
+  if (layers_.empty()) {
+    throw std::invalid_argument("MLP policy without layers");
+  }
+  std::size_t inputs = STATE_DIM;
+  std::size_t num_parameters = 0U;
+  for (const auto & layer : layers_) {
+    if (layer.inputs != inputs || layer.outputs == 0U || layer.outputs > MAX_LAYER_SIZE) {
+      throw std::invalid_argument("wrong MLP policy layer size");
+    }
+    if (layer.weights.size() != layer.inputs * layer.outputs ||
+      layer.bias.size() != layer.outputs)
+    {
+      throw std::invalid_argument("wrong number of MLP policy parameters");
+    }
+    if (layer.activation != Activation::LINEAR && layer.activation != Activation::TANH &&
+      layer.activation != Activation::RELU)
+    {
+      throw std::invalid_argument("unknown MLP policy activation");
+    }
+    const auto is_finite = [](float value) {return std::isfinite(value);};
+    if (!std::all_of(layer.weights.begin(), layer.weights.end(), is_finite) ||
+      !std::all_of(layer.bias.begin(), layer.bias.end(), is_finite))
+    {
+      throw std::invalid_argument("MLP policy parameters must be finite");
+    }
+    num_parameters += (num_blocks(layer.inputs) * 4U + 1U) * num_blocks(layer.outputs);
+    inputs = layer.outputs;
+  }
+  if (inputs != 1U) {
+    throw std::invalid_argument("MLP policy output layer must have one neuron");
+  }
+
+  // pack the weights by columns, so every input is broadcast and multiplied by whole blocks
+  // of outputs without horizontal sums. The padding is zero, so the padded activations are
+  // zero as well for all the supported activations.
+  parameters_.assign(num_parameters, Block{{0.0F, 0.0F, 0.0F, 0.0F}});
+  std::size_t offset = 0U;
+  for (const auto & layer : layers_) {
+    PackedLayer packed{num_blocks(layer.inputs), num_blocks(layer.outputs), layer.activation,
+      offset, offset + num_blocks(layer.inputs) * 4U * num_blocks(layer.outputs)};
+    for (std::size_t row = 0; row < layer.outputs; row++) {
+      for (std::size_t column = 0; column < layer.inputs; column++) {
+        parameters_[packed.weights + column * packed.output_blocks + row / 4U].values[row % 4U] =
+          layer.weights[row * layer.inputs + column];
+      }
+      parameters_[packed.bias + row / 4U].values[row % 4U] = layer.bias[row];
+    }
+    offset = packed.bias + packed.output_blocks;
+    packed_layers_.push_back(packed);
+  }
+}
+
+MlpPolicy MlpPolicy::load(const std::string & path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("could not open MLP policy " + path);
+  }
+  const std::vector<std::uint8_t> data{std::istreambuf_iterator<char>(in),
+    std::istreambuf_iterator<char>()};
+  return from_bytes(data);
+}
+
+void MlpPolicy::save(const std::string & path) const
+{
+  const auto data = to_bytes();
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("could not open MLP policy " + path);
+  }
+  out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+  if (!out) {
+    throw std::runtime_error("could not write MLP policy " + path);
+  }
+}
+
+std::vector<std::uint8_t> MlpPolicy::to_bytes() const
+{
+  std::vector<std::uint8_t> data;
+  for (const char c : POLICY_MAGIC) {
+    write_value(data, c);
+  }
+  write_value(data, POLICY_VERSION);
+  write_value(data, static_cast<std::uint32_t>(layers_.size()));
+  write_value(data, max_force_);
+  for (const auto & layer : layers_) {
+    write_value(data, static_cast<std::uint32_t>(layer.inputs));
+    write_value(data, static_cast<std::uint32_t>(layer.outputs));
+    write_value(data, static_cast<std::uint32_t>(layer.activation));
+    for (const float w : layer.weights) {
+      write_value(data, w);
+    }
+    for (const float b : layer.bias) {
+      write_value(data, b);
+    }
+  }
+  return data;
+}
+
+MlpPolicy MlpPolicy::from_bytes(const std::vector<std::uint8_t> & data)
+{
+  Reader reader(data);
+  for (const char c : POLICY_MAGIC) {
+    if (reader.read<char>() != c) {
+      throw std::runtime_error("not an MLP policy");
+    }
+  }
+  if (reader.read<std::uint32_t>() != POLICY_VERSION) {
+    throw std::runtime_error("unsupported MLP policy version");
+  }
+  const auto num_layers = reader.read<std::uint32_t>();
+  const auto max_force = reader.read<double>();
+  std::vector<Layer> layers;
+  for (std::uint32_t i = 0; i < num_layers; i++) {
+    Layer layer;
+    layer.inputs = reader.read<std::uint32_t>();
+    layer.outputs = reader.read<std::uint32_t>();
+    layer.activation = static_cast<Activation>(reader.read<std::uint32_t>());
+    // the sizes are checked before allocating
+    if (layer.inputs > MAX_LAYER_SIZE || layer.outputs > MAX_LAYER_SIZE) {
+      throw std::runtime_error("wrong MLP policy layer size");
+    }
+    layer.weights.resize(layer.inputs * layer.outputs);
+    for (auto & w : layer.weights) {
+      w = reader.read<float>();
+    }
+    layer.bias.resize(layer.outputs);
+    for (auto & b : layer.bias) {
+      b = reader.read<float>();
+    }
+    layers.push_back(std::move(layer));
+  }
+  if (!reader.at_end()) {
+    throw std::runtime_error("MLP policy has trailing data");
+  }
+  try {
+    return MlpPolicy(max_force, layers);
+  } catch (const std::invalid_argument & e) {
+    throw std::runtime_error(e.what());
+  }
+}
+
+double MlpPolicy::evaluate(const double * error) const noexcept
+{
+  Block buffers[2][MAX_LAYER_SIZE / 4U];
+  static_assert(STATE_DIM == 4U, "the input must fit in one block");
+  Block * input = buffers[0];
+  Block * output = buffers[1];
+  for (std::size_t i = 0; i < STATE_DIM; i++) {
+    input[0].values[i] = static_cast<float>(error[i]);
+  }
+
+  for (const auto & layer : packed_layers_) {
+    const Block * weights = &parameters_[layer.weights];
+    const Block * bias = &parameters_[layer.bias];
+    const std::size_t num_inputs = layer.input_blocks * 4U;
+    std::size_t k = 0U;
+    for (; k + 4U <= layer.output_blocks; k += 4U) {
+      dense_four_blocks(
+        weights + k, layer.output_blocks, bias + k, input, num_inputs, output + k);
+    }
+    for (; k < layer.output_blocks; k++) {
+      dense_block(
+        weights + k, layer.output_blocks, bias + k, input, num_inputs, output + k);
+    }
+    if (layer.activation == Activation::TANH) {
+      for (std::size_t block = 0; block < layer.output_blocks; block++) {
+        store_block(output[block].values, tanh_approximation(load_block(output[block].values)));
+      }
+    } else if (layer.activation == Activation::RELU) {
+      for (std::size_t block = 0; block < layer.output_blocks; block++) {
+        store_block(output[block].values, max(load_block(output[block].values), broadcast(0.0F)));
+      }
+    }
+    std::swap(input, output);
+  }
+  const double force = static_cast<double>(input[0].values[0]);
+  return std::min(std::max(force, -max_force_), max_force_);
+}
+
+double MlpPolicy::get_max_force() const
+{
+  return max_force_;
+}
+
+const std::vector<MlpPolicy::Layer> & MlpPolicy::get_layers() const
+{
+  return layers_;
+}
+}  // namespace pendulum_controller
+}  // namespace pendulum
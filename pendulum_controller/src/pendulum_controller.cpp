@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "pendulum_controller/pendulum_controller.hpp"
+#include <memory>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -20,8 +22,18 @@ namespace pendulum
 {
 namespace pendulum_controller
 {
-PendulumController::Config::Config(std::vector<double> feedback_matrix)
-: feedback_matrix{std::move(feedback_matrix)} {}
+PendulumController::Config::Config(
+  std::vector<double> feedback_matrix,
+  std::shared_ptr<const ExplicitMpcTable> explicit_mpc_table,
+  std::shared_ptr<const MlpPolicy> mlp_policy)
+: feedback_matrix{std::move(feedback_matrix)},
+  explicit_mpc_table{std::move(explicit_mpc_table)},
+  mlp_policy{std::move(mlp_policy)}
+{
+  if (this->explicit_mpc_table && this->mlp_policy) {
+    throw std::invalid_argument("explicit MPC law and MLP policy can not be used together");
+  }
+}
 
 const std::vector<double> &
 PendulumController::Config::get_feedback_matrix() const
@@ -29,6 +41,18 @@ PendulumController::Config::get_feedback_matrix() const
   return feedback_matrix;
 }
 
+const std::shared_ptr<const ExplicitMpcTable> &
+PendulumController::Config::get_explicit_mpc_table() const
+{
+  return explicit_mpc_table;
+}
+
+const std::shared_ptr<const MlpPolicy> &
+PendulumController::Config::get_mlp_policy() const
+{
+  return mlp_policy;
+}
+
 PendulumController::PendulumController(const Config & config)
 : cfg_(config),
   state_{0.0, 0.0, M_PI, 0.0},
@@ -102,6 +126,24 @@ double PendulumController::calculate(
     throw std::invalid_argument("wrong state size vector");
   }
 
+  const auto & explicit_mpc_table = cfg_.get_explicit_mpc_table();
+  if (explicit_mpc_table) {
+    double error[ExplicitMpcTable::STATE_DIM];
+    for (size_t i = 0; i < ExplicitMpcTable::STATE_DIM; i++) {
+      error[i] = state[i] - reference[i];
+    }
+    return explicit_mpc_table->evaluate(error);
+  }
+
+  const auto & mlp_policy = cfg_.get_mlp_policy();
+  if (mlp_policy) {
+    double error[MlpPolicy::STATE_DIM];
+    for (size_t i = 0; i < MlpPolicy::STATE_DIM; i++) {
+      error[i] = state[i] - reference[i];
+    }
+    return mlp_policy->evaluate(error);
+  }
+
   for (size_t i = 0; i < dim; i++) {
     controller_output += -cfg_.get_feedback_matrix()[i] * (state[i] - reference[i]);
   }
@@ -12,12 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <vector>
 #include <memory>
 
 #include "rclcpp/strategies/message_pool_memory_strategy.hpp"
 #include "rclcpp/strategies/allocator_memory_strategy.hpp"
+#include "rcl_interfaces/srv/list_parameters.hpp"
 
 #include "pendulum_controller/pendulum_controller_node.hpp"
 
@@ -25,6 +31,58 @@ namespace pendulum
 {
 namespace pendulum_controller
 {
+namespace
+{
+std::shared_ptr<const ExplicitMpcTable> load_explicit_mpc_table(const std::string & path)
+{
+  if (path.empty()) {
+    return nullptr;
+  }
+  return std::make_shared<const ExplicitMpcTable>(ExplicitMpcTable::load(path));
+}
+
+std::shared_ptr<const MlpPolicy> load_mlp_policy(const std::string & path)
+{
+  if (path.empty()) {
+    return nullptr;
+  }
+  return std::make_shared<const MlpPolicy>(MlpPolicy::load(path));
+}
+
+// FNV-1a, only compared between runs of the same build
+std::uint64_t fingerprint(std::uint64_t hash, const std::string & bytes)
+{
+  for (const char byte : bytes) {
+    hash = (hash ^ static_cast<std::uint8_t>(byte)) * 1099511628211ULL;
+  }
+  // the length separates consecutive strings
+  return (hash ^ bytes.size()) * 1099511628211ULL;
+}
+
+std::uint64_t fingerprint_file(std::uint64_t hash, const std::string & path)
+{
+  if (path.empty()) {
+    return hash;
+  }
+  std::ifstream file(path, std::ios::binary);
+  return fingerprint(
+    hash, std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+}
+
+AnytimeController::Refinement make_refinement(PendulumController controller)
+{
+  // the worker thread evaluates the configured law with its own copy of the controller
+  return [controller](
+    const AnytimeController::State & state, const AnytimeController::State & reference,
+    std::size_t, double & force) mutable {
+      controller.set_state(state[0], state[1], state[2], state[3]);
+      controller.set_teleop(reference[0], reference[1], reference[2], reference[3]);
+      controller.update();
+      force = controller.get_force_command();
+      return true;
+    };
+}
+}  // namespace
 
 PendulumControllerNode::PendulumControllerNode(const rclcpp::NodeOptions & options)
 : PendulumControllerNode("pendulum_controller", options)
@@ -45,15 +103,108 @@ PendulumControllerNode::PendulumControllerNode(
         declare_parameter<std::uint16_t>("topic_stats_publish_period_ms", 1000U)}},
   deadline_duration_{std::chrono::milliseconds {
         declare_parameter<std::uint16_t>("deadline_duration_ms", 0U)}},
+  enable_pre_serialization_(declare_parameter<bool>("enable_pre_serialization", false)),
+  enable_persistence_(declare_parameter<bool>("enable_persistence", false)),
+  persistence_segment_name_(declare_parameter<std::string>(
+      "persistence_segment_name",
+      utils::SharedMemorySegment::get_node_segment_name(get_fully_qualified_name()))),
+  persistence_max_age_{std::chrono::milliseconds {
+        declare_parameter<std::uint16_t>("persistence_max_age_ms", 1000U)}},
+  shadow_command_topic_name_(declare_parameter<std::string>(
+      "shadow.command_topic_name", "joint_command_shadow")),
+  enable_perf_counters_(declare_parameter<bool>("enable_perf_counters", false)),
+  enable_thread_time_accounting_(declare_parameter<bool>("enable_thread_time_accounting", false)),
+  enable_trace_marker_(declare_parameter<bool>("enable_trace_marker", false)),
   controller_(PendulumController::Config(
       declare_parameter<std::vector<double>>("controller.feedback_matrix",
-      {-10.0000, -51.5393, 356.8637, 154.4146}))),
+      {-10.0000, -51.5393, 356.8637, 154.4146}),
+      load_explicit_mpc_table(
+        declare_parameter<std::string>("controller.explicit_mpc_table", "")),
+      load_mlp_policy(declare_parameter<std::string>("controller.mlp_policy", "")))),
+  event_trigger_(EventTrigger::Config(
+      declare_parameter<bool>("event_trigger.enabled", false),
+      declare_parameter<double>("event_trigger.force_threshold", 1.0),
+      declare_parameter<std::vector<double>>(
+        "event_trigger.state_thresholds", {0.0, 0.0, 0.0, 0.0}),
+      std::chrono::milliseconds {
+        declare_parameter<std::uint16_t>("event_trigger.max_silence_ms", 100U)})),
+  load_shedder_(utils::LoadShedder::Config(
+      declare_parameter<bool>("load_shedding.enabled", false),
+      std::chrono::microseconds {
+        declare_parameter<std::uint16_t>("load_shedding.budget_us", 1000U)},
+      declare_parameter<double>("load_shedding.shed_threshold", 0.5),
+      declare_parameter<double>("load_shedding.restore_threshold", 0.25),
+      declare_parameter<std::uint16_t>("load_shedding.restore_cycles", 100U),
+      declare_parameter<std::uint16_t>("load_shedding.max_level", 4U))),
+  linear_controller_(PendulumController::Config(
+      get_parameter("controller.feedback_matrix").as_double_array())),
+  anytime_controller_(AnytimeController::Config(
+      declare_parameter<bool>("anytime.enabled", false),
+      std::chrono::microseconds {
+        declare_parameter<std::uint32_t>("anytime.deadline_us", 500U)},
+      std::chrono::microseconds {
+        declare_parameter<std::uint32_t>("anytime.period_us", 1000U)},
+      std::chrono::microseconds {
+        declare_parameter<std::uint32_t>("anytime.poll_period_us", 20U)},
+      declare_parameter<int>("anytime.priority", 0),
+      declare_parameter<int>("anytime.cpu", -1)),
+    make_refinement(controller_)),
+  enable_controller_switching_(declare_parameter<bool>("controllers.enabled", false)),
+  controller_names_(declare_parameter<std::vector<std::string>>(
+      "controllers.names", {"feedback"})),
+  controller_switcher_(ControllerSwitcher::Config(
+      declare_parameter<std::uint16_t>("controllers.transfer_cycles", 50U))),
+  snapshot_{},
+  num_cycles_{0U},
+  shadow_controller_(ShadowController::Config(
+      declare_parameter<bool>("shadow.enabled", false),
+      declare_parameter<int>("shadow.cpu", -1),
+      std::chrono::microseconds {
+        declare_parameter<std::uint32_t>("shadow.poll_period_us", 100U)})),
   num_missed_deadlines_pub_{0U},
-  num_missed_deadlines_sub_{0U}
+  num_missed_deadlines_sub_{0U},
+  publish_duration_{0},
+  num_publish_timed_{0U},
+  topic_stats_shed_{false}
 {
+  if (enable_persistence_) {
+    persistent_state_ =
+      std::make_unique<utils::PersistentState<ControllerSnapshot>>(persistence_segment_name_);
+  }
+  // the clock is calibrated when first used, here instead of in the first cycle
+  if (utils::TscClock::is_tsc_enabled()) {
+    RCLCPP_INFO(
+      get_logger(), "Timestamps read from the time stamp counter at %.3f MHz",
+      1e-6 * utils::TscClock::get_tsc_frequency());
+  } else {
+    RCLCPP_INFO(get_logger(), "Timestamps read from steady_clock, no invariant time stamp counter");
+  }
+  if (enable_trace_marker_) {
+    trace_marker_ = std::make_unique<utils::TraceMarker>(get_fully_qualified_name());
+    if (!trace_marker_->is_open()) {
+      RCLCPP_WARN(get_logger(), "Could not open the ftrace trace_marker, check tracefs access");
+    }
+  }
+  for (const auto & name : controller_names_) {
+    declare_parameter<std::string>(
+      "controllers." + name + ".type", "pendulum_controller/FeedbackLaw");
+  }
+  if (shadow_controller_.get_config().is_enabled()) {
+    declare_parameter<std::string>("shadow.type", "pendulum_controller/FeedbackLaw");
+  }
+  if (enable_controller_switching_ || shadow_controller_.get_config().is_enabled()) {
+    law_loader_ = std::make_unique<pluginlib::ClassLoader<ControllerLaw>>(
+      "pendulum_controller", "pendulum::pendulum_controller::ControllerLaw");
+  }
+  if (enable_controller_switching_) {
+    create_select_controller_service();
+  }
   create_teleoperation_subscription();
   create_state_subscription();
   create_command_publisher();
+  if (shadow_controller_.get_config().is_enabled()) {
+    create_shadow_command_publisher();
+  }
 }
 
 void PendulumControllerNode::create_teleoperation_subscription()
@@ -79,23 +230,98 @@ void PendulumControllerNode::create_state_subscription()
     {
       num_missed_deadlines_sub_++;
     };
-  if (enable_topic_stats_) {
+  if (enable_topic_stats_ && !topic_stats_shed_) {
     state_subscription_options.topic_stats_options.state = rclcpp::TopicStatisticsState::Enable;
     state_subscription_options.topic_stats_options.publish_topic = topic_stats_topic_name_;
     state_subscription_options.topic_stats_options.publish_period = topic_stats_publish_period_;
   }
   auto on_sensor_message = [this](const pendulum2_msgs::msg::JointState::SharedPtr msg) {
+      // the statistics, the instrumentation and the shadow evaluation are not needed to control
+      // the pendulum, they are decimated or skipped when the cycle is close to its budget
+      const bool allow_non_critical = load_shedder_.allow();
+      const bool account_time = enable_thread_time_accounting_ && allow_non_critical;
+      if (account_time) {
+        state_callback_time_.begin();
+      }
+      const std::uint64_t cycle = num_cycles_;
+      if (trace_marker_) {
+        trace_marker_->write(utils::TraceMarker::RECEIVE, cycle);
+      }
+      const auto arrival_time = std::chrono::steady_clock::now();
+
       // update pendulum state
       controller_.set_state(
         msg->cart_position, msg->cart_velocity,
         msg->pole_angle, msg->pole_velocity);
 
       // update pendulum controller output
-      controller_.update();
+      const bool measure_perf = perf_counters_ && allow_non_critical;
+      if (measure_perf) {
+        perf_update_->begin();
+      }
+      if (enable_controller_switching_) {
+        // a requested switch is applied here, at the cycle boundary
+        controller_.set_force_command(
+          controller_switcher_.update(controller_.get_state(), controller_.get_teleop()));
+      } else if (anytime_controller_.get_config().is_enabled()) {
+        // the configured law runs on the worker thread, the feedback matrix is the fallback
+        const auto & reference = controller_.get_teleop();
+        linear_controller_.set_state(
+          msg->cart_position, msg->cart_velocity,
+          msg->pole_angle, msg->pole_velocity);
+        linear_controller_.set_teleop(reference[0], reference[1], reference[2], reference[3]);
+        linear_controller_.update();
+        controller_.set_force_command(
+          anytime_controller_.update(
+            controller_.get_state(), reference,
+            linear_controller_.get_force_command(), arrival_time));
+      } else {
+        controller_.update();
+      }
+      if (measure_perf) {
+        perf_update_->end();
+      }
 
-      // publish pendulum force command
-      command_message_.force = controller_.get_force_command();
-      command_pub_->publish(command_message_);
+      // publish pendulum force command, the driver holds the last one if it is skipped
+      const double force = controller_.get_force_command();
+      const auto now = utils::TscClock::now();
+      if (event_trigger_.update(force, controller_.get_state(), now)) {
+        command_message_.force = force;
+        if (trace_marker_) {
+          trace_marker_->write(utils::TraceMarker::PUBLISH, cycle);
+        }
+        if (measure_perf) {
+          perf_publish_->begin();
+        }
+        if (enable_pre_serialization_) {
+          serialized_command_message_.update(command_message_);
+          command_pub_->publish(serialized_command_message_.get_serialized_message());
+        } else {
+          command_pub_->publish(command_message_);
+        }
+        if (measure_perf) {
+          perf_publish_->end();
+        }
+        if (allow_non_critical) {
+          publish_duration_ += utils::TscClock::now() - now;
+          num_publish_timed_++;
+        }
+      }
+      // the candidate law is evaluated with the same inputs on its own thread
+      if (shadow_controller_.get_config().is_enabled() && allow_non_critical) {
+        shadow_controller_.submit(controller_.get_state(), controller_.get_teleop(), force);
+      }
+      num_cycles_++;
+      if (persistent_state_) {
+        store_controller_state();
+      }
+      load_shedder_.update(std::chrono::steady_clock::now() - arrival_time);
+      if (trace_marker_) {
+        trace_marker_->write(utils::TraceMarker::CYCLE_END, cycle);
+      }
+      if (account_time) {
+        state_callback_time_.end();
+      }
     };
   state_sub_ = this->create_subscription<pendulum2_msgs::msg::JointState>(
     state_topic_name_,
@@ -119,6 +345,57 @@ void PendulumControllerNode::create_command_publisher()
     command_publisher_options);
 }
 
+void PendulumControllerNode::create_shadow_command_publisher()
+{
+  shadow_command_pub_ = this->create_publisher<pendulum2_msgs::msg::JointCommand>(
+    shadow_command_topic_name_, rclcpp::QoS(10));
+}
+
+void PendulumControllerNode::create_select_controller_service()
+{
+  using pendulum2_msgs::srv::SelectController;
+  auto on_select_controller = [this](
+    const std::shared_ptr<SelectController::Request> request,
+    std::shared_ptr<SelectController::Response> response) {
+      // only the request is stored, the update thread switches the law pointer
+      response->success = controller_switcher_.request(request->name);
+      response->message = response->success ?
+        "switching to " + request->name + " at the next cycle" :
+        "unknown controller " + request->name;
+      RCLCPP_INFO(get_logger(), "%s", response->message.c_str());
+    };
+  select_controller_srv_ = this->create_service<SelectController>(
+    "~/select_controller", on_select_controller);
+}
+
+void PendulumControllerNode::load_controller_laws()
+{
+  controller_switcher_.clear();
+  for (const auto & name : controller_names_) {
+    const std::string prefix = "controllers." + name;
+    const auto type = get_parameter(prefix + ".type").as_string();
+    auto law = law_loader_->createSharedInstance(type);
+    law->initialize(prefix, get_node_parameters_interface());
+    controller_switcher_.add(name, law);
+    RCLCPP_INFO(get_logger(), "Loaded controller %s of type %s", name.c_str(), type.c_str());
+  }
+}
+
+void PendulumControllerNode::load_shadow_controller()
+{
+  const auto type = get_parameter("shadow.type").as_string();
+  auto law = law_loader_->createSharedInstance(type);
+  law->initialize("shadow", get_node_parameters_interface());
+  // called from the shadow thread, the candidate command is recorded but never applied
+  shadow_controller_.set_candidate(
+    law, [this](double candidate_force, double) {
+      pendulum2_msgs::msg::JointCommand msg;
+      msg.force = candidate_force;
+      shadow_command_pub_->publish(msg);
+    });
+  RCLCPP_INFO(get_logger(), "Loaded shadow controller of type %s", type.c_str());
+}
+
 void PendulumControllerNode::log_controller_state()
 {
   const auto state = controller_.get_state();
@@ -134,14 +411,202 @@ void PendulumControllerNode::log_controller_state()
   RCLCPP_INFO(get_logger(), "Force command = %lf", force_command);
   RCLCPP_INFO(get_logger(), "Publisher missed deadlines = %u", num_missed_deadlines_pub_);
   RCLCPP_INFO(get_logger(), "Subscription missed deadlines = %u", num_missed_deadlines_sub_);
+
+  // estimate the message rate and publishing CPU time saved by the event trigger
+  const auto num_commands = event_trigger_.get_num_commands();
+  const auto num_published = event_trigger_.get_num_published();
+  const std::chrono::duration<double> active_time =
+    utils::TscClock::now() - activation_time_;
+  const double publish_cost = num_publish_timed_ > 0U ?
+    std::chrono::duration<double, std::micro>(publish_duration_).count() /
+    static_cast<double>(num_publish_timed_) : 0.0;
+  RCLCPP_INFO(
+    get_logger(), "Published commands = %" PRIu64 " of %" PRIu64,
+    static_cast<uint64_t>(num_published), static_cast<uint64_t>(num_commands));
+  if (active_time.count() > 0.0) {
+    RCLCPP_INFO(
+      get_logger(), "Command rate = %lf msg/s, saved %lf msg/s",
+      static_cast<double>(num_published) / active_time.count(),
+      static_cast<double>(num_commands - num_published) / active_time.count());
+  }
+  RCLCPP_INFO(
+    get_logger(), "Publish CPU time = %lf us/msg, saved %lf ms",
+    publish_cost, 1e-3 * publish_cost * static_cast<double>(num_commands - num_published));
+  if (anytime_controller_.get_config().is_enabled()) {
+    RCLCPP_INFO(
+      get_logger(),
+      "Anytime commands: final = %" PRIu64 ", partial = %" PRIu64 ", fallback = %" PRIu64,
+      static_cast<uint64_t>(anytime_controller_.get_num_final()),
+      static_cast<uint64_t>(anytime_controller_.get_num_partial()),
+      static_cast<uint64_t>(anytime_controller_.get_num_fallback()));
+  }
+  if (enable_controller_switching_ && !controller_switcher_.empty()) {
+    RCLCPP_INFO(
+      get_logger(), "Active controller = %s, switches = %" PRIu64,
+      controller_switcher_.get_active_name().c_str(),
+      static_cast<uint64_t>(controller_switcher_.get_num_switches()));
+  }
+  if (shadow_controller_.get_config().is_enabled()) {
+    const auto & deviation = shadow_controller_.get_deviation();
+    const auto & compute_time = shadow_controller_.get_compute_time();
+    RCLCPP_INFO(
+      get_logger(),
+      "Shadow deviation = %lf +- %lf, range [%lf, %lf] over %" PRIu64 " commands",
+      deviation.get_mean(), deviation.get_stddev(), deviation.get_min(), deviation.get_max(),
+      static_cast<uint64_t>(deviation.get_count()));
+    RCLCPP_INFO(
+      get_logger(), "Shadow compute time = %lf us mean, %lf us max, skipped = %" PRIu64,
+      compute_time.get_mean(), compute_time.get_max(),
+      static_cast<uint64_t>(shadow_controller_.get_num_skipped()));
+  }
+  if (load_shedder_.get_config().is_enabled()) {
+    RCLCPP_INFO(
+      get_logger(),
+      "Load shedding level = %zu, shed events = %" PRIu64 ", restore events = %" PRIu64,
+      load_shedder_.get_level(),
+      static_cast<uint64_t>(load_shedder_.get_num_shed_events()),
+      static_cast<uint64_t>(load_shedder_.get_num_restore_events()));
+    RCLCPP_INFO(
+      get_logger(), "Shed cycles = %" PRIu64 ", max cycle time = %lf us",
+      static_cast<uint64_t>(load_shedder_.get_num_skipped()),
+      std::chrono::duration<double, std::micro>(load_shedder_.get_max_cycle_time()).count());
+  }
+  if (perf_counters_) {
+    utils::log_perf_section(get_logger(), "Controller update", *perf_counters_, *perf_update_);
+    utils::log_perf_section(get_logger(), "Command publish", *perf_counters_, *perf_publish_);
+  }
+  if (enable_thread_time_accounting_) {
+    utils::log_thread_time(get_logger(), "State callback", state_callback_time_);
+  }
+}
+
+std::uint64_t PendulumControllerNode::get_config_fingerprint() const
+{
+  // the feedback matrix, the table and policy paths, the switcher laws and their own parameters
+  auto names = list_parameters(
+    {"controller", "controllers"},
+    rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE).names;
+  std::sort(names.begin(), names.end());
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (const auto & parameter : get_parameters(names)) {
+    hash = fingerprint(hash, parameter.get_name());
+    hash = fingerprint(hash, parameter.value_to_string());
+  }
+  // the files may have been replaced under the same path
+  hash = fingerprint_file(hash, get_parameter("controller.explicit_mpc_table").as_string());
+  return fingerprint_file(hash, get_parameter("controller.mlp_policy").as_string());
+}
+
+void PendulumControllerNode::store_controller_state()
+{
+  snapshot_.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  snapshot_.num_cycles = num_cycles_;
+  std::copy_n(controller_.get_state().begin(), 4U, snapshot_.state);
+  std::copy_n(controller_.get_teleop().begin(), 4U, snapshot_.reference);
+  snapshot_.force_command = controller_.get_force_command();
+  snapshot_.active_law = enable_controller_switching_ ?
+    controller_switcher_.get_active_index() : 0U;
+  persistent_state_->store(snapshot_);
+}
+
+bool PendulumControllerNode::restore_controller_state()
+{
+  ControllerSnapshot snapshot;
+  if (!persistent_state_->load(snapshot)) {
+    return false;
+  }
+  const auto age = std::chrono::steady_clock::now().time_since_epoch() -
+    std::chrono::nanoseconds{snapshot.time_ns};
+  if (age > persistence_max_age_) {
+    RCLCPP_WARN(
+      get_logger(), "Persisted state is %lf ms old, starting from the initial state",
+      std::chrono::duration<double, std::milli>(age).count());
+    return false;
+  }
+  if (snapshot.config_fingerprint != snapshot_.config_fingerprint) {
+    RCLCPP_WARN(
+      get_logger(), "Persisted state has another configuration, starting from the initial state");
+    return false;
+  }
+  const std::uint64_t active_law = enable_controller_switching_ ?
+    controller_switcher_.get_active_index() : 0U;
+  if (snapshot.active_law != active_law) {
+    RCLCPP_WARN(
+      get_logger(),
+      "Persisted state has another active controller, starting from the initial state");
+    return false;
+  }
+  controller_.set_state(snapshot.state[0], snapshot.state[1], snapshot.state[2], snapshot.state[3]);
+  controller_.set_teleop(
+    snapshot.reference[0], snapshot.reference[1], snapshot.reference[2], snapshot.reference[3]);
+  controller_.set_force_command(snapshot.force_command);
+  num_cycles_ = snapshot.num_cycles;
+  RCLCPP_INFO(
+    get_logger(), "Resumed from persisted state at cycle %" PRIu64 ", %lf ms old",
+    static_cast<uint64_t>(num_cycles_),
+    std::chrono::duration<double, std::milli>(age).count());
+  return true;
 }
 
 rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 PendulumControllerNode::on_configure(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Configuring");
+  // the switcher computes the force itself, the anytime law would never run
+  if (enable_controller_switching_ && anytime_controller_.get_config().is_enabled()) {
+    RCLCPP_ERROR(get_logger(), "controllers.enabled and anytime.enabled can not be both set");
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::FAILURE;
+  }
+  // all the laws are loaded and allocated here, a switch only changes the active one
+  if (enable_controller_switching_) {
+    try {
+      load_controller_laws();
+    } catch (const std::exception & e) {
+      RCLCPP_ERROR(get_logger(), "Could not load the controllers: %s", e.what());
+      controller_switcher_.clear();
+      return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::FAILURE;
+    }
+  }
+  if (shadow_controller_.get_config().is_enabled()) {
+    try {
+      load_shadow_controller();
+    } catch (const std::exception & e) {
+      RCLCPP_ERROR(get_logger(), "Could not load the shadow controller: %s", e.what());
+      controller_switcher_.clear();
+      return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::FAILURE;
+    }
+  }
+  // topic statistics can not be toggled on a live subscription, they are shed or restored here
+  // depending on the shedding level at the end of the last activation
+  const bool shed_topic_stats = load_shedder_.get_level() > 0U;
+  if (enable_topic_stats_ && shed_topic_stats != topic_stats_shed_) {
+    topic_stats_shed_ = shed_topic_stats;
+    create_state_subscription();
+    RCLCPP_INFO(get_logger(), "Topic statistics %s", topic_stats_shed_ ? "shed" : "restored");
+  }
+  // the shedding parameters may have been changed while the node was unconfigured
+  try {
+    load_shedder_ = utils::LoadShedder(
+      utils::LoadShedder::Config(
+        get_parameter("load_shedding.enabled").as_bool(),
+        std::chrono::microseconds {get_parameter("load_shedding.budget_us").as_int()},
+        get_parameter("load_shedding.shed_threshold").as_double(),
+        get_parameter("load_shedding.restore_threshold").as_double(),
+        static_cast<std::size_t>(get_parameter("load_shedding.restore_cycles").as_int()),
+        static_cast<std::size_t>(get_parameter("load_shedding.max_level").as_int())));
+  } catch (const std::exception & e) {
+    RCLCPP_ERROR(get_logger(), "Invalid load shedding parameters: %s", e.what());
+    controller_switcher_.clear();
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::FAILURE;
+  }
+  // hashed here, the law parameters may have been changed while the node was unconfigured
+  if (persistent_state_) {
+    snapshot_.config_fingerprint = get_config_fingerprint();
+  }
   // reset internal state of the controller for a clean start
   controller_.reset();
+  num_cycles_ = 0U;
   return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
 
@@ -149,7 +614,49 @@ rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 PendulumControllerNode::on_activate(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Activating");
+  // resume from the state of a previous process before the first state message is handled
+  if (persistent_state_) {
+    restore_controller_state();
+  }
   command_pub_->on_activate();
+  // always publish the first command after activation
+  event_trigger_.reset();
+  // the clock never calibrates itself in the cycles, its rate is corrected here
+  utils::TscClock::calibrate();
+  activation_time_ = utils::TscClock::now();
+  publish_duration_ = std::chrono::nanoseconds{0};
+  num_publish_timed_ = 0U;
+  anytime_controller_.reset_counters();
+  try {
+    anytime_controller_.start();
+  } catch (const std::exception & e) {
+    RCLCPP_ERROR(get_logger(), "Could not start the anytime controller: %s", e.what());
+    command_pub_->on_deactivate();
+    return LifecycleNodeInterface::CallbackReturn::FAILURE;
+  }
+  state_callback_time_.reset();
+  if (enable_perf_counters_) {
+    // opened here for the executor thread, which also handles the state messages
+    perf_counters_ = std::make_unique<utils::PerfCounters>();
+    perf_update_ = std::make_unique<utils::PerfSection>(*perf_counters_);
+    perf_publish_ = std::make_unique<utils::PerfSection>(*perf_counters_);
+    if (!perf_counters_->is_any_available()) {
+      RCLCPP_WARN(get_logger(), "Performance counters are not permitted or not supported");
+    }
+  }
+  if (shadow_controller_.get_config().is_enabled()) {
+    shadow_command_pub_->on_activate();
+    shadow_controller_.reset_statistics();
+    try {
+      shadow_controller_.start();
+    } catch (const std::exception & e) {
+      RCLCPP_ERROR(get_logger(), "Could not start the shadow controller: %s", e.what());
+      anytime_controller_.stop();
+      shadow_command_pub_->on_deactivate();
+      command_pub_->on_deactivate();
+      return LifecycleNodeInterface::CallbackReturn::FAILURE;
+    }
+  }
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
 
@@ -158,6 +665,11 @@ PendulumControllerNode::on_deactivate(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Deactivating");
   command_pub_->on_deactivate();
+  anytime_controller_.stop();
+  if (shadow_controller_.get_config().is_enabled()) {
+    shadow_controller_.stop();
+    shadow_command_pub_->on_deactivate();
+  }
   // log the status to introspect the result
   log_controller_state();
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
@@ -167,6 +679,12 @@ rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 PendulumControllerNode::on_cleanup(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Cleaning up");
+  controller_switcher_.clear();
+  shadow_controller_.set_candidate(nullptr);
+  // an orderly stop must not be resumed by the next process
+  if (persistent_state_) {
+    persistent_state_->clear();
+  }
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
 
@@ -174,6 +692,9 @@ rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 PendulumControllerNode::on_shutdown(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Shutting down");
+  if (persistent_state_) {
+    persistent_state_->clear();
+  }
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
 }  // namespace pendulum_controller
@@ -0,0 +1,220 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_controller/shadow_controller.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pendulum_utils/tsc_clock.hpp"
+
+namespace pendulum
+{
+namespace pendulum_controller
+{
+ShadowController::Config::Config(
+  bool enabled, int cpu, std::chrono::microseconds poll_period)
+: enabled{enabled},
+  cpu{cpu},
+  poll_period{poll_period}
+{
+  if (poll_period.count() <= 0) {
+    throw std::invalid_argument("shadow poll period must be positive");
+  }
+}
+
+bool ShadowController::Config::is_enabled() const
+{
+  return enabled;
+}
+
+int ShadowController::Config::get_cpu() const
+{
+  return cpu;
+}
+
+std::chrono::microseconds ShadowController::Config::get_poll_period() const
+{
+  return poll_period;
+}
+
+ShadowController::ShadowController(const Config & config)
+: cfg_(config),
+  num_submitted_{0U},
+  stop_requested_{false},
+  num_skipped_{0U},
+  last_sequence_{0U}
+{}
+
+ShadowController::~ShadowController()
+{
+  stop();
+}
+
+void ShadowController::set_candidate(
+  std::shared_ptr<ControllerLaw> candidate,
+  ResultCallback on_result)
+{
+  if (worker_.joinable()) {
+    throw std::logic_error("the shadow candidate can not be changed while running");
+  }
+  candidate_ = std::move(candidate);
+  on_result_ = std::move(on_result);
+}
+
+void ShadowController::start()
+{
+  if (!cfg_.is_enabled() || !candidate_ || worker_.joinable()) {
+    return;
+  }
+  stop_requested_ = false;
+  // inputs submitted before the start are not evaluated
+  Sample sample;
+  sample.sequence = 0U;
+  read_latest(sample);
+  last_sequence_ = sample.sequence;
+  candidate_->reset();
+  std::promise<int> pinned;
+  std::future<int> pin_error = pinned.get_future();
+  worker_ = std::thread(&ShadowController::run, this, std::move(pinned));
+  const int error = pin_error.get();
+  if (error != 0) {
+    worker_.join();
+    throw std::runtime_error(
+            "failed to pin the shadow thread to cpu " + std::to_string(cfg_.get_cpu()) + ": " +
+            std::strerror(error));
+  }
+}
+
+void ShadowController::stop()
+{
+  if (worker_.joinable()) {
+    stop_requested_ = true;
+    worker_.join();
+  }
+}
+
+void ShadowController::submit(
+  const std::vector<double> & state, const std::vector<double> & reference,
+  double active_force) noexcept
+{
+  Sample sample;
+  std::copy_n(state.begin(), 4U, sample.state);
+  std::copy_n(reference.begin(), 4U, sample.reference);
+  sample.active_force = active_force;
+  sample.sequence = ++num_submitted_;
+  // the worker holds at most one buffer, the other one always takes the latest inputs
+  if (!inputs_[0].write(sample)) {
+    inputs_[1].write(sample);
+  }
+}
+
+const ShadowController::Config & ShadowController::get_config() const
+{
+  return cfg_;
+}
+
+const utils::AtomicAccumulator & ShadowController::get_deviation() const
+{
+  return deviation_;
+}
+
+const utils::AtomicAccumulator & ShadowController::get_compute_time() const
+{
+  return compute_time_;
+}
+
+std::uint64_t ShadowController::get_num_skipped() const
+{
+  return num_skipped_.load(std::memory_order_relaxed);
+}
+
+void ShadowController::reset_statistics()
+{
+  deviation_.reset();
+  compute_time_.reset();
+  num_skipped_ = 0U;
+}
+
+void ShadowController::read_latest(Sample & sample)
+{
+  Sample buffered;
+  for (auto & inputs : inputs_) {
+    if (inputs.read(buffered) > 0U && buffered.sequence > sample.sequence) {
+      sample = buffered;
+    }
+  }
+}
+
+void ShadowController::run(std::promise<int> pinned)
+{
+  // pinned before the first evaluation, a failure is reported to start
+  int error = 0;
+  if (cfg_.get_cpu() >= CPU_SETSIZE) {
+    error = EINVAL;
+  } else if (cfg_.get_cpu() >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cfg_.get_cpu(), &set);
+    error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+  pinned.set_value(error);
+  if (error != 0) {
+    return;
+  }
+
+  // preallocate the inputs of the candidate law
+  std::vector<double> state(4U);
+  std::vector<double> reference(4U);
+  Sample sample;
+  while (!stop_requested_.load(std::memory_order_relaxed)) {
+    sample.sequence = last_sequence_;
+    read_latest(sample);
+    if (sample.sequence == last_sequence_) {
+      std::this_thread::sleep_for(cfg_.get_poll_period());
+      continue;
+    }
+    if (sample.sequence > last_sequence_ + 1U) {
+      num_skipped_.store(
+        num_skipped_.load(std::memory_order_relaxed) + (sample.sequence - last_sequence_ - 1U),
+        std::memory_order_relaxed);
+    }
+    last_sequence_ = sample.sequence;
+    std::copy_n(sample.state, 4U, state.begin());
+    std::copy_n(sample.reference, 4U, reference.begin());
+
+    const auto start = utils::TscClock::now();
+    const double candidate_force = candidate_->compute(state, reference);
+    const auto compute_time = utils::TscClock::now() - start;
+
+    compute_time_.add(std::chrono::duration<double, std::micro>(compute_time).count());
+    deviation_.add(candidate_force - sample.active_force);
+    if (on_result_) {
+      on_result_(candidate_force, sample.active_force);
+    }
+  }
+}
+}  // namespace pendulum_controller
+}  // namespace pendulum
@@ -0,0 +1,175 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "pendulum_controller/anytime_controller.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_controller::AnytimeController;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace
+{
+AnytimeController::Config make_config(bool enabled, microseconds deadline)
+{
+  // the tests run the worker with the default priority and affinity
+  return AnytimeController::Config(enabled, deadline, 2 * deadline, microseconds(10), 0, -1);
+}
+}  // namespace
+
+class TestAnytimeController : public ::testing::Test
+{
+protected:
+  const std::vector<double> state{1.0, 2.0, 3.0, 4.0};
+  const std::vector<double> reference{0.5, 0.0, 3.0, 0.0};
+};
+
+TEST_F(TestAnytimeController, config)
+{
+  const AnytimeController::Config config(
+    true, microseconds(500), microseconds(1000), microseconds(20), 80, 2);
+  EXPECT_TRUE(config.is_enabled());
+  EXPECT_EQ(config.get_deadline(), microseconds(500));
+  EXPECT_EQ(config.get_period(), microseconds(1000));
+  EXPECT_EQ(config.get_poll_period(), microseconds(20));
+  EXPECT_EQ(config.get_priority(), 80);
+  EXPECT_EQ(config.get_cpu(), 2);
+  EXPECT_THROW(
+    AnytimeController::Config(true, microseconds(0), microseconds(1000), microseconds(20), 0, -1),
+    std::invalid_argument);
+  // the deadline must leave time for the rest of the cycle
+  EXPECT_THROW(
+    AnytimeController::Config(
+      true, microseconds(1000), microseconds(1000), microseconds(20), 0, -1),
+    std::invalid_argument);
+  EXPECT_THROW(
+    AnytimeController::Config(true, microseconds(500), microseconds(1000), microseconds(0), 0, -1),
+    std::invalid_argument);
+  EXPECT_THROW(
+    AnytimeController::Config(
+      true, microseconds(500), microseconds(1000), microseconds(20), 99, -1),
+    std::invalid_argument);
+  EXPECT_THROW(
+    AnytimeController::Config(true, microseconds(500), microseconds(1000), microseconds(20), 0, 32),
+    std::invalid_argument);
+}
+
+TEST_F(TestAnytimeController, disabled)
+{
+  bool called = false;
+  AnytimeController controller(
+    make_config(false, microseconds(5000)),
+    [&called](const AnytimeController::State &, const AnytimeController::State &,
+    std::size_t, double &) {
+      called = true;
+      return true;
+    });
+  controller.start();
+  EXPECT_DOUBLE_EQ(
+    controller.update(state, reference, -1.0, std::chrono::steady_clock::now()), -1.0);
+  controller.stop();
+  EXPECT_FALSE(called);
+  EXPECT_EQ(controller.get_num_fallback(), 1U);
+}
+
+TEST_F(TestAnytimeController, final_result)
+{
+  // single step law using the cart position error
+  AnytimeController controller(
+    make_config(true, microseconds(500000)),
+    [](const AnytimeController::State & x, const AnytimeController::State & r,
+    std::size_t, double & force) {
+      force = 10.0 * (x[0] - r[0]);
+      return true;
+    });
+  controller.start();
+  double force = 0.0;
+  for (std::size_t k = 0; k < 10U; k++) {
+    apex_test_tools::memory_test::start();
+    force = controller.update(state, reference, -1.0, std::chrono::steady_clock::now());
+    apex_test_tools::memory_test::stop();
+    EXPECT_DOUBLE_EQ(force, 5.0);
+  }
+  controller.stop();
+  EXPECT_EQ(controller.get_num_final(), 10U);
+  EXPECT_EQ(controller.get_num_partial(), 0U);
+  EXPECT_EQ(controller.get_num_fallback(), 0U);
+}
+
+TEST_F(TestAnytimeController, partial_result)
+{
+  // refinement which never converges, every iteration adds one Newton and only the first one is
+  // immediate, so a result is available at the deadline even on a loaded machine
+  AnytimeController controller(
+    make_config(true, microseconds(50000)),
+    [](const AnytimeController::State &, const AnytimeController::State &,
+    std::size_t iteration, double & force) {
+      if (iteration > 0U) {
+        std::this_thread::sleep_for(milliseconds(5));
+      }
+      force += 1.0;
+      return false;
+    });
+  controller.start();
+  const auto start = std::chrono::steady_clock::now();
+  const double force = controller.update(state, reference, -1.0, start);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  controller.stop();
+  EXPECT_GE(force, 1.0);
+  // a result which is never final is used when the deadline expires
+  EXPECT_GE(elapsed, milliseconds(50));
+  EXPECT_EQ(controller.get_num_partial(), 1U);
+  EXPECT_EQ(controller.get_num_final(), 0U);
+  EXPECT_EQ(controller.get_num_fallback(), 0U);
+}
+
+TEST_F(TestAnytimeController, fallback)
+{
+  // the first iteration does not finish before the deadline, it is released after the update
+  std::mutex mutex;
+  std::condition_variable released_cv;
+  bool released = false;
+  AnytimeController controller(
+    make_config(true, microseconds(10000)),
+    [&](const AnytimeController::State &, const AnytimeController::State &,
+    std::size_t, double & force) {
+      std::unique_lock<std::mutex> lock(mutex);
+      released_cv.wait(lock, [&released] {return released;});
+      force = 100.0;
+      return true;
+    });
+  controller.start();
+  const auto start = std::chrono::steady_clock::now();
+  const double force = controller.update(state, reference, -1.0, start);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    released = true;
+  }
+  released_cv.notify_one();
+  controller.stop();
+  EXPECT_DOUBLE_EQ(force, -1.0);
+  EXPECT_GE(elapsed, milliseconds(10));
+  EXPECT_EQ(controller.get_num_fallback(), 1U);
+  EXPECT_EQ(controller.get_num_final(), 0U);
+  controller.reset_counters();
+  EXPECT_EQ(controller.get_num_fallback(), 0U);
+}
@@ -0,0 +1,148 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "pendulum_controller/controller_switcher.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_controller::ControllerLaw;
+using pendulum::pendulum_controller::ControllerSwitcher;
+
+namespace
+{
+// proportional law on the cart position error
+class GainLaw : public ControllerLaw
+{
+public:
+  explicit GainLaw(double gain)
+  : gain_(gain) {}
+
+  void initialize(
+    const std::string &,
+    const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr &) override {}
+
+  double compute(
+    const std::vector<double> & state,
+    const std::vector<double> & reference) override
+  {
+    return gain_ * (reference[0] - state[0]) + bias_;
+  }
+
+  void align(const std::vector<double> & state, const std::vector<double> & reference,
+    double force) override
+  {
+    if (aligns_) {
+      bias_ = force - gain_ * (reference[0] - state[0]);
+    }
+  }
+
+  void reset() override
+  {
+    bias_ = 0.0;
+  }
+
+  bool aligns_ = false;
+
+private:
+  double gain_;
+  double bias_ = 0.0;
+};
+}  // namespace
+
+class TestControllerSwitcher : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    soft = std::make_shared<GainLaw>(1.0);
+    stiff = std::make_shared<GainLaw>(5.0);
+    switcher.add("soft", soft);
+    switcher.add("stiff", stiff);
+  }
+
+  std::shared_ptr<GainLaw> soft;
+  std::shared_ptr<GainLaw> stiff;
+  ControllerSwitcher switcher{ControllerSwitcher::Config(4U)};
+  std::vector<double> state{1.0, 0.0, 3.14, 0.0};
+  const std::vector<double> reference{3.0, 0.0, 3.14, 0.0};
+};
+
+TEST_F(TestControllerSwitcher, add)
+{
+  EXPECT_FALSE(switcher.empty());
+  EXPECT_EQ(switcher.get_active_name(), "soft");
+  EXPECT_EQ(switcher.get_names(), (std::vector<std::string>{"soft", "stiff"}));
+  EXPECT_THROW(switcher.add("soft", soft), std::invalid_argument);
+  EXPECT_THROW(switcher.add("none", nullptr), std::invalid_argument);
+  EXPECT_FALSE(switcher.request("none"));
+  EXPECT_DOUBLE_EQ(switcher.update(state, reference), 2.0);
+  switcher.clear();
+  EXPECT_TRUE(switcher.empty());
+  EXPECT_DOUBLE_EQ(switcher.update(state, reference), 0.0);
+}
+
+TEST_F(TestControllerSwitcher, bumpless_transfer)
+{
+  EXPECT_DOUBLE_EQ(switcher.update(state, reference), 2.0);
+  ASSERT_TRUE(switcher.request("stiff"));
+  // the switch is applied in the next update, without allocating memory
+  EXPECT_EQ(switcher.get_active_name(), "soft");
+  EXPECT_EQ(switcher.get_active_index(), 0U);
+  state[0] = 1.5;
+  apex_test_tools::memory_test::start();
+  const double switch_force = switcher.update(state, reference);
+  apex_test_tools::memory_test::stop();
+  EXPECT_EQ(switcher.get_active_name(), "stiff");
+  EXPECT_EQ(switcher.get_active_index(), 1U);
+  EXPECT_EQ(switcher.get_num_switches(), 1U);
+  // the switch cycle continues the previous law
+  EXPECT_DOUBLE_EQ(switch_force, 1.5);
+  EXPECT_DOUBLE_EQ(switcher.get_transfer_offset(), 1.5 - 7.5);
+
+  // the difference is removed over the transfer cycles
+  const double expected[] = {7.5 - 4.5, 7.5 - 3.0, 7.5 - 1.5, 7.5, 7.5};
+  for (const double force : expected) {
+    EXPECT_NEAR(switcher.update(state, reference), force, 1e-12);
+  }
+  EXPECT_NEAR(switcher.get_transfer_offset(), 0.0, 1e-12);
+}
+
+TEST_F(TestControllerSwitcher, switch_during_transfer)
+{
+  switcher.update(state, reference);
+  switcher.request("stiff");
+  switcher.update(state, reference);
+  const double force = switcher.update(state, reference);
+  switcher.request("soft");
+  // the switch cycle continues the previous law including its remaining offset
+  EXPECT_NEAR(switcher.update(state, reference), force, 1e-12);
+  EXPECT_NEAR(switcher.get_transfer_offset(), force - 2.0, 1e-12);
+}
+
+TEST_F(TestControllerSwitcher, aligned_law)
+{
+  stiff->aligns_ = true;
+  switcher.update(state, reference);
+  switcher.request("stiff");
+  EXPECT_DOUBLE_EQ(switcher.update(state, reference), 2.0);
+  // a law aligned with the previous force needs no offset
+  EXPECT_DOUBLE_EQ(switcher.get_transfer_offset(), 0.0);
+  EXPECT_DOUBLE_EQ(switcher.update(state, reference), 2.0);
+  switcher.reset();
+  EXPECT_DOUBLE_EQ(switcher.update(state, reference), 10.0);
+}
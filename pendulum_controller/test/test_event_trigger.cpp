@@ -0,0 +1,104 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+#include "pendulum_controller/event_trigger.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_controller::EventTrigger;
+using std::chrono::milliseconds;
+
+TEST(TestEventTrigger, disabled_publishes_always)
+{
+  EventTrigger trigger(EventTrigger::Config(false, 1.0, {0.0, 0.0, 0.0, 0.0}, milliseconds(100)));
+  const std::vector<double> state{0.0, 0.0, 0.0, 0.0};
+  const auto now = std::chrono::steady_clock::now();
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(trigger.update(0.0, state, now));
+  }
+  EXPECT_EQ(trigger.get_num_commands(), 10U);
+  EXPECT_EQ(trigger.get_num_published(), 10U);
+}
+
+TEST(TestEventTrigger, force_threshold)
+{
+  EventTrigger trigger(EventTrigger::Config(true, 1.0, {0.0, 0.0, 0.0, 0.0}, milliseconds(100)));
+  const std::vector<double> state{0.0, 0.0, 0.0, 0.0};
+  const auto now = std::chrono::steady_clock::now();
+  bool first = false;
+  bool small_change = true;
+  bool accumulated_change = false;
+
+  apex_test_tools::memory_test::start();
+  // the first command is always published
+  first = trigger.update(0.0, state, now);
+  small_change = trigger.update(0.6, state, now);
+  // the change is measured against the last published force
+  accumulated_change = trigger.update(1.2, state, now);
+  apex_test_tools::memory_test::stop();
+
+  EXPECT_TRUE(first);
+  EXPECT_FALSE(small_change);
+  EXPECT_TRUE(accumulated_change);
+  EXPECT_EQ(trigger.get_num_published(), 2U);
+}
+
+TEST(TestEventTrigger, state_thresholds)
+{
+  EventTrigger trigger(EventTrigger::Config(true, 1.0, {0.1, 0.0, 0.01, 0.0}, milliseconds(100)));
+  const auto now = std::chrono::steady_clock::now();
+  EXPECT_TRUE(trigger.update(0.0, {0.0, 0.0, 0.0, 0.0}, now));
+  EXPECT_FALSE(trigger.update(0.0, {0.05, 0.0, 0.005, 0.0}, now));
+  // the angle threshold is smaller than the position one
+  EXPECT_TRUE(trigger.update(0.0, {0.0, 0.0, 0.015, 0.0}, now));
+  EXPECT_FALSE(trigger.update(0.0, {0.0, 0.0, 0.02, 0.0}, now));
+  EXPECT_TRUE(trigger.update(0.0, {0.15, 0.0, 0.02, 0.0}, now));
+  // a 0 threshold disables the condition of the element
+  EXPECT_FALSE(trigger.update(0.0, {0.15, 10.0, 0.02, -10.0}, now));
+}
+
+TEST(TestEventTrigger, invalid_state_thresholds)
+{
+  EXPECT_THROW(
+    EventTrigger::Config(true, 1.0, {0.1, 0.1}, milliseconds(100)), std::invalid_argument);
+  EXPECT_THROW(
+    EventTrigger::Config(true, 1.0, {0.1, -0.1, 0.1, 0.1}, milliseconds(100)),
+    std::invalid_argument);
+}
+
+TEST(TestEventTrigger, max_silence)
+{
+  EventTrigger trigger(EventTrigger::Config(true, 1.0, {0.0, 0.0, 0.0, 0.0}, milliseconds(100)));
+  const std::vector<double> state{0.0, 0.0, 0.0, 0.0};
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(trigger.update(0.0, state, start));
+  EXPECT_FALSE(trigger.update(0.0, state, start + milliseconds(99)));
+  EXPECT_TRUE(trigger.update(0.0, state, start + milliseconds(100)));
+  EXPECT_FALSE(trigger.update(0.0, state, start + milliseconds(150)));
+}
+
+TEST(TestEventTrigger, reset)
+{
+  EventTrigger trigger(EventTrigger::Config(true, 1.0, {0.0, 0.0, 0.0, 0.0}, milliseconds(100)));
+  const std::vector<double> state{0.0, 0.0, 0.0, 0.0};
+  const auto now = std::chrono::steady_clock::now();
+  EXPECT_TRUE(trigger.update(0.0, state, now));
+  EXPECT_FALSE(trigger.update(0.0, state, now));
+  trigger.reset();
+  EXPECT_EQ(trigger.get_num_commands(), 0U);
+  EXPECT_TRUE(trigger.update(0.0, state, now));
+}
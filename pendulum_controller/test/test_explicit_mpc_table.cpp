@@ -0,0 +1,118 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "pendulum_controller/explicit_mpc_table.hpp"
+#include "pendulum_controller/pendulum_controller.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_controller::ExplicitMpcTable;
+using pendulum::pendulum_controller::PendulumController;
+
+class TestExplicitMpcTable : public ::testing::Test
+{
+protected:
+  // u = 10 * x for x <= 1, saturated at 10 N for x >= 1, one dimensional law on the cart position
+  ExplicitMpcTable make_table() const
+  {
+    ExplicitMpcTable::Grid grid{{{-2.0, -1.0, -1.0, -1.0}}, {{2.0, 1.0, 1.0, 1.0}},
+      {{2U, 1U, 1U, 1U}}};
+    std::vector<ExplicitMpcTable::Region> regions{
+      {{{10.0F, 0.0F, 0.0F, 0.0F}}, 0.0F, 0U, 1U},
+      {{{0.0F, 0.0F, 0.0F, 0.0F}}, 10.0F, 1U, 1U}};
+    std::vector<ExplicitMpcTable::Constraint> constraints{
+      {{{1.0F, 0.0F, 0.0F, 0.0F}}, 1.0F},
+      {{{-1.0F, 0.0F, 0.0F, 0.0F}}, -1.0F}};
+    // the left cell only contains the linear region
+    std::vector<std::uint32_t> cell_offsets{0U, 1U, 3U};
+    std::vector<std::uint16_t> cell_regions{0U, 0U, 1U};
+    return ExplicitMpcTable(
+      15.0, grid, regions, constraints, cell_offsets, cell_regions);
+  }
+};
+
+TEST_F(TestExplicitMpcTable, evaluate)
+{
+  const auto table = make_table();
+  const double linear[4] = {0.5, 0.0, 0.0, 0.0};
+  const double saturated[4] = {1.5, 0.0, 0.0, 0.0};
+  const double outside[4] = {-5.0, 3.0, 0.0, 0.0};
+  double force_linear = 0.0;
+  double force_saturated = 0.0;
+  double force_outside = 0.0;
+
+  apex_test_tools::memory_test::start();
+  force_linear = table.evaluate(linear);
+  force_saturated = table.evaluate(saturated);
+  force_outside = table.evaluate(outside);
+  apex_test_tools::memory_test::stop();
+
+  EXPECT_EQ(0U, table.find_region(linear));
+  EXPECT_EQ(1U, table.find_region(saturated));
+  EXPECT_DOUBLE_EQ(5.0, force_linear);
+  EXPECT_DOUBLE_EQ(10.0, force_saturated);
+  // outside of the grid the closest region is extrapolated and clamped to the force limit
+  EXPECT_DOUBLE_EQ(-15.0, force_outside);
+}
+
+TEST_F(TestExplicitMpcTable, serialization)
+{
+  const auto table = make_table();
+  const auto data = table.to_bytes();
+  const auto loaded = ExplicitMpcTable::from_bytes(data);
+  EXPECT_EQ(data, loaded.to_bytes());
+  EXPECT_DOUBLE_EQ(table.get_max_force(), loaded.get_max_force());
+  EXPECT_EQ(table.get_regions().size(), loaded.get_regions().size());
+
+  auto truncated = data;
+  truncated.pop_back();
+  EXPECT_THROW(ExplicitMpcTable::from_bytes(truncated), std::runtime_error);
+  auto wrong_magic = data;
+  wrong_magic[0] = 'X';
+  EXPECT_THROW(ExplicitMpcTable::from_bytes(wrong_magic), std::runtime_error);
+  EXPECT_THROW(ExplicitMpcTable::load("non_existent_table.bin"), std::runtime_error);
+}
+
+TEST_F(TestExplicitMpcTable, invalid_table)
+{
+  ExplicitMpcTable::Grid grid{{{-1.0, -1.0, -1.0, -1.0}}, {{1.0, 1.0, 1.0, 1.0}},
+    {{2U, 1U, 1U, 1U}}};
+  std::vector<ExplicitMpcTable::Region> regions{{{{1.0F, 0.0F, 0.0F, 0.0F}}, 0.0F, 0U, 0U}};
+  // the second cell has no candidate regions
+  EXPECT_THROW(
+    ExplicitMpcTable(10.0, grid, regions, {}, {0U, 1U, 1U}, {0U}), std::invalid_argument);
+  EXPECT_THROW(
+    ExplicitMpcTable(10.0, grid, regions, {}, {0U, 1U, 2U}, {0U, 1U}), std::invalid_argument);
+  EXPECT_NO_THROW(ExplicitMpcTable(10.0, grid, regions, {}, {0U, 1U, 2U}, {0U, 0U}));
+}
+
+TEST_F(TestExplicitMpcTable, controller_uses_table)
+{
+  PendulumController::Config config{{-10.0000, -51.5393, 356.8637, 154.4146},
+    std::make_shared<const ExplicitMpcTable>(make_table())};
+  PendulumController controller{config};
+  controller.set_teleop(0.25, 0.0, M_PI, 0.0);
+  controller.set_state(1.0, 0.0, M_PI, 0.0);
+
+  apex_test_tools::memory_test::start();
+  controller.update();
+  apex_test_tools::memory_test::stop();
+
+  // the error is used as the table input
+  EXPECT_DOUBLE_EQ(7.5, controller.get_force_command());
+}
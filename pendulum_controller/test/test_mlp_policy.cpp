@@ -0,0 +1,170 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "pendulum_controller/mlp_policy.hpp"
+#include "pendulum_controller/pendulum_controller.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_controller::MlpPolicy;
+using pendulum::pendulum_controller::PendulumController;
+
+class TestMlpPolicy : public ::testing::Test
+{
+protected:
+  // random network, the hidden sizes are not multiple of the SIMD width on purpose
+  std::vector<MlpPolicy::Layer> make_layers(MlpPolicy::Activation activation) const
+  {
+    std::mt19937 rand_gen(7U);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+    const std::vector<std::size_t> sizes{4U, 13U, 6U, 1U};
+    std::vector<MlpPolicy::Layer> layers;
+    for (std::size_t l = 0; l + 1U < sizes.size(); l++) {
+      MlpPolicy::Layer layer{sizes[l], sizes[l + 1U],
+        l + 2U < sizes.size() ? activation : MlpPolicy::Activation::LINEAR, {}, {}};
+      for (std::size_t i = 0; i < layer.inputs * layer.outputs; i++) {
+        layer.weights.push_back(dist(rand_gen));
+      }
+      for (std::size_t i = 0; i < layer.outputs; i++) {
+        layer.bias.push_back(dist(rand_gen));
+      }
+      layers.push_back(layer);
+    }
+    return layers;
+  }
+
+  // straightforward double precision evaluation
+  static double reference(const std::vector<MlpPolicy::Layer> & layers, const double * error)
+  {
+    std::vector<double> x(error, error + MlpPolicy::STATE_DIM);
+    for (const auto & layer : layers) {
+      std::vector<double> y(layer.outputs);
+      for (std::size_t r = 0; r < layer.outputs; r++) {
+        y[r] = layer.bias[r];
+        for (std::size_t c = 0; c < layer.inputs; c++) {
+          y[r] += layer.weights[r * layer.inputs + c] * x[c];
+        }
+        if (layer.activation == MlpPolicy::Activation::TANH) {
+          y[r] = std::tanh(y[r]);
+        } else if (layer.activation == MlpPolicy::Activation::RELU) {
+          y[r] = std::max(y[r], 0.0);
+        }
+      }
+      x = y;
+    }
+    return x[0];
+  }
+};
+
+TEST_F(TestMlpPolicy, evaluate)
+{
+  for (const auto activation : {MlpPolicy::Activation::TANH, MlpPolicy::Activation::RELU}) {
+    const auto layers = make_layers(activation);
+    const MlpPolicy policy(100.0, layers);
+    std::mt19937 rand_gen(3U);
+    std::uniform_real_distribution<double> dist(-3.0, 3.0);
+    for (std::size_t k = 0; k < 1000U; k++) {
+      const double error[4] = {dist(rand_gen), dist(rand_gen), dist(rand_gen), dist(rand_gen)};
+      double force = 0.0;
+      apex_test_tools::memory_test::start();
+      force = policy.evaluate(error);
+      apex_test_tools::memory_test::stop();
+      EXPECT_NEAR(force, reference(layers, error), 1e-4);
+    }
+  }
+}
+
+TEST_F(TestMlpPolicy, tanh_saturation)
+{
+  // single tanh neuron with a large gain followed by a linear output
+  std::vector<MlpPolicy::Layer> layers{
+    {4U, 1U, MlpPolicy::Activation::TANH, {1.0F, 0.0F, 0.0F, 0.0F}, {0.0F}},
+    {1U, 1U, MlpPolicy::Activation::LINEAR, {1.0F}, {0.0F}}};
+  const MlpPolicy policy(100.0, layers);
+  for (const double x : {-1e6, -20.0, -9.0, -4.5, -0.1, 0.0, 0.3, 2.0, 8.9, 50.0, 1e30}) {
+    const double error[4] = {x, 0.0, 0.0, 0.0};
+    EXPECT_NEAR(policy.evaluate(error), std::tanh(x), 1e-6) << x;
+  }
+}
+
+TEST_F(TestMlpPolicy, force_limit)
+{
+  std::vector<MlpPolicy::Layer> layers{
+    {4U, 1U, MlpPolicy::Activation::LINEAR, {100.0F, 0.0F, 0.0F, 0.0F}, {0.0F}}};
+  const MlpPolicy policy(10.0, layers);
+  const double positive[4] = {1.0, 0.0, 0.0, 0.0};
+  const double negative[4] = {-1.0, 0.0, 0.0, 0.0};
+  EXPECT_DOUBLE_EQ(policy.evaluate(positive), 10.0);
+  EXPECT_DOUBLE_EQ(policy.evaluate(negative), -10.0);
+}
+
+TEST_F(TestMlpPolicy, serialization)
+{
+  const MlpPolicy policy(100.0, make_layers(MlpPolicy::Activation::TANH));
+  const auto loaded = MlpPolicy::from_bytes(policy.to_bytes());
+  EXPECT_EQ(loaded.get_layers().size(), 3U);
+  EXPECT_DOUBLE_EQ(loaded.get_max_force(), 100.0);
+  const double error[4] = {0.1, -0.2, 0.3, -0.4};
+  EXPECT_DOUBLE_EQ(loaded.evaluate(error), policy.evaluate(error));
+
+  auto truncated = policy.to_bytes();
+  truncated.pop_back();
+  EXPECT_THROW(MlpPolicy::from_bytes(truncated), std::runtime_error);
+  auto wrong_magic = policy.to_bytes();
+  wrong_magic[0] = 'X';
+  EXPECT_THROW(MlpPolicy::from_bytes(wrong_magic), std::runtime_error);
+}
+
+TEST_F(TestMlpPolicy, invalid_policy)
+{
+  auto layers = make_layers(MlpPolicy::Activation::TANH);
+  EXPECT_THROW(MlpPolicy(0.0, layers), std::invalid_argument);
+  EXPECT_THROW(MlpPolicy(100.0, {}), std::invalid_argument);
+  auto wrong_size = layers;
+  wrong_size[1].inputs = 12U;
+  EXPECT_THROW(MlpPolicy(100.0, wrong_size), std::invalid_argument);
+  auto wrong_output = layers;
+  wrong_output.pop_back();
+  EXPECT_THROW(MlpPolicy(100.0, wrong_output), std::invalid_argument);
+  auto not_finite = layers;
+  not_finite[0].bias[0] = NAN;
+  EXPECT_THROW(MlpPolicy(100.0, not_finite), std::invalid_argument);
+}
+
+TEST_F(TestMlpPolicy, controller_uses_policy)
+{
+  // linear policy equivalent to the feedback matrix
+  const std::vector<double> feedback_matrix{-10.0000, -51.5393, 356.8637, 154.4146};
+  std::vector<MlpPolicy::Layer> layers{
+    {4U, 1U, MlpPolicy::Activation::LINEAR, {10.0F, 51.5393F, -356.8637F, -154.4146F}, {0.0F}}};
+  auto policy = std::make_shared<const MlpPolicy>(1000.0, layers);
+  PendulumController controller(PendulumController::Config(feedback_matrix, nullptr, policy));
+  PendulumController linear(PendulumController::Config{feedback_matrix});
+  controller.set_state(0.1, 0.2, M_PI + 0.05, -0.1);
+  linear.set_state(0.1, 0.2, M_PI + 0.05, -0.1);
+
+  apex_test_tools::memory_test::start();
+  controller.update();
+  apex_test_tools::memory_test::stop();
+  linear.update();
+
+  EXPECT_NEAR(controller.get_force_command(), linear.get_force_command(), 1e-3);
+}
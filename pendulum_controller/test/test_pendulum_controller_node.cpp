@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <stdexcept>
 #include <vector>
 #include "pendulum_controller/pendulum_controller_node.hpp"
 
@@ -90,6 +91,28 @@ TEST_F(TestPendulumControllerNode, trigger_lifecycle_transitions) {
       rclcpp_lifecycle::Transition(Transition::TRANSITION_UNCONFIGURED_SHUTDOWN)).id());
 }
 
+TEST_F(TestPendulumControllerNode, anytime_deadline) {
+  // the deadline must be shorter than the period of the state messages
+  params.emplace_back("anytime.enabled", true);
+  params.emplace_back("anytime.deadline_us", 1000);
+  params.emplace_back("anytime.period_us", 1000);
+  node_options.parameter_overrides(params);
+  EXPECT_THROW(PendulumControllerNode{node_options}, std::invalid_argument);
+}
+
+TEST_F(TestPendulumControllerNode, anytime_with_controller_switching) {
+  using lifecycle_msgs::msg::State;
+  using lifecycle_msgs::msg::Transition;
+  // the switcher computes the force, the anytime law would be silently ignored
+  params.emplace_back("anytime.enabled", true);
+  params.emplace_back("controllers.enabled", true);
+  node_options.parameter_overrides(params);
+  PendulumControllerNode controller_node{node_options};
+  EXPECT_EQ(
+    State::PRIMARY_STATE_UNCONFIGURED, controller_node.trigger_transition(
+      rclcpp_lifecycle::Transition(Transition::TRANSITION_CONFIGURE)).id());
+}
+
 TEST_F(TestPendulumControllerNode, pendulum_state_message_size) {
   EXPECT_TRUE(rosidl_generator_traits::has_bounded_size<pendulum2_msgs::msg::JointState>());
   EXPECT_TRUE(rosidl_generator_traits::has_fixed_size<pendulum2_msgs::msg::JointState>());
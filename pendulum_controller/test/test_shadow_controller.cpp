@@ -0,0 +1,143 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pendulum_controller/shadow_controller.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_controller::ControllerLaw;
+using pendulum::pendulum_controller::ShadowController;
+
+namespace
+{
+// proportional law on the cart position error
+class GainLaw : public ControllerLaw
+{
+public:
+  explicit GainLaw(double gain)
+  : gain_(gain) {}
+
+  void initialize(
+    const std::string &,
+    const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr &) override {}
+
+  double compute(
+    const std::vector<double> & state,
+    const std::vector<double> & reference) override
+  {
+    return gain_ * (reference[0] - state[0]);
+  }
+
+private:
+  double gain_;
+};
+
+// waits until the shadow evaluated the expected number of inputs
+bool wait_for_count(const ShadowController & shadow, std::uint64_t count)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (shadow.get_deviation().get_count() + shadow.get_num_skipped() < count) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+}  // namespace
+
+TEST(TestShadowController, config)
+{
+  EXPECT_THROW(
+    ShadowController::Config(true, -1, std::chrono::microseconds(0)), std::invalid_argument);
+  ShadowController shadow(ShadowController::Config(false, -1, std::chrono::microseconds(100)));
+  shadow.set_candidate(std::make_shared<GainLaw>(2.0));
+  // a disabled shadow does not evaluate the candidate
+  shadow.start();
+  shadow.submit({1.0, 0.0, 3.14, 0.0}, {2.0, 0.0, 3.14, 0.0}, 1.0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(shadow.get_deviation().get_count(), 0U);
+}
+
+TEST(TestShadowController, deviation)
+{
+  ShadowController shadow(ShadowController::Config(true, -1, std::chrono::microseconds(50)));
+  std::atomic<double> last_candidate{0.0};
+  shadow.set_candidate(
+    std::make_shared<GainLaw>(2.0),
+    [&last_candidate](double candidate_force, double) {
+      last_candidate = candidate_force;
+    });
+  shadow.start();
+  EXPECT_THROW(shadow.set_candidate(std::make_shared<GainLaw>(1.0)), std::logic_error);
+
+  const std::vector<double> state{1.0, 0.0, 3.14, 0.0};
+  const std::vector<double> reference{2.0, 0.0, 3.14, 0.0};
+  // the control thread does not allocate memory when submitting
+  apex_test_tools::memory_test::start();
+  shadow.submit(state, reference, 1.5);
+  apex_test_tools::memory_test::stop();
+  ASSERT_TRUE(wait_for_count(shadow, 1U));
+  shadow.submit(state, reference, 2.5);
+  ASSERT_TRUE(wait_for_count(shadow, 2U));
+  shadow.stop();
+
+  EXPECT_DOUBLE_EQ(last_candidate, 2.0);
+  const auto & deviation = shadow.get_deviation();
+  EXPECT_EQ(deviation.get_count(), 2U);
+  EXPECT_DOUBLE_EQ(deviation.get_mean(), 0.0);
+  EXPECT_DOUBLE_EQ(deviation.get_min(), -0.5);
+  EXPECT_DOUBLE_EQ(deviation.get_max(), 0.5);
+  EXPECT_EQ(shadow.get_compute_time().get_count(), 2U);
+  EXPECT_GE(shadow.get_compute_time().get_min(), 0.0);
+
+  shadow.reset_statistics();
+  EXPECT_EQ(shadow.get_deviation().get_count(), 0U);
+}
+
+TEST(TestShadowController, pinning)
+{
+  // the worker is pinned before it evaluates anything, a failure is reported by start
+  ShadowController shadow(ShadowController::Config(true, 1 << 20, std::chrono::microseconds(100)));
+  shadow.set_candidate(std::make_shared<GainLaw>(1.0));
+  EXPECT_THROW(shadow.start(), std::runtime_error);
+  shadow.submit({1.0, 0.0, 3.14, 0.0}, {2.0, 0.0, 3.14, 0.0}, 1.0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(shadow.get_deviation().get_count(), 0U);
+  // the candidate can be changed after a failed start
+  EXPECT_NO_THROW(shadow.set_candidate(std::make_shared<GainLaw>(2.0)));
+}
+
+TEST(TestShadowController, skips_old_inputs)
+{
+  ShadowController shadow(ShadowController::Config(true, -1, std::chrono::microseconds(100)));
+  shadow.set_candidate(std::make_shared<GainLaw>(1.0));
+  shadow.start();
+  const std::vector<double> reference{0.0, 0.0, 3.14, 0.0};
+  for (std::size_t i = 0U; i < 1000U; i++) {
+    shadow.submit({static_cast<double>(i), 0.0, 3.14, 0.0}, reference, 0.0);
+  }
+  ASSERT_TRUE(wait_for_count(shadow, 1000U));
+  shadow.stop();
+  // the latest inputs are always evaluated
+  EXPECT_DOUBLE_EQ(shadow.get_deviation().get_min(), -999.0);
+  EXPECT_EQ(shadow.get_deviation().get_count() + shadow.get_num_skipped(), 1000U);
+}
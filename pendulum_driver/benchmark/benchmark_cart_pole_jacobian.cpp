@@ -0,0 +1,82 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief Measures the cost of the analytic cart-pole Jacobians against forward finite
+///        differences, which need 5 extra evaluations of the dynamics.
+
+#include <chrono>
+#include <cstdio>
+
+#include "pendulum_driver/cart_pole_model.hpp"
+
+using pendulum::pendulum_driver::CartPoleParameters;
+using pendulum::pendulum_driver::cart_pole_derivative;
+using pendulum::pendulum_driver::cart_pole_jacobian;
+
+namespace
+{
+void finite_difference_jacobian(
+  const double * y, double u, const CartPoleParameters & p, double * A, double * B)
+{
+  const double h = 1e-7;
+  double f0[4], f[4], yp[4];
+  cart_pole_derivative(y, u, p, 0.0, f0);
+  for (std::size_t j = 0; j < 4U; j++) {
+    for (std::size_t k = 0; k < 4U; k++) {
+      yp[k] = y[k];
+    }
+    yp[j] += h;
+    cart_pole_derivative(yp, u, p, 0.0, f);
+    for (std::size_t i = 0; i < 4U; i++) {
+      A[i * 4U + j] = (f[i] - f0[i]) / h;
+    }
+  }
+  cart_pole_derivative(y, u + h, p, 0.0, f);
+  for (std::size_t i = 0; i < 4U; i++) {
+    B[i] = (f[i] - f0[i]) / h;
+  }
+}
+
+template<typename F>
+double measure_ns(F && jacobian, std::size_t iterations)
+{
+  const CartPoleParameters p{1.0, 5.0, 2.0, 20.0, -9.8};
+  double y[4] = {0.1, 0.2, M_PI + 0.1, -0.3};
+  double A[16], B[4];
+  double checksum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t k = 0; k < iterations; k++) {
+    // perturb the state so the calls cannot be hoisted out of the loop
+    y[2] += 1e-9;
+    jacobian(y, 1.0, p, A, B);
+    checksum += A[14] + B[3];
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+    std::chrono::steady_clock::now() - start;
+  std::printf("  (checksum %g)\n", checksum);
+  return elapsed.count() / static_cast<double>(iterations);
+}
+}  // namespace
+
+int main()
+{
+  const std::size_t iterations = 10000000U;
+  const double analytic = measure_ns(cart_pole_jacobian, iterations);
+  const double finite = measure_ns(finite_difference_jacobian, iterations);
+  std::printf("analytic jacobian:           %8.2f ns/call\n", analytic);
+  std::printf("finite difference jacobian:  %8.2f ns/call\n", finite);
+  std::printf("speedup:                     %8.2f x\n", finite / analytic);
+  return 0;
+}
@@ -0,0 +1,225 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides alternative fixed-cost integrators for the cart-pole model.
+
+#ifndef PENDULUM_DRIVER__CART_POLE_INTEGRATORS_HPP_
+#define PENDULUM_DRIVER__CART_POLE_INTEGRATORS_HPP_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "pendulum_driver/cart_pole_model.hpp"
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+/// \brief Solves the linear system J * x = b using Gaussian elimination with partial pivoting
+/// \param[in,out] J 4x4 row-major matrix, overwritten during the elimination
+/// \param[in,out] b Right hand side at input and solution at output
+/// \return False if the matrix is singular, b is not modified in that case
+inline bool solve_4x4(double * J, double * b)
+{
+  std::size_t perm[4] = {0U, 1U, 2U, 3U};
+  for (std::size_t col = 0; col < 4U; col++) {
+    std::size_t pivot = col;
+    for (std::size_t row = col + 1U; row < 4U; row++) {
+      if (std::fabs(J[perm[row] * 4U + col]) > std::fabs(J[perm[pivot] * 4U + col])) {
+        pivot = row;
+      }
+    }
+    const std::size_t tmp = perm[col];
+    perm[col] = perm[pivot];
+    perm[pivot] = tmp;
+    const double diag = J[perm[col] * 4U + col];
+    if (diag == 0.0 || !std::isfinite(diag)) {
+      return false;
+    }
+    for (std::size_t row = col + 1U; row < 4U; row++) {
+      const double factor = J[perm[row] * 4U + col] / diag;
+      for (std::size_t k = col; k < 4U; k++) {
+        J[perm[row] * 4U + k] -= factor * J[perm[col] * 4U + k];
+      }
+      b[perm[row]] -= factor * b[perm[col]];
+    }
+  }
+  double x[4];
+  for (std::size_t i = 4U; i-- > 0U; ) {
+    double sum = b[perm[i]];
+    for (std::size_t k = i + 1U; k < 4U; k++) {
+      sum -= J[perm[i] * 4U + k] * x[k];
+    }
+    x[i] = sum / J[perm[i] * 4U + i];
+  }
+  for (std::size_t i = 0; i < 4U; i++) {
+    b[i] = x[i];
+  }
+  return true;
+}
+
+/// \brief Integrates the cart-pole model one step using 4th order Runge-Kutta with a noise
+///        sample per stage, as the ODE solver of the PendulumDriver evaluates it
+/// \param[in,out] y State array with the current state at input and next state at output
+/// \param[in] u Force applied to the cart in Newton, constant during the step
+/// \param[in] p Model parameters
+/// \param[in] h Time step in seconds
+/// \param[in] pole_noise Noise added to the pole angular acceleration in each of the 4 stages
+inline void cart_pole_rk4_step(
+  double * y, double u, const CartPoleParameters & p, double h,
+  const std::array<double, 4> & pole_noise)
+{
+  double k1[4], k2[4], k3[4], k4[4], s[4];
+  cart_pole_derivative(y, u, p, pole_noise[0], k1);
+  for (std::size_t i = 0; i < 4U; i++) {
+    s[i] = y[i] + h * 0.5 * k1[i];
+  }
+  cart_pole_derivative(s, u, p, pole_noise[1], k2);
+  for (std::size_t i = 0; i < 4U; i++) {
+    s[i] = y[i] + h * 0.5 * k2[i];
+  }
+  cart_pole_derivative(s, u, p, pole_noise[2], k3);
+  for (std::size_t i = 0; i < 4U; i++) {
+    s[i] = y[i] + h * k3[i];
+  }
+  cart_pole_derivative(s, u, p, pole_noise[3], k4);
+  for (std::size_t i = 0; i < 4U; i++) {
+    y[i] = y[i] + (h / 6.0) * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+  }
+}
+
+/// \brief Integrates the cart-pole model one step using the implicit theta method
+///
+///  Solves y' = y + h * ((1 - theta) * f(y) + theta * f(y')) with a fixed number of Newton
+///  iterations using the analytic Jacobians, so the cost per step is bounded. theta = 1 is the
+///  backward Euler method (L-stable, first order) and theta = 0.5 is the trapezoidal rule
+///  (A-stable, second order).
+/// \param[in,out] y State array with the current state at input and next state at output
+/// \param[in] u Force applied to the cart in Newton, constant during the step
+/// \param[in] p Model parameters
+/// \param[in] h Time step in seconds
+/// \param[in] theta Implicitness of the method, in (0, 1]
+/// \param[in] newton_iterations Number of Newton iterations
+/// \param[in] pole_noise Noise added to the pole angular acceleration, constant during the step
+inline void cart_pole_theta_step(
+  double * y, double u, const CartPoleParameters & p, double h, double theta,
+  std::size_t newton_iterations, double pole_noise = 0.0)
+{
+  double f[4], base[4], z[4], J[16], B[4], residual[4];
+  cart_pole_derivative(y, u, p, pole_noise, f);
+  for (std::size_t i = 0; i < 4U; i++) {
+    base[i] = y[i] + h * (1.0 - theta) * f[i];
+    z[i] = y[i];
+  }
+  for (std::size_t it = 0; it < newton_iterations; it++) {
+    cart_pole_derivative(z, u, p, pole_noise, f);
+    cart_pole_jacobian(z, u, p, J, B);
+    for (std::size_t i = 0; i < 4U; i++) {
+      residual[i] = -(z[i] - base[i] - h * theta * f[i]);
+      for (std::size_t k = 0; k < 4U; k++) {
+        J[i * 4U + k] = ((i == k) ? 1.0 : 0.0) - h * theta * J[i * 4U + k];
+      }
+    }
+    if (!solve_4x4(J, residual)) {
+      break;
+    }
+    for (std::size_t i = 0; i < 4U; i++) {
+      z[i] += residual[i];
+    }
+  }
+  for (std::size_t i = 0; i < 4U; i++) {
+    y[i] = z[i];
+  }
+}
+
+/// \brief Integrates the cart-pole model one step using a variational midpoint integrator
+///
+///  The step is derived from the midpoint discrete Lagrangian
+///  Ld(q0, q1) = h * L((q0 + q1) / 2, (q1 - q0) / h), with the cart force and the damping added
+///  through the discrete Lagrange-d'Alembert principle. The resulting map is symplectic for the
+///  conservative part of the dynamics, so without damping the energy error stays bounded
+///  instead of drifting, even with large steps. The implicit equation for the next
+///  configuration is solved with a fixed number of Newton iterations on a 2x2 system.
+/// \param[in,out] y State array with the current state at input and next state at output
+/// \param[in] u Force applied to the cart in Newton, constant during the step
+/// \param[in] p Model parameters
+/// \param[in] h Time step in seconds
+/// \param[in] newton_iterations Number of Newton iterations
+/// \param[in] pole_noise Noise added to the pole angular acceleration, applied as the
+///                       equivalent torque m * L^2 * pole_noise
+inline void cart_pole_variational_step(
+  double * y, double u, const CartPoleParameters & p, double h,
+  std::size_t newton_iterations, double pole_noise = 0.0)
+{
+  const double m = p.pendulum_mass;
+  const double M = p.cart_mass;
+  const double L = p.pendulum_length;
+  const double d = p.damping_coefficient;
+  const double g = p.gravity;
+  const double torque = m * L * L * pole_noise;
+
+  // continuous Legendre transform at the initial configuration
+  const double C0 = std::cos(y[2]);
+  const double p0_x = (M + m) * y[1] + m * L * y[3] * C0;
+  const double p0_th = m * L * y[1] * C0 + m * L * L * y[3];
+
+  // explicit Euler guess for the next configuration
+  double x1 = y[0] + h * y[1];
+  double th1 = y[2] + h * y[3];
+  double vx = 0.0, vth = 0.0, S = 0.0, C = 0.0;
+  auto midpoint = [&]() {
+      vx = (x1 - y[0]) / h;
+      vth = (th1 - y[2]) / h;
+      S = std::sin(0.5 * (y[2] + th1));
+      C = std::cos(0.5 * (y[2] + th1));
+    };
+
+  for (std::size_t it = 0; it < newton_iterations; it++) {
+    midpoint();
+    // p0 = -D1 Ld(q0, q1) - fd-(q0, q1)
+    const double r_x = (M + m) * vx + m * L * vth * C - 0.5 * h * (u - d * vx) - p0_x;
+    const double r_th = m * L * vx * C + m * L * L * vth -
+      0.5 * h * (-m * L * vx * vth * S + m * g * L * S + torque) - p0_th;
+    const double j_xx = (M + m) / h + 0.5 * d;
+    const double j_xth = m * L * C / h - 0.5 * m * L * vth * S;
+    const double j_thx = m * L * C / h + 0.5 * m * L * vth * S;
+    const double j_thth = m * L * L / h + 0.25 * h * m * L * C * (vx * vth - g);
+    const double det = j_xx * j_thth - j_xth * j_thx;
+    if (det == 0.0 || !std::isfinite(det)) {
+      break;
+    }
+    x1 -= (j_thth * r_x - j_xth * r_th) / det;
+    th1 -= (j_xx * r_th - j_thx * r_x) / det;
+  }
+  midpoint();
+
+  // p1 = D2 Ld(q0, q1) + fd+(q0, q1)
+  const double p1_x = (M + m) * vx + m * L * vth * C + 0.5 * h * (u - d * vx);
+  const double p1_th = m * L * vx * C + m * L * L * vth +
+    0.5 * h * (-m * L * vx * vth * S + m * g * L * S + torque);
+
+  // inverse continuous Legendre transform at the final configuration
+  const double C1 = std::cos(th1);
+  const double mass_det = m * L * L * (M + m * (1.0 - C1 * C1));
+  y[0] = x1;
+  y[1] = (m * L * L * p1_x - m * L * C1 * p1_th) / mass_det;
+  y[2] = th1;
+  y[3] = ((M + m) * p1_th - m * L * C1 * p1_x) / mass_det;
+}
+}  // namespace pendulum_driver
+}  // namespace pendulum
+
+#endif  // PENDULUM_DRIVER__CART_POLE_INTEGRATORS_HPP_
@@ -0,0 +1,224 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the equations of motion of the inverted pendulum on a cart.
+///
+///  The functions work on plain arrays and do not allocate memory so they can be used both by
+///  the PendulumDriver and by batched simulations.
+
+#ifndef PENDULUM_DRIVER__CART_POLE_MODEL_HPP_
+#define PENDULUM_DRIVER__CART_POLE_MODEL_HPP_
+
+#include <cmath>
+#include <cstddef>
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+/// Physical parameters of the cart-pole model.
+struct CartPoleParameters
+{
+  // pendulum mass in kg
+  double pendulum_mass;
+  // cart mass in kg
+  double cart_mass;
+  // pendulum length in m
+  double pendulum_length;
+  // cart damping coefficient
+  double damping_coefficient;
+  // gravity in m/s^2
+  double gravity;
+};
+
+/// \brief Computes the cart acceleration
+/// \param[in] y State array: cart position, cart velocity, pole angle, pole velocity
+/// \param[in] u Force applied to the cart in Newton
+/// \param[in] p Model parameters
+/// \return Cart acceleration in m/s^2
+inline double cart_acceleration(const double * y, double u, const CartPoleParameters & p)
+{
+  const double m = p.pendulum_mass;
+  const double M = p.cart_mass;
+  const double L = p.pendulum_length;
+  const double d = p.damping_coefficient;
+  const double g = p.gravity;
+  const double Sy = std::sin(y[2]);
+  const double Cy = std::cos(y[2]);
+  const double D = m * L * L * (M + m * (1 - Cy * Cy));
+  return (1 / D) *
+         (-m * m * L * L * g * Cy * Sy + m * L * L * (m * L * y[3] * y[3] * Sy - d * y[1])) +
+         m * L * L * (1 / D) * u;
+}
+
+/// \brief Computes the pole angular acceleration
+/// \param[in] y State array: cart position, cart velocity, pole angle, pole velocity
+/// \param[in] u Force applied to the cart in Newton
+/// \param[in] p Model parameters
+/// \return Pole angular acceleration in rad/s^2
+inline double pole_acceleration(const double * y, double u, const CartPoleParameters & p)
+{
+  const double m = p.pendulum_mass;
+  const double M = p.cart_mass;
+  const double L = p.pendulum_length;
+  const double d = p.damping_coefficient;
+  const double g = p.gravity;
+  const double Sy = std::sin(y[2]);
+  const double Cy = std::cos(y[2]);
+  const double D = m * L * L * (M + m * (1 - Cy * Cy));
+  return (1 / D) * ((m + M) * m * g * L * Sy - m * L * Cy * (m * L * y[3] * y[3] * Sy -
+         d * y[1])) - m * L * Cy * (1 / D) * u;
+}
+
+/// \brief Computes the full state derivative sharing the trigonometric terms
+/// \param[in] y State array: cart position, cart velocity, pole angle, pole velocity
+/// \param[in] u Force applied to the cart in Newton
+/// \param[in] p Model parameters
+/// \param[in] pole_noise Noise added to the pole angular acceleration
+/// \param[out] dy State derivative
+inline void cart_pole_derivative(
+  const double * y, double u, const CartPoleParameters & p,
+  double pole_noise, double * dy)
+{
+  const double m = p.pendulum_mass;
+  const double M = p.cart_mass;
+  const double L = p.pendulum_length;
+  const double d = p.damping_coefficient;
+  const double g = p.gravity;
+  const double Sy = std::sin(y[2]);
+  const double Cy = std::cos(y[2]);
+  const double D = m * L * L * (M + m * (1 - Cy * Cy));
+  const double inertial = m * L * y[3] * y[3] * Sy - d * y[1];
+  dy[0] = y[1];
+  dy[1] = (1 / D) * (-m * m * L * L * g * Cy * Sy + m * L * L * inertial) + m * L * L * (1 / D) * u;
+  dy[2] = y[3];
+  dy[3] = (1 / D) * ((m + M) * m * g * L * Sy - m * L * Cy * inertial) - m * L * Cy * (1 / D) * u +
+    pole_noise;
+}
+
+/// \brief Computes the total mechanical energy of the cart-pole
+///
+///  The equations of motion derive from the Lagrangian
+///  T - V with T = (M + m) * v^2 / 2 + m * L * v * w * cos(theta) + m * L^2 * w^2 / 2 and
+///  V = m * g * L * cos(theta), damping and the cart force act as external forces.
+/// \param[in] y State array: cart position, cart velocity, pole angle, pole velocity
+/// \param[in] p Model parameters
+/// \return Kinetic plus potential energy in Joule
+inline double cart_pole_energy(const double * y, const CartPoleParameters & p)
+{
+  const double m = p.pendulum_mass;
+  const double M = p.cart_mass;
+  const double L = p.pendulum_length;
+  const double C = std::cos(y[2]);
+  const double kinetic = 0.5 * (M + m) * y[1] * y[1] + m * L * y[1] * y[3] * C +
+    0.5 * m * L * L * y[3] * y[3];
+  return kinetic + m * p.gravity * L * C;
+}
+
+/// \brief Computes the analytic Jacobians of the state derivative
+///
+///  The equations of motion are rewritten as
+///  dv/dt = N1 / E and dw/dt = N2 / (L * E) with E = M + m * sin^2(theta),
+///  N1 = u - d * v + m * L * w^2 * sin(theta) - m * g * sin(theta) * cos(theta) and
+///  N2 = (m + M) * g * sin(theta) - cos(theta) * (u - d * v + m * L * w^2 * sin(theta)),
+///  which are differentiated by hand. The noise term does not depend on the state or the input.
+/// \param[in] y State array: cart position, cart velocity, pole angle, pole velocity
+/// \param[in] u Force applied to the cart in Newton
+/// \param[in] p Model parameters
+/// \param[out] A Jacobian with respect to the state, 4x4 row-major
+/// \param[out] B Jacobian with respect to the input, 4 elements
+inline void cart_pole_jacobian(
+  const double * y, double u, const CartPoleParameters & p,
+  double * A, double * B)
+{
+  const double m = p.pendulum_mass;
+  const double M = p.cart_mass;
+  const double L = p.pendulum_length;
+  const double d = p.damping_coefficient;
+  const double g = p.gravity;
+  const double v = y[1];
+  const double w = y[3];
+  const double S = std::sin(y[2]);
+  const double C = std::cos(y[2]);
+
+  const double E = M + m * S * S;
+  const double inv_E = 1.0 / E;
+  const double dE = 2.0 * m * S * C;
+  // force terms shared by both accelerations
+  const double P = u - d * v + m * L * w * w * S;
+  const double dP = m * L * w * w * C;
+  const double N1 = P - m * g * S * C;
+  const double dN1 = dP - m * g * (C * C - S * S);
+  const double N2 = (m + M) * g * S - C * P;
+  const double dN2 = (m + M) * g * C + S * P - C * dP;
+
+  A[0] = 0.0;
+  A[1] = 1.0;
+  A[2] = 0.0;
+  A[3] = 0.0;
+
+  A[4] = 0.0;
+  A[5] = -d * inv_E;
+  A[6] = (dN1 * E - N1 * dE) * inv_E * inv_E;
+  A[7] = 2.0 * m * L * w * S * inv_E;
+
+  A[8] = 0.0;
+  A[9] = 0.0;
+  A[10] = 0.0;
+  A[11] = 1.0;
+
+  A[12] = 0.0;
+  A[13] = d * C * inv_E / L;
+  A[14] = (dN2 * E - N2 * dE) * inv_E * inv_E / L;
+  A[15] = -2.0 * m * w * S * C * inv_E;
+
+  B[0] = 0.0;
+  B[1] = inv_E;
+  B[2] = 0.0;
+  B[3] = -C * inv_E / L;
+}
+
+/// \brief Integrates the cart-pole model one step using 4th order Runge-Kutta
+/// \param[in,out] y State array with the current state at input and next state at output
+/// \param[in] u Force applied to the cart in Newton, constant during the step
+/// \param[in] p Model parameters
+/// \param[in] h Time step in seconds
+/// \param[in] pole_noise Noise added to the pole angular acceleration, constant during the step
+inline void cart_pole_rk4_step(
+  double * y, double u, const CartPoleParameters & p, double h,
+  double pole_noise = 0.0)
+{
+  double k1[4], k2[4], k3[4], k4[4], s[4];
+  cart_pole_derivative(y, u, p, pole_noise, k1);
+  for (std::size_t i = 0; i < 4U; i++) {
+    s[i] = y[i] + h * 0.5 * k1[i];
+  }
+  cart_pole_derivative(s, u, p, pole_noise, k2);
+  for (std::size_t i = 0; i < 4U; i++) {
+    s[i] = y[i] + h * 0.5 * k2[i];
+  }
+  cart_pole_derivative(s, u, p, pole_noise, k3);
+  for (std::size_t i = 0; i < 4U; i++) {
+    s[i] = y[i] + h * k3[i];
+  }
+  cart_pole_derivative(s, u, p, pole_noise, k4);
+  for (std::size_t i = 0; i < 4U; i++) {
+    y[i] = y[i] + (h / 6.0) * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+  }
+}
+}  // namespace pendulum_driver
+}  // namespace pendulum
+
+#endif  // PENDULUM_DRIVER__CART_POLE_MODEL_HPP_
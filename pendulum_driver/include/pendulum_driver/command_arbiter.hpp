@@ -0,0 +1,131 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the selection of the command source of a hot-standby controller.
+
+#ifndef PENDULUM_DRIVER__COMMAND_ARBITER_HPP_
+#define PENDULUM_DRIVER__COMMAND_ARBITER_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "pendulum_driver/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+/// \class This class selects the command source between a primary and a standby controller.
+///
+///  Both controllers compute a command for every state message. The commands of the active
+///  source are applied as they arrive and the ones of the other source are kept as a backup.
+///  Every control period, before a new state is published, the arbiter checks when the active
+///  source sent its last command. A single late or skipped command is only counted as missed:
+///  the source fails when it is silent for longer than the timeout. If the other source sent a
+///  command within the timeout, it becomes active and its last command is applied in the same
+///  cycle. The switchover latency is the time from the last command of the failed source to the
+///  switch.
+class PENDULUM_DRIVER_PUBLIC CommandArbiter
+{
+public:
+  enum Source : std::size_t
+  {
+    PRIMARY = 0U,
+    STANDBY = 1U
+  };
+  static constexpr std::size_t NUM_SOURCES = 2U;
+
+  class PENDULUM_DRIVER_PUBLIC Config
+  {
+public:
+    /// \brief Constructor
+    /// \param[in] timeout silence after which a source is failed, longer than the control
+    ///            period and than the maximum silence of an event-triggered controller
+    /// \throw std::invalid_argument If the timeout is not positive
+    explicit Config(std::chrono::microseconds timeout);
+
+    /// \brief Gets the silence after which a source is failed
+    /// \return Timeout
+    std::chrono::nanoseconds get_timeout() const;
+
+private:
+    std::chrono::nanoseconds timeout;
+  };
+
+  /// \brief Constructor
+  /// \param[in] config Failover configuration
+  explicit CommandArbiter(const Config & config);
+
+  /// \brief Resets the arbiter, the primary source becomes active
+  void reset();
+
+  /// \brief Registers a command received from a source
+  /// \param[in] source Controller which sent the command
+  /// \param[in] force Force command in Newton
+  /// \param[in] now Reception time
+  /// \return True if the source is active and the command must be applied
+  bool on_command(Source source, double force, std::chrono::steady_clock::time_point now);
+
+  /// \brief Checks the active source at the end of a control period
+  /// \param[in] now Current time
+  /// \return True if the active source changed, the new command must be applied
+  bool on_cycle(std::chrono::steady_clock::time_point now);
+
+  /// \brief Gets the configuration
+  /// \return Configuration
+  const Config & get_config() const;
+
+  /// \brief Gets the active source
+  /// \return Active source
+  Source get_active_source() const;
+
+  /// \brief Gets the last command of the active source
+  /// \return Force command in Newton
+  double get_force_command() const;
+
+  /// \brief Gets the number of source switches
+  /// \return Number of switches
+  std::uint64_t get_num_switches() const;
+
+  /// \brief Gets the number of control periods without a command of the active source
+  /// \return Number of missed commands
+  std::uint64_t get_num_missed_commands() const;
+
+  /// \brief Gets the latency of the last switch
+  /// \return Switchover latency
+  std::chrono::nanoseconds get_last_switch_latency() const;
+
+  /// \brief Gets the maximum switchover latency
+  /// \return Switchover latency
+  std::chrono::nanoseconds get_max_switch_latency() const;
+
+private:
+  const Config cfg_;
+  Source active_;
+  std::array<double, NUM_SOURCES> force_;
+  std::array<bool, NUM_SOURCES> received_;
+  std::array<bool, NUM_SOURCES> has_command_;
+  std::array<std::chrono::steady_clock::time_point, NUM_SOURCES> last_command_time_;
+  std::uint64_t num_switches_;
+  std::uint64_t num_missed_commands_;
+  std::chrono::nanoseconds last_switch_latency_;
+  std::chrono::nanoseconds max_switch_latency_;
+};
+}  // namespace pendulum_driver
+}  // namespace pendulum
+
+#endif  // PENDULUM_DRIVER__COMMAND_ARBITER_HPP_
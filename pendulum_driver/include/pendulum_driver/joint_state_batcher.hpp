@@ -0,0 +1,89 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the packing and unpacking of batched pendulum state messages.
+
+#ifndef PENDULUM_DRIVER__JOINT_STATE_BATCHER_HPP_
+#define PENDULUM_DRIVER__JOINT_STATE_BATCHER_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "pendulum2_msgs/msg/joint_state_batch.hpp"
+
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_driver/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+/// \class This class accumulates consecutive state samples in a batch message.
+///
+///  The message has a fixed capacity and is allocated once, so adding samples does not allocate
+///  memory. A batch is complete every batch size samples and must then be published before the
+///  next sample is added.
+class PENDULUM_DRIVER_PUBLIC JointStateBatcher
+{
+public:
+  /// \brief Constructor
+  /// \param[in] batch_size number of samples per message
+  /// \throw std::invalid_argument If the batch size is 0 or larger than the message capacity
+  explicit JointStateBatcher(std::size_t batch_size);
+
+  /// \brief Adds a state sample to the batch
+  /// \param[in] state Pendulum state
+  /// \param[in] stamp_ns Time of the sample in nanoseconds
+  /// \return True if the batch is complete and the message must be published
+  bool add(const PendulumDriver::PendulumState & state, std::int64_t stamp_ns);
+
+  /// \brief Gets the batch message
+  /// \return Message with the samples added since the last complete batch
+  const pendulum2_msgs::msg::JointStateBatch & get_message() const;
+
+  /// \brief Discards the samples and restarts the sample index
+  void reset();
+
+  /// \brief Gets the number of samples per message
+  /// \return Batch size
+  std::size_t get_batch_size() const;
+
+private:
+  const std::size_t batch_size_;
+  std::uint64_t num_samples_;
+  pendulum2_msgs::msg::JointStateBatch message_;
+};
+
+/// \brief Calls a function for every sample of a batch message, in order
+/// \param[in] batch Batch message
+/// \param[in] callback Function called with the sample index and the sample
+/// \return Number of samples in the message
+template<typename Callback>
+std::size_t unpack_joint_state_batch(
+  const pendulum2_msgs::msg::JointStateBatch & batch, Callback && callback)
+{
+  // never trust the sample count of a received message
+  const std::size_t num_samples = std::min<std::size_t>(
+    batch.num_samples, pendulum2_msgs::msg::JointStateBatch::MAX_SAMPLES);
+  for (std::size_t i = 0U; i < num_samples; i++) {
+    callback(batch.first_sample_index + i, batch.samples[i]);
+  }
+  return num_samples;
+}
+}  // namespace pendulum_driver
+}  // namespace pendulum
+
+#endif  // PENDULUM_DRIVER__JOINT_STATE_BATCHER_HPP_
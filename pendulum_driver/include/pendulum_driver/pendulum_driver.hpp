@@ -22,10 +22,12 @@
 #include <chrono>
 #include <vector>
 #include <random>
+#include <string>
 
 #include "pendulum2_msgs/msg/joint_state.hpp"
 #include "pendulum2_msgs/msg/joint_command.hpp"
 
+#include "pendulum_driver/cart_pole_model.hpp"
 #include "pendulum_driver/runge_kutta.hpp"
 #include "pendulum_driver/visibility_control.hpp"
 
@@ -59,6 +61,22 @@ public:
     double cart_force = 0.0;
   };
 
+  /// Numerical method used to integrate the equations of motion.
+  enum class Integrator
+  {
+    /// explicit 4th order Runge-Kutta
+    RK4,
+    /// implicit backward Euler, for stiff configurations such as large damping coefficients
+    BACKWARD_EULER,
+    /// implicit trapezoidal rule, second order accurate and A-stable
+    TRAPEZOIDAL,
+    /// variational midpoint rule, symplectic with bounded energy error for long simulations
+    VARIATIONAL
+  };
+
+  /// Number of Newton iterations used by the implicit and variational integrators
+  static constexpr std::size_t IMPLICIT_NEWTON_ITERATIONS = 3U;
+
   class Config
   {
 public:
@@ -70,6 +88,7 @@ public:
     /// \param[in] gravity gravity
     /// \param[in] max_cart_force maximum cart force
     /// \param[in] physics_update_period physics simulation update period
+    /// \param[in] integrator numerical method used to integrate the equations of motion
     Config(
       double pendulum_mass,
       double cart_mass,
@@ -78,7 +97,8 @@ public:
       double gravity,
       double max_cart_force,
       double noise_level,
-      std::chrono::microseconds physics_update_period);
+      std::chrono::microseconds physics_update_period,
+      Integrator integrator = Integrator::RK4);
 
     /// \brief Gets the pendulum mass
     /// \return Pendulum mass in kilograms
@@ -112,6 +132,10 @@ public:
     /// \return physics simulation update period
     std::chrono::microseconds get_physics_update_period() const;
 
+    /// \brief Gets the numerical method used to integrate the equations of motion
+    /// \return integrator
+    Integrator get_integrator() const;
+
 private:
     /// pendulum mass in kg
     double pendulum_mass = 1.0;
@@ -129,6 +153,8 @@ private:
     double noise_level = 1.0;
     /// physics simulation update period
     std::chrono::microseconds physics_update_period;
+    /// numerical method used to integrate the equations of motion
+    Integrator integrator;
   };
 
   explicit PendulumDriver(const Config & config);
@@ -160,6 +186,10 @@ private:
   /// \return cart disturbance force in Newton.
   double get_disturbance_force() const;
 
+  /// \brief Gets the simulation configuration
+  /// \return Configuration
+  const Config & get_config() const;
+
   /// \brief Updates the driver simulation.
   void update();
 
@@ -171,6 +201,8 @@ private:
   const Config cfg_;
   double dt_;
   PendulumState state_;
+  // cart-pole model parameters taken from the configuration
+  const CartPoleParameters model_params_;
 
   RungeKutta ode_solver_;
   // state array for ODE solver
@@ -195,6 +227,12 @@ private:
   // pointer to the derivative motion functions (ODE)
   derivativeF derivative_function_;
 };
+
+/// \brief Converts an integrator name to its enumeration value
+/// \param[in] name One of "rk4", "backward_euler", "trapezoidal" or "variational"
+/// \return Integrator
+/// \throw std::invalid_argument If the name is not a known integrator
+PENDULUM_DRIVER_PUBLIC PendulumDriver::Integrator integrator_from_string(const std::string & name);
 }  // namespace pendulum_driver
 }  // namespace pendulum
 #endif  // PENDULUM_DRIVER__PENDULUM_DRIVER_HPP_
@@ -18,17 +18,30 @@
 #ifndef PENDULUM_DRIVER__PENDULUM_DRIVER_NODE_HPP_
 #define PENDULUM_DRIVER__PENDULUM_DRIVER_NODE_HPP_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 #include "lifecycle_msgs/msg/transition_event.hpp"
+#include "sensor_msgs/msg/joint_state.hpp"
 #include "rclcpp/strategies/message_pool_memory_strategy.hpp"
 #include "rclcpp/strategies/allocator_memory_strategy.hpp"
 
+#include "pendulum_driver/command_arbiter.hpp"
+#include "pendulum_driver/joint_state_batcher.hpp"
 #include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_driver/state_bridge.hpp"
 #include "pendulum_driver/visibility_control.hpp"
+#include "pendulum_utils/load_shedder.hpp"
+#include "pendulum_utils/instrumentation_log.hpp"
+#include "pendulum_utils/perf_counters.hpp"
+#include "pendulum_utils/persistent_state.hpp"
+#include "pendulum_utils/pre_serialized_message.hpp"
+#include "pendulum_utils/thread_time_accounting.hpp"
+#include "pendulum_utils/trace_marker.hpp"
+#include "pendulum_utils/tsc_clock.hpp"
 
 namespace pendulum
 {
@@ -52,24 +65,57 @@ public:
     const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
 
 private:
+  /// Driver state mirrored in shared memory to resume after a restart
+  struct DriverSnapshot
+  {
+    // steady clock time of the store in nanoseconds
+    std::int64_t time_ns;
+    std::uint64_t num_cycles;
+    double state[PendulumDriver::STATE_DIM];
+    double controller_force;
+    double disturbance_force;
+    // physical and simulation parameters, a snapshot of another configuration is not restored
+    double pendulum_mass;
+    double cart_mass;
+    double pendulum_length;
+    double damping_coefficient;
+    double gravity;
+    double max_cart_force;
+    std::int32_t integrator;
+    double noise_level;
+  };
+
   /// \brief Initialize state message
   void init_state_message();
 
   /// \brief Create command subscription
   void create_command_subscription();
 
+  /// \brief Create standby controller command subscription
+  void create_standby_command_subscription();
+
   /// \brief Create disturbance subscription
   void create_disturbance_subscription();
 
   /// \brief Create state publisher
   void create_state_publisher();
 
+  /// \brief Create batched state publisher
+  void create_batch_publisher();
+
   /// \brief Create timer callback
   void create_state_timer_callback();
 
   /// \brief Log pendulum driver state
   void log_driver_state();
 
+  /// \brief Stores the driver state in the persistence segment
+  void store_driver_state();
+
+  /// \brief Restores the driver state from the persistence segment if it is recent enough
+  /// \return True if the state was restored
+  bool restore_driver_state();
+
   /// \brief Transition callback for state configuring
   /// \param[in] lifecycle node state
   rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
@@ -97,6 +143,7 @@ private:
 
   const std::string state_topic_name_;
   const std::string command_topic_name_;
+  const std::string standby_command_topic_name_;
   const std::string disturbance_topic_name_;
   const std::string cart_base_joint_name_;
   const std::string pole_joint_name_;
@@ -105,18 +152,64 @@ private:
   const std::string topic_stats_topic_name_;
   std::chrono::milliseconds topic_stats_publish_period_;
   std::chrono::milliseconds deadline_duration_;
+  bool enable_failover_;
+  bool enable_pre_serialization_;
+  bool enable_persistence_;
+  const std::string persistence_segment_name_;
+  std::chrono::milliseconds persistence_max_age_;
+  bool enable_batch_;
+  const std::string batch_topic_name_;
+  bool enable_perf_counters_;
+  bool enable_thread_time_accounting_;
+  bool enable_trace_marker_;
   PendulumDriver driver_;
+  CommandArbiter command_arbiter_;
+  // sheds the statistics, instrumentation and tool outputs when the state cycle runs out of
+  // headroom, configured again from its parameters in every configuration
+  utils::LoadShedder load_shedder_;
+  // republishes the state in the bridge domain, null if the bridge is disabled
+  std::unique_ptr<StateBridge> state_bridge_;
+  // accumulates every physics sample for the batched state messages
+  JointStateBatcher batcher_;
+  std::unique_ptr<utils::PersistentState<DriverSnapshot>> persistent_state_;
+  // counters of the thread which activated the node, null if they are disabled
+  std::unique_ptr<utils::PerfCounters> perf_counters_;
+  std::unique_ptr<utils::PerfSection> perf_update_;
+  std::unique_ptr<utils::PerfSection> perf_publish_;
+  // CPU time versus wall time of the real-time callbacks
+  utils::ThreadTimeAccounting state_timer_time_;
+  utils::ThreadTimeAccounting command_time_;
+  utils::ThreadTimeAccounting standby_command_time_;
+  // cycle events in the kernel trace, null if disabled
+  std::unique_ptr<utils::TraceMarker> trace_marker_;
+  std::uint64_t num_cycles_;
 
   std::shared_ptr<rclcpp::Subscription<pendulum2_msgs::msg::JointCommand>> command_sub_;
+  std::shared_ptr<rclcpp::Subscription<pendulum2_msgs::msg::JointCommand>> standby_command_sub_;
   std::shared_ptr<rclcpp::Subscription<pendulum2_msgs::msg::JointCommand>> disturbance_sub_;
   std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<pendulum2_msgs::msg::JointState>> state_pub_;
+  std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<pendulum2_msgs::msg::JointStateBatch>>
+  batch_pub_;
 
   rclcpp::TimerBase::SharedPtr state_timer_;
   rclcpp::TimerBase::SharedPtr update_driver_timer_;
   pendulum2_msgs::msg::JointState state_message_;
+  // state message serialized once and patched every cycle
+  utils::PreSerializedMessage<pendulum2_msgs::msg::JointState> serialized_state_message_;
 
   uint32_t num_missed_deadlines_pub_;
   uint32_t num_missed_deadlines_sub_;
+
+  // state publish time statistics since the last activation, in microseconds
+  std::uint64_t num_state_publish_;
+  double state_publish_time_sum_;
+  double state_publish_time_sum_sq_;
+  double state_publish_time_max_;
+
+  // the command subscription was created without topic statistics because of load shedding
+  bool topic_stats_shed_;
+  // the non-critical outputs of the current cycle are not shed
+  bool allow_non_critical_;
 };
 }  // namespace pendulum_driver
 }  // namespace pendulum
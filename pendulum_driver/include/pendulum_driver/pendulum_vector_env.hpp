@@ -0,0 +1,155 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides a batched simulation of many independent pendulums with a
+///        reinforcement learning environment interface.
+
+#ifndef PENDULUM_DRIVER__PENDULUM_VECTOR_ENV_HPP_
+#define PENDULUM_DRIVER__PENDULUM_VECTOR_ENV_HPP_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "pendulum_driver/cart_pole_model.hpp"
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_driver/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+/// \class This class simulates a batch of independent inverted pendulums.
+///
+///  The interface follows the usual vectorized environment convention: `step` takes one cart
+///  force per instance and fills the observation, reward and done buffers for all instances.
+///  Instances which finish an episode are automatically reset in the same step, their last
+///  observation is kept in `get_final_observations`.
+///
+///  All the buffers are allocated in the constructor and are stored contiguously, the pointers
+///  returned by the getters are stable for the lifetime of the object and can be wrapped by
+///  external consumers without copies. Observations are stored as `num_envs x STATE_DIM`
+///  row-major arrays with the same state layout used by the PendulumDriver.
+///
+///  The instances are integrated with the integrator of the driver configuration and get the
+///  same pole acceleration noise as the PendulumDriver, drawn from a seeded generator per
+///  instance so the episodes are reproducible.
+class PENDULUM_DRIVER_PUBLIC PendulumVectorEnv
+{
+public:
+  static constexpr std::size_t STATE_DIM = PendulumDriver::STATE_DIM;
+
+  /// Environment configuration parameters.
+  struct Config
+  {
+    /// number of simulated pendulums
+    std::size_t num_envs = 1024U;
+    /// number of steps before an episode is truncated, 0 disables truncation
+    std::uint32_t max_episode_steps = 1000U;
+    /// pole angle deviation from the up position which terminates an episode in radians
+    double failure_angle = 0.5;
+    /// cart position which terminates an episode in meters
+    double failure_position = 5.0;
+    /// half-width of the uniform distribution of the initial state around the up position
+    std::array<double, STATE_DIM> initial_state_range{{0.1, 0.1, 0.1, 0.1}};
+    /// relative half-width of the uniform randomization of the pendulum mass
+    double pendulum_mass_randomization = 0.0;
+    /// relative half-width of the uniform randomization of the cart mass
+    double cart_mass_randomization = 0.0;
+    /// relative half-width of the uniform randomization of the pendulum length
+    double pendulum_length_randomization = 0.0;
+    /// relative half-width of the uniform randomization of the damping coefficient
+    double damping_coefficient_randomization = 0.0;
+    /// reward weight of the squared pole angle error
+    double angle_weight = 1.0;
+    /// reward weight of the squared cart position error
+    double position_weight = 0.01;
+    /// reward weight of the squared cart force
+    double force_weight = 1e-6;
+    /// seed of the random generators
+    std::uint64_t seed = 42U;
+  };
+
+  /// \brief Constructor
+  /// \param[in] driver_config Nominal pendulum configuration
+  /// \param[in] config Environment configuration
+  /// \throw std::invalid_argument If the configuration is not valid
+  PendulumVectorEnv(const PendulumDriver::Config & driver_config, const Config & config);
+
+  /// \brief Resets the selected instances
+  ///
+  ///  A reset samples a new initial state and, if enabled, new model parameters.
+  /// \param[in] mask Array of num_envs flags, only instances with a non-zero flag are reset.
+  ///                 If null all the instances are reset.
+  void reset(const std::uint8_t * mask = nullptr);
+
+  /// \brief Steps all the instances one physics update period
+  /// \param[in] actions Array of num_envs cart forces in Newton, clamped to max_cart_force
+  void step(const double * actions);
+
+  /// \brief Gets the number of simulated pendulums
+  std::size_t get_num_envs() const;
+
+  /// \brief Gets the observation buffer, num_envs x STATE_DIM row-major
+  const double * get_observations() const;
+
+  /// \brief Gets the observations before the automatic reset, num_envs x STATE_DIM row-major.
+  ///        Only the rows of instances with the done flag set are updated in a step.
+  const double * get_final_observations() const;
+
+  /// \brief Gets the rewards of the last step, num_envs elements
+  const double * get_rewards() const;
+
+  /// \brief Gets the done flags of the last step, num_envs elements
+  const std::uint8_t * get_dones() const;
+
+  /// \brief Gets the truncation flags of the last step, num_envs elements.
+  ///        An instance is truncated if its episode reached max_episode_steps.
+  const std::uint8_t * get_truncations() const;
+
+  /// \brief Gets the model parameters used by an instance
+  /// \param[in] index Instance index
+  /// \return Model parameters
+  const CartPoleParameters & get_parameters(std::size_t index) const;
+
+private:
+  /// \brief Returns a uniform random number in [-1, 1) from the instance generator
+  double uniform(std::size_t index);
+
+  /// \brief Returns a pole acceleration noise sample of the driver noise level
+  double noise(std::size_t index);
+
+  /// \brief Resets a single instance
+  void reset_instance(std::size_t index);
+
+  const PendulumDriver::Config driver_config_;
+  const Config cfg_;
+  const CartPoleParameters nominal_params_;
+  const double dt_;
+
+  std::vector<double> observations_;
+  std::vector<double> final_observations_;
+  std::vector<double> rewards_;
+  std::vector<std::uint8_t> dones_;
+  std::vector<std::uint8_t> truncations_;
+  std::vector<std::uint32_t> episode_steps_;
+  std::vector<CartPoleParameters> params_;
+  // one small generator per instance keeps the instances independent of the batch layout
+  std::vector<std::uint64_t> rand_state_;
+};
+}  // namespace pendulum_driver
+}  // namespace pendulum
+
+#endif  // PENDULUM_DRIVER__PENDULUM_VECTOR_ENV_HPP_
@@ -0,0 +1,136 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides a bridge republishing the pendulum state in another ROS domain.
+
+#ifndef PENDULUM_DRIVER__STATE_BRIDGE_HPP_
+#define PENDULUM_DRIVER__STATE_BRIDGE_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+#include "pendulum2_msgs/msg/joint_state.hpp"
+
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_driver/visibility_control.hpp"
+#include "pendulum_utils/latest_value_buffer.hpp"
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+/// \class This class republishes the pendulum state for visualization and tools.
+///
+///  Every subscriber of the real-time state topic adds work to the real-time publisher. The
+///  bridge keeps rviz, PlotJuggler and the command line tools away from it: the real-time thread
+///  only copies the state in a buffer, and a non real-time thread publishes the latest state at
+///  a lower rate from its own ROS context, in a separate ROS domain.
+class PENDULUM_DRIVER_PUBLIC StateBridge
+{
+public:
+  class PENDULUM_DRIVER_PUBLIC Config
+  {
+public:
+    /// \brief Constructor
+    /// \param[in] domain_id ROS domain of the republished state
+    /// \param[in] node_name name of the bridge node in the bridge domain
+    /// \param[in] topic_name topic of the republished state
+    /// \param[in] publish_period period of the republished state
+    Config(
+      std::size_t domain_id,
+      const std::string & node_name,
+      const std::string & topic_name,
+      std::chrono::microseconds publish_period);
+
+    /// \brief Gets the ROS domain of the republished state
+    /// \return Domain id
+    std::size_t get_domain_id() const;
+
+    /// \brief Gets the name of the bridge node
+    /// \return Node name
+    const std::string & get_node_name() const;
+
+    /// \brief Gets the topic of the republished state
+    /// \return Topic name
+    const std::string & get_topic_name() const;
+
+    /// \brief Gets the period of the republished state
+    /// \return Publish period
+    std::chrono::microseconds get_publish_period() const;
+
+private:
+    std::size_t domain_id;
+    std::string node_name;
+    std::string topic_name;
+    std::chrono::microseconds publish_period;
+  };
+
+  /// \brief Constructor, creates the bridge context, node and publisher
+  /// \param[in] config Bridge configuration
+  explicit StateBridge(const Config & config);
+
+  /// \brief Destructor, stops the bridge thread and shuts down the bridge context
+  ~StateBridge();
+
+  StateBridge(const StateBridge &) = delete;
+  StateBridge & operator=(const StateBridge &) = delete;
+
+  /// \brief Starts the bridge thread
+  void start();
+
+  /// \brief Stops the bridge thread
+  void stop();
+
+  /// \brief Passes a new state to the bridge, called from the real-time thread
+  /// \param[in] state Pendulum state
+  void write(const PendulumDriver::PendulumState & state) noexcept;
+
+  /// \brief Gets the number of republished states
+  /// \return Number of states
+  std::uint64_t get_num_published() const;
+
+  /// \brief Gets the number of states dropped because the bridge thread was reading
+  /// \return Number of states
+  std::uint64_t get_num_dropped() const;
+
+private:
+  /// \brief Bridge thread loop
+  void run();
+
+  const Config cfg_;
+  utils::LatestValueBuffer<PendulumDriver::PendulumState> buffer_;
+
+  std::shared_ptr<rclcpp::Context> context_;
+  std::shared_ptr<rclcpp::Node> node_;
+  std::shared_ptr<rclcpp::Publisher<pendulum2_msgs::msg::JointState>> state_pub_;
+  pendulum2_msgs::msg::JointState state_message_;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable stop_requested_cv_;
+  bool stop_requested_;
+  std::uint64_t num_published_;
+};
+}  // namespace pendulum_driver
+}  // namespace pendulum
+
+#endif  // PENDULUM_DRIVER__STATE_BRIDGE_HPP_
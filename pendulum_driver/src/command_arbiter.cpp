@@ -0,0 +1,127 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_driver/command_arbiter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+CommandArbiter::Config::Config(std::chrono::microseconds timeout)
+: timeout{timeout}
+{
+  if (timeout.count() <= 0) {
+    throw std::invalid_argument("failover timeout must be positive");
+  }
+}
+
+std::chrono::nanoseconds CommandArbiter::Config::get_timeout() const
+{
+  return timeout;
+}
+
+CommandArbiter::CommandArbiter(const Config & config)
+: cfg_(config)
+{
+  reset();
+}
+
+void CommandArbiter::reset()
+{
+  active_ = PRIMARY;
+  force_.fill(0.0);
+  received_.fill(false);
+  has_command_.fill(false);
+  last_command_time_.fill(std::chrono::steady_clock::time_point{});
+  num_switches_ = 0U;
+  num_missed_commands_ = 0U;
+  last_switch_latency_ = std::chrono::nanoseconds{0};
+  max_switch_latency_ = std::chrono::nanoseconds{0};
+}
+
+bool CommandArbiter::on_command(
+  Source source, double force, std::chrono::steady_clock::time_point now)
+{
+  force_[source] = force;
+  received_[source] = true;
+  has_command_[source] = true;
+  last_command_time_[source] = now;
+  return source == active_;
+}
+
+bool CommandArbiter::on_cycle(std::chrono::steady_clock::time_point now)
+{
+  const Source other = active_ == PRIMARY ? STANDBY : PRIMARY;
+  if (!received_[active_] && has_command_[active_]) {
+    num_missed_commands_++;
+  }
+  // a source which never sent a command is not considered failed, the controllers may start
+  // after the driver
+  const bool active_failed = has_command_[active_] &&
+    now - last_command_time_[active_] > cfg_.get_timeout();
+  const bool other_alive = has_command_[other] &&
+    now - last_command_time_[other] <= cfg_.get_timeout();
+  bool switched = false;
+  if (other_alive && (active_failed || !has_command_[active_])) {
+    if (active_failed) {
+      last_switch_latency_ = now - last_command_time_[active_];
+      max_switch_latency_ = std::max(max_switch_latency_, last_switch_latency_);
+    }
+    active_ = other;
+    num_switches_++;
+    switched = true;
+  }
+  received_.fill(false);
+  return switched;
+}
+
+const CommandArbiter::Config & CommandArbiter::get_config() const
+{
+  return cfg_;
+}
+
+CommandArbiter::Source CommandArbiter::get_active_source() const
+{
+  return active_;
+}
+
+double CommandArbiter::get_force_command() const
+{
+  return force_[active_];
+}
+
+std::uint64_t CommandArbiter::get_num_switches() const
+{
+  return num_switches_;
+}
+
+std::uint64_t CommandArbiter::get_num_missed_commands() const
+{
+  return num_missed_commands_;
+}
+
+std::chrono::nanoseconds CommandArbiter::get_last_switch_latency() const
+{
+  return last_switch_latency_;
+}
+
+std::chrono::nanoseconds CommandArbiter::get_max_switch_latency() const
+{
+  return max_switch_latency_;
+}
+}  // namespace pendulum_driver
+}  // namespace pendulum
@@ -0,0 +1,68 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_driver/joint_state_batcher.hpp"
+
+#include <stdexcept>
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+JointStateBatcher::JointStateBatcher(std::size_t batch_size)
+: batch_size_(batch_size)
+{
+  if (batch_size_ == 0U || batch_size_ > pendulum2_msgs::msg::JointStateBatch::MAX_SAMPLES) {
+    throw std::invalid_argument("batch size must be between 1 and the message capacity");
+  }
+  reset();
+}
+
+bool JointStateBatcher::add(const PendulumDriver::PendulumState & state, std::int64_t stamp_ns)
+{
+  // the previous batch was published, start a new one
+  if (message_.num_samples == batch_size_) {
+    message_.num_samples = 0U;
+    message_.first_sample_index = num_samples_;
+  }
+  auto & sample = message_.samples[message_.num_samples];
+  sample.stamp_ns = stamp_ns;
+  sample.cart_position = state.cart_position;
+  sample.cart_velocity = state.cart_velocity;
+  sample.cart_force = state.cart_force;
+  sample.pole_angle = state.pole_angle;
+  sample.pole_velocity = state.pole_velocity;
+  message_.num_samples++;
+  num_samples_++;
+  return message_.num_samples == batch_size_;
+}
+
+const pendulum2_msgs::msg::JointStateBatch & JointStateBatcher::get_message() const
+{
+  return message_;
+}
+
+void JointStateBatcher::reset()
+{
+  num_samples_ = 0U;
+  message_.num_samples = 0U;
+  message_.first_sample_index = 0U;
+}
+
+std::size_t JointStateBatcher::get_batch_size() const
+{
+  return batch_size_;
+}
+}  // namespace pendulum_driver
+}  // namespace pendulum
@@ -15,6 +15,7 @@
 #include "pendulum_driver/pendulum_driver.hpp"
 #include <vector>
 #include "rcppmath/clamp.hpp"
+#include "pendulum_driver/cart_pole_integrators.hpp"
 
 namespace pendulum
 {
@@ -22,6 +23,8 @@ namespace pendulum_driver
 {
 PendulumDriver::PendulumDriver(const Config & config)
 : cfg_(config),
+  model_params_{config.get_pendulum_mass(), config.get_cart_mass(),
+    config.get_pendulum_length(), config.get_damping_coefficient(), config.get_gravity()},
   ode_solver_(STATE_DIM),
   X_{0.0, 0.0, M_PI, 0.0},
   controller_force_{0.0},
@@ -38,28 +41,14 @@ PendulumDriver::PendulumDriver(const Config & config)
 
   derivative_function_ = [this](const std::vector<double> & y,
       double u, size_t i) -> double {
-      const double m = cfg_.get_pendulum_mass();
-      const double M = cfg_.get_cart_mass();
-      const double L = cfg_.get_pendulum_length();
-      const double d = cfg_.get_damping_coefficient();
-      const double g = cfg_.get_gravity();
       if (i == 0) {
         return y[1];
       } else if (i == 1) {
-        double Sy = sin(y[2]);
-        double Cy = cos(y[2]);
-        double D = m * L * L * (M + m * (1 - Cy * Cy));
-        return (1 / D) *
-               (-m * m * L * L * g * Cy * Sy + m * L * L * (m * L * y[3] * y[3] * Sy - d * y[1])) +
-               m * L * L * (1 / D) * u;
+        return cart_acceleration(y.data(), u, model_params_);
       } else if (i == 2) {
         return y[3];
       } else if (i == 3) {
-        double Sy = sin(y[2]);
-        double Cy = cos(y[2]);
-        double D = m * L * L * (M + m * (1 - Cy * Cy));
-        return (1 / D) * ((m + M) * m * g * L * Sy - m * L * Cy * (m * L * y[3] * y[3] * Sy -
-               d * y[1])) - m * L * Cy * (1 / D) * u + noise_gen_(rand_gen_);
+        return pole_acceleration(y.data(), u, model_params_) + noise_gen_(rand_gen_);
       } else {
         throw std::invalid_argument("received wrong index");
       }
@@ -77,6 +66,10 @@ void PendulumDriver::set_state(double cart_pos, double cart_vel, double pole_pos
   state_.cart_velocity = cart_vel;
   state_.pole_angle = pole_pos;
   state_.pole_velocity = pole_vel;
+  X_[0] = cart_pos;
+  X_[1] = cart_vel;
+  X_[2] = pole_pos;
+  X_[3] = pole_vel;
 }
 
 void PendulumDriver::set_disturbance_force(double force)
@@ -99,10 +92,35 @@ double PendulumDriver::get_disturbance_force() const
   return disturbance_force_;
 }
 
+const PendulumDriver::Config & PendulumDriver::get_config() const
+{
+  return cfg_;
+}
+
 void PendulumDriver::update()
 {
   double cart_force = disturbance_force_ + controller_force_;
-  ode_solver_.step(derivative_function_, X_, dt_, cart_force);
+  switch (cfg_.get_integrator()) {
+    case Integrator::BACKWARD_EULER:
+      cart_pole_theta_step(
+        X_.data(), cart_force, model_params_, dt_, 1.0,
+        IMPLICIT_NEWTON_ITERATIONS, noise_gen_(rand_gen_));
+      break;
+    case Integrator::TRAPEZOIDAL:
+      cart_pole_theta_step(
+        X_.data(), cart_force, model_params_, dt_, 0.5,
+        IMPLICIT_NEWTON_ITERATIONS, noise_gen_(rand_gen_));
+      break;
+    case Integrator::VARIATIONAL:
+      cart_pole_variational_step(
+        X_.data(), cart_force, model_params_, dt_,
+        IMPLICIT_NEWTON_ITERATIONS, noise_gen_(rand_gen_));
+      break;
+    case Integrator::RK4:
+    default:
+      ode_solver_.step(derivative_function_, X_, dt_, cart_force);
+      break;
+  }
 
   state_.cart_position = X_[0];
   state_.cart_velocity = X_[1];
@@ -117,7 +135,6 @@ void PendulumDriver::reset()
   set_state(0.0, 0.0, M_PI, 0.0);
   set_disturbance_force(0.0);
   set_controller_cart_force(0.0);
-  X_ = {0.0, 0.0, M_PI, 0.0};
 }
 
 }  // namespace pendulum_driver
@@ -14,6 +14,8 @@
 
 #include "pendulum_driver/pendulum_driver.hpp"
 #include <array>
+#include <stdexcept>
+#include <string>
 
 namespace pendulum
 {
@@ -28,7 +30,8 @@ PendulumDriver::Config::Config(
   const double gravity,
   const double max_cart_force,
   const double noise_level,
-  std::chrono::microseconds physics_update_period)
+  std::chrono::microseconds physics_update_period,
+  Integrator integrator)
 : pendulum_mass{pendulum_mass},
   cart_mass{cart_mass},
   pendulum_length{pendulum_length},
@@ -36,7 +39,8 @@ PendulumDriver::Config::Config(
   gravity{gravity},
   max_cart_force{max_cart_force},
   noise_level{noise_level},
-  physics_update_period{physics_update_period}
+  physics_update_period{physics_update_period},
+  integrator{integrator}
 {}
 
 double PendulumDriver::Config::get_pendulum_mass() const
@@ -79,5 +83,24 @@ std::chrono::microseconds PendulumDriver::Config::get_physics_update_period() co
   return physics_update_period;
 }
 
+PendulumDriver::Integrator PendulumDriver::Config::get_integrator() const
+{
+  return integrator;
+}
+
+PendulumDriver::Integrator integrator_from_string(const std::string & name)
+{
+  if (name == "rk4") {
+    return PendulumDriver::Integrator::RK4;
+  } else if (name == "backward_euler") {
+    return PendulumDriver::Integrator::BACKWARD_EULER;
+  } else if (name == "trapezoidal") {
+    return PendulumDriver::Integrator::TRAPEZOIDAL;
+  } else if (name == "variational") {
+    return PendulumDriver::Integrator::VARIATIONAL;
+  }
+  throw std::invalid_argument("unknown integrator: " + name);
+}
+
 }  // namespace pendulum_driver
 }  // namespace pendulum
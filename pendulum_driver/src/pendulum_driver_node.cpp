@@ -12,6 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <memory>
 
@@ -34,6 +39,8 @@ PendulumDriverNode::PendulumDriverNode(
 : LifecycleNode(node_name, options),
   state_topic_name_(declare_parameter<std::string>("state_topic_name", "pendulum_joint_states")),
   command_topic_name_(declare_parameter<std::string>("command_topic_name", "joint_command")),
+  standby_command_topic_name_(declare_parameter<std::string>(
+      "standby_command_topic_name", "joint_command_standby")),
   disturbance_topic_name_(declare_parameter<std::string>("disturbance_topic_name", "disturbance")),
   cart_base_joint_name_(declare_parameter<std::string>("cart_base_joint_name", "cart_base_joint")),
   pole_joint_name_(declare_parameter<std::string>("pole_joint_name", "pole_joint")),
@@ -45,6 +52,20 @@ PendulumDriverNode::PendulumDriverNode(
         declare_parameter<std::uint16_t>("topic_stats_publish_period_ms", 1000U)}},
   deadline_duration_{std::chrono::milliseconds{
         declare_parameter<std::uint16_t>("deadline_duration_ms", 0U)}},
+  enable_failover_(declare_parameter<bool>("enable_failover", false)),
+  enable_pre_serialization_(declare_parameter<bool>("enable_pre_serialization", false)),
+  enable_persistence_(declare_parameter<bool>("enable_persistence", false)),
+  persistence_segment_name_(declare_parameter<std::string>(
+      "persistence_segment_name",
+      utils::SharedMemorySegment::get_node_segment_name(get_fully_qualified_name()))),
+  persistence_max_age_{std::chrono::milliseconds{
+        declare_parameter<std::uint16_t>("persistence_max_age_ms", 1000U)}},
+  enable_batch_(declare_parameter<bool>("batch.enabled", false)),
+  batch_topic_name_(declare_parameter<std::string>(
+      "batch.topic_name", "pendulum_joint_state_batches")),
+  enable_perf_counters_(declare_parameter<bool>("enable_perf_counters", false)),
+  enable_thread_time_accounting_(declare_parameter<bool>("enable_thread_time_accounting", false)),
+  enable_trace_marker_(declare_parameter<bool>("enable_trace_marker", false)),
   driver_(
     PendulumDriver::Config(
       declare_parameter<double>("driver.pendulum_mass", 1.0),
@@ -54,15 +75,71 @@ PendulumDriverNode::PendulumDriverNode(
       declare_parameter<double>("driver.gravity", -9.8),
       declare_parameter<double>("driver.max_cart_force", 1000.0),
       declare_parameter<double>("driver.noise_level", 1.0),
-      std::chrono::microseconds {state_publish_period_}
+      std::chrono::microseconds {state_publish_period_},
+      integrator_from_string(declare_parameter<std::string>("driver.integrator", "rk4"))
     )
   ),
+  command_arbiter_(
+    CommandArbiter::Config(
+      std::chrono::microseconds {
+        declare_parameter<std::uint32_t>("failover_timeout_us", 3000U)})),
+  load_shedder_(
+    utils::LoadShedder::Config(
+      declare_parameter<bool>("load_shedding.enabled", false),
+      std::chrono::microseconds {state_publish_period_},
+      declare_parameter<double>("load_shedding.shed_threshold", 0.5),
+      declare_parameter<double>("load_shedding.restore_threshold", 0.25),
+      declare_parameter<std::uint16_t>("load_shedding.restore_cycles", 100U),
+      declare_parameter<std::uint16_t>("load_shedding.max_level", 4U)
+    )
+  ),
+  batcher_(declare_parameter<std::uint16_t>("batch.size", 10U)),
+  num_cycles_{0U},
   num_missed_deadlines_pub_{0U},
-  num_missed_deadlines_sub_{0U}
+  num_missed_deadlines_sub_{0U},
+  num_state_publish_{0U},
+  state_publish_time_sum_{0.0},
+  state_publish_time_sum_sq_{0.0},
+  state_publish_time_max_{0.0},
+  topic_stats_shed_{false},
+  allow_non_critical_{true}
 {
+  const bool enable_bridge = declare_parameter<bool>("bridge.enabled", false);
+  const StateBridge::Config bridge_config(
+    declare_parameter<std::uint16_t>("bridge.domain_id", 1U),
+    std::string(get_name()) + "_bridge",
+    state_topic_name_,
+    std::chrono::milliseconds {declare_parameter<std::uint16_t>("bridge.publish_period_ms", 40U)});
+  if (enable_bridge) {
+    state_bridge_ = std::make_unique<StateBridge>(bridge_config);
+  }
+  if (enable_persistence_) {
+    persistent_state_ =
+      std::make_unique<utils::PersistentState<DriverSnapshot>>(persistence_segment_name_);
+  }
+  // the clock is calibrated when first used, here instead of in the first cycle
+  if (utils::TscClock::is_tsc_enabled()) {
+    RCLCPP_INFO(
+      get_logger(), "Timestamps read from the time stamp counter at %.3f MHz",
+      1e-6 * utils::TscClock::get_tsc_frequency());
+  } else {
+    RCLCPP_INFO(get_logger(), "Timestamps read from steady_clock, no invariant time stamp counter");
+  }
+  if (enable_trace_marker_) {
+    trace_marker_ = std::make_unique<utils::TraceMarker>(get_fully_qualified_name());
+    if (!trace_marker_->is_open()) {
+      RCLCPP_WARN(get_logger(), "Could not open the ftrace trace_marker, check tracefs access");
+    }
+  }
   init_state_message();
   create_state_publisher();
+  if (enable_batch_) {
+    create_batch_publisher();
+  }
   create_command_subscription();
+  if (enable_failover_) {
+    create_standby_command_subscription();
+  }
   create_disturbance_subscription();
   create_state_timer_callback();
 }
@@ -90,6 +167,12 @@ void PendulumDriverNode::create_state_publisher()
     sensor_publisher_options);
 }
 
+void PendulumDriverNode::create_batch_publisher()
+{
+  batch_pub_ = this->create_publisher<pendulum2_msgs::msg::JointStateBatch>(
+    batch_topic_name_, rclcpp::QoS(10));
+}
+
 void PendulumDriverNode::create_command_subscription()
 {
   // Pre-allocates message in a pool
@@ -104,13 +187,29 @@ void PendulumDriverNode::create_command_subscription()
     {
       num_missed_deadlines_sub_++;
     };
-  if (enable_topic_stats_) {
+  if (enable_topic_stats_ && !topic_stats_shed_) {
     command_subscription_options.topic_stats_options.state = rclcpp::TopicStatisticsState::Enable;
     command_subscription_options.topic_stats_options.publish_topic = topic_stats_topic_name_;
     command_subscription_options.topic_stats_options.publish_period = topic_stats_publish_period_;
   }
   auto on_command_received = [this](pendulum2_msgs::msg::JointCommand::SharedPtr msg) {
-      driver_.set_controller_cart_force(msg->force);
+      // accounted in the cycles which are not shed by the state timer
+      const bool account_time = enable_thread_time_accounting_ && allow_non_critical_;
+      if (account_time) {
+        command_time_.begin();
+      }
+      if (trace_marker_) {
+        trace_marker_->write(utils::TraceMarker::RECEIVE, num_cycles_);
+      }
+      if (!enable_failover_ ||
+        command_arbiter_.on_command(
+          CommandArbiter::PRIMARY, msg->force, std::chrono::steady_clock::now()))
+      {
+        driver_.set_controller_cart_force(msg->force);
+      }
+      if (account_time) {
+        command_time_.end();
+      }
     };
   command_sub_ = this->create_subscription<pendulum2_msgs::msg::JointCommand>(
     command_topic_name_,
@@ -120,6 +219,35 @@ void PendulumDriverNode::create_command_subscription()
     command_msg_strategy);
 }
 
+void PendulumDriverNode::create_standby_command_subscription()
+{
+  // Pre-allocates message in a pool
+  using rclcpp::strategies::message_pool_memory_strategy::MessagePoolMemoryStrategy;
+  auto command_msg_strategy =
+    std::make_shared<MessagePoolMemoryStrategy<pendulum2_msgs::msg::JointCommand, 1>>();
+
+  auto on_command_received = [this](pendulum2_msgs::msg::JointCommand::SharedPtr msg) {
+      const bool account_time = enable_thread_time_accounting_ && allow_non_critical_;
+      if (account_time) {
+        standby_command_time_.begin();
+      }
+      if (command_arbiter_.on_command(
+          CommandArbiter::STANDBY, msg->force, std::chrono::steady_clock::now()))
+      {
+        driver_.set_controller_cart_force(msg->force);
+      }
+      if (account_time) {
+        standby_command_time_.end();
+      }
+    };
+  standby_command_sub_ = this->create_subscription<pendulum2_msgs::msg::JointCommand>(
+    standby_command_topic_name_,
+    rclcpp::QoS(10),
+    on_command_received,
+    rclcpp::SubscriptionOptions(),
+    command_msg_strategy);
+}
+
 void PendulumDriverNode::create_disturbance_subscription()
 {
   auto on_disturbance_received = [this](pendulum2_msgs::msg::JointCommand::SharedPtr msg) {
@@ -132,14 +260,79 @@ void PendulumDriverNode::create_disturbance_subscription()
 void PendulumDriverNode::create_state_timer_callback()
 {
   auto state_timer_callback = [this]() {
+      // the statistics, the instrumentation and the state copies for the tools are not needed to
+      // control the pendulum, they are decimated or skipped when the cycle is close to its budget
+      allow_non_critical_ = load_shedder_.allow();
+      const bool account_time = enable_thread_time_accounting_ && allow_non_critical_;
+      if (account_time) {
+        state_timer_time_.begin();
+      }
+      const std::uint64_t cycle = num_cycles_;
+      if (trace_marker_) {
+        trace_marker_->write(utils::TraceMarker::CYCLE_START, cycle);
+      }
+      const auto cycle_start = std::chrono::steady_clock::now();
+      // switch to the standby controller if the active one did not answer the last state
+      if (enable_failover_ && command_arbiter_.on_cycle(cycle_start)) {
+        driver_.set_controller_cart_force(command_arbiter_.get_force_command());
+      }
+      const bool measure_perf = perf_counters_ && allow_non_critical_;
+      if (measure_perf) {
+        perf_update_->begin();
+      }
       driver_.update();
+      if (measure_perf) {
+        perf_update_->end();
+      }
       const auto state = driver_.get_state();
       state_message_.cart_position = state.cart_position;
       state_message_.cart_velocity = state.cart_velocity;
       state_message_.cart_force = state.cart_force;
       state_message_.pole_angle = state.pole_angle;
       state_message_.pole_velocity = state.pole_velocity;
-      state_pub_->publish(state_message_);
+      if (trace_marker_) {
+        trace_marker_->write(utils::TraceMarker::PUBLISH, cycle);
+      }
+      const auto publish_start = allow_non_critical_ ?
+        utils::TscClock::now() : utils::TscClock::time_point{};
+      if (measure_perf) {
+        perf_publish_->begin();
+      }
+      if (enable_pre_serialization_) {
+        serialized_state_message_.update(state_message_);
+        state_pub_->publish(serialized_state_message_.get_serialized_message());
+      } else {
+        state_pub_->publish(state_message_);
+      }
+      if (measure_perf) {
+        perf_publish_->end();
+      }
+      if (allow_non_critical_) {
+        const double publish_time = std::chrono::duration<double, std::micro>(
+          utils::TscClock::now() - publish_start).count();
+        num_state_publish_++;
+        state_publish_time_sum_ += publish_time;
+        state_publish_time_sum_sq_ += publish_time * publish_time;
+        state_publish_time_max_ = std::max(state_publish_time_max_, publish_time);
+        if (state_bridge_) {
+          state_bridge_->write(state);
+        }
+        // the samples of a shed cycle are missing in the batch, the sample stamps show the gap
+        if (batch_pub_ && batcher_.add(state, this->get_clock()->now().nanoseconds())) {
+          batch_pub_->publish(batcher_.get_message());
+        }
+      }
+      num_cycles_++;
+      if (persistent_state_) {
+        store_driver_state();
+      }
+      load_shedder_.update(std::chrono::steady_clock::now() - cycle_start);
+      if (trace_marker_) {
+        trace_marker_->write(utils::TraceMarker::CYCLE_END, cycle);
+      }
+      if (account_time) {
+        state_timer_time_.end();
+      }
     };
   state_timer_ = this->create_wall_timer(state_publish_period_, state_timer_callback);
   // cancel immediately to prevent triggering it in this state
@@ -160,14 +353,157 @@ void PendulumDriverNode::log_driver_state()
   RCLCPP_INFO(get_logger(), "Disturbance force = %lf", disturbance_force);
   RCLCPP_INFO(get_logger(), "Publisher missed deadlines = %u", num_missed_deadlines_pub_);
   RCLCPP_INFO(get_logger(), "Subscription missed deadlines = %u", num_missed_deadlines_sub_);
+  if (num_state_publish_ > 0U) {
+    // the jitter of the publish time grows with the number of subscribers of the state topic
+    const double samples = static_cast<double>(num_state_publish_);
+    const double mean = state_publish_time_sum_ / samples;
+    const double variance = std::max(0.0, state_publish_time_sum_sq_ / samples - mean * mean);
+    RCLCPP_INFO(
+      get_logger(), "State publish time: mean = %lf us, stddev = %lf us, max = %lf us",
+      mean, std::sqrt(variance), state_publish_time_max_);
+  }
+  if (state_bridge_) {
+    RCLCPP_INFO(
+      get_logger(), "Bridge republished states = %" PRIu64 ", dropped = %" PRIu64,
+      static_cast<uint64_t>(state_bridge_->get_num_published()),
+      static_cast<uint64_t>(state_bridge_->get_num_dropped()));
+  }
+  if (load_shedder_.get_config().is_enabled()) {
+    RCLCPP_INFO(
+      get_logger(),
+      "Load shedding level = %zu, shed events = %" PRIu64 ", restore events = %" PRIu64,
+      load_shedder_.get_level(),
+      static_cast<uint64_t>(load_shedder_.get_num_shed_events()),
+      static_cast<uint64_t>(load_shedder_.get_num_restore_events()));
+    RCLCPP_INFO(
+      get_logger(), "Shed outputs = %" PRIu64 ", max cycle time = %lf us",
+      static_cast<uint64_t>(load_shedder_.get_num_skipped()),
+      std::chrono::duration<double, std::micro>(load_shedder_.get_max_cycle_time()).count());
+  }
+  if (enable_failover_) {
+    RCLCPP_INFO(
+      get_logger(), "Active controller = %s",
+      command_arbiter_.get_active_source() == CommandArbiter::PRIMARY ? "primary" : "standby");
+    RCLCPP_INFO(
+      get_logger(), "Controller switches = %" PRIu64 ", missed commands = %" PRIu64,
+      static_cast<uint64_t>(command_arbiter_.get_num_switches()),
+      static_cast<uint64_t>(command_arbiter_.get_num_missed_commands()));
+    RCLCPP_INFO(
+      get_logger(), "Switchover latency: last = %lf ms, max = %lf ms",
+      std::chrono::duration<double, std::milli>(
+        command_arbiter_.get_last_switch_latency()).count(),
+      std::chrono::duration<double, std::milli>(
+        command_arbiter_.get_max_switch_latency()).count());
+  }
+  if (perf_counters_) {
+    utils::log_perf_section(get_logger(), "Driver update", *perf_counters_, *perf_update_);
+    utils::log_perf_section(get_logger(), "State publish", *perf_counters_, *perf_publish_);
+  }
+  if (enable_thread_time_accounting_) {
+    utils::log_thread_time(get_logger(), "State timer", state_timer_time_);
+    utils::log_thread_time(get_logger(), "Command callback", command_time_);
+    if (enable_failover_) {
+      utils::log_thread_time(get_logger(), "Standby command callback", standby_command_time_);
+    }
+  }
+}
+
+void PendulumDriverNode::store_driver_state()
+{
+  const auto & state = driver_.get_state();
+  const auto & config = driver_.get_config();
+  DriverSnapshot snapshot;
+  snapshot.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  snapshot.num_cycles = num_cycles_;
+  snapshot.state[0] = state.cart_position;
+  snapshot.state[1] = state.cart_velocity;
+  snapshot.state[2] = state.pole_angle;
+  snapshot.state[3] = state.pole_velocity;
+  snapshot.controller_force = driver_.get_controller_cart_force();
+  snapshot.disturbance_force = driver_.get_disturbance_force();
+  snapshot.pendulum_mass = config.get_pendulum_mass();
+  snapshot.cart_mass = config.get_cart_mass();
+  snapshot.pendulum_length = config.get_pendulum_length();
+  snapshot.damping_coefficient = config.get_damping_coefficient();
+  snapshot.gravity = config.get_gravity();
+  snapshot.max_cart_force = config.get_max_cart_force();
+  snapshot.integrator = static_cast<std::int32_t>(config.get_integrator());
+  snapshot.noise_level = config.get_noise_level();
+  persistent_state_->store(snapshot);
+}
+
+bool PendulumDriverNode::restore_driver_state()
+{
+  DriverSnapshot snapshot;
+  if (!persistent_state_->load(snapshot)) {
+    return false;
+  }
+  const auto age = std::chrono::steady_clock::now().time_since_epoch() -
+    std::chrono::nanoseconds{snapshot.time_ns};
+  if (age > persistence_max_age_) {
+    RCLCPP_WARN(
+      get_logger(), "Persisted state is %lf ms old, starting from the initial state",
+      std::chrono::duration<double, std::milli>(age).count());
+    return false;
+  }
+  const auto & config = driver_.get_config();
+  if (snapshot.pendulum_mass != config.get_pendulum_mass() ||
+    snapshot.cart_mass != config.get_cart_mass() ||
+    snapshot.pendulum_length != config.get_pendulum_length() ||
+    snapshot.damping_coefficient != config.get_damping_coefficient() ||
+    snapshot.gravity != config.get_gravity() ||
+    snapshot.max_cart_force != config.get_max_cart_force() ||
+    snapshot.integrator != static_cast<std::int32_t>(config.get_integrator()) ||
+    snapshot.noise_level != config.get_noise_level())
+  {
+    RCLCPP_WARN(
+      get_logger(), "Persisted state has another configuration, starting from the initial state");
+    return false;
+  }
+  driver_.set_state(snapshot.state[0], snapshot.state[1], snapshot.state[2], snapshot.state[3]);
+  driver_.set_controller_cart_force(snapshot.controller_force);
+  driver_.set_disturbance_force(snapshot.disturbance_force);
+  num_cycles_ = snapshot.num_cycles;
+  RCLCPP_INFO(
+    get_logger(), "Resumed from persisted state at cycle %" PRIu64 ", %lf ms old",
+    static_cast<uint64_t>(num_cycles_),
+    std::chrono::duration<double, std::milli>(age).count());
+  return true;
 }
 
 rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 PendulumDriverNode::on_configure(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Configuring");
+  // topic statistics can not be toggled on a live subscription, they are shed or restored here
+  // depending on the shedding level at the end of the last activation
+  const bool shed_topic_stats = load_shedder_.get_level() > 0U;
+  if (enable_topic_stats_ && shed_topic_stats != topic_stats_shed_) {
+    topic_stats_shed_ = shed_topic_stats;
+    create_command_subscription();
+    RCLCPP_INFO(get_logger(), "Topic statistics %s", topic_stats_shed_ ? "shed" : "restored");
+  }
+  // the shedding parameters may have been changed while the node was unconfigured
+  try {
+    load_shedder_ = utils::LoadShedder(
+      utils::LoadShedder::Config(
+        get_parameter("load_shedding.enabled").as_bool(),
+        std::chrono::microseconds {state_publish_period_},
+        get_parameter("load_shedding.shed_threshold").as_double(),
+        get_parameter("load_shedding.restore_threshold").as_double(),
+        static_cast<std::size_t>(get_parameter("load_shedding.restore_cycles").as_int()),
+        static_cast<std::size_t>(get_parameter("load_shedding.max_level").as_int())));
+  } catch (const std::exception & e) {
+    RCLCPP_ERROR(get_logger(), "Invalid load shedding parameters: %s", e.what());
+    return LifecycleNodeInterface::CallbackReturn::FAILURE;
+  }
+  allow_non_critical_ = true;
   // reset internal state of the driver for a clean start
   driver_.reset();
+  command_arbiter_.reset();
+  num_cycles_ = 0U;
+  batcher_.reset();
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
 
@@ -175,7 +511,35 @@ rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 PendulumDriverNode::on_activate(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Activating");
+  // the clock never calibrates itself in the cycles, its rate is corrected here
+  utils::TscClock::calibrate();
+  // resume from the state of a previous process, the next published state continues it
+  if (persistent_state_) {
+    restore_driver_state();
+  }
   state_pub_->on_activate();
+  if (batch_pub_) {
+    batch_pub_->on_activate();
+  }
+  num_state_publish_ = 0U;
+  state_publish_time_sum_ = 0.0;
+  state_publish_time_sum_sq_ = 0.0;
+  state_publish_time_max_ = 0.0;
+  state_timer_time_.reset();
+  command_time_.reset();
+  standby_command_time_.reset();
+  if (enable_perf_counters_) {
+    // opened here for the executor thread, which also runs the state timer
+    perf_counters_ = std::make_unique<utils::PerfCounters>();
+    perf_update_ = std::make_unique<utils::PerfSection>(*perf_counters_);
+    perf_publish_ = std::make_unique<utils::PerfSection>(*perf_counters_);
+    if (!perf_counters_->is_any_available()) {
+      RCLCPP_WARN(get_logger(), "Performance counters are not permitted or not supported");
+    }
+  }
+  if (state_bridge_) {
+    state_bridge_->start();
+  }
   state_timer_->reset();
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
@@ -185,7 +549,13 @@ PendulumDriverNode::on_deactivate(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Deactivating");
   state_timer_->cancel();
+  if (state_bridge_) {
+    state_bridge_->stop();
+  }
   state_pub_->on_deactivate();
+  if (batch_pub_) {
+    batch_pub_->on_deactivate();
+  }
   // log the status to introspect the result
   log_driver_state();
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
@@ -195,6 +565,10 @@ rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 PendulumDriverNode::on_cleanup(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Cleaning up");
+  // an orderly stop must not be resumed by the next process
+  if (persistent_state_) {
+    persistent_state_->clear();
+  }
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
 
@@ -202,6 +576,9 @@ rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
 PendulumDriverNode::on_shutdown(const rclcpp_lifecycle::State &)
 {
   RCLCPP_INFO(get_logger(), "Shutting down");
+  if (persistent_state_) {
+    persistent_state_->clear();
+  }
   return LifecycleNodeInterface::CallbackReturn::SUCCESS;
 }
 }  // namespace pendulum_driver
@@ -0,0 +1,199 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_driver/pendulum_vector_env.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "pendulum_driver/cart_pole_integrators.hpp"
+#include "rcppmath/clamp.hpp"
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+namespace
+{
+/// splitmix64 is used to derive well distributed seeds for the instance generators
+std::uint64_t splitmix64(std::uint64_t x)
+{
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27U)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31U);
+}
+}  // namespace
+
+PendulumVectorEnv::PendulumVectorEnv(
+  const PendulumDriver::Config & driver_config,
+  const Config & config)
+: driver_config_(driver_config),
+  cfg_(config),
+  nominal_params_{driver_config.get_pendulum_mass(), driver_config.get_cart_mass(),
+    driver_config.get_pendulum_length(), driver_config.get_damping_coefficient(),
+    driver_config.get_gravity()},
+  dt_(driver_config.get_physics_update_period().count() / (1000.0 * 1000.0)),
+  observations_(config.num_envs * STATE_DIM, 0.0),
+  final_observations_(config.num_envs * STATE_DIM, 0.0),
+  rewards_(config.num_envs, 0.0),
+  dones_(config.num_envs, 0U),
+  truncations_(config.num_envs, 0U),
+  episode_steps_(config.num_envs, 0U),
+  params_(config.num_envs, nominal_params_),
+  rand_state_(config.num_envs)
+{
+  if (cfg_.num_envs == 0U) {
+    throw std::invalid_argument("num_envs must be greater than zero");
+  }
+  if (std::isnan(dt_) || dt_ <= 0.0) {
+    throw std::invalid_argument("invalid physics update period");
+  }
+  for (std::size_t i = 0; i < cfg_.num_envs; i++) {
+    // xorshift generators must not start from zero
+    rand_state_[i] = splitmix64(cfg_.seed + i) | 1U;
+  }
+  reset();
+}
+
+double PendulumVectorEnv::uniform(std::size_t index)
+{
+  // xorshift64*
+  std::uint64_t x = rand_state_[index];
+  x ^= x >> 12U;
+  x ^= x << 25U;
+  x ^= x >> 27U;
+  rand_state_[index] = x;
+  const std::uint64_t r = x * 0x2545F4914F6CDD1DULL;
+  return static_cast<double>(r >> 11U) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+double PendulumVectorEnv::noise(std::size_t index)
+{
+  // the generator is not advanced without noise, the seeded episodes do not depend on it
+  const double noise_level = driver_config_.get_noise_level();
+  return (noise_level > 0.0) ? noise_level * uniform(index) : 0.0;
+}
+
+void PendulumVectorEnv::reset_instance(std::size_t index)
+{
+  CartPoleParameters & p = params_[index];
+  p = nominal_params_;
+  p.pendulum_mass *= 1.0 + cfg_.pendulum_mass_randomization * uniform(index);
+  p.cart_mass *= 1.0 + cfg_.cart_mass_randomization * uniform(index);
+  p.pendulum_length *= 1.0 + cfg_.pendulum_length_randomization * uniform(index);
+  p.damping_coefficient *= 1.0 + cfg_.damping_coefficient_randomization * uniform(index);
+
+  double * y = &observations_[index * STATE_DIM];
+  y[0] = cfg_.initial_state_range[0] * uniform(index);
+  y[1] = cfg_.initial_state_range[1] * uniform(index);
+  y[2] = M_PI + cfg_.initial_state_range[2] * uniform(index);
+  y[3] = cfg_.initial_state_range[3] * uniform(index);
+  episode_steps_[index] = 0U;
+}
+
+void PendulumVectorEnv::reset(const std::uint8_t * mask)
+{
+  for (std::size_t i = 0; i < cfg_.num_envs; i++) {
+    if (mask == nullptr || mask[i] != 0U) {
+      reset_instance(i);
+      rewards_[i] = 0.0;
+      dones_[i] = 0U;
+      truncations_[i] = 0U;
+    }
+  }
+}
+
+void PendulumVectorEnv::step(const double * actions)
+{
+  const double max_force = driver_config_.get_max_cart_force();
+  const std::size_t newton_iterations = PendulumDriver::IMPLICIT_NEWTON_ITERATIONS;
+
+  for (std::size_t i = 0; i < cfg_.num_envs; i++) {
+    double * y = &observations_[i * STATE_DIM];
+    const double u = rcppmath::clamp(actions[i], -max_force, max_force);
+    // same integrators and noise distribution as PendulumDriver::update
+    switch (driver_config_.get_integrator()) {
+      case PendulumDriver::Integrator::BACKWARD_EULER:
+        cart_pole_theta_step(y, u, params_[i], dt_, 1.0, newton_iterations, noise(i));
+        break;
+      case PendulumDriver::Integrator::TRAPEZOIDAL:
+        cart_pole_theta_step(y, u, params_[i], dt_, 0.5, newton_iterations, noise(i));
+        break;
+      case PendulumDriver::Integrator::VARIATIONAL:
+        cart_pole_variational_step(y, u, params_[i], dt_, newton_iterations, noise(i));
+        break;
+      case PendulumDriver::Integrator::RK4:
+      default:
+        cart_pole_rk4_step(y, u, params_[i], dt_, {{noise(i), noise(i), noise(i), noise(i)}});
+        break;
+    }
+
+    const double angle_error = y[2] - M_PI;
+    rewards_[i] = -(cfg_.angle_weight * angle_error * angle_error +
+      cfg_.position_weight * y[0] * y[0] +
+      cfg_.force_weight * u * u);
+
+    episode_steps_[i]++;
+    const bool terminated = !(std::fabs(angle_error) <= cfg_.failure_angle) ||
+      !(std::fabs(y[0]) <= cfg_.failure_position);
+    const bool truncated = !terminated && cfg_.max_episode_steps > 0U &&
+      episode_steps_[i] >= cfg_.max_episode_steps;
+    dones_[i] = (terminated || truncated) ? 1U : 0U;
+    truncations_[i] = truncated ? 1U : 0U;
+
+    if (dones_[i] != 0U) {
+      std::copy(y, y + STATE_DIM, &final_observations_[i * STATE_DIM]);
+      reset_instance(i);
+    }
+  }
+}
+
+std::size_t PendulumVectorEnv::get_num_envs() const
+{
+  return cfg_.num_envs;
+}
+
+const double * PendulumVectorEnv::get_observations() const
+{
+  return observations_.data();
+}
+
+const double * PendulumVectorEnv::get_final_observations() const
+{
+  return final_observations_.data();
+}
+
+const double * PendulumVectorEnv::get_rewards() const
+{
+  return rewards_.data();
+}
+
+const std::uint8_t * PendulumVectorEnv::get_dones() const
+{
+  return dones_.data();
+}
+
+const std::uint8_t * PendulumVectorEnv::get_truncations() const
+{
+  return truncations_.data();
+}
+
+const CartPoleParameters & PendulumVectorEnv::get_parameters(std::size_t index) const
+{
+  return params_.at(index);
+}
+}  // namespace pendulum_driver
+}  // namespace pendulum
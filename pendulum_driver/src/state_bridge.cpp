@@ -0,0 +1,151 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_driver/state_bridge.hpp"
+
+#include <memory>
+#include <string>
+
+namespace pendulum
+{
+namespace pendulum_driver
+{
+StateBridge::Config::Config(
+  std::size_t domain_id,
+  const std::string & node_name,
+  const std::string & topic_name,
+  std::chrono::microseconds publish_period)
+: domain_id(domain_id),
+  node_name(node_name),
+  topic_name(topic_name),
+  publish_period(publish_period)
+{}
+
+std::size_t StateBridge::Config::get_domain_id() const
+{
+  return domain_id;
+}
+
+const std::string & StateBridge::Config::get_node_name() const
+{
+  return node_name;
+}
+
+const std::string & StateBridge::Config::get_topic_name() const
+{
+  return topic_name;
+}
+
+std::chrono::microseconds StateBridge::Config::get_publish_period() const
+{
+  return publish_period;
+}
+
+StateBridge::StateBridge(const Config & config)
+: cfg_(config),
+  context_(std::make_shared<rclcpp::Context>()),
+  stop_requested_(false),
+  num_published_(0U)
+{
+  // a separate context creates a separate DDS participant, in the bridge domain
+  rclcpp::InitOptions init_options;
+  init_options.auto_initialize_logging(false);
+  init_options.set_domain_id(cfg_.get_domain_id());
+  context_->init(0, nullptr, init_options);
+
+  rclcpp::NodeOptions node_options;
+  node_options.context(context_);
+  node_options.use_global_arguments(false);
+  node_options.start_parameter_services(false);
+  node_options.start_parameter_event_publisher(false);
+  node_ = std::make_shared<rclcpp::Node>(cfg_.get_node_name(), node_options);
+  state_pub_ = node_->create_publisher<pendulum2_msgs::msg::JointState>(
+    cfg_.get_topic_name(), rclcpp::QoS(10));
+}
+
+StateBridge::~StateBridge()
+{
+  stop();
+  state_pub_.reset();
+  node_.reset();
+  context_->shutdown("state bridge destroyed");
+}
+
+void StateBridge::start()
+{
+  if (thread_.joinable()) {
+    return;
+  }
+  stop_requested_ = false;
+  thread_ = std::thread(&StateBridge::run, this);
+}
+
+void StateBridge::stop()
+{
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = true;
+  }
+  stop_requested_cv_.notify_one();
+  thread_.join();
+}
+
+void StateBridge::write(const PendulumDriver::PendulumState & state) noexcept
+{
+  buffer_.write(state);
+}
+
+std::uint64_t StateBridge::get_num_published() const
+{
+  return num_published_;
+}
+
+std::uint64_t StateBridge::get_num_dropped() const
+{
+  return buffer_.get_num_dropped();
+}
+
+void StateBridge::run()
+{
+  std::uint64_t last_version = 0U;
+  auto next_publish_time = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_requested_) {
+    next_publish_time += cfg_.get_publish_period();
+    if (stop_requested_cv_.wait_until(
+        lock, next_publish_time, [this]() {return stop_requested_;}))
+    {
+      break;
+    }
+    PendulumDriver::PendulumState state;
+    const std::uint64_t version = buffer_.read(state);
+    // the state only changes while the driver is active
+    if (version == last_version) {
+      continue;
+    }
+    last_version = version;
+    state_message_.cart_position = state.cart_position;
+    state_message_.cart_velocity = state.cart_velocity;
+    state_message_.cart_force = state.cart_force;
+    state_message_.pole_angle = state.pole_angle;
+    state_message_.pole_velocity = state.pole_velocity;
+    state_pub_->publish(state_message_);
+    num_published_++;
+  }
+}
+}  // namespace pendulum_driver
+}  // namespace pendulum
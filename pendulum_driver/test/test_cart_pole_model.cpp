@@ -0,0 +1,150 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "pendulum_driver/cart_pole_model.hpp"
+#include "pendulum_driver/cart_pole_integrators.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_driver::CartPoleParameters;
+using pendulum::pendulum_driver::cart_pole_derivative;
+using pendulum::pendulum_driver::cart_pole_energy;
+using pendulum::pendulum_driver::cart_pole_jacobian;
+using pendulum::pendulum_driver::cart_pole_rk4_step;
+using pendulum::pendulum_driver::cart_pole_variational_step;
+
+class TestCartPoleModel : public ::testing::Test
+{
+protected:
+  CartPoleParameters params{1.0, 5.0, 2.0, 20.0, -9.8};
+
+  // central finite differences of the state derivative
+  void finite_difference_jacobian(const double * y, double u, double * A, double * B) const
+  {
+    const double h = 1e-6;
+    double yp[4], ym[4], fp[4], fm[4];
+    for (std::size_t j = 0; j < 4U; j++) {
+      for (std::size_t k = 0; k < 4U; k++) {
+        yp[k] = y[k];
+        ym[k] = y[k];
+      }
+      yp[j] += h;
+      ym[j] -= h;
+      cart_pole_derivative(yp, u, params, 0.0, fp);
+      cart_pole_derivative(ym, u, params, 0.0, fm);
+      for (std::size_t i = 0; i < 4U; i++) {
+        A[i * 4U + j] = (fp[i] - fm[i]) / (2.0 * h);
+      }
+    }
+    cart_pole_derivative(y, u + h, params, 0.0, fp);
+    cart_pole_derivative(y, u - h, params, 0.0, fm);
+    for (std::size_t i = 0; i < 4U; i++) {
+      B[i] = (fp[i] - fm[i]) / (2.0 * h);
+    }
+  }
+};
+
+TEST_F(TestCartPoleModel, jacobian_matches_finite_differences)
+{
+  const double states[][4] = {
+    {0.0, 0.0, M_PI, 0.0},
+    {0.5, -1.0, M_PI + 0.3, 2.0},
+    {-2.0, 3.0, 0.7, -1.5},
+    {1.0, 0.2, 0.0, 0.0},
+  };
+  const double inputs[] = {0.0, 50.0, -200.0, 10.0};
+
+  for (std::size_t s = 0; s < 4U; s++) {
+    double A[16], B[4], A_fd[16], B_fd[4];
+    apex_test_tools::memory_test::start();
+    cart_pole_jacobian(states[s], inputs[s], params, A, B);
+    apex_test_tools::memory_test::stop();
+    finite_difference_jacobian(states[s], inputs[s], A_fd, B_fd);
+    for (std::size_t i = 0; i < 16U; i++) {
+      EXPECT_NEAR(A_fd[i], A[i], 1e-5 * (1.0 + std::fabs(A_fd[i]))) << "state " << s <<
+        " element " << i;
+    }
+    for (std::size_t i = 0; i < 4U; i++) {
+      EXPECT_NEAR(B_fd[i], B[i], 1e-5 * (1.0 + std::fabs(B_fd[i]))) << "state " << s <<
+        " element " << i;
+    }
+  }
+}
+
+TEST_F(TestCartPoleModel, linearization_at_up_position)
+{
+  // classic linearized cart-pole model around the up position
+  const double y[4] = {0.0, 0.0, M_PI, 0.0};
+  double A[16], B[4];
+  cart_pole_jacobian(y, 0.0, params, A, B);
+
+  const double m = params.pendulum_mass;
+  const double M = params.cart_mass;
+  const double L = params.pendulum_length;
+  const double d = params.damping_coefficient;
+  const double g = params.gravity;
+  EXPECT_DOUBLE_EQ(-d / M, A[5]);
+  EXPECT_NEAR(-m * g / M, A[6], 1e-12);
+  EXPECT_NEAR(-d / (M * L), A[13], 1e-12);
+  EXPECT_NEAR(-(m + M) * g / (M * L), A[14], 1e-12);
+  EXPECT_DOUBLE_EQ(1.0 / M, B[1]);
+  EXPECT_DOUBLE_EQ(1.0 / (M * L), B[3]);
+}
+
+TEST_F(TestCartPoleModel, variational_integrator_energy_is_bounded)
+{
+  // undamped and unforced large swing with a coarse step, the energy should be conserved
+  const CartPoleParameters undamped{1.0, 5.0, 2.0, 0.0, -9.8};
+  const double h = 0.05;
+  double y_rk4[4] = {0.0, 0.0, M_PI - 1.5, 0.0};
+  double y_var[4] = {0.0, 0.0, M_PI - 1.5, 0.0};
+  const double energy = cart_pole_energy(y_var, undamped);
+
+  apex_test_tools::memory_test::start();
+  cart_pole_variational_step(y_var, 0.0, undamped, h, 3U);
+  apex_test_tools::memory_test::stop();
+  cart_pole_rk4_step(y_rk4, 0.0, undamped, h);
+  const std::size_t steps = 20000U;
+  double first_quarter_error = 0.0;
+  double last_quarter_error = 0.0;
+  for (std::size_t k = 1; k < steps; k++) {
+    cart_pole_variational_step(y_var, 0.0, undamped, h, 3U);
+    cart_pole_rk4_step(y_rk4, 0.0, undamped, h);
+    const double error = std::fabs(cart_pole_energy(y_var, undamped) - energy);
+    if (k < steps / 4U) {
+      first_quarter_error = std::fmax(first_quarter_error, error);
+    } else if (k >= 3U * steps / 4U) {
+      last_quarter_error = std::fmax(last_quarter_error, error);
+    }
+  }
+  // the variational error oscillates with the motion but does not accumulate
+  EXPECT_LT(first_quarter_error, 0.01 * std::fabs(energy));
+  EXPECT_LT(last_quarter_error, 1.1 * first_quarter_error);
+  // RK4 slowly dissipates energy at the same step size
+  EXPECT_GT(
+    std::fabs(cart_pole_energy(y_rk4, undamped) - energy), 1.5 * last_quarter_error);
+}
+
+TEST_F(TestCartPoleModel, variational_integrator_damping_dissipates_energy)
+{
+  double y[4] = {0.0, 1.0, M_PI - 1.0, 0.0};
+  double energy = cart_pole_energy(y, params);
+  for (std::size_t k = 0; k < 1000U; k++) {
+    cart_pole_variational_step(y, 0.0, params, 0.01, 3U);
+    const double next_energy = cart_pole_energy(y, params);
+    EXPECT_LT(next_energy, energy + 1e-6);
+    energy = next_energy;
+  }
+}
@@ -0,0 +1,126 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include "pendulum_driver/command_arbiter.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_driver::CommandArbiter;
+using std::chrono::microseconds;
+
+class TestCommandArbiter : public ::testing::Test
+{
+protected:
+  const microseconds period{10000};
+  const std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+  // a source fails after two and a half periods without a command
+  CommandArbiter arbiter{CommandArbiter::Config(microseconds(25000))};
+};
+
+TEST_F(TestCommandArbiter, config)
+{
+  EXPECT_EQ(arbiter.get_config().get_timeout(), microseconds(25000));
+  EXPECT_THROW(CommandArbiter::Config(microseconds(0)), std::invalid_argument);
+}
+
+TEST_F(TestCommandArbiter, primary_is_applied)
+{
+  EXPECT_TRUE(arbiter.on_command(CommandArbiter::PRIMARY, 1.0, start));
+  EXPECT_FALSE(arbiter.on_command(CommandArbiter::STANDBY, 2.0, start));
+  EXPECT_FALSE(arbiter.on_cycle(start + period));
+  EXPECT_EQ(arbiter.get_active_source(), CommandArbiter::PRIMARY);
+  EXPECT_DOUBLE_EQ(arbiter.get_force_command(), 1.0);
+}
+
+TEST_F(TestCommandArbiter, failover)
+{
+  bool switched = false;
+  auto now = start;
+  for (int k = 0; k < 5; k++) {
+    arbiter.on_command(CommandArbiter::PRIMARY, 1.0, now + microseconds(500));
+    arbiter.on_command(CommandArbiter::STANDBY, 1.1, now + microseconds(600));
+    now += period;
+    EXPECT_FALSE(arbiter.on_cycle(now));
+  }
+  // the primary stalls, the standby keeps answering, a single miss is tolerated
+  arbiter.on_command(CommandArbiter::STANDBY, 1.9, now + microseconds(600));
+  now += period;
+  EXPECT_FALSE(arbiter.on_cycle(now));
+  EXPECT_EQ(arbiter.get_active_source(), CommandArbiter::PRIMARY);
+  arbiter.on_command(CommandArbiter::STANDBY, 2.0, now + microseconds(600));
+  now += period;
+
+  apex_test_tools::memory_test::start();
+  switched = arbiter.on_cycle(now);
+  apex_test_tools::memory_test::stop();
+
+  EXPECT_TRUE(switched);
+  EXPECT_EQ(arbiter.get_active_source(), CommandArbiter::STANDBY);
+  EXPECT_DOUBLE_EQ(arbiter.get_force_command(), 2.0);
+  EXPECT_EQ(arbiter.get_num_switches(), 1U);
+  EXPECT_EQ(arbiter.get_num_missed_commands(), 2U);
+  // the last primary command arrived 500 us after the cycle three periods before the switch
+  EXPECT_EQ(arbiter.get_last_switch_latency(), period * 3 - microseconds(500));
+
+  // the standby commands are applied, the late primary ones are not
+  EXPECT_TRUE(arbiter.on_command(CommandArbiter::STANDBY, 3.0, now + microseconds(600)));
+  EXPECT_FALSE(arbiter.on_command(CommandArbiter::PRIMARY, 4.0, now + microseconds(700)));
+  EXPECT_FALSE(arbiter.on_cycle(now + period));
+  EXPECT_DOUBLE_EQ(arbiter.get_force_command(), 3.0);
+}
+
+TEST_F(TestCommandArbiter, jitter)
+{
+  // the primary skips every other command, like an event-triggered controller
+  auto now = start;
+  for (int k = 0; k < 20; k++) {
+    if (k % 2 == 0) {
+      arbiter.on_command(CommandArbiter::PRIMARY, 1.0, now + microseconds(500));
+    }
+    arbiter.on_command(CommandArbiter::STANDBY, 2.0, now + microseconds(600));
+    now += period;
+    EXPECT_FALSE(arbiter.on_cycle(now));
+  }
+  EXPECT_EQ(arbiter.get_active_source(), CommandArbiter::PRIMARY);
+  EXPECT_EQ(arbiter.get_num_missed_commands(), 10U);
+  EXPECT_EQ(arbiter.get_num_switches(), 0U);
+}
+
+TEST_F(TestCommandArbiter, both_stalled)
+{
+  arbiter.on_command(CommandArbiter::PRIMARY, 1.0, start);
+  arbiter.on_command(CommandArbiter::STANDBY, 2.0, start);
+  EXPECT_FALSE(arbiter.on_cycle(start + period));
+  // no source answered, the last command is held
+  for (int k = 2; k < 5; k++) {
+    EXPECT_FALSE(arbiter.on_cycle(start + period * k));
+  }
+  EXPECT_EQ(arbiter.get_active_source(), CommandArbiter::PRIMARY);
+  EXPECT_DOUBLE_EQ(arbiter.get_force_command(), 1.0);
+  EXPECT_EQ(arbiter.get_num_missed_commands(), 3U);
+  EXPECT_EQ(arbiter.get_num_switches(), 0U);
+}
+
+TEST_F(TestCommandArbiter, primary_not_started)
+{
+  EXPECT_FALSE(arbiter.on_cycle(start));
+  arbiter.on_command(CommandArbiter::STANDBY, 2.0, start);
+  EXPECT_TRUE(arbiter.on_cycle(start + period));
+  EXPECT_EQ(arbiter.get_active_source(), CommandArbiter::STANDBY);
+  arbiter.reset();
+  EXPECT_EQ(arbiter.get_active_source(), CommandArbiter::PRIMARY);
+  EXPECT_EQ(arbiter.get_num_switches(), 0U);
+}
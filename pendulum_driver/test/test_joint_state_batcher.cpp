@@ -0,0 +1,98 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "pendulum_driver/joint_state_batcher.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_driver::JointStateBatcher;
+using pendulum::pendulum_driver::PendulumDriver;
+using pendulum::pendulum_driver::unpack_joint_state_batch;
+
+namespace
+{
+PendulumDriver::PendulumState make_state(std::size_t k)
+{
+  PendulumDriver::PendulumState state;
+  state.cart_position = 0.1 * static_cast<double>(k);
+  state.cart_force = static_cast<double>(k);
+  return state;
+}
+}  // namespace
+
+TEST(TestJointStateBatcher, invalid_batch_size)
+{
+  EXPECT_THROW(JointStateBatcher(0U), std::invalid_argument);
+  EXPECT_THROW(
+    JointStateBatcher(pendulum2_msgs::msg::JointStateBatch::MAX_SAMPLES + 1U),
+    std::invalid_argument);
+}
+
+TEST(TestJointStateBatcher, batches)
+{
+  JointStateBatcher batcher(4U);
+  std::vector<std::uint64_t> indices;
+  std::vector<double> forces;
+  std::size_t num_batches = 0U;
+  for (std::size_t k = 0U; k < 12U; k++) {
+    apex_test_tools::memory_test::start();
+    const bool complete = batcher.add(make_state(k), static_cast<std::int64_t>(1000 * k));
+    apex_test_tools::memory_test::stop();
+    // one message every 4 samples
+    EXPECT_EQ(complete, k % 4U == 3U);
+    if (complete) {
+      num_batches++;
+      const auto num_samples = unpack_joint_state_batch(
+        batcher.get_message(),
+        [&indices, &forces](std::uint64_t index, const pendulum2_msgs::msg::JointStateSample & s) {
+          indices.push_back(index);
+          forces.push_back(s.cart_force);
+        });
+      EXPECT_EQ(num_samples, 4U);
+    }
+  }
+  EXPECT_EQ(num_batches, 3U);
+  // every sample is received once, in order
+  ASSERT_EQ(indices.size(), 12U);
+  for (std::size_t k = 0U; k < 12U; k++) {
+    EXPECT_EQ(indices[k], k);
+    EXPECT_DOUBLE_EQ(forces[k], static_cast<double>(k));
+  }
+}
+
+TEST(TestJointStateBatcher, reset)
+{
+  JointStateBatcher batcher(2U);
+  batcher.add(make_state(0U), 0);
+  batcher.add(make_state(1U), 1);
+  batcher.add(make_state(2U), 2);
+  batcher.reset();
+  EXPECT_FALSE(batcher.add(make_state(3U), 3));
+  EXPECT_TRUE(batcher.add(make_state(4U), 4));
+  EXPECT_EQ(batcher.get_message().first_sample_index, 0U);
+  EXPECT_EQ(batcher.get_message().samples[0].stamp_ns, 3);
+}
+
+TEST(TestJointStateBatcher, corrupted_count)
+{
+  pendulum2_msgs::msg::JointStateBatch batch;
+  batch.num_samples = 1000U;
+  std::size_t calls = 0U;
+  unpack_joint_state_batch(
+    batch, [&calls](std::uint64_t, const pendulum2_msgs::msg::JointStateSample &) {calls++;});
+  EXPECT_EQ(calls, pendulum2_msgs::msg::JointStateBatch::MAX_SAMPLES);
+}
@@ -168,3 +168,67 @@ TEST_F(TestPendulumDriver, update)
   driver.update();
   apex_test_tools::memory_test::stop();
 }
+
+TEST_F(TestPendulumDriver, integrator_from_string)
+{
+  using pendulum::pendulum_driver::integrator_from_string;
+  EXPECT_EQ(PendulumDriver::Integrator::RK4, integrator_from_string("rk4"));
+  EXPECT_EQ(PendulumDriver::Integrator::BACKWARD_EULER, integrator_from_string("backward_euler"));
+  EXPECT_EQ(PendulumDriver::Integrator::TRAPEZOIDAL, integrator_from_string("trapezoidal"));
+  EXPECT_EQ(PendulumDriver::Integrator::VARIATIONAL, integrator_from_string("variational"));
+  EXPECT_THROW(integrator_from_string("euler"), std::invalid_argument);
+  EXPECT_EQ(PendulumDriver::Integrator::RK4, config.get_integrator());
+}
+
+TEST_F(TestPendulumDriver, implicit_integrators_match_rk4)
+{
+  for (const auto integrator : {PendulumDriver::Integrator::BACKWARD_EULER,
+      PendulumDriver::Integrator::TRAPEZOIDAL, PendulumDriver::Integrator::VARIATIONAL})
+  {
+    PendulumDriver::Config implicit_config{pendulum_mass, cart_mass, pendulum_length,
+      damping_coefficient, gravity, max_cart_force, 0.0, state_publish_period, integrator};
+    PendulumDriver::Config rk4_config{pendulum_mass, cart_mass, pendulum_length,
+      damping_coefficient, gravity, max_cart_force, 0.0, state_publish_period};
+    PendulumDriver implicit_driver{implicit_config};
+    PendulumDriver rk4_driver{rk4_config};
+    implicit_driver.set_controller_cart_force(10.0);
+    rk4_driver.set_controller_cart_force(10.0);
+
+    apex_test_tools::memory_test::start();
+    implicit_driver.update();
+    apex_test_tools::memory_test::stop();
+    for (std::size_t i = 1; i < 200U; i++) {
+      implicit_driver.update();
+    }
+    for (std::size_t i = 0; i < 200U; i++) {
+      rk4_driver.update();
+    }
+    EXPECT_NEAR(rk4_driver.get_state().cart_position, implicit_driver.get_state().cart_position,
+      1e-3);
+    EXPECT_NEAR(rk4_driver.get_state().pole_angle, implicit_driver.get_state().pole_angle, 1e-3);
+  }
+}
+
+TEST_F(TestPendulumDriver, implicit_integrator_stiff_damping)
+{
+  // the cart velocity eigenvalue -d/M * dt is far outside the RK4 stability region
+  const double stiff_damping{1e5};
+  const std::chrono::microseconds large_period{10000};
+  PendulumDriver::Config rk4_config{pendulum_mass, cart_mass, pendulum_length,
+    stiff_damping, gravity, max_cart_force, 0.0, large_period};
+  PendulumDriver::Config implicit_config{pendulum_mass, cart_mass, pendulum_length,
+    stiff_damping, gravity, max_cart_force, 0.0, large_period,
+    PendulumDriver::Integrator::BACKWARD_EULER};
+  PendulumDriver rk4_driver{rk4_config};
+  PendulumDriver implicit_driver{implicit_config};
+  rk4_driver.set_state(0.0, 1.0, M_PI, 0.0);
+  implicit_driver.set_state(0.0, 1.0, M_PI, 0.0);
+
+  for (std::size_t i = 0; i < 100U; i++) {
+    rk4_driver.update();
+    implicit_driver.update();
+  }
+  EXPECT_FALSE(std::fabs(rk4_driver.get_state().cart_velocity) < 1.0);
+  EXPECT_LT(std::fabs(implicit_driver.get_state().cart_velocity), 1.0);
+  EXPECT_TRUE(std::isfinite(implicit_driver.get_state().pole_angle));
+}
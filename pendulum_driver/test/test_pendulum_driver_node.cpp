@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <cstddef>
+#include <memory>
 #include <vector>
 #include "pendulum_driver/pendulum_driver_node.hpp"
 
@@ -97,6 +100,76 @@ TEST_F(TestPendulumDriverNode, trigger_lifecycle_transitions) {
       rclcpp_lifecycle::Transition(Transition::TRANSITION_UNCONFIGURED_SHUTDOWN)).id());
 }
 
+TEST_F(TestPendulumDriverNode, load_shedding) {
+  using lifecycle_msgs::msg::State;
+  using lifecycle_msgs::msg::Transition;
+  params.emplace_back("batch.enabled", true);
+  params.emplace_back("batch.size", 1);
+  params.emplace_back("load_shedding.enabled", true);
+  // every cycle takes longer than 10 ns, the batches are disabled after the first cycle
+  params.emplace_back("load_shedding.shed_threshold", 1e-6);
+  params.emplace_back("load_shedding.restore_threshold", 1e-6);
+  params.emplace_back("load_shedding.restore_cycles", 1);
+  params.emplace_back("load_shedding.max_level", 1);
+  node_options.parameter_overrides(params);
+  auto driver_node = std::make_shared<PendulumDriverNode>("driver_node", node_options);
+
+  auto listener = std::make_shared<rclcpp::Node>("listener");
+  std::size_t num_states = 0U;
+  std::size_t num_batches = 0U;
+  auto state_sub = listener->create_subscription<pendulum2_msgs::msg::JointState>(
+    "joint_states", rclcpp::QoS(100),
+    [&num_states](pendulum2_msgs::msg::JointState::SharedPtr) {num_states++;});
+  auto batch_sub = listener->create_subscription<pendulum2_msgs::msg::JointStateBatch>(
+    "pendulum_joint_state_batches", rclcpp::QoS(100),
+    [&num_batches](pendulum2_msgs::msg::JointStateBatch::SharedPtr) {num_batches++;});
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(driver_node->get_node_base_interface());
+  executor.add_node(listener);
+  const auto spin_until_states = [&](std::size_t count) {
+      const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (num_states < count && std::chrono::steady_clock::now() < timeout) {
+        executor.spin_some(std::chrono::milliseconds(10));
+      }
+    };
+
+  ASSERT_EQ(
+    State::PRIMARY_STATE_INACTIVE, driver_node->trigger_transition(
+      rclcpp_lifecycle::Transition(Transition::TRANSITION_CONFIGURE)).id());
+  ASSERT_EQ(
+    State::PRIMARY_STATE_ACTIVE, driver_node->trigger_transition(
+      rclcpp_lifecycle::Transition(Transition::TRANSITION_ACTIVATE)).id());
+  spin_until_states(20U);
+  // the state messages are never shed
+  EXPECT_GE(num_states, 20U);
+  EXPECT_LE(num_batches, 1U);
+
+  // the shedding parameters are read again in the next configuration
+  ASSERT_EQ(
+    State::PRIMARY_STATE_INACTIVE, driver_node->trigger_transition(
+      rclcpp_lifecycle::Transition(Transition::TRANSITION_DEACTIVATE)).id());
+  ASSERT_EQ(
+    State::PRIMARY_STATE_UNCONFIGURED, driver_node->trigger_transition(
+      rclcpp_lifecycle::Transition(Transition::TRANSITION_CLEANUP)).id());
+  driver_node->set_parameter(rclcpp::Parameter("load_shedding.shed_threshold", 1.0));
+  driver_node->set_parameter(rclcpp::Parameter("load_shedding.restore_threshold", 1.0));
+  ASSERT_EQ(
+    State::PRIMARY_STATE_INACTIVE, driver_node->trigger_transition(
+      rclcpp_lifecycle::Transition(Transition::TRANSITION_CONFIGURE)).id());
+  ASSERT_EQ(
+    State::PRIMARY_STATE_ACTIVE, driver_node->trigger_transition(
+      rclcpp_lifecycle::Transition(Transition::TRANSITION_ACTIVATE)).id());
+  num_states = 0U;
+  num_batches = 0U;
+  spin_until_states(20U);
+  // a cycle longer than the period is shed, the next one below it restores the batches
+  EXPECT_GE(num_states, 20U);
+  EXPECT_GE(num_batches, 10U);
+  ASSERT_EQ(
+    State::PRIMARY_STATE_INACTIVE, driver_node->trigger_transition(
+      rclcpp_lifecycle::Transition(Transition::TRANSITION_DEACTIVATE)).id());
+}
+
 TEST_F(TestPendulumDriverNode, pendulum_state_message_size) {
   EXPECT_TRUE(rosidl_generator_traits::has_bounded_size<pendulum2_msgs::msg::JointState>());
   EXPECT_TRUE(rosidl_generator_traits::has_fixed_size<pendulum2_msgs::msg::JointState>());
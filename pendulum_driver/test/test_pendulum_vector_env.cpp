@@ -0,0 +1,179 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_driver/pendulum_vector_env.hpp"
+#include "apex_test_tools/apex_test_tools.hpp"
+
+using pendulum::pendulum_driver::PendulumDriver;
+using pendulum::pendulum_driver::PendulumVectorEnv;
+
+class TestPendulumVectorEnv : public ::testing::Test
+{
+protected:
+  PendulumDriver::Config driver_config{1.0, 5.0, 2.0, 20.0, -9.8, 1000.0, 0.0,
+    std::chrono::microseconds{1000}};
+  PendulumVectorEnv::Config env_config;
+
+  void SetUp() override
+  {
+    env_config.num_envs = 16U;
+  }
+};
+
+TEST_F(TestPendulumVectorEnv, reset_initial_state)
+{
+  PendulumVectorEnv env{driver_config, env_config};
+  const double * obs = env.get_observations();
+  for (std::size_t i = 0; i < env.get_num_envs(); i++) {
+    EXPECT_LE(std::fabs(obs[i * 4 + 0]), env_config.initial_state_range[0]);
+    EXPECT_LE(std::fabs(obs[i * 4 + 1]), env_config.initial_state_range[1]);
+    EXPECT_LE(std::fabs(obs[i * 4 + 2] - M_PI), env_config.initial_state_range[2]);
+    EXPECT_LE(std::fabs(obs[i * 4 + 3]), env_config.initial_state_range[3]);
+  }
+}
+
+TEST_F(TestPendulumVectorEnv, matches_driver)
+{
+  env_config.initial_state_range = {{0.0, 0.0, 0.0, 0.0}};
+  env_config.max_episode_steps = 0U;
+  PendulumVectorEnv env{driver_config, env_config};
+  PendulumDriver driver{driver_config};
+  std::vector<double> actions(env_config.num_envs, 10.0);
+
+  for (std::size_t step = 0; step < 100U; step++) {
+    env.step(actions.data());
+    driver.set_controller_cart_force(10.0);
+    driver.update();
+  }
+  const auto & state = driver.get_state();
+  const double * obs = env.get_observations();
+  EXPECT_NEAR(state.cart_position, obs[0], 1e-9);
+  EXPECT_NEAR(state.cart_velocity, obs[1], 1e-9);
+  EXPECT_NEAR(state.pole_angle, obs[2], 1e-9);
+  EXPECT_NEAR(state.pole_velocity, obs[3], 1e-9);
+}
+
+TEST_F(TestPendulumVectorEnv, matches_driver_integrators)
+{
+  env_config.initial_state_range = {{0.0, 0.0, 0.0, 0.0}};
+  env_config.max_episode_steps = 0U;
+  for (const auto integrator : {PendulumDriver::Integrator::BACKWARD_EULER,
+      PendulumDriver::Integrator::TRAPEZOIDAL, PendulumDriver::Integrator::VARIATIONAL})
+  {
+    const PendulumDriver::Config config{1.0, 5.0, 2.0, 20.0, -9.8, 1000.0, 0.0,
+      std::chrono::microseconds{1000}, integrator};
+    PendulumVectorEnv env{config, env_config};
+    PendulumDriver driver{config};
+    std::vector<double> actions(env_config.num_envs, 10.0);
+
+    for (std::size_t step = 0; step < 100U; step++) {
+      env.step(actions.data());
+      driver.set_controller_cart_force(10.0);
+      driver.update();
+    }
+    const auto & state = driver.get_state();
+    const double * obs = env.get_observations();
+    EXPECT_NEAR(state.cart_position, obs[0], 1e-9);
+    EXPECT_NEAR(state.cart_velocity, obs[1], 1e-9);
+    EXPECT_NEAR(state.pole_angle, obs[2], 1e-9);
+    EXPECT_NEAR(state.pole_velocity, obs[3], 1e-9);
+  }
+}
+
+TEST_F(TestPendulumVectorEnv, auto_reset)
+{
+  env_config.max_episode_steps = 0U;
+  PendulumVectorEnv env{driver_config, env_config};
+  std::vector<double> actions(env_config.num_envs, 1000.0);
+
+  bool done = false;
+  for (std::size_t step = 0; step < 10000U && !done; step++) {
+    env.step(actions.data());
+    done = env.get_dones()[0] != 0U;
+  }
+  ASSERT_TRUE(done);
+  EXPECT_EQ(0U, env.get_truncations()[0]);
+  const double * final_obs = env.get_final_observations();
+  const double * obs = env.get_observations();
+  EXPECT_GT(std::fabs(final_obs[2] - M_PI), env_config.failure_angle);
+  EXPECT_LE(std::fabs(obs[2] - M_PI), env_config.initial_state_range[2]);
+}
+
+TEST_F(TestPendulumVectorEnv, truncation)
+{
+  env_config.initial_state_range = {{0.0, 0.0, 0.0, 0.0}};
+  env_config.max_episode_steps = 5U;
+  PendulumVectorEnv env{driver_config, env_config};
+  std::vector<double> actions(env_config.num_envs, 0.0);
+
+  for (std::size_t step = 0; step < 4U; step++) {
+    env.step(actions.data());
+    EXPECT_EQ(0U, env.get_dones()[0]);
+  }
+  env.step(actions.data());
+  EXPECT_EQ(1U, env.get_dones()[0]);
+  EXPECT_EQ(1U, env.get_truncations()[0]);
+}
+
+TEST_F(TestPendulumVectorEnv, reset_mask)
+{
+  PendulumVectorEnv env{driver_config, env_config};
+  std::vector<double> actions(env_config.num_envs, 100.0);
+  env.step(actions.data());
+  const std::vector<double> stepped(
+    env.get_observations(), env.get_observations() + env_config.num_envs * 4U);
+
+  std::vector<std::uint8_t> mask(env_config.num_envs, 0U);
+  mask[1] = 1U;
+  apex_test_tools::memory_test::start();
+  env.reset(mask.data());
+  apex_test_tools::memory_test::stop();
+
+  const double * obs = env.get_observations();
+  for (std::size_t j = 0; j < 4U; j++) {
+    EXPECT_DOUBLE_EQ(stepped[j], obs[j]);
+    EXPECT_NE(stepped[4U + j], obs[4U + j]);
+  }
+}
+
+TEST_F(TestPendulumVectorEnv, domain_randomization)
+{
+  env_config.pendulum_mass_randomization = 0.2;
+  env_config.cart_mass_randomization = 0.2;
+  PendulumVectorEnv env{driver_config, env_config};
+
+  bool different = false;
+  for (std::size_t i = 0; i < env.get_num_envs(); i++) {
+    const auto & p = env.get_parameters(i);
+    EXPECT_GE(p.pendulum_mass, 0.8 * driver_config.get_pendulum_mass());
+    EXPECT_LE(p.pendulum_mass, 1.2 * driver_config.get_pendulum_mass());
+    EXPECT_GE(p.cart_mass, 0.8 * driver_config.get_cart_mass());
+    EXPECT_LE(p.cart_mass, 1.2 * driver_config.get_cart_mass());
+    EXPECT_DOUBLE_EQ(p.pendulum_length, driver_config.get_pendulum_length());
+    different = different || (p.pendulum_mass != env.get_parameters(0).pendulum_mass);
+  }
+  EXPECT_TRUE(different);
+}
+
+TEST_F(TestPendulumVectorEnv, step)
+{
+  PendulumVectorEnv env{driver_config, env_config};
+  std::vector<double> actions(env_config.num_envs, 0.0);
+  apex_test_tools::memory_test::start();
+  env.step(actions.data());
+  apex_test_tools::memory_test::stop();
+}
@@ -0,0 +1,172 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "pendulum_driver/state_bridge.hpp"
+
+using pendulum::pendulum_driver::PendulumDriver;
+using pendulum::pendulum_driver::StateBridge;
+
+namespace
+{
+constexpr std::size_t DOMAIN_ID = 42U;
+constexpr char TOPIC_NAME[] = "test_state_bridge_states";
+
+PendulumDriver::PendulumState make_state(std::size_t k)
+{
+  PendulumDriver::PendulumState state;
+  state.cart_position = 0.1 * static_cast<double>(k);
+  state.pole_angle = 0.01 * static_cast<double>(k);
+  state.cart_force = static_cast<double>(k);
+  return state;
+}
+
+StateBridge::Config make_config()
+{
+  return StateBridge::Config(
+    DOMAIN_ID, "test_state_bridge", TOPIC_NAME, std::chrono::milliseconds(10));
+}
+}  // namespace
+
+class TestStateBridge : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // the listener joins the bridge domain with its own context
+    context = std::make_shared<rclcpp::Context>();
+    rclcpp::InitOptions init_options;
+    init_options.set_domain_id(DOMAIN_ID);
+    context->init(0, nullptr, init_options);
+    rclcpp::NodeOptions node_options;
+    node_options.context(context);
+    listener = std::make_shared<rclcpp::Node>("test_state_bridge_listener", node_options);
+    state_sub = listener->create_subscription<pendulum2_msgs::msg::JointState>(
+      TOPIC_NAME, rclcpp::QoS(10),
+      [this](pendulum2_msgs::msg::JointState::SharedPtr msg) {
+        last_message = *msg;
+        num_received++;
+      });
+    rclcpp::ExecutorOptions executor_options;
+    executor_options.context = context;
+    executor = std::make_unique<rclcpp::executors::SingleThreadedExecutor>(executor_options);
+    executor->add_node(listener);
+  }
+
+  void TearDown() override
+  {
+    executor.reset();
+    state_sub.reset();
+    listener.reset();
+    context->shutdown("test finished");
+  }
+
+  bool spin_until(const std::function<bool()> & condition)
+  {
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!condition() && std::chrono::steady_clock::now() < timeout) {
+      executor->spin_some(std::chrono::milliseconds(10));
+    }
+    return condition();
+  }
+
+  std::shared_ptr<rclcpp::Context> context;
+  std::shared_ptr<rclcpp::Node> listener;
+  std::shared_ptr<rclcpp::Subscription<pendulum2_msgs::msg::JointState>> state_sub;
+  std::unique_ptr<rclcpp::executors::SingleThreadedExecutor> executor;
+  pendulum2_msgs::msg::JointState last_message;
+  std::size_t num_received = 0U;
+};
+
+TEST_F(TestStateBridge, start_stop)
+{
+  StateBridge bridge(make_config());
+  // stopping a bridge which is not running does nothing
+  bridge.stop();
+  bridge.start();
+  bridge.start();
+  bridge.stop();
+  bridge.stop();
+  // restarted after a deactivation
+  bridge.start();
+  bridge.stop();
+  // nothing was written, nothing is republished
+  EXPECT_EQ(bridge.get_num_published(), 0U);
+  EXPECT_EQ(bridge.get_num_dropped(), 0U);
+}
+
+TEST_F(TestStateBridge, publishes_latest_state)
+{
+  StateBridge bridge(make_config());
+  bridge.start();
+  // the first states may be published before the listener is discovered
+  std::size_t k = 1U;
+  ASSERT_TRUE(
+    spin_until(
+      [&]() {
+        bridge.write(make_state(k++));
+        return num_received > 0U;
+      }));
+
+  // only the last of several states written in one period is republished
+  for (std::size_t i = 0U; i < 10U; i++) {
+    bridge.write(make_state(k++));
+  }
+  const auto latest = make_state(k - 1U);
+  ASSERT_TRUE(
+    spin_until(
+      [&]() {
+        return last_message.cart_position == latest.cart_position;
+      }));
+  EXPECT_DOUBLE_EQ(last_message.pole_angle, latest.pole_angle);
+  EXPECT_DOUBLE_EQ(last_message.cart_force, latest.cart_force);
+
+  // a state is not republished again if no new one was written
+  const std::uint64_t num_published = bridge.get_num_published();
+  const auto idle_end = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+  spin_until([&]() {return std::chrono::steady_clock::now() >= idle_end;});
+  bridge.stop();
+  EXPECT_EQ(bridge.get_num_published(), num_published);
+  EXPECT_LT(num_published, k);
+  EXPECT_GE(num_published, num_received);
+}
+
+TEST_F(TestStateBridge, dropped_states)
+{
+  StateBridge bridge(make_config());
+  // without the bridge thread no write finds the buffer busy
+  for (std::size_t k = 0U; k < 1000U; k++) {
+    bridge.write(make_state(k));
+  }
+  EXPECT_EQ(bridge.get_num_dropped(), 0U);
+
+  // while the bridge thread reads, a write can be dropped, but it is always counted
+  bridge.start();
+  const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+  std::uint64_t num_written = 0U;
+  while (std::chrono::steady_clock::now() < end) {
+    bridge.write(make_state(num_written++));
+  }
+  bridge.stop();
+  EXPECT_LE(bridge.get_num_dropped(), num_written);
+  EXPECT_GT(bridge.get_num_published(), 0U);
+  const std::uint64_t num_dropped = bridge.get_num_dropped();
+  bridge.write(make_state(0U));
+  EXPECT_EQ(bridge.get_num_dropped(), num_dropped);
+}
@@ -0,0 +1,273 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief Python bindings for the pendulum simulation and controller.
+///
+///  The batched simulation buffers are exposed as read-only NumPy arrays which view the C++
+///  memory directly, the arrays keep the owning object alive. The GIL is released while the
+///  simulation is stepped.
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_driver/pendulum_vector_env.hpp"
+#include "pendulum_controller/pendulum_controller.hpp"
+
+namespace py = pybind11;
+
+using pendulum::pendulum_controller::PendulumController;
+using pendulum::pendulum_driver::PendulumDriver;
+using pendulum::pendulum_driver::PendulumVectorEnv;
+
+namespace
+{
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using FlagArray = py::array_t<std::uint8_t, py::array::c_style | py::array::forcecast>;
+
+/// \brief Creates a read-only NumPy array viewing memory owned by another python object
+template<typename T>
+py::array_t<T> make_view(const T * data, std::vector<py::ssize_t> shape, py::handle owner)
+{
+  py::array_t<T> array(shape, data, owner);
+  array.attr("setflags")(py::arg("write") = false);
+  return array;
+}
+
+py::tuple step_result(const PendulumVectorEnv & env, py::handle owner)
+{
+  const auto n = static_cast<py::ssize_t>(env.get_num_envs());
+  const auto dim = static_cast<py::ssize_t>(PendulumVectorEnv::STATE_DIM);
+  return py::make_tuple(
+    make_view(env.get_observations(), {n, dim}, owner),
+    make_view(env.get_rewards(), {n}, owner),
+    make_view(env.get_dones(), {n}, owner));
+}
+
+void check_size(const py::array & array, std::size_t expected, const char * name)
+{
+  if (static_cast<std::size_t>(array.size()) != expected) {
+    throw std::invalid_argument(std::string(name) + " has a wrong number of elements");
+  }
+}
+}  // namespace
+
+PYBIND11_MODULE(pendulum_py, m)
+{
+  m.doc() = "Python bindings for the pendulum simulation and controller";
+
+  py::class_<PendulumDriver::Config>(m, "DriverConfig")
+  .def(
+    py::init(
+      [](double pendulum_mass, double cart_mass, double pendulum_length,
+      double damping_coefficient, double gravity, double max_cart_force,
+      double noise_level, std::uint32_t physics_update_period_us,
+      const std::string & integrator) {
+        return PendulumDriver::Config(
+          pendulum_mass, cart_mass, pendulum_length, damping_coefficient, gravity,
+          max_cart_force, noise_level, std::chrono::microseconds{physics_update_period_us},
+          pendulum::pendulum_driver::integrator_from_string(integrator));
+      }),
+    py::arg("pendulum_mass") = 1.0, py::arg("cart_mass") = 5.0,
+    py::arg("pendulum_length") = 2.0, py::arg("damping_coefficient") = 20.0,
+    py::arg("gravity") = -9.8, py::arg("max_cart_force") = 1000.0,
+    py::arg("noise_level") = 1.0, py::arg("physics_update_period_us") = 1000U,
+    py::arg("integrator") = "rk4")
+  .def_property_readonly("pendulum_mass", &PendulumDriver::Config::get_pendulum_mass)
+  .def_property_readonly("cart_mass", &PendulumDriver::Config::get_cart_mass)
+  .def_property_readonly("pendulum_length", &PendulumDriver::Config::get_pendulum_length)
+  .def_property_readonly(
+    "damping_coefficient", &PendulumDriver::Config::get_damping_coefficient)
+  .def_property_readonly("gravity", &PendulumDriver::Config::get_gravity)
+  .def_property_readonly("max_cart_force", &PendulumDriver::Config::get_max_cart_force)
+  .def_property_readonly("noise_level", &PendulumDriver::Config::get_noise_level)
+  .def_property_readonly(
+    "physics_update_period_us",
+    [](const PendulumDriver::Config & c) {return c.get_physics_update_period().count();});
+
+  py::class_<PendulumDriver>(m, "Driver")
+  .def(py::init<const PendulumDriver::Config &>(), py::arg("config"))
+  .def("set_state", &PendulumDriver::set_state)
+  .def("set_controller_cart_force", &PendulumDriver::set_controller_cart_force)
+  .def("set_disturbance_force", &PendulumDriver::set_disturbance_force)
+  .def("get_controller_cart_force", &PendulumDriver::get_controller_cart_force)
+  .def("get_disturbance_force", &PendulumDriver::get_disturbance_force)
+  .def("update", &PendulumDriver::update)
+  .def("reset", &PendulumDriver::reset)
+  .def(
+    "get_state", [](const PendulumDriver & d) {
+      const auto & s = d.get_state();
+      return py::make_tuple(
+        s.cart_position, s.cart_velocity, s.pole_angle, s.pole_velocity, s.cart_force);
+    })
+  .def(
+    "run", [](PendulumDriver & d, const DoubleArray & forces) {
+      // replays a controller force sequence and records the state after each update
+      const auto steps = static_cast<std::size_t>(forces.size());
+      py::array_t<double> states({static_cast<py::ssize_t>(steps), py::ssize_t{5}});
+      const double * u = forces.data();
+      double * out = states.mutable_data();
+      {
+        py::gil_scoped_release release;
+        for (std::size_t k = 0; k < steps; k++) {
+          d.set_controller_cart_force(u[k]);
+          d.update();
+          const auto & s = d.get_state();
+          out[5 * k + 0] = s.cart_position;
+          out[5 * k + 1] = s.cart_velocity;
+          out[5 * k + 2] = s.pole_angle;
+          out[5 * k + 3] = s.pole_velocity;
+          out[5 * k + 4] = s.cart_force;
+        }
+      }
+      return states;
+    }, py::arg("forces"),
+    "Applies a sequence of controller forces, returns the states as a (steps, 5) array");
+
+  py::class_<PendulumController>(m, "Controller")
+  .def(
+    py::init(
+      [](std::vector<double> feedback_matrix) {
+        return new PendulumController(PendulumController::Config(std::move(feedback_matrix)));
+      }), py::arg("feedback_matrix"))
+  .def("reset", &PendulumController::reset)
+  .def("update", &PendulumController::update)
+  .def(
+    "set_teleop",
+    py::overload_cast<double, double, double, double>(&PendulumController::set_teleop))
+  .def("set_teleop", py::overload_cast<double, double>(&PendulumController::set_teleop))
+  .def("set_state", &PendulumController::set_state)
+  .def("set_force_command", &PendulumController::set_force_command)
+  .def("get_teleop", &PendulumController::get_teleop)
+  .def("get_state", &PendulumController::get_state)
+  .def("get_force_command", &PendulumController::get_force_command);
+
+  py::class_<PendulumVectorEnv::Config>(m, "VectorEnvConfig")
+  .def(py::init<>())
+  .def_readwrite("num_envs", &PendulumVectorEnv::Config::num_envs)
+  .def_readwrite("max_episode_steps", &PendulumVectorEnv::Config::max_episode_steps)
+  .def_readwrite("failure_angle", &PendulumVectorEnv::Config::failure_angle)
+  .def_readwrite("failure_position", &PendulumVectorEnv::Config::failure_position)
+  .def_readwrite("initial_state_range", &PendulumVectorEnv::Config::initial_state_range)
+  .def_readwrite(
+    "pendulum_mass_randomization", &PendulumVectorEnv::Config::pendulum_mass_randomization)
+  .def_readwrite("cart_mass_randomization", &PendulumVectorEnv::Config::cart_mass_randomization)
+  .def_readwrite(
+    "pendulum_length_randomization", &PendulumVectorEnv::Config::pendulum_length_randomization)
+  .def_readwrite(
+    "damping_coefficient_randomization",
+    &PendulumVectorEnv::Config::damping_coefficient_randomization)
+  .def_readwrite("angle_weight", &PendulumVectorEnv::Config::angle_weight)
+  .def_readwrite("position_weight", &PendulumVectorEnv::Config::position_weight)
+  .def_readwrite("force_weight", &PendulumVectorEnv::Config::force_weight)
+  .def_readwrite("seed", &PendulumVectorEnv::Config::seed);
+
+  py::class_<PendulumVectorEnv>(m, "VectorEnv")
+  .def(
+    py::init<const PendulumDriver::Config &, const PendulumVectorEnv::Config &>(),
+    py::arg("driver_config"), py::arg("config"))
+  .def_property_readonly("num_envs", &PendulumVectorEnv::get_num_envs)
+  .def_property_readonly(
+    "observations", [](py::object self) {
+      const auto & env = self.cast<const PendulumVectorEnv &>();
+      return make_view(
+        env.get_observations(),
+        {static_cast<py::ssize_t>(env.get_num_envs()),
+          static_cast<py::ssize_t>(PendulumVectorEnv::STATE_DIM)}, self);
+    }, "Read-only (num_envs, 4) view of the current observations")
+  .def_property_readonly(
+    "final_observations", [](py::object self) {
+      const auto & env = self.cast<const PendulumVectorEnv &>();
+      return make_view(
+        env.get_final_observations(),
+        {static_cast<py::ssize_t>(env.get_num_envs()),
+          static_cast<py::ssize_t>(PendulumVectorEnv::STATE_DIM)}, self);
+    }, "Read-only (num_envs, 4) view of the observations before the automatic reset")
+  .def_property_readonly(
+    "truncations", [](py::object self) {
+      const auto & env = self.cast<const PendulumVectorEnv &>();
+      return make_view(
+        env.get_truncations(), {static_cast<py::ssize_t>(env.get_num_envs())}, self);
+    })
+  .def(
+    "reset", [](py::object self, py::object mask) {
+      auto & env = self.cast<PendulumVectorEnv &>();
+      if (mask.is_none()) {
+        py::gil_scoped_release release;
+        env.reset();
+      } else {
+        const auto flags = mask.cast<FlagArray>();
+        check_size(flags, env.get_num_envs(), "mask");
+        py::gil_scoped_release release;
+        env.reset(flags.data());
+      }
+      const auto n = static_cast<py::ssize_t>(env.get_num_envs());
+      const auto dim = static_cast<py::ssize_t>(PendulumVectorEnv::STATE_DIM);
+      return make_view(env.get_observations(), {n, dim}, self);
+    }, py::arg("mask") = py::none(),
+    "Resets the instances selected by mask (all if None), returns the observations")
+  .def(
+    "step", [](py::object self, const DoubleArray & actions) {
+      auto & env = self.cast<PendulumVectorEnv &>();
+      check_size(actions, env.get_num_envs(), "actions");
+      {
+        py::gil_scoped_release release;
+        env.step(actions.data());
+      }
+      return step_result(env, self);
+    }, py::arg("actions"),
+    "Steps all the instances, returns (observations, rewards, dones) views")
+  .def(
+    "step_linear_feedback", [](py::object self, const DoubleArray & feedback_matrix,
+    std::size_t steps) {
+      // same control law as PendulumController around the up position, evaluated in C++
+      auto & env = self.cast<PendulumVectorEnv &>();
+      check_size(feedback_matrix, PendulumVectorEnv::STATE_DIM, "feedback_matrix");
+      const double * K = feedback_matrix.data();
+      std::vector<double> actions(env.get_num_envs());
+      {
+        py::gil_scoped_release release;
+        for (std::size_t k = 0; k < steps; k++) {
+          const double * obs = env.get_observations();
+          for (std::size_t i = 0; i < actions.size(); i++) {
+            const double * x = &obs[i * PendulumVectorEnv::STATE_DIM];
+            actions[i] = -(K[0] * x[0] + K[1] * x[1] + K[2] * (x[2] - M_PI) + K[3] * x[3]);
+          }
+          env.step(actions.data());
+        }
+      }
+      return step_result(env, self);
+    }, py::arg("feedback_matrix"), py::arg("steps") = 1U,
+    "Steps all the instances with a full state feedback law, returns the last step result")
+  .def(
+    "get_parameters", [](const PendulumVectorEnv & env, std::size_t index) {
+      const auto & p = env.get_parameters(index);
+      py::dict d;
+      d["pendulum_mass"] = p.pendulum_mass;
+      d["cart_mass"] = p.cart_mass;
+      d["pendulum_length"] = p.pendulum_length;
+      d["damping_coefficient"] = p.damping_coefficient;
+      d["gravity"] = p.gravity;
+      return d;
+    }, py::arg("index"));
+}
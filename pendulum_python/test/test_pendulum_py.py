@@ -0,0 +1,89 @@
+# Copyright 2021 Carlos San Vicente
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import math
+
+import numpy as np
+import pendulum_py
+import pytest
+
+FEEDBACK_MATRIX = [-10.0000, -51.5393, 356.8637, 154.4146]
+
+
+def make_env(num_envs=8, max_episode_steps=1000):
+    driver_config = pendulum_py.DriverConfig(noise_level=0.0)
+    config = pendulum_py.VectorEnvConfig()
+    config.num_envs = num_envs
+    config.max_episode_steps = max_episode_steps
+    return pendulum_py.VectorEnv(driver_config, config)
+
+
+def test_observations_are_views():
+    env = make_env()
+    obs = env.observations
+    assert obs.shape == (8, 4)
+    assert not obs.flags.writeable
+    assert not obs.flags.owndata
+    before = obs.copy()
+    env.step(np.zeros(8))
+    # the view follows the simulation without being requested again
+    assert not np.array_equal(before, obs)
+
+
+def test_step_result():
+    env = make_env()
+    obs, rewards, dones = env.step(np.zeros(8))
+    assert obs.shape == (8, 4)
+    assert rewards.shape == (8,)
+    assert dones.shape == (8,)
+    assert np.all(rewards <= 0.0)
+
+
+def test_wrong_action_size():
+    env = make_env()
+    with pytest.raises(ValueError):
+        env.step(np.zeros(3))
+
+
+def test_reset_mask():
+    env = make_env()
+    env.step(np.full(8, 100.0))
+    before = env.observations.copy()
+    mask = np.zeros(8, dtype=np.uint8)
+    mask[1] = 1
+    obs = env.reset(mask)
+    assert np.array_equal(before[0], obs[0])
+    assert not np.array_equal(before[1], obs[1])
+
+
+def test_linear_feedback_balances():
+    env = make_env(max_episode_steps=0)
+    obs, _, dones = env.step_linear_feedback(np.array(FEEDBACK_MATRIX), steps=2000)
+    assert not np.any(dones)
+    assert np.all(np.abs(obs[:, 2] - math.pi) < 0.05)
+
+
+def test_controller():
+    controller = pendulum_py.Controller(FEEDBACK_MATRIX)
+    controller.set_state(0.0, 0.0, math.pi + 0.1, 0.0)
+    controller.update()
+    assert controller.get_force_command() == pytest.approx(-FEEDBACK_MATRIX[2] * 0.1)
+
+
+def test_driver_run():
+    driver = pendulum_py.Driver(pendulum_py.DriverConfig(noise_level=0.0))
+    states = driver.run(np.full(100, 10.0))
+    assert states.shape == (100, 5)
+    assert states[-1, 0] > 0.0
+    assert states[-1, 4] == pytest.approx(10.0)
@@ -0,0 +1,124 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides an offline closed-loop simulation of the pendulum driver and
+///        controller, used to evaluate controller gains without ROS communication.
+
+#ifndef PENDULUM_TOOLS__CLOSED_LOOP_ROLLOUT_HPP_
+#define PENDULUM_TOOLS__CLOSED_LOOP_ROLLOUT_HPP_
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_controller/pendulum_controller.hpp"
+#include "pendulum_tools/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+/// Initial condition and disturbance profile used in a closed-loop rollout.
+struct Scenario
+{
+  // Initial state: cart position, cart velocity, pole angle, pole velocity
+  std::array<double, 4> initial_state{{0.0, 0.0, M_PI, 0.0}};
+  // Force applied by the disturbance in Newton
+  double disturbance_force = 0.0;
+  // Time when the disturbance starts in seconds
+  double disturbance_start = 0.0;
+  // Duration of the disturbance in seconds
+  double disturbance_duration = 0.0;
+};
+
+/// Weights of the terms combined in the rollout cost.
+struct CostWeights
+{
+  // Weight of the integral of the squared cart position and pole angle error
+  double state_error = 1.0;
+  // Weight of the integral of the squared cart force
+  double control_effort = 1e-5;
+  // Weight of the settling time
+  double settling_time = 0.1;
+};
+
+/// Cost terms measured in a single rollout.
+struct RolloutResult
+{
+  // Integral of the squared error (ISE)
+  double ise = 0.0;
+  // Integral of the squared cart force
+  double effort = 0.0;
+  // Last time the state was out of the settling band in seconds
+  double settling_time = 0.0;
+  // True if the pole fell down during the rollout
+  bool failed = false;
+  // Weighted total cost
+  double cost = 0.0;
+};
+
+/// \class This class runs a PendulumDriver and a PendulumController in a closed loop
+///        without ROS communication to measure the performance of a feedback matrix.
+///
+///  The driver and the controller are stepped in lock-step, one controller update per
+///  physics update, which mirrors the pendulum_demo data flow with zero communication delay.
+class PENDULUM_TOOLS_PUBLIC ClosedLoopRollout
+{
+public:
+  /// \brief Constructor
+  /// \param[in] driver_config Driver configuration used for all the rollouts
+  /// \param[in] duration Simulated time for each rollout in seconds
+  /// \param[in] weights Weights used to compute the rollout cost
+  ClosedLoopRollout(
+    const pendulum_driver::PendulumDriver::Config & driver_config,
+    double duration,
+    const CostWeights & weights);
+
+  /// \brief Runs a closed-loop simulation for a single scenario
+  /// \param[in] feedback_matrix Controller feedback matrix to evaluate
+  /// \param[in] scenario Initial condition and disturbance profile
+  /// \return Measured cost terms
+  RolloutResult run(const std::vector<double> & feedback_matrix, const Scenario & scenario) const;
+
+  /// \brief Runs a closed-loop simulation for several scenarios and accumulates the costs
+  /// \param[in] feedback_matrix Controller feedback matrix to evaluate
+  /// \param[in] scenarios Initial conditions and disturbance profiles
+  /// \return Accumulated cost terms
+  RolloutResult run(
+    const std::vector<double> & feedback_matrix,
+    const std::vector<Scenario> & scenarios) const;
+
+  /// \brief Gets the default set of scenarios used to tune the controller
+  /// \return Scenarios with initial pole deviations and pushes in both directions
+  static std::vector<Scenario> default_scenarios();
+
+private:
+  const pendulum_driver::PendulumDriver::Config driver_config_;
+  const double duration_;
+  const CostWeights weights_;
+  // penalty added to the cost when the pole falls down
+  static constexpr double FAILURE_COST = 1e6;
+  // pole angle deviation considered as fallen in radians
+  static constexpr double FAILURE_ANGLE = M_PI_2;
+  // settling band for the pole angle in radians
+  static constexpr double SETTLING_ANGLE = 0.02;
+  // settling band for the cart position in meters
+  static constexpr double SETTLING_POSITION = 0.05;
+};
+}  // namespace pendulum_tools
+}  // namespace pendulum
+
+#endif  // PENDULUM_TOOLS__CLOSED_LOOP_ROLLOUT_HPP_
@@ -0,0 +1,156 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_TOOLS__COMMAND_LINE_HPP_
+#define PENDULUM_TOOLS__COMMAND_LINE_HPP_
+
+#include <cstddef>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rcutils/cmdline_parser.h"
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+/// \class This class reads the options of the command line tools.
+///
+///  The options are given as "--name value". The values are converted to the type of the setting
+///  they are read into, which keeps its default if the option is not given.
+class CommandLine
+{
+public:
+  /// \brief Constructor
+  /// \param[in] argc Number of arguments
+  /// \param[in] argv Arguments
+  /// \param[in] usage Text printed by print_usage
+  CommandLine(int argc, char * argv[], const char * usage)
+  : begin_{argv}, end_{argv + argc}, usage_{usage}
+  {}
+
+  /// \brief Prints the usage if -h is given
+  /// \return True if the usage was printed and the tool should exit
+  bool print_usage_if_requested() const
+  {
+    if (!has("-h")) {
+      return false;
+    }
+    std::printf("%s", usage_);
+    return true;
+  }
+
+  /// \brief Gets if a flag or an option is given
+  /// \param[in] option Option name
+  /// \return True if it is given
+  bool has(const char * option) const
+  {
+    return rcutils_cli_option_exist(begin_, end_, option);
+  }
+
+  /// \brief Reads a text option
+  /// \param[in] option Option name
+  /// \param[out] value Option value, unchanged if the option is not given
+  /// \return True if the option is given with a value
+  bool get(const char * option, std::string & value) const
+  {
+    if (!has(option)) {
+      return false;
+    }
+    const char * arg = rcutils_cli_get_option(begin_, end_, option);
+    if (arg == nullptr) {
+      return false;
+    }
+    value = arg;
+    return true;
+  }
+
+  /// \brief Reads a number option
+  /// \throw std::invalid_argument If the value is not a number
+  bool get(const char * option, double & value) const
+  {
+    std::string text;
+    if (!get(option, text)) {
+      return false;
+    }
+    value = to_double(option, text);
+    return true;
+  }
+
+  /// \brief Reads a count option
+  /// \throw std::invalid_argument If the value is not a non negative integer
+  bool get(const char * option, std::size_t & value) const
+  {
+    std::string text;
+    if (!get(option, text)) {
+      return false;
+    }
+    std::size_t end = 0U;
+    try {
+      if (!text.empty() && text[0] != '-') {
+        value = std::stoul(text, &end);
+      }
+    } catch (const std::exception &) {
+      end = 0U;
+    }
+    if (end == 0U || end != text.size()) {
+      throw std::invalid_argument(std::string("invalid value for ") + option + ": " + text);
+    }
+    return true;
+  }
+
+  /// \brief Reads a comma separated list of numbers
+  /// \throw std::invalid_argument If an element is not a number
+  bool get(const char * option, std::vector<double> & values) const
+  {
+    std::string text;
+    if (!get(option, text)) {
+      return false;
+    }
+    values.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+      values.push_back(to_double(option, item));
+    }
+    return true;
+  }
+
+private:
+  static double to_double(const char * option, const std::string & text)
+  {
+    std::size_t end = 0U;
+    double value = 0.0;
+    try {
+      value = std::stod(text, &end);
+    } catch (const std::exception &) {
+      end = 0U;
+    }
+    if (end == 0U || end != text.size()) {
+      throw std::invalid_argument(std::string("invalid value for ") + option + ": " + text);
+    }
+    return value;
+  }
+
+  char ** begin_;
+  char ** end_;
+  const char * usage_;
+};
+}  // namespace pendulum_tools
+}  // namespace pendulum
+
+#endif  // PENDULUM_TOOLS__COMMAND_LINE_HPP_
@@ -0,0 +1,95 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the offline generator of the explicit MPC law.
+
+#ifndef PENDULUM_TOOLS__EXPLICIT_MPC_BUILDER_HPP_
+#define PENDULUM_TOOLS__EXPLICIT_MPC_BUILDER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "pendulum_controller/explicit_mpc_table.hpp"
+#include "pendulum_driver/cart_pole_model.hpp"
+#include "pendulum_tools/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+/// \class This class computes the explicit solution of a force constrained MPC.
+///
+///  The cart-pole is linearized around the up position and discretized with a zero-order hold
+///  at the controller period. The MPC minimizes the quadratic state and force cost over the
+///  horizon, with the discrete LQR cost as terminal cost, subject to |u| <= max_force. The
+///  optimal first force is a piecewise-affine function of the state error, with one region per
+///  set of saturated forces along the horizon. All the 3^horizon sets are enumerated, the
+///  empty ones are discarded with a linear program and the lookup grid of the table stores the
+///  regions intersecting each cell.
+class PENDULUM_TOOLS_PUBLIC ExplicitMpcBuilder
+{
+public:
+  using State = std::array<double, 4>;
+
+  /// Generator configuration parameters.
+  struct Config
+  {
+    /// number of predicted steps, the number of candidate regions grows as 3^horizon
+    std::size_t horizon = 4U;
+    /// controller period in seconds, the state publish period of the driver
+    double sample_period = 0.01;
+    /// state error weights: cart position, cart velocity, pole angle, pole velocity
+    State state_weights{{1.0, 1.0, 1.0, 1.0}};
+    /// force weight
+    double force_weight = 1e-2;
+    /// force limit in Newton, should match driver.max_cart_force
+    double max_force = 1000.0;
+    /// bounds of the state error region covered by the lookup grid
+    State grid_lower{{-2.0, -4.0, -0.5, -2.0}};
+    State grid_upper{{2.0, 4.0, 0.5, 2.0}};
+    /// number of grid cells per state dimension
+    std::size_t grid_cells = 6U;
+  };
+
+  /// \brief Constructor
+  /// \param[in] params Model parameters
+  /// \param[in] config Generator configuration
+  /// \throw std::invalid_argument If the configuration is not consistent
+  ExplicitMpcBuilder(const pendulum_driver::CartPoleParameters & params, const Config & config);
+
+  /// \brief Computes the explicit MPC table
+  /// \return Table ready to be stored and loaded by the controller
+  pendulum_controller::ExplicitMpcTable build() const;
+
+  /// \brief Solves the MPC problem online, used to validate the table
+  /// \param[in] error State error: cart position, cart velocity, pole angle, pole velocity
+  /// \return Optimal first force in Newton
+  double solve_online(const State & error) const;
+
+  /// \brief Gets the unconstrained feedback gain, u = gain * error
+  /// \return Gain, the negative of an equivalent controller.feedback_matrix
+  State get_unconstrained_gain() const;
+
+private:
+  const Config cfg_;
+  // condensed problem: minimize U' * H * U / 2 + (G * error)' * U, |U| <= max_force
+  std::vector<double> H_;
+  std::vector<double> G_;
+};
+}  // namespace pendulum_tools
+}  // namespace pendulum
+
+#endif  // PENDULUM_TOOLS__EXPLICIT_MPC_BUILDER_HPP_
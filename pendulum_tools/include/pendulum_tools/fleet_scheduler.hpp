@@ -0,0 +1,136 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides a scheduler running many simulated pendulums from one thread.
+
+#ifndef PENDULUM_TOOLS__FLEET_SCHEDULER_HPP_
+#define PENDULUM_TOOLS__FLEET_SCHEDULER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_utils/timing_wheel.hpp"
+#include "pendulum_tools/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+/// \class This class updates a fleet of PendulumDriver instances from a single thread.
+///
+///  Every instance has its own update rate and a timer in a hierarchical timing wheel, so
+///  scheduling the next update and finding the expired instances do not depend on the fleet
+///  size. The thread sleeps until the next expiry and serves all the instances expiring in the
+///  same tick in one wake-up. The first updates are spread over the period of every instance to
+///  avoid bursts. An instance that is late by a full period or more is counted as an overrun
+///  and updated in the next tick, without skipping the missed update.
+///
+///  The measured busy time gives the number of instances with the same rate mix that fit in
+///  one core for a target utilization.
+class PENDULUM_TOOLS_PUBLIC FleetScheduler
+{
+public:
+  /// Scheduler configuration parameters.
+  struct Config
+  {
+    /// number of simulated pendulums
+    std::size_t instances = 1000U;
+    /// update rates in Hz, assigned to the instances round robin
+    std::vector<double> rates{1000.0, 500.0, 100.0};
+    /// timing wheel resolution, the update periods are rounded to it
+    std::chrono::nanoseconds tick{std::chrono::microseconds(100)};
+    /// run duration in seconds
+    double duration = 5.0;
+    /// sleep until the expiries, otherwise the time is simulated and the updates run as fast
+    /// as possible
+    bool realtime = true;
+    /// core utilization used to compute the capacity
+    double target_utilization = 0.7;
+  };
+
+  /// Run statistics.
+  struct Result
+  {
+    std::uint64_t num_updates;
+    /// number of times the thread woke up to serve expired timers
+    std::uint64_t num_wakeups;
+    /// number of times the thread woke up only to cascade timers to a finer level of the wheel
+    std::uint64_t num_cascades;
+    /// number of updates started a full period or more after their expiry
+    std::uint64_t num_overruns;
+    /// maximum delay between an expiry and the update, in seconds
+    double max_lateness;
+    /// time spent updating the instances, in seconds
+    double busy_time;
+    /// scheduled time covered by the run, in seconds
+    double scheduled_time;
+    /// busy time divided by the scheduled time
+    double utilization;
+    /// mean busy time per update, in seconds
+    double cost_per_update;
+    /// number of instances with the same rate mix that fit in one core
+    double instances_per_core;
+  };
+
+  /// \brief Constructor
+  /// \param[in] driver_config Driver configuration, the physics update period is replaced by
+  ///  the period of every instance
+  /// \param[in] config Scheduler configuration
+  /// \throw std::invalid_argument If the configuration is not consistent
+  FleetScheduler(
+    const pendulum_driver::PendulumDriver::Config & driver_config,
+    const Config & config);
+
+  /// \brief Runs the fleet for the configured duration
+  /// \return Run statistics
+  Result run();
+
+  /// \brief Gets the number of updates done by an instance in the last run
+  /// \param[in] index Instance index
+  /// \return Number of updates
+  std::uint64_t get_num_updates(std::size_t index) const;
+
+  /// \brief Gets an instance
+  /// \param[in] index Instance index
+  /// \return Driver
+  const pendulum_driver::PendulumDriver & get_driver(std::size_t index) const;
+
+  /// \brief Gets the update period of an instance in ticks
+  /// \param[in] index Instance index
+  /// \return Period in ticks
+  std::uint64_t get_period_ticks(std::size_t index) const;
+
+private:
+  struct Instance
+  {
+    std::unique_ptr<pendulum_driver::PendulumDriver> driver;
+    utils::TimingWheel::Timer timer;
+    std::uint64_t period_ticks;
+    std::uint64_t num_updates;
+  };
+
+  Config config_;
+  std::vector<Instance> instances_;
+  // mean update rate of the instances in Hz
+  double mean_rate_;
+};
+}  // namespace pendulum_tools
+}  // namespace pendulum
+
+#endif  // PENDULUM_TOOLS__FLEET_SCHEDULER_HPP_
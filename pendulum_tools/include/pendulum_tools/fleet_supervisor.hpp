@@ -0,0 +1,128 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides the core partitioning and the metrics aggregation used to run a
+///        fleet of pendulum_demo processes.
+
+#ifndef PENDULUM_TOOLS__FLEET_SUPERVISOR_HPP_
+#define PENDULUM_TOOLS__FLEET_SUPERVISOR_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pendulum_tools/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+/// \brief Splits the cores of a machine in disjoint sets, one per instance
+///
+///  The first cores are reserved for the operating system, interrupts and the supervisor. The
+///  remaining cores are split in contiguous sets of the same size, the cores left over are not
+///  used.
+/// \param[in] num_cores Number of cores of the machine
+/// \param[in] reserved_cores Number of cores not assigned to any instance
+/// \param[in] instances Number of instances
+/// \return Cores of every instance
+/// \throw std::invalid_argument If every instance can not get at least one core
+PENDULUM_TOOLS_PUBLIC
+std::vector<std::vector<std::size_t>> partition_cores(
+  std::size_t num_cores,
+  std::size_t reserved_cores,
+  std::size_t instances);
+
+/// \brief Formats a core set as a cpu list, e.g. "4-7"
+/// \param[in] cores Cores in increasing order
+/// \return Cpu list
+PENDULUM_TOOLS_PUBLIC
+std::string format_cpu_list(const std::vector<std::size_t> & cores);
+
+/// Statistics of a message period, as reported by the ROS 2 topic statistics.
+struct PeriodStatistics
+{
+  double average = 0.0;
+  double minimum = 0.0;
+  double maximum = 0.0;
+  double standard_deviation = 0.0;
+  std::uint64_t sample_count = 0U;
+};
+
+/// \class This class aggregates the topic statistics windows reported by the instances of a
+/// fleet.
+///
+///  The windows of every instance and source are merged in running statistics: the averages
+///  and standard deviations are pooled weighted by the sample counts, and the extremes are kept.
+///  The fleet statistics merge all the instances.
+class PENDULUM_TOOLS_PUBLIC FleetMetrics
+{
+public:
+  /// Statistics sources of every instance
+  enum Source : std::size_t
+  {
+    /// command period measured by the driver
+    DRIVER = 0U,
+    /// state period measured by the controller
+    CONTROLLER,
+    NUM_SOURCES
+  };
+
+  /// \brief Constructor
+  /// \param[in] instances Number of instances
+  explicit FleetMetrics(std::size_t instances);
+
+  /// \brief Adds a statistics window, empty windows are ignored
+  /// \param[in] instance Instance index
+  /// \param[in] source Statistics source
+  /// \param[in] window Statistics of the window
+  void add(std::size_t instance, Source source, const PeriodStatistics & window);
+
+  /// \brief Gets the statistics of an instance
+  /// \param[in] instance Instance index
+  /// \param[in] source Statistics source
+  /// \return Merged statistics of all the windows received
+  const PeriodStatistics & get(std::size_t instance, Source source) const;
+
+  /// \brief Gets the statistics of the whole fleet
+  /// \param[in] source Statistics source
+  /// \return Merged statistics of all the instances
+  PeriodStatistics get_fleet(Source source) const;
+
+  /// \brief Gets the instance with the largest maximum period
+  /// \param[in] source Statistics source
+  /// \return Instance index
+  std::size_t get_worst_instance(Source source) const;
+
+  /// \brief Gets the number of instances that did not report any statistics
+  /// \param[in] source Statistics source
+  /// \return Number of silent instances
+  std::size_t get_num_silent(Source source) const;
+
+  /// \brief Merges the statistics of two sets of samples
+  /// \param[in] a First statistics
+  /// \param[in] b Second statistics
+  /// \return Statistics of the union
+  static PeriodStatistics merge(const PeriodStatistics & a, const PeriodStatistics & b);
+
+private:
+  std::vector<std::array<PeriodStatistics, NUM_SOURCES>> instances_;
+};
+}  // namespace pendulum_tools
+}  // namespace pendulum
+
+#endif  // PENDULUM_TOOLS__FLEET_SUPERVISOR_HPP_
@@ -0,0 +1,111 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides a parallel optimizer for the controller feedback matrix.
+
+#ifndef PENDULUM_TOOLS__GAIN_TUNER_HPP_
+#define PENDULUM_TOOLS__GAIN_TUNER_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "pendulum_tools/closed_loop_rollout.hpp"
+#include "pendulum_tools/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+/// \class This class tunes the controller feedback matrix using the
+/// <a href="https://en.wikipedia.org/wiki/Cross-entropy_method">cross-entropy method</a>.
+///
+///  Every iteration samples a population of candidate gain vectors from a diagonal gaussian,
+///  evaluates them with closed-loop rollouts over all the scenarios in parallel threads and
+///  refits the distribution to the elite candidates.
+class PENDULUM_TOOLS_PUBLIC GainTuner
+{
+public:
+  /// Optimizer configuration parameters.
+  struct Config
+  {
+    /// number of optimizer iterations
+    std::size_t iterations = 40U;
+    /// number of candidates evaluated per iteration
+    std::size_t population = 64U;
+    /// number of best candidates used to refit the distribution
+    std::size_t elite = 8U;
+    /// number of worker threads, 0 uses the hardware concurrency
+    std::size_t threads = 0U;
+    /// weight of the new elite statistics when the distribution is refitted
+    double smoothing = 0.7;
+    /// initial standard deviation relative to the initial gains
+    double initial_relative_std = 0.5;
+    /// seed for the candidate sampling
+    std::uint32_t seed = 42U;
+  };
+
+  /// Result of a single optimizer iteration.
+  struct IterationReport
+  {
+    std::size_t iteration;
+    double best_cost;
+    double elite_mean_cost;
+    std::vector<double> best_gains;
+  };
+
+  /// \brief Constructor
+  /// \param[in] rollout Closed-loop rollout used to evaluate the candidates, copied
+  /// \param[in] scenarios Scenarios evaluated for every candidate
+  /// \param[in] config Optimizer configuration
+  /// \throw std::invalid_argument If the configuration is not consistent
+  GainTuner(
+    const ClosedLoopRollout & rollout,
+    std::vector<Scenario> scenarios,
+    const Config & config);
+
+  /// \brief Runs the optimization
+  /// \param[in] initial_gains Initial mean of the search distribution
+  /// \param[in] on_iteration Optional callback called after each iteration
+  /// \return Best feedback matrix found
+  std::vector<double> tune(
+    const std::vector<double> & initial_gains,
+    const std::function<void(const IterationReport &)> & on_iteration = nullptr) const;
+
+  /// \brief Evaluates a feedback matrix over all the scenarios
+  /// \param[in] gains Feedback matrix to evaluate
+  /// \return Accumulated cost terms
+  RolloutResult evaluate(const std::vector<double> & gains) const;
+
+  /// \brief Formats a feedback matrix as a pendulum_controller parameter file fragment
+  /// \param[in] gains Feedback matrix
+  /// \return YAML text ready to paste in pendulum.param.yaml
+  static std::string to_param_yaml(const std::vector<double> & gains);
+
+private:
+  /// \brief Evaluates all candidates in parallel and stores their total cost
+  void evaluate_population(
+    const std::vector<std::vector<double>> & candidates,
+    std::vector<double> & costs) const;
+
+  const ClosedLoopRollout rollout_;
+  const std::vector<Scenario> scenarios_;
+  const Config cfg_;
+};
+}  // namespace pendulum_tools
+}  // namespace pendulum
+
+#endif  // PENDULUM_TOOLS__GAIN_TUNER_HPP_
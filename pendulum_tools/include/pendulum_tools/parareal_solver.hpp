@@ -0,0 +1,137 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief This file provides a parallel-in-time solver for long open-loop simulations.
+
+#ifndef PENDULUM_TOOLS__PARAREAL_SOLVER_HPP_
+#define PENDULUM_TOOLS__PARAREAL_SOLVER_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "pendulum_driver/cart_pole_model.hpp"
+#include "pendulum_tools/visibility_control.hpp"
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+/// \class This class integrates an open-loop cart-pole trajectory with the
+/// <a href="https://en.wikipedia.org/wiki/Parareal">Parareal</a> algorithm.
+///
+///  The simulation interval is split in time slices. A cheap coarse propagator sweeps
+///  sequentially over the slices to predict their initial states, and the fine propagator, the
+///  same RK4 step used by the PendulumDriver, integrates all the slices in parallel threads from
+///  the predicted states. Every iteration corrects the predictions with the difference between
+///  the fine and the coarse results until the slice initial states stop changing. After k
+///  iterations the first k slices are exact, so the result matches the sequential simulation
+///  within the tolerance and the speedup is roughly slices / iterations.
+///
+///  The applied forces are given per fine step, e.g. recorded from a previous run, so the
+///  solver only applies to open-loop and replay scenarios.
+class PENDULUM_TOOLS_PUBLIC PararealSolver
+{
+public:
+  using State = std::array<double, 4>;
+
+  /// Solver configuration parameters.
+  struct Config
+  {
+    /// number of time slices, 0 uses 4 slices per worker thread
+    std::size_t slices = 0U;
+    /// number of worker threads, 0 uses the hardware concurrency
+    std::size_t threads = 0U;
+    /// maximum number of corrections
+    std::size_t max_iterations = 20U;
+    /// maximum change of the slice initial states to consider the solution converged
+    double tolerance = 1e-9;
+    /// number of fine steps covered by one coarse RK4 step
+    std::size_t coarse_ratio = 20U;
+    /// store the state after every fine step in the result
+    bool store_trajectory = true;
+  };
+
+  /// Convergence information of a single correction.
+  struct IterationReport
+  {
+    std::size_t iteration;
+    /// maximum change of the slice initial states
+    double max_correction;
+    /// number of slices whose initial state is exact
+    std::size_t converged_slices;
+  };
+
+  /// Solver result.
+  struct Result
+  {
+    /// state after the last fine step
+    State final_state;
+    /// cart position, cart velocity, pole angle and pole velocity after every fine step,
+    /// starting with the initial state, empty if the trajectory is not stored
+    std::vector<double> trajectory;
+    /// number of corrections done
+    std::size_t iterations;
+    /// maximum change of the slice initial states in the last correction
+    double max_correction;
+    bool converged;
+  };
+
+  /// \brief Constructor
+  /// \param[in] params Model parameters
+  /// \param[in] fine_step Fine propagator step, the period at which the forces are given
+  /// \param[in] config Solver configuration
+  /// \throw std::invalid_argument If the configuration is not consistent
+  PararealSolver(
+    const pendulum_driver::CartPoleParameters & params,
+    std::chrono::microseconds fine_step,
+    const Config & config);
+
+  /// \brief Integrates the trajectory in parallel
+  /// \param[in] initial_state Initial cart position, cart velocity, pole angle, pole velocity
+  /// \param[in] forces Force applied to the cart during each fine step
+  /// \param[in] on_iteration Optional callback called after each correction
+  /// \return Solution and convergence information
+  Result solve(
+    const State & initial_state,
+    const std::vector<double> & forces,
+    const std::function<void(const IterationReport &)> & on_iteration = nullptr) const;
+
+  /// \brief Integrates the trajectory sequentially with the fine propagator
+  /// \param[in] initial_state Initial cart position, cart velocity, pole angle, pole velocity
+  /// \param[in] forces Force applied to the cart during each fine step
+  /// \return State after the last fine step
+  State solve_sequential(const State & initial_state, const std::vector<double> & forces) const;
+
+private:
+  /// \brief Integrates fine steps [begin, end) from the given state
+  void fine_propagate(
+    State & y, const std::vector<double> & forces,
+    std::size_t begin, std::size_t end, double * trajectory) const;
+
+  /// \brief Integrates the fine steps [begin, end) with coarse steps using the mean force
+  void coarse_propagate(
+    State & y, const std::vector<double> & forces, std::size_t begin, std::size_t end) const;
+
+  const pendulum_driver::CartPoleParameters params_;
+  const double dt_;
+  const Config cfg_;
+};
+}  // namespace pendulum_tools
+}  // namespace pendulum
+
+#endif  // PENDULUM_TOOLS__PARAREAL_SOLVER_HPP_
@@ -0,0 +1,132 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_tools/closed_loop_rollout.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+using pendulum_controller::PendulumController;
+using pendulum_driver::PendulumDriver;
+
+ClosedLoopRollout::ClosedLoopRollout(
+  const PendulumDriver::Config & driver_config,
+  double duration,
+  const CostWeights & weights)
+: driver_config_(driver_config),
+  duration_(duration),
+  weights_(weights)
+{
+  if (duration_ <= 0.0) {
+    throw std::invalid_argument("rollout duration must be positive");
+  }
+}
+
+RolloutResult ClosedLoopRollout::run(
+  const std::vector<double> & feedback_matrix,
+  const Scenario & scenario) const
+{
+  PendulumDriver driver{driver_config_};
+  PendulumController controller{PendulumController::Config{feedback_matrix}};
+  driver.reset();
+  controller.reset();
+  driver.set_state(
+    scenario.initial_state[0], scenario.initial_state[1],
+    scenario.initial_state[2], scenario.initial_state[3]);
+
+  const double dt = driver_config_.get_physics_update_period().count() / (1000.0 * 1000.0);
+  const double disturbance_end = scenario.disturbance_start + scenario.disturbance_duration;
+  const auto steps = static_cast<std::size_t>(duration_ / dt);
+
+  RolloutResult result;
+  for (std::size_t step = 0U; step < steps; step++) {
+    const double t = static_cast<double>(step) * dt;
+    const auto & state = driver.get_state();
+
+    controller.set_state(
+      state.cart_position, state.cart_velocity,
+      state.pole_angle, state.pole_velocity);
+    controller.update();
+    driver.set_controller_cart_force(controller.get_force_command());
+    const bool disturbed = (t >= scenario.disturbance_start) && (t < disturbance_end);
+    driver.set_disturbance_force(disturbed ? scenario.disturbance_force : 0.0);
+    driver.update();
+
+    const double position_error = state.cart_position - controller.get_teleop()[0];
+    const double angle_error = state.pole_angle - M_PI;
+    const double force = driver.get_controller_cart_force();
+    result.ise += (position_error * position_error + angle_error * angle_error) * dt;
+    result.effort += force * force * dt;
+    if (std::fabs(angle_error) > SETTLING_ANGLE ||
+      std::fabs(position_error) > SETTLING_POSITION)
+    {
+      result.settling_time = t + dt;
+    }
+    if (std::fabs(angle_error) > FAILURE_ANGLE || !std::isfinite(angle_error)) {
+      result.failed = true;
+      break;
+    }
+  }
+
+  result.cost = weights_.state_error * result.ise +
+    weights_.control_effort * result.effort +
+    weights_.settling_time * result.settling_time;
+  if (result.failed) {
+    result.cost += FAILURE_COST;
+  }
+  return result;
+}
+
+RolloutResult ClosedLoopRollout::run(
+  const std::vector<double> & feedback_matrix,
+  const std::vector<Scenario> & scenarios) const
+{
+  RolloutResult total;
+  for (const auto & scenario : scenarios) {
+    const RolloutResult result = run(feedback_matrix, scenario);
+    total.ise += result.ise;
+    total.effort += result.effort;
+    total.settling_time += result.settling_time;
+    total.failed = total.failed || result.failed;
+    total.cost += result.cost;
+  }
+  return total;
+}
+
+std::vector<Scenario> ClosedLoopRollout::default_scenarios()
+{
+  std::vector<Scenario> scenarios(6);
+  // pole tilted to both sides
+  scenarios[0].initial_state = {{0.0, 0.0, M_PI + 0.1, 0.0}};
+  scenarios[1].initial_state = {{0.0, 0.0, M_PI - 0.1, 0.0}};
+  // cart away from the reference position
+  scenarios[2].initial_state = {{1.0, 0.0, M_PI, 0.0}};
+  // pole moving
+  scenarios[3].initial_state = {{0.0, 0.0, M_PI, 0.3}};
+  // short pushes in both directions
+  scenarios[4].disturbance_force = 100.0;
+  scenarios[4].disturbance_start = 0.5;
+  scenarios[4].disturbance_duration = 0.1;
+  scenarios[5].disturbance_force = -100.0;
+  scenarios[5].disturbance_start = 0.5;
+  scenarios[5].disturbance_duration = 0.1;
+  return scenarios;
+}
+}  // namespace pendulum_tools
+}  // namespace pendulum
@@ -0,0 +1,653 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_tools/explicit_mpc_builder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+namespace
+{
+constexpr std::size_t NX = 4U;
+
+// dense row-major matrices
+using Matrix = std::vector<double>;
+
+Matrix multiply(
+  const Matrix & a, const Matrix & b,
+  std::size_t rows, std::size_t inner, std::size_t cols)
+{
+  Matrix c(rows * cols, 0.0);
+  for (std::size_t i = 0; i < rows; i++) {
+    for (std::size_t k = 0; k < inner; k++) {
+      for (std::size_t j = 0; j < cols; j++) {
+        c[i * cols + j] += a[i * inner + k] * b[k * cols + j];
+      }
+    }
+  }
+  return c;
+}
+
+Matrix transpose(const Matrix & a, std::size_t rows, std::size_t cols)
+{
+  Matrix t(rows * cols);
+  for (std::size_t i = 0; i < rows; i++) {
+    for (std::size_t j = 0; j < cols; j++) {
+      t[j * rows + i] = a[i * cols + j];
+    }
+  }
+  return t;
+}
+
+// solves A * X = B in place of B with partial pivoting, A is n x n and B is n x m
+bool solve(Matrix a, Matrix & b, std::size_t n, std::size_t m)
+{
+  for (std::size_t col = 0; col < n; col++) {
+    std::size_t pivot = col;
+    for (std::size_t row = col + 1U; row < n; row++) {
+      if (std::fabs(a[row * n + col]) > std::fabs(a[pivot * n + col])) {
+        pivot = row;
+      }
+    }
+    if (std::fabs(a[pivot * n + col]) < 1e-300) {
+      return false;
+    }
+    for (std::size_t k = 0; k < n; k++) {
+      std::swap(a[col * n + k], a[pivot * n + k]);
+    }
+    for (std::size_t k = 0; k < m; k++) {
+      std::swap(b[col * m + k], b[pivot * m + k]);
+    }
+    for (std::size_t row = 0; row < n; row++) {
+      if (row == col) {
+        continue;
+      }
+      const double factor = a[row * n + col] / a[col * n + col];
+      for (std::size_t k = col; k < n; k++) {
+        a[row * n + k] -= factor * a[col * n + k];
+      }
+      for (std::size_t k = 0; k < m; k++) {
+        b[row * m + k] -= factor * b[col * m + k];
+      }
+    }
+  }
+  for (std::size_t row = 0; row < n; row++) {
+    for (std::size_t k = 0; k < m; k++) {
+      b[row * m + k] /= a[row * n + row];
+    }
+  }
+  return true;
+}
+
+// zero-order hold discretization using the exponential of [[A, B], [0, 0]] * h
+void discretize(const double * A, const double * B, double h, Matrix & Ad, Matrix & Bd)
+{
+  const std::size_t n = NX + 1U;
+  Matrix M(n * n, 0.0);
+  for (std::size_t i = 0; i < NX; i++) {
+    for (std::size_t j = 0; j < NX; j++) {
+      M[i * n + j] = A[i * NX + j] * h;
+    }
+    M[i * n + NX] = B[i] * h;
+  }
+  double norm = 0.0;
+  for (const double v : M) {
+    norm = std::max(norm, std::fabs(v));
+  }
+  // scaling and squaring with a truncated Taylor series
+  std::size_t squarings = 0U;
+  while (norm * static_cast<double>(n) > 0.5) {
+    norm *= 0.5;
+    squarings++;
+  }
+  const double scale = std::ldexp(1.0, -static_cast<int>(squarings));
+  for (double & v : M) {
+    v *= scale;
+  }
+  Matrix E(n * n, 0.0);
+  Matrix term(n * n, 0.0);
+  for (std::size_t i = 0; i < n; i++) {
+    E[i * n + i] = 1.0;
+    term[i * n + i] = 1.0;
+  }
+  for (std::size_t k = 1; k <= 16U; k++) {
+    term = multiply(term, M, n, n, n);
+    for (double & v : term) {
+      v /= static_cast<double>(k);
+    }
+    for (std::size_t i = 0; i < n * n; i++) {
+      E[i] += term[i];
+    }
+  }
+  for (std::size_t s = 0; s < squarings; s++) {
+    E = multiply(E, E, n, n, n);
+  }
+  Ad.assign(NX * NX, 0.0);
+  Bd.assign(NX, 0.0);
+  for (std::size_t i = 0; i < NX; i++) {
+    for (std::size_t j = 0; j < NX; j++) {
+      Ad[i * NX + j] = E[i * n + j];
+    }
+    Bd[i] = E[i * n + NX];
+  }
+}
+
+// discrete algebraic Riccati equation solved by fixed point iteration
+Matrix solve_dare(const Matrix & A, const Matrix & B, const Matrix & Q, double R)
+{
+  const Matrix At = transpose(A, NX, NX);
+  Matrix P = Q;
+  for (std::size_t it = 0; it < 200000U; it++) {
+    const Matrix PA = multiply(P, A, NX, NX, NX);
+    const Matrix PB = multiply(P, B, NX, NX, 1U);
+    double BPB = 0.0;
+    for (std::size_t i = 0; i < NX; i++) {
+      BPB += B[i] * PB[i];
+    }
+    // B' * P * A
+    Matrix BPA(NX, 0.0);
+    for (std::size_t i = 0; i < NX; i++) {
+      for (std::size_t j = 0; j < NX; j++) {
+        BPA[j] += B[i] * PA[i * NX + j];
+      }
+    }
+    const Matrix APA = multiply(At, PA, NX, NX, NX);
+    Matrix next(NX * NX);
+    double max_diff = 0.0;
+    double max_value = 0.0;
+    for (std::size_t i = 0; i < NX; i++) {
+      for (std::size_t j = 0; j < NX; j++) {
+        next[i * NX + j] = Q[i * NX + j] + APA[i * NX + j] - BPA[i] * BPA[j] / (R + BPB);
+        max_diff = std::max(max_diff, std::fabs(next[i * NX + j] - P[i * NX + j]));
+        max_value = std::max(max_value, std::fabs(next[i * NX + j]));
+      }
+    }
+    P = next;
+    if (max_diff <= 1e-12 * (1.0 + max_value)) {
+      return P;
+    }
+  }
+  throw std::runtime_error("the Riccati equation did not converge");
+}
+
+struct Halfspace
+{
+  std::array<double, NX> normal;
+  double bound;
+};
+
+// checks with a phase one simplex if {x | normal * x <= bound - margin, lower <= x <= upper}
+// is not empty
+bool is_feasible(
+  const std::vector<Halfspace> & constraints,
+  const ExplicitMpcBuilder::State & lower,
+  const ExplicitMpcBuilder::State & upper,
+  double margin)
+{
+  // the variables are shifted to z = x - lower >= 0 and the upper bounds become rows
+  const std::size_t m = constraints.size() + NX;
+  const std::size_t cols = NX + 2U * m + 1U;
+  const std::size_t rhs = cols - 1U;
+  std::vector<double> T((m + 1U) * cols, 0.0);
+  std::vector<std::size_t> basis(m);
+  auto at = [&T, cols](std::size_t r, std::size_t c) -> double & {return T[r * cols + c];};
+
+  for (std::size_t r = 0; r < m; r++) {
+    std::array<double, NX> a{};
+    double c = 0.0;
+    if (r < constraints.size()) {
+      a = constraints[r].normal;
+      c = constraints[r].bound - margin;
+      for (std::size_t j = 0; j < NX; j++) {
+        c -= a[j] * lower[j];
+      }
+    } else {
+      a[r - constraints.size()] = 1.0;
+      c = upper[r - constraints.size()] - lower[r - constraints.size()];
+    }
+    const double sign = (c < 0.0) ? -1.0 : 1.0;
+    for (std::size_t j = 0; j < NX; j++) {
+      at(r, j) = sign * a[j];
+    }
+    at(r, NX + r) = sign;
+    at(r, rhs) = sign * c;
+    if (sign < 0.0) {
+      // artificial variable, its sum is minimized
+      at(r, NX + m + r) = 1.0;
+      basis[r] = NX + m + r;
+      for (std::size_t j = 0; j < NX + m; j++) {
+        at(m, j) -= at(r, j);
+      }
+      at(m, rhs) -= at(r, rhs);
+    } else {
+      basis[r] = NX + r;
+    }
+  }
+
+  const double eps = 1e-12;
+  for (std::size_t it = 0; it < 100U * (m + NX); it++) {
+    // Bland's rule avoids cycling
+    std::size_t entering = cols;
+    for (std::size_t j = 0; j < NX + m; j++) {
+      if (at(m, j) < -eps) {
+        entering = j;
+        break;
+      }
+    }
+    if (entering == cols) {
+      break;
+    }
+    std::size_t leaving = m;
+    double best_ratio = std::numeric_limits<double>::infinity();
+    for (std::size_t r = 0; r < m; r++) {
+      if (at(r, entering) > eps) {
+        const double ratio = at(r, rhs) / at(r, entering);
+        if (ratio < best_ratio || (ratio == best_ratio && basis[r] < basis[leaving])) {
+          best_ratio = ratio;
+          leaving = r;
+        }
+      }
+    }
+    if (leaving == m) {
+      break;
+    }
+    const double pivot = at(leaving, entering);
+    for (std::size_t j = 0; j < cols; j++) {
+      at(leaving, j) /= pivot;
+    }
+    for (std::size_t r = 0; r <= m; r++) {
+      if (r != leaving && at(r, entering) != 0.0) {
+        const double factor = at(r, entering);
+        for (std::size_t j = 0; j < cols; j++) {
+          at(r, j) -= factor * at(leaving, j);
+        }
+      }
+    }
+    basis[leaving] = entering;
+  }
+  return -at(m, rhs) <= 1e-9;
+}
+
+double max_violation(const std::vector<Halfspace> & constraints, const double * x)
+{
+  double violation = -std::numeric_limits<double>::infinity();
+  for (const auto & c : constraints) {
+    double value = -c.bound;
+    for (std::size_t j = 0; j < NX; j++) {
+      value += c.normal[j] * x[j];
+    }
+    violation = std::max(violation, value);
+  }
+  return violation;
+}
+
+struct CandidateRegion
+{
+  std::array<double, NX> gain;
+  double offset;
+  std::vector<Halfspace> constraints;
+};
+}  // namespace
+
+ExplicitMpcBuilder::ExplicitMpcBuilder(
+  const pendulum_driver::CartPoleParameters & params,
+  const Config & config)
+: cfg_(config)
+{
+  // 3^horizon regions must fit the 16 bit region indices of the table
+  if (cfg_.horizon == 0U || cfg_.horizon > 10U) {
+    throw std::invalid_argument("horizon must be between 1 and 10");
+  }
+  if (!(cfg_.sample_period > 0.0) || !(cfg_.force_weight > 0.0) || !(cfg_.max_force > 0.0)) {
+    throw std::invalid_argument("sample period, force weight and force limit must be positive");
+  }
+  if (cfg_.grid_cells == 0U || cfg_.grid_cells > 32U) {
+    throw std::invalid_argument("grid cells must be between 1 and 32");
+  }
+  for (std::size_t i = 0; i < NX; i++) {
+    if (!(cfg_.state_weights[i] >= 0.0) || !(cfg_.grid_upper[i] > cfg_.grid_lower[i])) {
+      throw std::invalid_argument("wrong state weights or grid bounds");
+    }
+  }
+
+  // linearization around the up position
+  const double up[NX] = {0.0, 0.0, M_PI, 0.0};
+  double A[NX * NX];
+  double B[NX];
+  pendulum_driver::cart_pole_jacobian(up, 0.0, params, A, B);
+  Matrix Ad, Bd;
+  discretize(A, B, cfg_.sample_period, Ad, Bd);
+
+  Matrix Q(NX * NX, 0.0);
+  for (std::size_t i = 0; i < NX; i++) {
+    Q[i * NX + i] = cfg_.state_weights[i];
+  }
+  const Matrix P = solve_dare(Ad, Bd, Q, cfg_.force_weight);
+
+  // powers[k] = Ad^k, impulse[k] = Ad^k * Bd
+  const std::size_t N = cfg_.horizon;
+  std::vector<Matrix> powers(N + 1U);
+  std::vector<Matrix> impulse(N);
+  powers[0].assign(NX * NX, 0.0);
+  for (std::size_t i = 0; i < NX; i++) {
+    powers[0][i * NX + i] = 1.0;
+  }
+  for (std::size_t k = 1; k <= N; k++) {
+    powers[k] = multiply(Ad, powers[k - 1U], NX, NX, NX);
+  }
+  for (std::size_t k = 0; k < N; k++) {
+    impulse[k] = multiply(powers[k], Bd, NX, NX, 1U);
+  }
+
+  // x_k = Ad^k * x_0 + sum_{j < k} Ad^(k - 1 - j) * Bd * u_j
+  H_.assign(N * N, 0.0);
+  G_.assign(N * NX, 0.0);
+  for (std::size_t k = 1; k <= N; k++) {
+    const Matrix & W = (k == N) ? P : Q;
+    for (std::size_t i = 0; i < k; i++) {
+      const Matrix Wg = multiply(W, impulse[k - 1U - i], NX, NX, 1U);
+      for (std::size_t j = 0; j < k; j++) {
+        double value = 0.0;
+        for (std::size_t r = 0; r < NX; r++) {
+          value += Wg[r] * impulse[k - 1U - j][r];
+        }
+        H_[i * N + j] += 2.0 * value;
+      }
+      const Matrix WgA = multiply(transpose(Wg, NX, 1U), powers[k], 1U, NX, NX);
+      for (std::size_t c = 0; c < NX; c++) {
+        G_[i * NX + c] += 2.0 * WgA[c];
+      }
+    }
+  }
+  for (std::size_t i = 0; i < N; i++) {
+    H_[i * N + i] += 2.0 * cfg_.force_weight;
+  }
+}
+
+ExplicitMpcBuilder::State ExplicitMpcBuilder::get_unconstrained_gain() const
+{
+  const std::size_t N = cfg_.horizon;
+  Matrix X = G_;
+  for (double & v : X) {
+    v = -v;
+  }
+  if (!solve(H_, X, N, NX)) {
+    throw std::runtime_error("singular MPC hessian");
+  }
+  return State{{X[0], X[1], X[2], X[3]}};
+}
+
+double ExplicitMpcBuilder::solve_online(const State & error) const
+{
+  // projected coordinate descent, exact for box constrained convex problems
+  const std::size_t N = cfg_.horizon;
+  std::vector<double> linear(N, 0.0);
+  for (std::size_t i = 0; i < N; i++) {
+    for (std::size_t c = 0; c < NX; c++) {
+      linear[i] += G_[i * NX + c] * error[c];
+    }
+  }
+  std::vector<double> U(N, 0.0);
+  for (std::size_t sweep = 0; sweep < 1000000U; sweep++) {
+    double max_change = 0.0;
+    for (std::size_t i = 0; i < N; i++) {
+      double gradient = linear[i];
+      for (std::size_t j = 0; j < N; j++) {
+        gradient += H_[i * N + j] * U[j];
+      }
+      const double next = std::min(
+        std::max(U[i] - gradient / H_[i * N + i], -cfg_.max_force), cfg_.max_force);
+      max_change = std::max(max_change, std::fabs(next - U[i]));
+      U[i] = next;
+    }
+    if (max_change <= 1e-12 * cfg_.max_force) {
+      break;
+    }
+  }
+  return U[0];
+}
+
+pendulum_controller::ExplicitMpcTable ExplicitMpcBuilder::build() const
+{
+  using pendulum_controller::ExplicitMpcTable;
+  const std::size_t N = cfg_.horizon;
+  const double umax = cfg_.max_force;
+
+  std::size_t num_sets = 1U;
+  for (std::size_t i = 0; i < N; i++) {
+    num_sets *= 3U;
+  }
+
+  std::vector<CandidateRegion> candidates;
+  for (std::size_t set = 0; set < num_sets; set++) {
+    // saturation of every force: -1 lower bound, 0 free, 1 upper bound
+    std::vector<int> saturation(N);
+    std::vector<std::size_t> free;
+    std::size_t code = set;
+    for (std::size_t i = 0; i < N; i++) {
+      saturation[i] = static_cast<int>(code % 3U) - 1;
+      code /= 3U;
+      if (saturation[i] == 0) {
+        free.push_back(i);
+      }
+    }
+
+    // U = T * error + t
+    Matrix T(N * NX, 0.0);
+    std::vector<double> t(N, 0.0);
+    for (std::size_t i = 0; i < N; i++) {
+      t[i] = saturation[i] * umax;
+    }
+    const std::size_t nf = free.size();
+    if (nf > 0U) {
+      Matrix Hff(nf * nf);
+      Matrix X(nf * (NX + 1U), 0.0);
+      for (std::size_t a = 0; a < nf; a++) {
+        for (std::size_t b = 0; b < nf; b++) {
+          Hff[a * nf + b] = H_[free[a] * N + free[b]];
+        }
+        for (std::size_t c = 0; c < NX; c++) {
+          X[a * (NX + 1U) + c] = -G_[free[a] * NX + c];
+        }
+        for (std::size_t j = 0; j < N; j++) {
+          X[a * (NX + 1U) + NX] -= H_[free[a] * N + j] * t[j];
+        }
+      }
+      if (!solve(Hff, X, nf, NX + 1U)) {
+        continue;
+      }
+      for (std::size_t a = 0; a < nf; a++) {
+        for (std::size_t c = 0; c < NX; c++) {
+          T[free[a] * NX + c] = X[a * (NX + 1U) + c];
+        }
+        t[free[a]] = X[a * (NX + 1U) + NX];
+      }
+    }
+
+    // gradient H * U + G * error = gT * error + gt
+    Matrix gT = multiply(H_, T, N, N, NX);
+    std::vector<double> gt(N, 0.0);
+    for (std::size_t i = 0; i < N; i++) {
+      for (std::size_t c = 0; c < NX; c++) {
+        gT[i * NX + c] += G_[i * NX + c];
+      }
+      for (std::size_t j = 0; j < N; j++) {
+        gt[i] += H_[i * N + j] * t[j];
+      }
+    }
+
+    // optimality conditions: free forces within the limits, and the gradient pushes the
+    // saturated forces against their limit
+    std::vector<Halfspace> raw;
+    for (std::size_t i = 0; i < N; i++) {
+      Halfspace h;
+      if (saturation[i] == 0) {
+        for (std::size_t c = 0; c < NX; c++) {
+          h.normal[c] = T[i * NX + c];
+        }
+        h.bound = umax - t[i];
+        raw.push_back(h);
+        for (std::size_t c = 0; c < NX; c++) {
+          h.normal[c] = -T[i * NX + c];
+        }
+        h.bound = umax + t[i];
+        raw.push_back(h);
+      } else {
+        const double sign = static_cast<double>(saturation[i]);
+        for (std::size_t c = 0; c < NX; c++) {
+          h.normal[c] = sign * gT[i * NX + c];
+        }
+        h.bound = -sign * gt[i];
+        raw.push_back(h);
+      }
+    }
+
+    CandidateRegion region;
+    bool empty = false;
+    for (auto h : raw) {
+      double norm = 0.0;
+      for (const double a : h.normal) {
+        norm += a * a;
+      }
+      norm = std::sqrt(norm);
+      if (norm < 1e-12) {
+        // constant condition, either always or never satisfied
+        empty = empty || (h.bound < -1e-9);
+        continue;
+      }
+      for (double & a : h.normal) {
+        a /= norm;
+      }
+      h.bound /= norm;
+      region.constraints.push_back(h);
+    }
+    if (empty || !is_feasible(region.constraints, cfg_.grid_lower, cfg_.grid_upper, 1e-7)) {
+      continue;
+    }
+    for (std::size_t c = 0; c < NX; c++) {
+      region.gain[c] = T[c];
+    }
+    region.offset = t[0];
+    candidates.push_back(std::move(region));
+  }
+  if (candidates.empty()) {
+    throw std::runtime_error("no explicit MPC region found");
+  }
+
+  // candidate regions of every grid cell, the first state dimension is the most significant
+  ExplicitMpcTable::Grid grid;
+  std::size_t num_cells = 1U;
+  for (std::size_t i = 0; i < NX; i++) {
+    grid.lower[i] = cfg_.grid_lower[i];
+    grid.upper[i] = cfg_.grid_upper[i];
+    grid.cells[i] = static_cast<std::uint32_t>(cfg_.grid_cells);
+    num_cells *= cfg_.grid_cells;
+  }
+  std::vector<std::vector<std::size_t>> cell_candidates(num_cells);
+  std::vector<bool> used(candidates.size(), false);
+  for (std::size_t cell = 0; cell < num_cells; cell++) {
+    State lower, upper, center;
+    std::size_t code = cell;
+    for (std::size_t i = NX; i-- > 0U; ) {
+      const std::size_t index = code % cfg_.grid_cells;
+      code /= cfg_.grid_cells;
+      const double width = (grid.upper[i] - grid.lower[i]) / static_cast<double>(cfg_.grid_cells);
+      lower[i] = grid.lower[i] + width * static_cast<double>(index);
+      upper[i] = lower[i] + width;
+      center[i] = 0.5 * (lower[i] + upper[i]);
+    }
+    for (std::size_t r = 0; r < candidates.size(); r++) {
+      // quick rejection: a single half-space excludes all the cell corners
+      bool excluded = false;
+      for (const auto & h : candidates[r].constraints) {
+        double min_value = 0.0;
+        for (std::size_t c = 0; c < NX; c++) {
+          min_value += h.normal[c] * ((h.normal[c] > 0.0) ? lower[c] : upper[c]);
+        }
+        if (min_value > h.bound) {
+          excluded = true;
+          break;
+        }
+      }
+      if (!excluded && is_feasible(candidates[r].constraints, lower, upper, 1e-9)) {
+        cell_candidates[cell].push_back(r);
+      }
+    }
+    if (cell_candidates[cell].empty()) {
+      // numerically thin regions only, keep the closest one to the cell center
+      std::size_t best = 0U;
+      double best_violation = std::numeric_limits<double>::infinity();
+      for (std::size_t r = 0; r < candidates.size(); r++) {
+        const double violation = max_violation(candidates[r].constraints, center.data());
+        if (violation < best_violation) {
+          best_violation = violation;
+          best = r;
+        }
+      }
+      cell_candidates[cell].push_back(best);
+    }
+    for (const auto r : cell_candidates[cell]) {
+      used[r] = true;
+    }
+  }
+
+  // store only the regions referenced by a cell
+  std::vector<std::size_t> new_index(candidates.size());
+  std::vector<ExplicitMpcTable::Region> regions;
+  std::vector<ExplicitMpcTable::Constraint> constraints;
+  for (std::size_t r = 0; r < candidates.size(); r++) {
+    if (!used[r]) {
+      continue;
+    }
+    new_index[r] = regions.size();
+    ExplicitMpcTable::Region region;
+    for (std::size_t c = 0; c < NX; c++) {
+      region.gain[c] = static_cast<float>(candidates[r].gain[c]);
+    }
+    region.offset = static_cast<float>(candidates[r].offset);
+    region.first_constraint = static_cast<std::uint32_t>(constraints.size());
+    region.num_constraints = static_cast<std::uint32_t>(candidates[r].constraints.size());
+    for (const auto & h : candidates[r].constraints) {
+      ExplicitMpcTable::Constraint constraint;
+      for (std::size_t c = 0; c < NX; c++) {
+        constraint.normal[c] = static_cast<float>(h.normal[c]);
+      }
+      constraint.bound = static_cast<float>(h.bound);
+      constraints.push_back(constraint);
+    }
+    regions.push_back(region);
+  }
+  std::vector<std::uint32_t> cell_offsets{0U};
+  std::vector<std::uint16_t> cell_regions;
+  for (const auto & list : cell_candidates) {
+    for (const auto r : list) {
+      cell_regions.push_back(static_cast<std::uint16_t>(new_index[r]));
+    }
+    cell_offsets.push_back(static_cast<std::uint32_t>(cell_regions.size()));
+  }
+  return ExplicitMpcTable(
+    umax, grid, std::move(regions), std::move(constraints),
+    std::move(cell_offsets), std::move(cell_regions));
+}
+}  // namespace pendulum_tools
+}  // namespace pendulum
@@ -0,0 +1,164 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_tools/fleet_scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+using pendulum_driver::PendulumDriver;
+using utils::TimingWheel;
+
+FleetScheduler::FleetScheduler(
+  const PendulumDriver::Config & driver_config,
+  const Config & config)
+: config_(config), mean_rate_(0.0)
+{
+  if (config_.instances == 0U) {
+    throw std::invalid_argument("the fleet needs at least one instance");
+  }
+  if (config_.rates.empty()) {
+    throw std::invalid_argument("at least one update rate is needed");
+  }
+  if (config_.tick.count() <= 0) {
+    throw std::invalid_argument("tick must be positive");
+  }
+  if (config_.duration <= 0.0) {
+    throw std::invalid_argument("duration must be positive");
+  }
+  if (config_.target_utilization <= 0.0 || config_.target_utilization > 1.0) {
+    throw std::invalid_argument("target utilization must be in (0, 1]");
+  }
+  const double tick = std::chrono::duration<double>(config_.tick).count();
+  for (const double rate : config_.rates) {
+    if (!(rate > 0.0) || 1.0 / rate < tick) {
+      throw std::invalid_argument("update rates must be positive and not above the tick rate");
+    }
+  }
+
+  // the timers are linked by address, the vector must not reallocate
+  instances_.resize(config_.instances);
+  for (std::size_t i = 0U; i < instances_.size(); i++) {
+    Instance & instance = instances_[i];
+    const double rate = config_.rates[i % config_.rates.size()];
+    instance.period_ticks =
+      std::max<std::uint64_t>(1U, static_cast<std::uint64_t>(std::llround(1.0 / (rate * tick))));
+    const auto period = std::chrono::duration_cast<std::chrono::microseconds>(
+      config_.tick * instance.period_ticks);
+    instance.driver = std::make_unique<PendulumDriver>(
+      PendulumDriver::Config(
+        driver_config.get_pendulum_mass(),
+        driver_config.get_cart_mass(),
+        driver_config.get_pendulum_length(),
+        driver_config.get_damping_coefficient(),
+        driver_config.get_gravity(),
+        driver_config.get_max_cart_force(),
+        driver_config.get_noise_level(),
+        period,
+        driver_config.get_integrator()));
+    instance.timer.id = i;
+    instance.num_updates = 0U;
+    mean_rate_ += 1.0 / (static_cast<double>(instance.period_ticks) * tick);
+  }
+  mean_rate_ /= static_cast<double>(instances_.size());
+}
+
+FleetScheduler::Result FleetScheduler::run()
+{
+  using std::chrono::steady_clock;
+
+  TimingWheel wheel;
+  for (auto & instance : instances_) {
+    instance.driver->reset();
+    instance.num_updates = 0U;
+    instance.timer = TimingWheel::Timer{};
+    instance.timer.id = static_cast<std::size_t>(&instance - instances_.data());
+    // spread the first updates over the period
+    wheel.schedule(instance.timer, instance.timer.id % instance.period_ticks + 1U);
+  }
+
+  const double tick = std::chrono::duration<double>(config_.tick).count();
+  const auto end_tick = static_cast<std::uint64_t>(config_.duration / tick);
+  Result result{};
+  std::uint64_t max_lateness = 0U;
+  steady_clock::duration busy_time{0};
+  const auto start = steady_clock::now();
+
+  std::uint64_t next_tick = 0U;
+  while (wheel.get_next_expiry(next_tick) && next_tick <= end_tick) {
+    std::uint64_t now_tick = next_tick;
+    if (config_.realtime) {
+      std::this_thread::sleep_until(start + config_.tick * next_tick);
+      const auto elapsed_ticks = static_cast<std::uint64_t>(
+        (steady_clock::now() - start) / config_.tick);
+      now_tick = std::max(next_tick, std::min(elapsed_ticks, end_tick));
+    }
+    const std::uint64_t num_updates = result.num_updates;
+    const auto busy_start = steady_clock::now();
+    wheel.advance(
+      now_tick, [this, &wheel, &result, &max_lateness, now_tick](TimingWheel::Timer & timer) {
+        Instance & instance = instances_[timer.id];
+        const std::uint64_t lateness = now_tick - timer.expiry;
+        max_lateness = std::max(max_lateness, lateness);
+        if (lateness >= instance.period_ticks) {
+          result.num_overruns++;
+        }
+        instance.driver->update();
+        instance.num_updates++;
+        result.num_updates++;
+        wheel.schedule(timer, timer.expiry + instance.period_ticks);
+      });
+    busy_time += steady_clock::now() - busy_start;
+    // the wheel also wakes up to move timers to a finer level, without any expired timer
+    if (result.num_updates > num_updates) {
+      result.num_wakeups++;
+    } else {
+      result.num_cascades++;
+    }
+  }
+
+  result.max_lateness = static_cast<double>(max_lateness) * tick;
+  result.busy_time = std::chrono::duration<double>(busy_time).count();
+  result.scheduled_time = static_cast<double>(end_tick) * tick;
+  result.utilization = result.scheduled_time > 0.0 ?
+    result.busy_time / result.scheduled_time : 0.0;
+  result.cost_per_update = result.num_updates > 0U ?
+    result.busy_time / static_cast<double>(result.num_updates) : 0.0;
+  result.instances_per_core = result.cost_per_update > 0.0 ?
+    config_.target_utilization / (result.cost_per_update * mean_rate_) : 0.0;
+  return result;
+}
+
+std::uint64_t FleetScheduler::get_num_updates(std::size_t index) const
+{
+  return instances_.at(index).num_updates;
+}
+
+const PendulumDriver & FleetScheduler::get_driver(std::size_t index) const
+{
+  return *instances_.at(index).driver;
+}
+
+std::uint64_t FleetScheduler::get_period_ticks(std::size_t index) const
+{
+  return instances_.at(index).period_ticks;
+}
+}  // namespace pendulum_tools
+}  // namespace pendulum
@@ -0,0 +1,151 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_tools/fleet_supervisor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+std::vector<std::vector<std::size_t>> partition_cores(
+  std::size_t num_cores,
+  std::size_t reserved_cores,
+  std::size_t instances)
+{
+  if (instances == 0U) {
+    throw std::invalid_argument("the fleet needs at least one instance");
+  }
+  if (reserved_cores >= num_cores) {
+    throw std::invalid_argument("no cores left after the reserved ones");
+  }
+  const std::size_t cores_per_instance = (num_cores - reserved_cores) / instances;
+  if (cores_per_instance == 0U) {
+    throw std::invalid_argument(
+            std::to_string(instances) + " instances do not fit in " +
+            std::to_string(num_cores - reserved_cores) + " cores");
+  }
+  std::vector<std::vector<std::size_t>> partition(instances);
+  for (std::size_t i = 0U; i < instances; i++) {
+    for (std::size_t k = 0U; k < cores_per_instance; k++) {
+      partition[i].push_back(reserved_cores + i * cores_per_instance + k);
+    }
+  }
+  return partition;
+}
+
+std::string format_cpu_list(const std::vector<std::size_t> & cores)
+{
+  std::string list;
+  std::size_t i = 0U;
+  while (i < cores.size()) {
+    // extend the range while the cores are consecutive
+    std::size_t j = i;
+    while (j + 1U < cores.size() && cores[j + 1U] == cores[j] + 1U) {
+      j++;
+    }
+    if (!list.empty()) {
+      list += ",";
+    }
+    list += std::to_string(cores[i]);
+    if (j > i) {
+      list += "-" + std::to_string(cores[j]);
+    }
+    i = j + 1U;
+  }
+  return list;
+}
+
+FleetMetrics::FleetMetrics(std::size_t instances)
+: instances_(instances)
+{}
+
+void FleetMetrics::add(std::size_t instance, Source source, const PeriodStatistics & window)
+{
+  if (window.sample_count == 0U) {
+    return;
+  }
+  PeriodStatistics & stats = instances_.at(instance)[source];
+  stats = merge(stats, window);
+}
+
+const PeriodStatistics & FleetMetrics::get(std::size_t instance, Source source) const
+{
+  return instances_.at(instance)[source];
+}
+
+PeriodStatistics FleetMetrics::get_fleet(Source source) const
+{
+  PeriodStatistics fleet;
+  for (const auto & instance : instances_) {
+    fleet = merge(fleet, instance[source]);
+  }
+  return fleet;
+}
+
+std::size_t FleetMetrics::get_worst_instance(Source source) const
+{
+  std::size_t worst = 0U;
+  for (std::size_t i = 1U; i < instances_.size(); i++) {
+    if (instances_[i][source].sample_count > 0U &&
+      (instances_[worst][source].sample_count == 0U ||
+      instances_[i][source].maximum > instances_[worst][source].maximum))
+    {
+      worst = i;
+    }
+  }
+  return worst;
+}
+
+std::size_t FleetMetrics::get_num_silent(Source source) const
+{
+  return static_cast<std::size_t>(
+    std::count_if(
+      instances_.begin(), instances_.end(),
+      [source](const std::array<PeriodStatistics, NUM_SOURCES> & instance) {
+        return instance[source].sample_count == 0U;
+      }));
+}
+
+PeriodStatistics FleetMetrics::merge(const PeriodStatistics & a, const PeriodStatistics & b)
+{
+  if (a.sample_count == 0U) {
+    return b;
+  }
+  if (b.sample_count == 0U) {
+    return a;
+  }
+  const double na = static_cast<double>(a.sample_count);
+  const double nb = static_cast<double>(b.sample_count);
+  const double n = na + nb;
+  const double delta = b.average - a.average;
+  // pooled sum of squared deviations
+  const double m2 = na * a.standard_deviation * a.standard_deviation +
+    nb * b.standard_deviation * b.standard_deviation + delta * delta * na * nb / n;
+
+  PeriodStatistics merged;
+  merged.average = a.average + delta * nb / n;
+  merged.minimum = std::min(a.minimum, b.minimum);
+  merged.maximum = std::max(a.maximum, b.maximum);
+  merged.standard_deviation = std::sqrt(m2 / n);
+  merged.sample_count = a.sample_count + b.sample_count;
+  return merged;
+}
+}  // namespace pendulum_tools
+}  // namespace pendulum
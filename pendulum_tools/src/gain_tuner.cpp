@@ -0,0 +1,172 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_tools/gain_tuner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+GainTuner::GainTuner(
+  const ClosedLoopRollout & rollout,
+  std::vector<Scenario> scenarios,
+  const Config & config)
+: rollout_(rollout),
+  scenarios_(std::move(scenarios)),
+  cfg_(config)
+{
+  if (cfg_.population == 0U || cfg_.elite == 0U || cfg_.elite > cfg_.population) {
+    throw std::invalid_argument("elite size must be between 1 and the population size");
+  }
+  if (scenarios_.empty()) {
+    throw std::invalid_argument("at least one scenario is required");
+  }
+}
+
+RolloutResult GainTuner::evaluate(const std::vector<double> & gains) const
+{
+  return rollout_.run(gains, scenarios_);
+}
+
+void GainTuner::evaluate_population(
+  const std::vector<std::vector<double>> & candidates,
+  std::vector<double> & costs) const
+{
+  std::size_t num_threads = cfg_.threads;
+  if (num_threads == 0U) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min(num_threads, candidates.size());
+
+  // candidates are handed out one at a time so slow (unstable) rollouts do not
+  // leave the other threads idle
+  std::atomic<std::size_t> next_candidate{0U};
+  auto worker = [&]() {
+      std::size_t i = next_candidate.fetch_add(1U);
+      while (i < candidates.size()) {
+        costs[i] = rollout_.run(candidates[i], scenarios_).cost;
+        i = next_candidate.fetch_add(1U);
+      }
+    };
+
+  std::vector<std::thread> workers;
+  workers.reserve(num_threads);
+  for (std::size_t t = 0U; t < num_threads; t++) {
+    workers.emplace_back(worker);
+  }
+  for (auto & w : workers) {
+    w.join();
+  }
+}
+
+std::vector<double> GainTuner::tune(
+  const std::vector<double> & initial_gains,
+  const std::function<void(const IterationReport &)> & on_iteration) const
+{
+  const std::size_t dim = initial_gains.size();
+  std::vector<double> mean = initial_gains;
+  std::vector<double> stddev(dim);
+  for (std::size_t j = 0U; j < dim; j++) {
+    stddev[j] = cfg_.initial_relative_std * std::max(std::fabs(initial_gains[j]), 1.0);
+  }
+
+  std::mt19937 rand_gen(cfg_.seed);
+  std::normal_distribution<double> normal(0.0, 1.0);
+  std::vector<std::vector<double>> candidates(cfg_.population, std::vector<double>(dim));
+  std::vector<double> costs(cfg_.population);
+  std::vector<std::size_t> order(cfg_.population);
+
+  std::vector<double> best_gains = initial_gains;
+  double best_cost = evaluate(initial_gains).cost;
+
+  for (std::size_t iteration = 0U; iteration < cfg_.iterations; iteration++) {
+    // keep the current mean in the population so the best cost never regresses
+    candidates[0] = mean;
+    for (std::size_t i = 1U; i < cfg_.population; i++) {
+      for (std::size_t j = 0U; j < dim; j++) {
+        candidates[i][j] = mean[j] + stddev[j] * normal(rand_gen);
+      }
+    }
+
+    evaluate_population(candidates, costs);
+
+    std::iota(order.begin(), order.end(), 0U);
+    std::partial_sort(
+      order.begin(), order.begin() + cfg_.elite, order.end(),
+      [&costs](std::size_t a, std::size_t b) {return costs[a] < costs[b];});
+
+    if (costs[order[0]] < best_cost) {
+      best_cost = costs[order[0]];
+      best_gains = candidates[order[0]];
+    }
+
+    double elite_cost = 0.0;
+    for (std::size_t j = 0U; j < dim; j++) {
+      double elite_mean = 0.0;
+      for (std::size_t e = 0U; e < cfg_.elite; e++) {
+        elite_mean += candidates[order[e]][j];
+      }
+      elite_mean /= static_cast<double>(cfg_.elite);
+      double elite_var = 0.0;
+      for (std::size_t e = 0U; e < cfg_.elite; e++) {
+        const double diff = candidates[order[e]][j] - elite_mean;
+        elite_var += diff * diff;
+      }
+      elite_var /= static_cast<double>(cfg_.elite);
+      mean[j] = cfg_.smoothing * elite_mean + (1.0 - cfg_.smoothing) * mean[j];
+      stddev[j] = cfg_.smoothing * std::sqrt(elite_var) + (1.0 - cfg_.smoothing) * stddev[j];
+    }
+    for (std::size_t e = 0U; e < cfg_.elite; e++) {
+      elite_cost += costs[order[e]];
+    }
+
+    if (on_iteration) {
+      on_iteration(
+        IterationReport{iteration, best_cost, elite_cost / static_cast<double>(cfg_.elite),
+          best_gains});
+    }
+  }
+  return best_gains;
+}
+
+std::string GainTuner::to_param_yaml(const std::vector<double> & gains)
+{
+  std::ostringstream yaml;
+  yaml << std::fixed << std::setprecision(4);
+  yaml << "/**/pendulum_controller:\n";
+  yaml << "  ros__parameters:\n";
+  yaml << "    controller:\n";
+  yaml << "      feedback_matrix: [";
+  for (std::size_t j = 0U; j < gains.size(); j++) {
+    yaml << (j > 0U ? ", " : "") << gains[j];
+  }
+  yaml << "]\n";
+  return yaml.str();
+}
+}  // namespace pendulum_tools
+}  // namespace pendulum
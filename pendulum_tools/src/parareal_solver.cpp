@@ -0,0 +1,191 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_tools/parareal_solver.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace pendulum
+{
+namespace pendulum_tools
+{
+PararealSolver::PararealSolver(
+  const pendulum_driver::CartPoleParameters & params,
+  std::chrono::microseconds fine_step,
+  const Config & config)
+: params_(params),
+  dt_(std::chrono::duration<double>(fine_step).count()),
+  cfg_(config)
+{
+  if (fine_step.count() <= 0) {
+    throw std::invalid_argument("fine step must be positive");
+  }
+  if (cfg_.coarse_ratio == 0U) {
+    throw std::invalid_argument("coarse ratio must be at least 1");
+  }
+  if (cfg_.max_iterations == 0U) {
+    throw std::invalid_argument("at least one iteration is required");
+  }
+  if (!(cfg_.tolerance >= 0.0)) {
+    throw std::invalid_argument("tolerance must not be negative");
+  }
+}
+
+void PararealSolver::fine_propagate(
+  State & y, const std::vector<double> & forces,
+  std::size_t begin, std::size_t end, double * trajectory) const
+{
+  for (std::size_t k = begin; k < end; k++) {
+    pendulum_driver::cart_pole_rk4_step(y.data(), forces[k], params_, dt_);
+    if (trajectory != nullptr) {
+      std::copy(y.begin(), y.end(), trajectory + 4U * (k + 1U));
+    }
+  }
+}
+
+void PararealSolver::coarse_propagate(
+  State & y, const std::vector<double> & forces, std::size_t begin, std::size_t end) const
+{
+  for (std::size_t k = begin; k < end; k += cfg_.coarse_ratio) {
+    const std::size_t step_end = std::min(k + cfg_.coarse_ratio, end);
+    double mean_force = 0.0;
+    for (std::size_t i = k; i < step_end; i++) {
+      mean_force += forces[i];
+    }
+    const double steps = static_cast<double>(step_end - k);
+    pendulum_driver::cart_pole_rk4_step(y.data(), mean_force / steps, params_, steps * dt_);
+  }
+}
+
+PararealSolver::State PararealSolver::solve_sequential(
+  const State & initial_state, const std::vector<double> & forces) const
+{
+  State y = initial_state;
+  fine_propagate(y, forces, 0U, forces.size(), nullptr);
+  return y;
+}
+
+PararealSolver::Result PararealSolver::solve(
+  const State & initial_state,
+  const std::vector<double> & forces,
+  const std::function<void(const IterationReport &)> & on_iteration) const
+{
+  const std::size_t num_steps = forces.size();
+  Result result{initial_state, {}, 0U, 0.0, true};
+  if (cfg_.store_trajectory) {
+    result.trajectory.resize(4U * (num_steps + 1U));
+    std::copy(initial_state.begin(), initial_state.end(), result.trajectory.begin());
+  }
+  if (num_steps == 0U) {
+    return result;
+  }
+
+  std::size_t num_threads = cfg_.threads;
+  if (num_threads == 0U) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  std::size_t num_slices = (cfg_.slices == 0U) ? 4U * num_threads : cfg_.slices;
+  num_slices = std::min(num_slices, num_steps);
+  num_threads = std::min(num_threads, num_slices);
+
+  std::vector<std::size_t> slice_begin(num_slices + 1U);
+  for (std::size_t n = 0U; n <= num_slices; n++) {
+    slice_begin[n] = n * num_steps / num_slices;
+  }
+
+  // initial state of every slice, and the fine and coarse results of every slice
+  std::vector<State> starts(num_slices + 1U);
+  std::vector<State> fine(num_slices);
+  std::vector<State> coarse(num_slices);
+
+  // initial prediction with a sequential coarse sweep
+  starts[0] = initial_state;
+  for (std::size_t n = 0U; n < num_slices; n++) {
+    coarse[n] = starts[n];
+    coarse_propagate(coarse[n], forces, slice_begin[n], slice_begin[n + 1U]);
+    starts[n + 1U] = coarse[n];
+  }
+
+  double * trajectory = cfg_.store_trajectory ? result.trajectory.data() : nullptr;
+  // slices before this index were propagated from their exact initial state
+  std::size_t exact_slices = 0U;
+  result.converged = false;
+
+  while (result.iterations < cfg_.max_iterations && !result.converged) {
+    // fine propagation of the slices which are not exact yet, in parallel
+    std::atomic<std::size_t> next_slice{exact_slices};
+    auto worker = [&]() {
+        std::size_t n = next_slice.fetch_add(1U);
+        while (n < num_slices) {
+          fine[n] = starts[n];
+          fine_propagate(fine[n], forces, slice_begin[n], slice_begin[n + 1U], trajectory);
+          n = next_slice.fetch_add(1U);
+        }
+      };
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+    for (std::size_t t = 0U; t < num_threads; t++) {
+      workers.emplace_back(worker);
+    }
+    for (auto & w : workers) {
+      w.join();
+    }
+
+    // the first pending slice started from an exact state, so its fine result is exact too
+    exact_slices++;
+    result.iterations++;
+
+    // sequential correction: U[n+1] = G(U[n]) + F(U_old[n]) - G(U_old[n])
+    double max_correction = 0.0;
+    for (std::size_t n = exact_slices - 1U; n < num_slices; n++) {
+      State predicted = starts[n];
+      coarse_propagate(predicted, forces, slice_begin[n], slice_begin[n + 1U]);
+      State corrected;
+      for (std::size_t i = 0U; i < 4U; i++) {
+        // copy the exact result instead of adding and subtracting the same coarse prediction
+        corrected[i] = (n + 1U == exact_slices) ? fine[n][i] :
+          predicted[i] + fine[n][i] - coarse[n][i];
+        const double correction = std::fabs(corrected[i] - starts[n + 1U][i]);
+        // written so that a diverged (NaN) state is not ignored
+        if (!(correction <= max_correction)) {
+          max_correction = correction;
+        }
+      }
+      coarse[n] = predicted;
+      starts[n + 1U] = corrected;
+    }
+    if (!std::isfinite(max_correction)) {
+      max_correction = std::numeric_limits<double>::infinity();
+    }
+
+    result.max_correction = max_correction;
+    result.converged = (exact_slices == num_slices) || (max_correction <= cfg_.tolerance);
+    if (on_iteration) {
+      on_iteration(IterationReport{result.iterations, max_correction, exact_slices});
+    }
+  }
+
+  // the stored trajectory comes from the last fine propagation, which started from states
+  // within the tolerance of the corrected ones
+  result.final_state = fine[num_slices - 1U];
+  return result;
+}
+}  // namespace pendulum_tools
+}  // namespace pendulum
@@ -0,0 +1,122 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "pendulum_tools/command_line.hpp"
+#include "pendulum_tools/explicit_mpc_builder.hpp"
+
+namespace
+{
+constexpr char USAGE[] =
+  "Usage: pendulum_explicit_mpc [options]\n"
+  "\t[--horizon predicted steps (default 4)]\n"
+  "\t[--sample-period-us controller period, driver state_publish_period_us "
+  "(default 10000)]\n"
+  "\t[--max-cart-force force limit, driver.max_cart_force (default 1000.0)]\n"
+  "\t[--force-weight force cost weight (default 0.01)]\n"
+  "\t[--grid-cells lookup grid cells per state dimension (default 6)]\n"
+  "\t[--validation-samples random states compared with the online MPC (default 1000)]\n"
+  "\t[--output table path (default explicit_mpc.bin)]\n"
+  "\t[-h]\n";
+
+struct ExplicitMpcSettings
+{
+  bool init(int argc, char * argv[])
+  {
+    const pendulum::pendulum_tools::CommandLine command_line(argc, argv, USAGE);
+    if (command_line.print_usage_if_requested()) {
+      return false;
+    }
+    command_line.get("--horizon", builder.horizon);
+    double sample_period_us = 0.0;
+    if (command_line.get("--sample-period-us", sample_period_us)) {
+      builder.sample_period = 1e-6 * sample_period_us;
+    }
+    command_line.get("--max-cart-force", builder.max_force);
+    command_line.get("--force-weight", builder.force_weight);
+    command_line.get("--grid-cells", builder.grid_cells);
+    command_line.get("--validation-samples", validation_samples);
+    command_line.get("--output", output_file);
+    return true;
+  }
+
+  pendulum::pendulum_tools::ExplicitMpcBuilder::Config builder;
+  std::size_t validation_samples = 1000U;
+  std::string output_file = "explicit_mpc.bin";
+};
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  ExplicitMpcSettings settings;
+  try {
+    if (!settings.init(argc, argv)) {
+      return EXIT_FAILURE;
+    }
+
+    using pendulum::pendulum_tools::ExplicitMpcBuilder;
+
+    // same defaults used by the pendulum_driver node
+    const pendulum::pendulum_driver::CartPoleParameters params{1.0, 5.0, 2.0, 20.0, -9.8};
+    const ExplicitMpcBuilder builder(params, settings.builder);
+
+    const auto gain = builder.get_unconstrained_gain();
+    std::printf(
+      "unconstrained feedback matrix [%.4f, %.4f, %.4f, %.4f]\n",
+      -gain[0], -gain[1], -gain[2], -gain[3]);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto table = builder.build();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const auto bytes = table.to_bytes();
+    std::printf(
+      "%zu regions, %zu cell candidates, %zu bytes, built in %.3f s\n",
+      table.get_regions().size(), table.get_num_cell_regions(), bytes.size(), elapsed.count());
+
+    // compare the table with the online solution inside the grid
+    const auto & cfg = settings.builder;
+    std::mt19937 rand_gen(42U);
+    double max_error = 0.0;
+    std::size_t saturated = 0U;
+    for (std::size_t k = 0; k < settings.validation_samples; k++) {
+      ExplicitMpcBuilder::State error;
+      for (std::size_t i = 0; i < error.size(); i++) {
+        std::uniform_real_distribution<double> dist(cfg.grid_lower[i], cfg.grid_upper[i]);
+        error[i] = dist(rand_gen);
+      }
+      const double expected = builder.solve_online(error);
+      max_error = std::max(max_error, std::fabs(table.evaluate(error.data()) - expected));
+      if (std::fabs(expected) >= cfg.max_force * (1.0 - 1e-9)) {
+        saturated++;
+      }
+    }
+    std::printf(
+      "validation: max force error %.3e N over %zu states, %zu saturated\n",
+      max_error, settings.validation_samples, saturated);
+
+    table.save(settings.output_file);
+    std::printf("table written to %s\n", settings.output_file.c_str());
+  } catch (const std::exception & e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,306 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ament_index_cpp/get_package_prefix.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "statistics_msgs/msg/metrics_message.hpp"
+#include "statistics_msgs/msg/statistic_data_type.hpp"
+
+#include "pendulum_tools/command_line.hpp"
+#include "pendulum_tools/fleet_supervisor.hpp"
+
+namespace
+{
+using pendulum::pendulum_tools::FleetMetrics;
+using pendulum::pendulum_tools::PeriodStatistics;
+
+constexpr char USAGE[] =
+  "Usage: pendulum_fleet [options]\n"
+  "\t[--instances number of pendulum_demo processes (default 4)]\n"
+  "\t[--cores cores of the machine, 0 for all (default 0)]\n"
+  "\t[--reserved-cores first cores left to the system and the supervisor (default 1)]\n"
+  "\t[--priority real-time priority of every instance, 0 to disable (default 0)]\n"
+  "\t[--lock-memory-size locked memory budget of every instance in MB (default 0)]\n"
+  "\t[--params-file parameters file of the instances]\n"
+  "\t[--duration run duration in seconds, 0 runs until interrupted (default 30.0)]\n"
+  "\t[--output aggregated report csv path]\n"
+  "\t[--executable pendulum_demo executable (default: from the pendulum_demo package)]\n"
+  "\t[-h]\n";
+
+struct FleetSettings
+{
+  bool init(int argc, char * argv[])
+  {
+    const pendulum::pendulum_tools::CommandLine command_line(argc, argv, USAGE);
+    if (command_line.print_usage_if_requested()) {
+      return false;
+    }
+    command_line.get("--instances", instances);
+    command_line.get("--cores", cores);
+    command_line.get("--reserved-cores", reserved_cores);
+    command_line.get("--priority", priority);
+    command_line.get("--lock-memory-size", lock_memory_size_mb);
+    command_line.get("--params-file", params_file);
+    command_line.get("--duration", duration);
+    command_line.get("--output", output_file);
+    command_line.get("--executable", executable);
+    if (cores == 0U) {
+      cores = std::thread::hardware_concurrency();
+    }
+    if (executable.empty()) {
+      executable = ament_index_cpp::get_package_prefix("pendulum_demo") +
+        "/lib/pendulum_demo/pendulum_demo";
+    }
+    return true;
+  }
+
+  std::size_t instances = 4U;
+  std::size_t cores = 0U;
+  std::size_t reserved_cores = 1U;
+  std::size_t priority = 0U;
+  std::size_t lock_memory_size_mb = 0U;
+  std::string params_file;
+  double duration = 30.0;
+  std::string output_file;
+  std::string executable;
+};
+
+const char * const SOURCE_TOPICS[FleetMetrics::NUM_SOURCES] = {"driver_stats", "controller_stats"};
+
+std::string get_namespace(std::size_t instance)
+{
+  return "/pendulum_" + std::to_string(instance);
+}
+
+/// \brief Starts an instance restricted to a core set
+/// \return Process id of the instance
+pid_t spawn_instance(const std::vector<std::string> & args, const std::vector<std::size_t> & cores)
+{
+  // prepare everything before forking, the child only calls async-signal-safe functions
+  std::vector<char *> argv;
+  for (const auto & arg : args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const std::size_t core : cores) {
+    CPU_SET(core, &set);
+  }
+
+  const pid_t pid = fork();
+  if (pid < 0) {
+    throw std::runtime_error("could not start " + args[0]);
+  }
+  if (pid == 0) {
+    // all the threads of the instance, including the middleware ones, inherit the affinity
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+      _exit(126);
+    }
+    execv(argv[0], argv.data());
+    _exit(127);
+  }
+  return pid;
+}
+
+PeriodStatistics to_period_statistics(const statistics_msgs::msg::MetricsMessage & msg)
+{
+  using statistics_msgs::msg::StatisticDataType;
+  PeriodStatistics stats;
+  for (const auto & point : msg.statistics) {
+    switch (point.data_type) {
+      case StatisticDataType::STATISTICS_DATA_TYPE_AVERAGE:
+        stats.average = point.data;
+        break;
+      case StatisticDataType::STATISTICS_DATA_TYPE_MINIMUM:
+        stats.minimum = point.data;
+        break;
+      case StatisticDataType::STATISTICS_DATA_TYPE_MAXIMUM:
+        stats.maximum = point.data;
+        break;
+      case StatisticDataType::STATISTICS_DATA_TYPE_STDDEV:
+        stats.standard_deviation = point.data;
+        break;
+      case StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT:
+        stats.sample_count = static_cast<std::uint64_t>(point.data);
+        break;
+      default:
+        break;
+    }
+  }
+  return stats;
+}
+
+void print_row(const char * name, const std::string & cores, const char * source,
+  const PeriodStatistics & stats)
+{
+  std::printf(
+    "%-12s %-8s %-17s %9lu %9.3f %9.3f %9.3f %9.3f\n", name, cores.c_str(), source,
+    static_cast<unsigned long>(stats.sample_count), stats.average, stats.minimum,
+    stats.maximum, stats.standard_deviation);
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  FleetSettings settings;
+  std::vector<pid_t> pids;
+  int32_t ret = 0;
+  try {
+    if (!settings.init(argc, argv)) {
+      return EXIT_FAILURE;
+    }
+    const auto partition = pendulum::pendulum_tools::partition_cores(
+      settings.cores, settings.reserved_cores, settings.instances);
+
+    rclcpp::init(argc, argv);
+    auto node = std::make_shared<rclcpp::Node>("pendulum_fleet_supervisor");
+    FleetMetrics metrics(settings.instances);
+    std::vector<rclcpp::Subscription<statistics_msgs::msg::MetricsMessage>::SharedPtr> subs;
+    for (std::size_t i = 0U; i < settings.instances; i++) {
+      for (std::size_t s = 0U; s < FleetMetrics::NUM_SOURCES; s++) {
+        const auto source = static_cast<FleetMetrics::Source>(s);
+        subs.push_back(
+          node->create_subscription<statistics_msgs::msg::MetricsMessage>(
+            get_namespace(i) + "/" + SOURCE_TOPICS[s], rclcpp::QoS(10),
+            [&metrics, i, source](const statistics_msgs::msg::MetricsMessage::SharedPtr msg) {
+              // the state and command messages have no header, only the period is measured
+              if (msg->metrics_source == "message_period") {
+                metrics.add(i, source, to_period_statistics(*msg));
+              }
+            }));
+      }
+    }
+
+    for (std::size_t i = 0U; i < settings.instances; i++) {
+      std::vector<std::string> args{settings.executable, "--autostart", "True"};
+      if (settings.priority > 0U) {
+        args.insert(args.end(), {"--priority", std::to_string(settings.priority)});
+      }
+      if (settings.lock_memory_size_mb > 0U) {
+        args.insert(
+          args.end(), {"--lock-memory-size", std::to_string(settings.lock_memory_size_mb)});
+      }
+      args.insert(args.end(), {"--ros-args", "-r", "__ns:=" + get_namespace(i)});
+      if (!settings.params_file.empty()) {
+        args.insert(args.end(), {"--params-file", settings.params_file});
+      }
+      args.insert(args.end(), {"-p", "enable_topic_stats:=True"});
+      pids.push_back(spawn_instance(args, partition[i]));
+      RCLCPP_INFO(
+        node->get_logger(), "started %s on cores %s (pid %d)", get_namespace(i).c_str(),
+        pendulum::pendulum_tools::format_cpu_list(partition[i]).c_str(), pids.back());
+    }
+
+    rclcpp::executors::SingleThreadedExecutor exec;
+    exec.add_node(node);
+    const auto end = std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(settings.duration));
+    while (rclcpp::ok() &&
+      (settings.duration <= 0.0 || std::chrono::steady_clock::now() < end))
+    {
+      exec.spin_once(std::chrono::milliseconds(100));
+      for (std::size_t i = 0U; i < pids.size(); i++) {
+        int status = 0;
+        if (pids[i] > 0 && waitpid(pids[i], &status, WNOHANG) == pids[i]) {
+          RCLCPP_ERROR(
+            node->get_logger(), "%s exited early with status %d", get_namespace(i).c_str(),
+            status);
+          pids[i] = 0;
+          ret = 1;
+        }
+      }
+    }
+
+    std::printf(
+      "%-12s %-8s %-17s %9s %9s %9s %9s %9s\n", "instance", "cores", "source", "samples",
+      "avg [ms]", "min [ms]", "max [ms]", "std [ms]");
+    for (std::size_t i = 0U; i < settings.instances; i++) {
+      const std::string cores = pendulum::pendulum_tools::format_cpu_list(partition[i]);
+      for (std::size_t s = 0U; s < FleetMetrics::NUM_SOURCES; s++) {
+        print_row(
+          get_namespace(i).c_str() + 1, cores, SOURCE_TOPICS[s],
+          metrics.get(i, static_cast<FleetMetrics::Source>(s)));
+      }
+    }
+    for (std::size_t s = 0U; s < FleetMetrics::NUM_SOURCES; s++) {
+      const auto source = static_cast<FleetMetrics::Source>(s);
+      print_row("fleet", "", SOURCE_TOPICS[s], metrics.get_fleet(source));
+      std::printf(
+        "%s: worst instance %s, %zu instances without statistics\n", SOURCE_TOPICS[s],
+        get_namespace(metrics.get_worst_instance(source)).c_str() + 1,
+        metrics.get_num_silent(source));
+    }
+
+    if (!settings.output_file.empty()) {
+      std::ofstream out(settings.output_file);
+      if (!out) {
+        throw std::runtime_error("could not open " + settings.output_file);
+      }
+      out << "instance,cores,source,samples,average,minimum,maximum,standard_deviation\n";
+      for (std::size_t i = 0U; i < settings.instances; i++) {
+        for (std::size_t s = 0U; s < FleetMetrics::NUM_SOURCES; s++) {
+          const auto & stats = metrics.get(i, static_cast<FleetMetrics::Source>(s));
+          out << i << ",\"" << pendulum::pendulum_tools::format_cpu_list(partition[i]) <<
+            "\"," << SOURCE_TOPICS[s] << "," << stats.sample_count << "," << stats.average <<
+            "," << stats.minimum << "," << stats.maximum << "," << stats.standard_deviation <<
+            "\n";
+        }
+      }
+    }
+    rclcpp::shutdown();
+  } catch (const std::exception & e) {
+    std::cerr << e.what() << std::endl;
+    ret = 2;
+  }
+
+  // stop the instances, forcing the ones that do not exit
+  for (const pid_t pid : pids) {
+    if (pid > 0) {
+      kill(pid, SIGINT);
+    }
+  }
+  const auto kill_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  for (const pid_t pid : pids) {
+    if (pid <= 0) {
+      continue;
+    }
+    while (waitpid(pid, nullptr, WNOHANG) == 0) {
+      if (std::chrono::steady_clock::now() > kill_deadline) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  return ret;
+}
@@ -0,0 +1,108 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pendulum_tools/command_line.hpp"
+#include "pendulum_tools/fleet_scheduler.hpp"
+#include "pendulum_utils/process_settings.hpp"
+
+namespace
+{
+constexpr char USAGE[] =
+  "Usage: pendulum_fleet_scheduler [options]\n"
+  "\t[--instances number of simulated pendulums (default 1000)]\n"
+  "\t[--rates comma separated update rates in Hz, assigned round robin "
+  "(default 1000,500,100)]\n"
+  "\t[--tick-us timing wheel resolution (default 100)]\n"
+  "\t[--duration run duration in seconds (default 5.0)]\n"
+  "\t[--simulated run as fast as possible in simulated time]\n"
+  "\t[--utilization target core utilization for the capacity (default 0.7)]\n"
+  "\t[--priority real-time priority of the scheduler thread]\n"
+  "\t[--cpu-affinity cpu mask of the scheduler thread]\n"
+  "\t[--lock-memory-size lock a fixed memory size in MB]\n"
+  "\t[-h]\n";
+
+struct FleetSettings
+{
+  bool init(int argc, char * argv[])
+  {
+    const pendulum::pendulum_tools::CommandLine command_line(argc, argv, USAGE);
+    if (command_line.print_usage_if_requested()) {
+      return false;
+    }
+    command_line.get("--instances", scheduler.instances);
+    command_line.get("--rates", scheduler.rates);
+    std::size_t tick_us = 0U;
+    if (command_line.get("--tick-us", tick_us)) {
+      scheduler.tick = std::chrono::microseconds(tick_us);
+    }
+    command_line.get("--duration", scheduler.duration);
+    scheduler.realtime = !command_line.has("--simulated");
+    command_line.get("--utilization", scheduler.target_utilization);
+    // same real-time options as pendulum_demo, applied to the thread running the scheduler
+    return process.init(argc, argv);
+  }
+
+  pendulum::pendulum_tools::FleetScheduler::Config scheduler;
+  pendulum::utils::ProcessSettings process;
+};
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  FleetSettings settings;
+  try {
+    if (!settings.init(argc, argv)) {
+      return EXIT_FAILURE;
+    }
+
+    using pendulum::pendulum_driver::PendulumDriver;
+    using pendulum::pendulum_tools::FleetScheduler;
+
+    // same defaults used by the pendulum_driver node
+    const PendulumDriver::Config driver_config{1.0, 5.0, 2.0, 20.0, -9.8, 1000.0, 1.0,
+      std::chrono::microseconds(1000)};
+    FleetScheduler fleet(driver_config, settings.scheduler);
+    // the fleet is allocated, the memory can be locked and this thread made real-time
+    settings.process.configure_process();
+
+    std::printf(
+      "running %zu pendulums for %.1f s (%s)\n", settings.scheduler.instances,
+      settings.scheduler.duration, settings.scheduler.realtime ? "real time" : "simulated time");
+    const auto result = fleet.run();
+    std::printf(
+      "updates %lu, wake-ups %lu (%lu cascade only), overruns %lu, max lateness %.1f us\n",
+      static_cast<unsigned long>(result.num_updates),
+      static_cast<unsigned long>(result.num_wakeups),
+      static_cast<unsigned long>(result.num_cascades),
+      static_cast<unsigned long>(result.num_overruns), result.max_lateness * 1e6);
+    std::printf(
+      "busy %.3f s of %.3f s (utilization %.1f %%), %.0f ns per update\n",
+      result.busy_time, result.scheduled_time, 100.0 * result.utilization,
+      result.cost_per_update * 1e9);
+    std::printf(
+      "capacity: %.0f instances per core at %.0f %% utilization\n",
+      result.instances_per_core, 100.0 * settings.scheduler.target_utilization);
+    return result.num_overruns == 0U ? 0 : 1;
+  } catch (const std::exception & e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,137 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pendulum_tools/closed_loop_rollout.hpp"
+#include "pendulum_tools/command_line.hpp"
+#include "pendulum_tools/gain_tuner.hpp"
+
+namespace
+{
+constexpr char USAGE[] =
+  "Usage: pendulum_gain_tuner [options]\n"
+  "\t[--iterations optimizer iterations (default 40)]\n"
+  "\t[--population candidates per iteration (default 64)]\n"
+  "\t[--elite candidates used to refit the distribution (default 8)]\n"
+  "\t[--threads worker threads, 0 for all cores (default 0)]\n"
+  "\t[--duration simulated seconds per scenario (default 5.0)]\n"
+  "\t[--physics-period-us physics and control period (default 10000)]\n"
+  "\t[--noise-level driver noise level (default 0.0)]\n"
+  "\t[--state-weight ISE weight (default 1.0)]\n"
+  "\t[--effort-weight force effort weight (default 1e-5)]\n"
+  "\t[--settling-weight settling time weight (default 0.1)]\n"
+  "\t[--gains initial feedback matrix, comma separated (default pendulum_controller's)]\n"
+  "\t[--output parameter file fragment path]\n"
+  "\t[-h]\n";
+
+struct TunerSettings
+{
+  bool init(int argc, char * argv[])
+  {
+    const pendulum::pendulum_tools::CommandLine command_line(argc, argv, USAGE);
+    if (command_line.print_usage_if_requested()) {
+      return false;
+    }
+    command_line.get("--iterations", tuner.iterations);
+    command_line.get("--population", tuner.population);
+    command_line.get("--elite", tuner.elite);
+    command_line.get("--threads", tuner.threads);
+    command_line.get("--duration", duration);
+    command_line.get("--physics-period-us", physics_period_us);
+    command_line.get("--noise-level", noise_level);
+    command_line.get("--state-weight", weights.state_error);
+    command_line.get("--effort-weight", weights.control_effort);
+    command_line.get("--settling-weight", weights.settling_time);
+    if (command_line.get("--gains", initial_gains) && initial_gains.size() != 4U) {
+      throw std::invalid_argument("--gains needs the 4 elements of the feedback matrix");
+    }
+    command_line.get("--output", output_file);
+    return true;
+  }
+
+  pendulum::pendulum_tools::GainTuner::Config tuner;
+  pendulum::pendulum_tools::CostWeights weights;
+  double duration = 5.0;
+  // state_publish_period_us of the bringup parameter file, the gains depend on the loop rate
+  std::size_t physics_period_us = 10000U;
+  // noise makes the cost stochastic, the tuner works best with deterministic rollouts
+  double noise_level = 0.0;
+  // feedback_matrix default of the pendulum_controller node
+  std::vector<double> initial_gains{-10.0000, -51.5393, 356.8637, 154.4146};
+  std::string output_file;
+};
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  TunerSettings settings;
+  try {
+    if (!settings.init(argc, argv)) {
+      return EXIT_FAILURE;
+    }
+
+    using pendulum::pendulum_driver::PendulumDriver;
+    using pendulum::pendulum_tools::ClosedLoopRollout;
+    using pendulum::pendulum_tools::GainTuner;
+
+    // same defaults used by the pendulum_driver node
+    const PendulumDriver::Config driver_config(
+      1.0, 5.0, 2.0, 20.0, -9.8, 1000.0, settings.noise_level,
+      std::chrono::microseconds{settings.physics_period_us});
+    const ClosedLoopRollout rollout(driver_config, settings.duration, settings.weights);
+    const GainTuner tuner(rollout, ClosedLoopRollout::default_scenarios(), settings.tuner);
+
+    const auto initial = tuner.evaluate(settings.initial_gains);
+    std::printf(
+      "initial cost %.4f (ise %.4f, effort %.1f, settling %.3f s)\n",
+      initial.cost, initial.ise, initial.effort, initial.settling_time);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto best = tuner.tune(
+      settings.initial_gains,
+      [](const GainTuner::IterationReport & report) {
+        std::printf(
+          "iteration %3zu: best cost %.4f, elite mean cost %.4f\n",
+          report.iteration, report.best_cost, report.elite_mean_cost);
+      });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const auto result = tuner.evaluate(best);
+    std::printf(
+      "final cost %.4f (ise %.4f, effort %.1f, settling %.3f s) in %.1f s\n",
+      result.cost, result.ise, result.effort, result.settling_time, elapsed.count());
+
+    const std::string yaml = GainTuner::to_param_yaml(best);
+    std::cout << yaml;
+    if (!settings.output_file.empty()) {
+      std::ofstream out(settings.output_file);
+      if (!out) {
+        std::cerr << "Could not open " << settings.output_file << std::endl;
+        return 2;
+      }
+      out << yaml;
+    }
+  } catch (const std::exception & e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,175 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pendulum_tools/command_line.hpp"
+#include "pendulum_tools/parareal_solver.hpp"
+
+namespace
+{
+constexpr char USAGE[] =
+  "Usage: pendulum_parareal [options]\n"
+  "\t[--forces file with one cart force per physics step (default: synthetic pushes)]\n"
+  "\t[--duration simulated seconds when no force file is given (default 3600.0)]\n"
+  "\t[--physics-period-us physics update period (default 1000)]\n"
+  "\t[--slices time slices, 0 for 4 per thread (default 0)]\n"
+  "\t[--threads worker threads, 0 for all cores (default 0)]\n"
+  "\t[--max-iterations maximum corrections (default 20)]\n"
+  "\t[--tolerance maximum slice state correction (default 1e-9)]\n"
+  "\t[--coarse-ratio physics steps per coarse step (default 20)]\n"
+  "\t[--compare also run the sequential simulation and report the speedup]\n"
+  "\t[--output trajectory csv path]\n"
+  "\t[--output-decimation write one of every N states (default 1)]\n"
+  "\t[-h]\n";
+
+struct PararealSettings
+{
+  bool init(int argc, char * argv[])
+  {
+    const pendulum::pendulum_tools::CommandLine command_line(argc, argv, USAGE);
+    if (command_line.print_usage_if_requested()) {
+      return false;
+    }
+    command_line.get("--forces", forces_file);
+    command_line.get("--duration", duration);
+    command_line.get("--physics-period-us", physics_period_us);
+    command_line.get("--slices", solver.slices);
+    command_line.get("--threads", solver.threads);
+    command_line.get("--max-iterations", solver.max_iterations);
+    command_line.get("--tolerance", solver.tolerance);
+    command_line.get("--coarse-ratio", solver.coarse_ratio);
+    compare = command_line.has("--compare");
+    command_line.get("--output", output_file);
+    command_line.get("--output-decimation", output_decimation);
+    if (output_decimation == 0U) {output_decimation = 1U;}
+    solver.store_trajectory = !output_file.empty();
+    return true;
+  }
+
+  pendulum::pendulum_tools::PararealSolver::Config solver;
+  std::string forces_file;
+  double duration = 3600.0;
+  std::size_t physics_period_us = 1000U;
+  bool compare = false;
+  std::string output_file;
+  std::size_t output_decimation = 1U;
+};
+
+std::vector<double> load_forces(const std::string & path)
+{
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("could not open " + path);
+  }
+  std::vector<double> forces;
+  double force;
+  while (in >> force) {
+    forces.push_back(force);
+  }
+  return forces;
+}
+
+std::vector<double> synthetic_forces(std::size_t steps, double dt)
+{
+  // slow oscillating push with a short disturbance every 10 seconds
+  std::vector<double> forces(steps);
+  for (std::size_t k = 0; k < steps; k++) {
+    const double t = static_cast<double>(k) * dt;
+    forces[k] = 20.0 * std::sin(0.5 * t) + ((std::fmod(t, 10.0) < 0.1) ? 100.0 : 0.0);
+  }
+  return forces;
+}
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  PararealSettings settings;
+  try {
+    if (!settings.init(argc, argv)) {
+      return EXIT_FAILURE;
+    }
+
+    using pendulum::pendulum_tools::PararealSolver;
+
+    const std::chrono::microseconds physics_period{settings.physics_period_us};
+    const double dt = std::chrono::duration<double>(physics_period).count();
+    const std::vector<double> forces = settings.forces_file.empty() ?
+      synthetic_forces(static_cast<std::size_t>(settings.duration / dt), dt) :
+      load_forces(settings.forces_file);
+
+    // same defaults used by the pendulum_driver node, starting at rest in the down position
+    const pendulum::pendulum_driver::CartPoleParameters params{1.0, 5.0, 2.0, 20.0, -9.8};
+    const PararealSolver solver(params, physics_period, settings.solver);
+    const PararealSolver::State initial_state{{0.0, 0.0, 0.0, 0.0}};
+
+    std::printf(
+      "simulating %zu steps (%.1f s)\n", forces.size(),
+      static_cast<double>(forces.size()) * dt);
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = solver.solve(
+      initial_state, forces,
+      [](const PararealSolver::IterationReport & report) {
+        std::printf(
+          "iteration %3zu: max correction %.3e, exact slices %zu\n",
+          report.iteration, report.max_correction, report.converged_slices);
+      });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf(
+      "%s after %zu iterations in %.3f s, final state [%.6f, %.6f, %.6f, %.6f]\n",
+      result.converged ? "converged" : "NOT converged", result.iterations, elapsed.count(),
+      result.final_state[0], result.final_state[1], result.final_state[2],
+      result.final_state[3]);
+
+    if (settings.compare) {
+      const auto seq_start = std::chrono::steady_clock::now();
+      const auto expected = solver.solve_sequential(initial_state, forces);
+      const std::chrono::duration<double> seq_elapsed =
+        std::chrono::steady_clock::now() - seq_start;
+      double max_error = 0.0;
+      for (std::size_t i = 0; i < 4U; i++) {
+        max_error = std::max(max_error, std::fabs(expected[i] - result.final_state[i]));
+      }
+      std::printf(
+        "sequential %.3f s, speedup %.2f x, final state error %.3e\n",
+        seq_elapsed.count(), seq_elapsed.count() / elapsed.count(), max_error);
+    }
+
+    if (!settings.output_file.empty()) {
+      std::ofstream out(settings.output_file);
+      if (!out) {
+        std::cerr << "Could not open " << settings.output_file << std::endl;
+        return 2;
+      }
+      out << "time,cart_position,cart_velocity,pole_angle,pole_velocity\n";
+      for (std::size_t k = 0; k <= forces.size(); k += settings.output_decimation) {
+        const double * y = &result.trajectory[4U * k];
+        out << static_cast<double>(k) * dt << "," << y[0] << "," << y[1] << "," << y[2] <<
+          "," << y[3] << "\n";
+      }
+    }
+    return result.converged ? 0 : 1;
+  } catch (const std::exception & e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,92 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "pendulum_tools/command_line.hpp"
+
+using pendulum::pendulum_tools::CommandLine;
+
+class TestCommandLine : public ::testing::Test
+{
+protected:
+  CommandLine make(std::vector<std::string> & args)
+  {
+    argv.clear();
+    for (auto & arg : args) {
+      argv.push_back(&arg[0]);
+    }
+    return CommandLine(static_cast<int>(argv.size()), argv.data(), "usage\n");
+  }
+
+  std::vector<char *> argv;
+};
+
+TEST_F(TestCommandLine, read_values)
+{
+  std::vector<std::string> args{
+    "tool", "--count", "12", "--ratio", "0.25", "--name", "out.csv", "--list", "1,-2.5,3e2",
+    "--flag"};
+  const CommandLine command_line = make(args);
+  EXPECT_FALSE(command_line.print_usage_if_requested());
+  EXPECT_TRUE(command_line.has("--flag"));
+
+  std::size_t count = 0U;
+  double ratio = 0.0;
+  std::string name;
+  std::vector<double> list;
+  EXPECT_TRUE(command_line.get("--count", count));
+  EXPECT_TRUE(command_line.get("--ratio", ratio));
+  EXPECT_TRUE(command_line.get("--name", name));
+  EXPECT_TRUE(command_line.get("--list", list));
+  EXPECT_EQ(count, 12U);
+  EXPECT_DOUBLE_EQ(ratio, 0.25);
+  EXPECT_EQ(name, "out.csv");
+  EXPECT_EQ(list, (std::vector<double>{1.0, -2.5, 300.0}));
+}
+
+TEST_F(TestCommandLine, missing_options_keep_defaults)
+{
+  std::vector<std::string> args{"tool", "--count"};
+  const CommandLine command_line = make(args);
+  std::size_t count = 7U;
+  double ratio = 0.5;
+  EXPECT_FALSE(command_line.get("--count", count));
+  EXPECT_FALSE(command_line.get("--ratio", ratio));
+  EXPECT_EQ(count, 7U);
+  EXPECT_DOUBLE_EQ(ratio, 0.5);
+}
+
+TEST_F(TestCommandLine, invalid_values)
+{
+  std::vector<std::string> args{"tool", "--count", "-3", "--ratio", "1.5x", "--list", "1,a"};
+  const CommandLine command_line = make(args);
+  std::size_t count = 0U;
+  double ratio = 0.0;
+  std::vector<double> list;
+  EXPECT_THROW(command_line.get("--count", count), std::invalid_argument);
+  EXPECT_THROW(command_line.get("--ratio", ratio), std::invalid_argument);
+  EXPECT_THROW(command_line.get("--list", list), std::invalid_argument);
+}
+
+TEST_F(TestCommandLine, usage)
+{
+  std::vector<std::string> args{"tool", "-h"};
+  const CommandLine command_line = make(args);
+  testing::internal::CaptureStdout();
+  EXPECT_TRUE(command_line.print_usage_if_requested());
+  EXPECT_EQ(testing::internal::GetCapturedStdout(), "usage\n");
+}
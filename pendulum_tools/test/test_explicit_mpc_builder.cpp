@@ -0,0 +1,78 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "pendulum_tools/explicit_mpc_builder.hpp"
+
+using pendulum::pendulum_driver::CartPoleParameters;
+using pendulum::pendulum_tools::ExplicitMpcBuilder;
+
+class TestExplicitMpcBuilder : public ::testing::Test
+{
+protected:
+  CartPoleParameters params{1.0, 5.0, 2.0, 20.0, -9.8};
+  ExplicitMpcBuilder::Config config;
+};
+
+TEST_F(TestExplicitMpcBuilder, unconstrained_gain_matches_lqr)
+{
+  // the default weights reproduce the default controller.feedback_matrix
+  const std::vector<double> feedback_matrix = {-10.0000, -51.5393, 356.8637, 154.4146};
+  const ExplicitMpcBuilder builder{params, config};
+  const auto gain = builder.get_unconstrained_gain();
+  for (std::size_t i = 0; i < 4U; i++) {
+    EXPECT_NEAR(-feedback_matrix[i], gain[i], 0.05 * std::fabs(feedback_matrix[i]));
+  }
+  // without active constraints in the grid the table has a single region
+  EXPECT_EQ(1U, builder.build().get_regions().size());
+}
+
+TEST_F(TestExplicitMpcBuilder, table_matches_online_mpc)
+{
+  config.max_force = 50.0;
+  const ExplicitMpcBuilder builder{params, config};
+  const auto table = builder.build();
+  EXPECT_GT(table.get_regions().size(), 1U);
+
+  std::mt19937 rand_gen(1U);
+  std::size_t saturated = 0U;
+  for (std::size_t k = 0; k < 500U; k++) {
+    ExplicitMpcBuilder::State error;
+    for (std::size_t i = 0; i < 4U; i++) {
+      std::uniform_real_distribution<double> dist(config.grid_lower[i], config.grid_upper[i]);
+      error[i] = dist(rand_gen);
+    }
+    const double expected = builder.solve_online(error);
+    const double force = table.evaluate(error.data());
+    EXPECT_NEAR(expected, force, 1e-3);
+    EXPECT_LE(std::fabs(force), config.max_force);
+    if (std::fabs(expected) >= config.max_force - 1e-9) {
+      saturated++;
+    }
+  }
+  // the constraints are active in a large part of the grid
+  EXPECT_GT(saturated, 50U);
+}
+
+TEST_F(TestExplicitMpcBuilder, invalid_config)
+{
+  config.horizon = 11U;
+  EXPECT_THROW(ExplicitMpcBuilder(params, config), std::invalid_argument);
+  config.horizon = 4U;
+  config.max_force = 0.0;
+  EXPECT_THROW(ExplicitMpcBuilder(params, config), std::invalid_argument);
+}
@@ -0,0 +1,122 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_tools/fleet_scheduler.hpp"
+
+using pendulum::pendulum_driver::PendulumDriver;
+using pendulum::pendulum_tools::FleetScheduler;
+
+class TestFleetScheduler : public ::testing::Test
+{
+protected:
+  PendulumDriver::Config driver_config{1.0, 5.0, 2.0, 20.0, -9.8, 1000.0, 0.0,
+    std::chrono::microseconds(1000)};
+};
+
+TEST_F(TestFleetScheduler, simulated_time_update_counts)
+{
+  FleetScheduler::Config config;
+  config.instances = 30U;
+  config.rates = {1000.0, 250.0, 100.0};
+  config.duration = 2.0;
+  config.realtime = false;
+  FleetScheduler scheduler{driver_config, config};
+  EXPECT_EQ(scheduler.get_period_ticks(0U), 10U);
+  EXPECT_EQ(scheduler.get_period_ticks(1U), 40U);
+  EXPECT_EQ(scheduler.get_period_ticks(2U), 100U);
+
+  const auto result = scheduler.run();
+  // every instance is updated at its rate
+  for (std::size_t i = 0U; i < config.instances; i++) {
+    const double rate = config.rates[i % 3U];
+    EXPECT_EQ(scheduler.get_num_updates(i), static_cast<std::uint64_t>(rate * config.duration));
+  }
+  EXPECT_EQ(result.num_updates, 10U * (2000U + 500U + 200U));
+  EXPECT_EQ(result.num_overruns, 0U);
+  EXPECT_EQ(result.max_lateness, 0.0);
+  // the instances sharing an expiry tick are served in one wake-up
+  EXPECT_LE(result.num_wakeups, 20000U);
+  EXPECT_GT(result.instances_per_core, 0.0);
+
+  // a second run starts from the beginning
+  EXPECT_EQ(scheduler.run().num_updates, result.num_updates);
+}
+
+TEST_F(TestFleetScheduler, cascade_wakeups)
+{
+  FleetScheduler::Config config;
+  config.instances = 1U;
+  // the period of 1000 ticks is beyond the first level of the wheel
+  config.rates = {10.0};
+  config.duration = 2.0;
+  config.realtime = false;
+  FleetScheduler scheduler{driver_config, config};
+  const auto result = scheduler.run();
+  EXPECT_EQ(result.num_updates, 20U);
+  // the wake-ups moving the timer to a finer level are not counted as serving wake-ups
+  EXPECT_EQ(result.num_wakeups, 20U);
+  EXPECT_GT(result.num_cascades, 0U);
+}
+
+TEST_F(TestFleetScheduler, drivers_are_simulated)
+{
+  FleetScheduler::Config config;
+  config.instances = 2U;
+  config.rates = {1000.0, 100.0};
+  config.duration = 1.0;
+  config.realtime = false;
+  // starting upright, the noise makes the pole fall at both rates
+  const PendulumDriver::Config noisy_config{1.0, 5.0, 2.0, 20.0, -9.8, 1000.0, 1.0,
+    std::chrono::microseconds(1000)};
+  FleetScheduler scheduler{noisy_config, config};
+  scheduler.run();
+  EXPECT_NE(scheduler.get_driver(0U).get_state().pole_angle, M_PI);
+  EXPECT_NE(scheduler.get_driver(1U).get_state().pole_angle, M_PI);
+  EXPECT_NE(
+    scheduler.get_driver(0U).get_state().pole_velocity,
+    scheduler.get_driver(1U).get_state().pole_velocity);
+}
+
+TEST_F(TestFleetScheduler, realtime_run)
+{
+  FleetScheduler::Config config;
+  config.instances = 100U;
+  config.rates = {1000.0, 500.0};
+  config.duration = 0.2;
+  FleetScheduler scheduler{driver_config, config};
+  const auto result = scheduler.run();
+  // late updates are caught up, so no update is lost
+  EXPECT_EQ(result.num_updates, 50U * (200U + 100U));
+  EXPECT_GT(result.busy_time, 0.0);
+  EXPECT_LT(result.utilization, 1.0);
+}
+
+TEST_F(TestFleetScheduler, invalid_config)
+{
+  FleetScheduler::Config config;
+  config.instances = 0U;
+  EXPECT_THROW(FleetScheduler(driver_config, config), std::invalid_argument);
+  config.instances = 1U;
+  config.rates = {20000.0};
+  EXPECT_THROW(FleetScheduler(driver_config, config), std::invalid_argument);
+  config.rates = {};
+  EXPECT_THROW(FleetScheduler(driver_config, config), std::invalid_argument);
+  config.rates = {100.0};
+  config.target_utilization = 1.5;
+  EXPECT_THROW(FleetScheduler(driver_config, config), std::invalid_argument);
+}
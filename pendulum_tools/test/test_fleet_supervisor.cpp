@@ -0,0 +1,76 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "pendulum_tools/fleet_supervisor.hpp"
+
+using pendulum::pendulum_tools::FleetMetrics;
+using pendulum::pendulum_tools::PeriodStatistics;
+using pendulum::pendulum_tools::format_cpu_list;
+using pendulum::pendulum_tools::partition_cores;
+
+TEST(TestFleetSupervisor, partition_cores)
+{
+  // 64 cores, 2 reserved, 20 instances of 3 cores, 2 cores left over
+  const auto partition = partition_cores(64U, 2U, 20U);
+  ASSERT_EQ(partition.size(), 20U);
+  EXPECT_EQ(partition[0], (std::vector<std::size_t>{2U, 3U, 4U}));
+  EXPECT_EQ(partition[19], (std::vector<std::size_t>{59U, 60U, 61U}));
+  EXPECT_EQ(format_cpu_list(partition[19]), "59-61");
+  EXPECT_EQ(format_cpu_list({1U, 3U, 4U, 5U, 8U}), "1,3-5,8");
+
+  EXPECT_EQ(partition_cores(8U, 0U, 8U)[7], (std::vector<std::size_t>{7U}));
+  EXPECT_THROW(partition_cores(8U, 1U, 8U), std::invalid_argument);
+  EXPECT_THROW(partition_cores(8U, 8U, 1U), std::invalid_argument);
+  EXPECT_THROW(partition_cores(8U, 0U, 0U), std::invalid_argument);
+}
+
+TEST(TestFleetSupervisor, merge_statistics)
+{
+  // samples {1, 3} and {2, 4, 6}
+  PeriodStatistics a{2.0, 1.0, 3.0, 1.0, 2U};
+  PeriodStatistics b{4.0, 2.0, 6.0, std::sqrt(8.0 / 3.0), 3U};
+  const auto merged = FleetMetrics::merge(a, b);
+  EXPECT_DOUBLE_EQ(merged.average, 16.0 / 5.0);
+  EXPECT_DOUBLE_EQ(merged.minimum, 1.0);
+  EXPECT_DOUBLE_EQ(merged.maximum, 6.0);
+  EXPECT_NEAR(merged.standard_deviation, std::sqrt(2.96), 1e-12);
+  EXPECT_EQ(merged.sample_count, 5U);
+}
+
+TEST(TestFleetSupervisor, fleet_metrics)
+{
+  FleetMetrics metrics(3U);
+  metrics.add(0U, FleetMetrics::DRIVER, PeriodStatistics{1.0, 0.9, 1.1, 0.05, 1000U});
+  metrics.add(0U, FleetMetrics::DRIVER, PeriodStatistics{1.0, 0.8, 1.3, 0.05, 1000U});
+  metrics.add(2U, FleetMetrics::DRIVER, PeriodStatistics{1.0, 0.5, 2.5, 0.2, 1000U});
+  // empty windows are ignored
+  metrics.add(1U, FleetMetrics::DRIVER, PeriodStatistics{NAN, NAN, NAN, NAN, 0U});
+
+  EXPECT_EQ(metrics.get(0U, FleetMetrics::DRIVER).sample_count, 2000U);
+  EXPECT_DOUBLE_EQ(metrics.get(0U, FleetMetrics::DRIVER).maximum, 1.3);
+  EXPECT_DOUBLE_EQ(metrics.get(0U, FleetMetrics::DRIVER).minimum, 0.8);
+  EXPECT_EQ(metrics.get_worst_instance(FleetMetrics::DRIVER), 2U);
+  EXPECT_EQ(metrics.get_num_silent(FleetMetrics::DRIVER), 1U);
+  EXPECT_EQ(metrics.get_num_silent(FleetMetrics::CONTROLLER), 3U);
+
+  const auto fleet = metrics.get_fleet(FleetMetrics::DRIVER);
+  EXPECT_EQ(fleet.sample_count, 3000U);
+  EXPECT_DOUBLE_EQ(fleet.average, 1.0);
+  EXPECT_DOUBLE_EQ(fleet.maximum, 2.5);
+  EXPECT_DOUBLE_EQ(fleet.minimum, 0.5);
+}
@@ -0,0 +1,112 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "pendulum_tools/closed_loop_rollout.hpp"
+#include "pendulum_tools/gain_tuner.hpp"
+
+using pendulum::pendulum_driver::PendulumDriver;
+using pendulum::pendulum_tools::ClosedLoopRollout;
+using pendulum::pendulum_tools::CostWeights;
+using pendulum::pendulum_tools::GainTuner;
+
+class TestGainTuner : public ::testing::Test
+{
+protected:
+  std::vector<double> feedback_matrix = {-10.0000, -51.5393, 356.8637, 154.4146};
+  PendulumDriver::Config driver_config{1.0, 5.0, 2.0, 20.0, -9.8, 1000.0, 0.0,
+    std::chrono::microseconds{1000}};
+  ClosedLoopRollout rollout{driver_config, 2.0, CostWeights{}};
+};
+
+TEST_F(TestGainTuner, stable_gains_do_not_fail)
+{
+  const auto result = rollout.run(feedback_matrix, ClosedLoopRollout::default_scenarios());
+  EXPECT_FALSE(result.failed);
+  EXPECT_GT(result.ise, 0.0);
+  EXPECT_GT(result.effort, 0.0);
+}
+
+TEST_F(TestGainTuner, zero_gains_fail)
+{
+  const auto result = rollout.run(
+    std::vector<double>{0.0, 0.0, 0.0, 0.0},
+    ClosedLoopRollout::default_scenarios());
+  EXPECT_TRUE(result.failed);
+}
+
+TEST_F(TestGainTuner, owns_rollout)
+{
+  // the tuner keeps its own copy of a temporary rollout
+  GainTuner::Config config;
+  const GainTuner tuner{
+    ClosedLoopRollout{driver_config, 2.0, CostWeights{}}, ClosedLoopRollout::default_scenarios(),
+    config};
+  const auto result = tuner.evaluate(feedback_matrix);
+  EXPECT_FALSE(result.failed);
+  EXPECT_DOUBLE_EQ(
+    result.cost, rollout.run(feedback_matrix, ClosedLoopRollout::default_scenarios()).cost);
+}
+
+TEST_F(TestGainTuner, tuning_improves_detuned_gains)
+{
+  GainTuner::Config config;
+  config.iterations = 3U;
+  config.population = 8U;
+  config.elite = 2U;
+  config.threads = 2U;
+  const GainTuner tuner{rollout, ClosedLoopRollout::default_scenarios(), config};
+
+  // the tuner keeps the initial gains if nothing better is found, so start far from the optimum
+  std::vector<double> detuned_matrix = feedback_matrix;
+  for (auto & gain : detuned_matrix) {
+    gain *= 0.6;
+  }
+  const auto detuned = tuner.evaluate(detuned_matrix);
+  ASSERT_FALSE(detuned.failed);
+
+  std::vector<GainTuner::IterationReport> reports;
+  const auto best = tuner.tune(
+    detuned_matrix,
+    [&reports](const GainTuner::IterationReport & report) {reports.push_back(report);});
+
+  ASSERT_EQ(config.iterations, reports.size());
+  ASSERT_EQ(feedback_matrix.size(), best.size());
+  EXPECT_LT(tuner.evaluate(best).cost, detuned.cost);
+  for (std::size_t i = 1U; i < reports.size(); i++) {
+    EXPECT_LE(reports[i].best_cost, reports[i - 1U].best_cost);
+  }
+  EXPECT_LT(reports.back().elite_mean_cost, detuned.cost);
+}
+
+TEST_F(TestGainTuner, invalid_config)
+{
+  GainTuner::Config config;
+  config.population = 4U;
+  config.elite = 5U;
+  EXPECT_THROW(
+    GainTuner(rollout, ClosedLoopRollout::default_scenarios(), config),
+    std::invalid_argument);
+}
+
+TEST_F(TestGainTuner, param_yaml)
+{
+  const std::string yaml = GainTuner::to_param_yaml(feedback_matrix);
+  EXPECT_NE(std::string::npos, yaml.find("/**/pendulum_controller:"));
+  EXPECT_NE(
+    std::string::npos,
+    yaml.find("feedback_matrix: [-10.0000, -51.5393, 356.8637, 154.4146]"));
+}
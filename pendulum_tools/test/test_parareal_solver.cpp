@@ -0,0 +1,118 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "pendulum_driver/pendulum_driver.hpp"
+#include "pendulum_tools/parareal_solver.hpp"
+
+using pendulum::pendulum_driver::CartPoleParameters;
+using pendulum::pendulum_driver::PendulumDriver;
+using pendulum::pendulum_tools::PararealSolver;
+
+class TestPararealSolver : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // 20 seconds of a recorded sinusoidal push at 1 kHz
+    forces.resize(20000U);
+    for (std::size_t k = 0; k < forces.size(); k++) {
+      forces[k] = 20.0 * std::sin(1e-3 * static_cast<double>(k));
+    }
+    config.slices = 16U;
+    config.threads = 4U;
+  }
+
+  CartPoleParameters params{1.0, 5.0, 2.0, 20.0, -9.8};
+  std::chrono::microseconds fine_step{1000};
+  PararealSolver::State initial_state{{0.0, 0.0, 0.5, 0.0}};
+  std::vector<double> forces;
+  PararealSolver::Config config;
+};
+
+TEST_F(TestPararealSolver, sequential_matches_driver_replay)
+{
+  PendulumDriver::Config driver_config{params.pendulum_mass, params.cart_mass,
+    params.pendulum_length, params.damping_coefficient, params.gravity, 1000.0, 0.0, fine_step};
+  PendulumDriver driver{driver_config};
+  driver.set_state(initial_state[0], initial_state[1], initial_state[2], initial_state[3]);
+  for (const double force : forces) {
+    driver.set_controller_cart_force(force);
+    driver.update();
+  }
+  const PararealSolver solver{params, fine_step, config};
+  const auto final_state = solver.solve_sequential(initial_state, forces);
+  EXPECT_NEAR(driver.get_state().cart_position, final_state[0], 1e-8);
+  EXPECT_NEAR(driver.get_state().cart_velocity, final_state[1], 1e-8);
+  EXPECT_NEAR(driver.get_state().pole_angle, final_state[2], 1e-8);
+  EXPECT_NEAR(driver.get_state().pole_velocity, final_state[3], 1e-8);
+}
+
+TEST_F(TestPararealSolver, converges_to_sequential_solution)
+{
+  const PararealSolver solver{params, fine_step, config};
+  std::vector<PararealSolver::IterationReport> reports;
+  const auto result = solver.solve(
+    initial_state, forces,
+    [&reports](const PararealSolver::IterationReport & report) {reports.push_back(report);});
+  const auto expected = solver.solve_sequential(initial_state, forces);
+
+  EXPECT_TRUE(result.converged);
+  // converging in fewer iterations than slices is what makes the solver faster
+  EXPECT_LT(result.iterations, config.slices / 2U);
+  ASSERT_EQ(result.iterations, reports.size());
+  for (std::size_t k = 0; k < reports.size(); k++) {
+    EXPECT_EQ(k + 1U, reports[k].iteration);
+    EXPECT_EQ(k + 1U, reports[k].converged_slices);
+  }
+  EXPECT_LE(reports.back().max_correction, config.tolerance);
+  for (std::size_t i = 0; i < 4U; i++) {
+    EXPECT_NEAR(expected[i], result.final_state[i], 1e-7);
+  }
+
+  ASSERT_EQ(4U * (forces.size() + 1U), result.trajectory.size());
+  EXPECT_EQ(initial_state[2], result.trajectory[2]);
+  for (std::size_t i = 0; i < 4U; i++) {
+    EXPECT_EQ(result.final_state[i], result.trajectory[4U * forces.size() + i]);
+  }
+}
+
+TEST_F(TestPararealSolver, exact_after_all_slices)
+{
+  // without tolerance every slice has to become exact, which reproduces the sequential result
+  config.slices = 8U;
+  config.tolerance = 0.0;
+  config.max_iterations = config.slices;
+  config.store_trajectory = false;
+  const PararealSolver solver{params, fine_step, config};
+  const auto result = solver.solve(initial_state, forces);
+  const auto expected = solver.solve_sequential(initial_state, forces);
+  EXPECT_TRUE(result.converged);
+  EXPECT_TRUE(result.trajectory.empty());
+  for (std::size_t i = 0; i < 4U; i++) {
+    EXPECT_EQ(expected[i], result.final_state[i]);
+  }
+}
+
+TEST_F(TestPararealSolver, invalid_config)
+{
+  config.coarse_ratio = 0U;
+  EXPECT_THROW(PararealSolver(params, fine_step, config), std::invalid_argument);
+  config.coarse_ratio = 10U;
+  EXPECT_THROW(
+    PararealSolver(params, std::chrono::microseconds{0}, config), std::invalid_argument);
+}
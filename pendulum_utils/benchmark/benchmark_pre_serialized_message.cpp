@@ -0,0 +1,82 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief Compares the cost of serializing the pendulum state with the middleware type support
+///        and of patching a pre-serialized message in place.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "pendulum2_msgs/msg/joint_state.hpp"
+#include "pendulum_utils/pre_serialized_message.hpp"
+
+using JointState = pendulum2_msgs::msg::JointState;
+
+namespace
+{
+// the calls are timed in blocks, a single call is close to the clock resolution
+constexpr std::size_t BLOCKS = 2000U;
+constexpr std::size_t BLOCK_SIZE = 100U;
+
+template<typename Function>
+void measure(const char * name, Function function)
+{
+  std::vector<JointState> messages(BLOCK_SIZE);
+  for (std::size_t k = 0; k < BLOCK_SIZE; k++) {
+    messages[k].cart_position = 1e-3 * static_cast<double>(k);
+    messages[k].cart_velocity = 0.5;
+    messages[k].pole_angle = 3.14;
+    messages[k].pole_velocity = -0.1;
+    messages[k].cart_force = static_cast<double>(k);
+  }
+  std::vector<double> samples(BLOCKS);
+  for (std::size_t b = 0; b < BLOCKS; b++) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto & message : messages) {
+      function(message);
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    samples[b] = elapsed.count() / static_cast<double>(BLOCK_SIZE);
+  }
+  std::sort(samples.begin(), samples.end());
+  double mean = 0.0;
+  for (const double s : samples) {
+    mean += s / static_cast<double>(BLOCKS);
+  }
+  std::printf(
+    "%-16s per message: mean %7.1f ns  median %7.1f ns  p99 %7.1f ns\n", name, mean,
+    samples[BLOCKS / 2U], samples[BLOCKS * 99U / 100U]);
+}
+}  // namespace
+
+int main()
+{
+  rclcpp::Serialization<JointState> serialization;
+  rclcpp::SerializedMessage serialized(64U);
+  measure(
+    "serialize", [&serialization, &serialized](const JointState & message) {
+      serialization.serialize_message(&message, &serialized);
+    });
+
+  pendulum::utils::PreSerializedMessage<JointState> pre_serialized;
+  measure(
+    "patch in place", [&pre_serialized](const JointState & message) {
+      pre_serialized.update(message);
+    });
+  return 0;
+}
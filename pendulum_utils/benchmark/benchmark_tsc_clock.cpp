@@ -0,0 +1,80 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief Compares the cost of reading the time stamp counter clock and the steady clock.
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "pendulum_utils/tsc_clock.hpp"
+
+namespace
+{
+// the calls are timed in blocks, a single call is close to the clock resolution
+constexpr std::size_t BLOCKS = 2000U;
+constexpr std::size_t BLOCK_SIZE = 100U;
+
+template<typename Function>
+void measure(const char * name, Function function)
+{
+  std::vector<double> samples(BLOCKS);
+  for (std::size_t b = 0; b < BLOCKS; b++) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t k = 0; k < BLOCK_SIZE; k++) {
+      function();
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    samples[b] = elapsed.count() / static_cast<double>(BLOCK_SIZE);
+  }
+  std::sort(samples.begin(), samples.end());
+  double mean = 0.0;
+  for (const double s : samples) {
+    mean += s / static_cast<double>(BLOCKS);
+  }
+  std::printf(
+    "%-24s per call: mean %7.1f ns  median %7.1f ns  p99 %7.1f ns\n", name, mean,
+    samples[BLOCKS / 2U], samples[BLOCKS * 99U / 100U]);
+}
+}  // namespace
+
+int main()
+{
+  using pendulum::utils::TscClock;
+  std::printf(
+    "time stamp counter: %s, %.3f MHz\n", TscClock::is_tsc_enabled() ? "enabled" : "disabled",
+    1e-6 * TscClock::get_tsc_frequency());
+
+  volatile std::int64_t sink = 0;
+  measure(
+    "TscClock::now", [&sink]() {
+      sink = TscClock::now().time_since_epoch().count();
+    });
+  measure(
+    "steady_clock::now", [&sink]() {
+      sink = std::chrono::steady_clock::now().time_since_epoch().count();
+    });
+  measure(
+    "CLOCK_THREAD_CPUTIME_ID", [&sink]() {
+      timespec time;
+      clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+      sink = time.tv_nsec;
+    });
+  return 0;
+}
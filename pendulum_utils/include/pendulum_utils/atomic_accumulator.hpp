@@ -0,0 +1,125 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__ATOMIC_ACCUMULATOR_HPP_
+#define PENDULUM_UTILS__ATOMIC_ACCUMULATOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class This class accumulates running statistics written by one thread and read by others.
+///
+///  Every field is a separate atomic, so neither the writer nor the readers take a lock or
+///  wait. There must be a single writer. A reader running at the same time as an add may see
+///  the fields of two consecutive samples, which is acceptable for monitoring.
+class AtomicAccumulator
+{
+public:
+  AtomicAccumulator()
+  {
+    reset();
+  }
+
+  AtomicAccumulator(const AtomicAccumulator &) = delete;
+  AtomicAccumulator & operator=(const AtomicAccumulator &) = delete;
+
+  /// \brief Adds a sample, called by the writer thread only
+  /// \param[in] value Sample
+  void add(double value) noexcept
+  {
+    // a single writer does not need read-modify-write operations
+    sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    sum_squares_.store(
+      sum_squares_.load(std::memory_order_relaxed) + value * value, std::memory_order_relaxed);
+    min_.store(std::min(min_.load(std::memory_order_relaxed), value), std::memory_order_relaxed);
+    max_.store(std::max(max_.load(std::memory_order_relaxed), value), std::memory_order_relaxed);
+    count_.store(count_.load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+  }
+
+  /// \brief Resets the statistics, must not run at the same time as add
+  void reset() noexcept
+  {
+    count_ = 0U;
+    sum_ = 0.0;
+    sum_squares_ = 0.0;
+    min_ = std::numeric_limits<double>::infinity();
+    max_ = -std::numeric_limits<double>::infinity();
+  }
+
+  /// \brief Gets the number of samples
+  /// \return Number of samples
+  std::uint64_t get_count() const noexcept
+  {
+    return count_.load(std::memory_order_acquire);
+  }
+
+  /// \brief Gets the mean of the samples
+  /// \return Mean, 0 if there are no samples
+  double get_mean() const noexcept
+  {
+    const std::uint64_t count = get_count();
+    return count > 0U ? sum_.load(std::memory_order_relaxed) / static_cast<double>(count) : 0.0;
+  }
+
+  /// \brief Gets the root mean square of the samples
+  /// \return RMS, 0 if there are no samples
+  double get_rms() const noexcept
+  {
+    const std::uint64_t count = get_count();
+    return count > 0U ?
+           std::sqrt(sum_squares_.load(std::memory_order_relaxed) / static_cast<double>(count)) :
+           0.0;
+  }
+
+  /// \brief Gets the standard deviation of the samples
+  /// \return Standard deviation, 0 if there are no samples
+  double get_stddev() const noexcept
+  {
+    const double mean = get_mean();
+    const double rms = get_rms();
+    return std::sqrt(std::max(0.0, rms * rms - mean * mean));
+  }
+
+  /// \brief Gets the minimum sample
+  /// \return Minimum, infinity if there are no samples
+  double get_min() const noexcept
+  {
+    return min_.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Gets the maximum sample
+  /// \return Maximum, minus infinity if there are no samples
+  double get_max() const noexcept
+  {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> count_;
+  std::atomic<double> sum_;
+  std::atomic<double> sum_squares_;
+  std::atomic<double> min_;
+  std::atomic<double> max_;
+};
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__ATOMIC_ACCUMULATOR_HPP_
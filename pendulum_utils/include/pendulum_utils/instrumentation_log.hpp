@@ -0,0 +1,45 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__INSTRUMENTATION_LOG_HPP_
+#define PENDULUM_UTILS__INSTRUMENTATION_LOG_HPP_
+
+#include "rclcpp/logger.hpp"
+
+#include "pendulum_utils/perf_counters.hpp"
+#include "pendulum_utils/thread_time_accounting.hpp"
+
+namespace pendulum
+{
+namespace utils
+{
+/// \brief Logs the mean and maximum of the available counters of a code section
+/// \param[in] logger Logger of the node
+/// \param[in] name Name of the section, prefixed to every line
+/// \param[in] counters Counters the section was measured with
+/// \param[in] section Measured section
+void log_perf_section(
+  const rclcpp::Logger & logger, const char * name,
+  const PerfCounters & counters, const PerfSection & section);
+
+/// \brief Logs the wall time, CPU time, involuntary delay and context switches of a callback
+/// \param[in] logger Logger of the node
+/// \param[in] name Name of the callback, prefixed to every line
+/// \param[in] accounting Thread time accounting of the callback
+void log_thread_time(
+  const rclcpp::Logger & logger, const char * name, const ThreadTimeAccounting & accounting);
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__INSTRUMENTATION_LOG_HPP_
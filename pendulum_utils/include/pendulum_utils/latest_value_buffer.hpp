@@ -0,0 +1,81 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__LATEST_VALUE_BUFFER_HPP_
+#define PENDULUM_UTILS__LATEST_VALUE_BUFFER_HPP_
+
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class This class passes the latest value from a real-time thread to a non real-time one.
+///
+///  The writer never waits: if the reader is copying the value at the same time, the new value
+///  is dropped and counted, which is acceptable when the reader only needs a recent sample.
+///  Every written value gets a new version, so the reader can tell if it already read it.
+template<typename T>
+class LatestValueBuffer
+{
+  static_assert(std::is_trivially_copyable<T>::value, "the value must be trivially copyable");
+
+public:
+  /// \brief Writes a value, called by the real-time thread
+  /// \param[in] value Value
+  /// \return False if the value was dropped because the reader held the buffer
+  bool write(const T & value) noexcept
+  {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      num_dropped_++;
+      return false;
+    }
+    value_ = value;
+    version_++;
+    return true;
+  }
+
+  /// \brief Reads the last written value
+  /// \param[out] value Value, unchanged if nothing was written
+  /// \return Version of the value, 0 if nothing was written
+  std::uint64_t read(T & value)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (version_ > 0U) {
+      value = value_;
+    }
+    return version_;
+  }
+
+  /// \brief Gets the number of values dropped by the writer
+  /// \return Number of dropped values
+  std::uint64_t get_num_dropped() const noexcept
+  {
+    return num_dropped_;
+  }
+
+private:
+  std::mutex mutex_;
+  T value_{};
+  std::uint64_t version_ = 0U;
+  // only modified by the writer
+  std::uint64_t num_dropped_ = 0U;
+};
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__LATEST_VALUE_BUFFER_HPP_
@@ -0,0 +1,136 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__LOAD_SHEDDER_HPP_
+#define PENDULUM_UTILS__LOAD_SHEDDER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class This class sheds non-critical outputs of a real-time cycle when it runs out of headroom.
+///
+///  The cycle time is reported every cycle and compared with the cycle budget. When a cycle uses
+///  more than the shed threshold, the shedding level is increased immediately. The non-critical
+///  outputs are decimated by two at every level and disabled at the maximum level, so the time
+///  they take is given back to the control tasks. The level is decreased again, one at a time,
+///  after a number of consecutive cycles below the restore threshold.
+class LoadShedder
+{
+public:
+  class Config
+  {
+public:
+    /// \brief Constructor
+    /// \param[in] enabled shed outputs, otherwise all outputs are always allowed
+    /// \param[in] budget time available for a cycle, usually the cycle period
+    /// \param[in] shed_threshold fraction of the budget above which outputs are shed
+    /// \param[in] restore_threshold fraction of the budget below which outputs are restored
+    /// \param[in] restore_cycles consecutive cycles below the restore threshold to restore a level
+    /// \param[in] max_level level at which the non-critical outputs are disabled
+    /// \throw std::invalid_argument If the thresholds are not in (0, 1] or the restore threshold
+    ///  is larger than the shed threshold
+    Config(
+      bool enabled,
+      std::chrono::nanoseconds budget,
+      double shed_threshold,
+      double restore_threshold,
+      std::size_t restore_cycles,
+      std::size_t max_level);
+
+    /// \brief Gets if the shedding is enabled
+    /// \return True if enabled
+    bool is_enabled() const;
+
+    /// \brief Gets the cycle time above which outputs are shed
+    /// \return Cycle time
+    std::chrono::nanoseconds get_shed_time() const;
+
+    /// \brief Gets the cycle time below which outputs are restored
+    /// \return Cycle time
+    std::chrono::nanoseconds get_restore_time() const;
+
+    /// \brief Gets the number of calm cycles needed to restore a level
+    /// \return Number of cycles
+    std::size_t get_restore_cycles() const;
+
+    /// \brief Gets the level at which the non-critical outputs are disabled
+    /// \return Level
+    std::size_t get_max_level() const;
+
+private:
+    bool enabled;
+    std::chrono::nanoseconds shed_time;
+    std::chrono::nanoseconds restore_time;
+    std::size_t restore_cycles;
+    std::size_t max_level;
+  };
+
+  /// \brief Constructor
+  /// \param[in] config Shedding configuration
+  explicit LoadShedder(const Config & config);
+
+  /// \brief Reports the time used by the last cycle and updates the shedding level
+  /// \param[in] cycle_time Execution time of the cycle
+  void update(std::chrono::nanoseconds cycle_time);
+
+  /// \brief Checks if a non-critical output may run in the current cycle
+  /// \return True if the output is allowed, false if it is shed
+  bool allow();
+
+  /// \brief Resets the level and the counters
+  void reset();
+
+  /// \brief Gets the configuration
+  /// \return Configuration
+  const Config & get_config() const;
+
+  /// \brief Gets the current shedding level, 0 if nothing is shed
+  /// \return Level
+  std::size_t get_level() const;
+
+  /// \brief Gets the number of level increases
+  /// \return Number of shedding events
+  std::uint64_t get_num_shed_events() const;
+
+  /// \brief Gets the number of level decreases
+  /// \return Number of restore events
+  std::uint64_t get_num_restore_events() const;
+
+  /// \brief Gets the number of non-critical outputs skipped
+  /// \return Number of skipped outputs
+  std::uint64_t get_num_skipped() const;
+
+  /// \brief Gets the maximum reported cycle time
+  /// \return Cycle time
+  std::chrono::nanoseconds get_max_cycle_time() const;
+
+private:
+  Config cfg_;
+  std::size_t level_;
+  std::size_t calm_cycles_;
+  std::uint64_t cycle_;
+  std::uint64_t num_shed_events_;
+  std::uint64_t num_restore_events_;
+  std::uint64_t num_skipped_;
+  std::chrono::nanoseconds max_cycle_time_;
+};
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__LOAD_SHEDDER_HPP_
@@ -0,0 +1,140 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__PERF_COUNTERS_HPP_
+#define PENDULUM_UTILS__PERF_COUNTERS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pendulum_utils/atomic_accumulator.hpp"
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class This class reads the hardware and software performance counters of a thread.
+///
+///  The counters are opened with perf_event_open for the thread which creates the object and
+///  only count while that thread runs. The hardware counters are opened as one group, so they
+///  are read together and cover the same interval. When the kernel allows it, they are read
+///  from user space with rdpmc without a system call. Counters which are not supported or not
+///  permitted, for example in a virtual machine or with a restrictive perf_event_paranoid, are
+///  disabled and read as zero, so the caller does not need to handle their absence.
+class PerfCounters
+{
+public:
+  enum Counter : std::size_t
+  {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    CONTEXT_SWITCHES,
+    NUM_COUNTERS
+  };
+
+  using Values = std::array<std::uint64_t, NUM_COUNTERS>;
+
+  /// \brief Opens the counters of the calling thread
+  PerfCounters();
+
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters & operator=(const PerfCounters &) = delete;
+
+  /// \brief Reads the counters, called by the thread which created the object
+  /// \param[out] values Counter values, zero for the disabled counters
+  void read(Values & values) const noexcept;
+
+  /// \brief Gets if a counter could be opened
+  /// \param[in] counter Counter
+  /// \return True if the counter is available
+  bool is_available(Counter counter) const;
+
+  /// \brief Gets if at least one counter could be opened
+  /// \return True if a counter is available
+  bool is_any_available() const;
+
+  /// \brief Gets if the hardware counters are read without a system call
+  /// \return True if rdpmc is used
+  bool is_rdpmc_enabled() const;
+
+  /// \brief Gets if the counters include the time spent in the kernel
+  /// \return False if the kernel only allowed counting user space
+  bool counts_kernel() const;
+
+  /// \brief Gets the name of a counter
+  /// \param[in] counter Counter
+  /// \return Name
+  static const char * get_name(Counter counter);
+
+private:
+  /// \brief Reads a counter from its memory mapped page with rdpmc
+  std::uint64_t read_rdpmc(std::size_t counter) const noexcept;
+
+  std::array<int, NUM_COUNTERS> fds_;
+  // memory mapped perf_event_mmap_page of the hardware counters, only used with rdpmc
+  std::array<void *, NUM_COUNTERS> pages_;
+  // position of the counter in the group read, NUM_COUNTERS if it is not in the group
+  std::array<std::size_t, NUM_COUNTERS> group_index_;
+  int leader_fd_;
+  std::size_t group_size_;
+  std::size_t page_size_;
+  bool rdpmc_enabled_;
+  bool counts_kernel_;
+};
+
+/// \class This class aggregates the counter increments of a code section over many runs.
+///
+///  The section is delimited with begin and end on the thread which owns the counters. The
+///  statistics of every counter are kept in lock-free accumulators, which can be read from other
+///  threads while the section runs.
+class PerfSection
+{
+public:
+  /// \brief Constructor
+  /// \param[in] counters Counters of the thread running the section
+  explicit PerfSection(const PerfCounters & counters);
+
+  /// \brief Marks the start of the section
+  void begin() noexcept;
+
+  /// \brief Marks the end of the section and adds the counter increments to the statistics
+  void end() noexcept;
+
+  /// \brief Gets the statistics of a counter
+  /// \param[in] counter Counter
+  /// \return Statistics of the counter increments per run
+  const AtomicAccumulator & get(PerfCounters::Counter counter) const;
+
+  /// \brief Gets the mean instructions per cycle
+  /// \return Instructions per cycle, 0 if the cycles were not counted
+  double get_instructions_per_cycle() const;
+
+  /// \brief Resets the statistics, must not run at the same time as end
+  void reset();
+
+private:
+  const PerfCounters & counters_;
+  PerfCounters::Values start_;
+  PerfCounters::Values end_;
+  std::array<AtomicAccumulator, PerfCounters::NUM_COUNTERS> accumulators_;
+};
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__PERF_COUNTERS_HPP_
@@ -0,0 +1,154 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__PERSISTENT_STATE_HPP_
+#define PENDULUM_UTILS__PERSISTENT_STATE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class Named POSIX shared memory segment mapped in the process memory.
+///
+///  The segment is created if it does not exist and is not removed when the object is
+///  destroyed, so its content survives a crash of the process.
+class SharedMemorySegment
+{
+public:
+  /// \brief Opens or creates a segment
+  /// \param[in] name Segment name, starting with '/'
+  /// \param[in] size Segment size in bytes
+  /// \throw std::runtime_error If the segment can not be opened or mapped
+  SharedMemorySegment(const std::string & name, std::size_t size);
+
+  ~SharedMemorySegment();
+
+  SharedMemorySegment(const SharedMemorySegment &) = delete;
+  SharedMemorySegment & operator=(const SharedMemorySegment &) = delete;
+
+  /// \brief Gets the mapped memory
+  /// \return Pointer to the start of the segment
+  void * get_data() const;
+
+  /// \brief Gets the segment name
+  /// \return Name
+  const std::string & get_name() const;
+
+  /// \brief Removes a segment from the system, processes which mapped it keep their mapping
+  /// \param[in] name Segment name
+  /// \return True if the segment existed
+  static bool remove(const std::string & name);
+
+  /// \brief Gets a segment name unique to a node, the names are global in the system
+  /// \param[in] node_name Fully qualified node name, for example "/pendulum_0/pendulum_driver"
+  /// \return Segment name, for example "/pendulum_0_pendulum_driver_state"
+  static std::string get_node_segment_name(const std::string & node_name);
+
+private:
+  std::string name_;
+  std::size_t size_;
+  void * data_;
+};
+
+/// \class This class mirrors a value in a named shared memory segment.
+///
+///  A process stores its state every cycle and, when it is restarted after a crash, loads the
+///  last stored value to resume from it. The value is written alternately in two slots and the
+///  number of completed stores is published after the copy, so a crash in the middle of a store
+///  leaves the previous value readable. Storing does not allocate memory and does not make
+///  system calls.
+template<typename T>
+class PersistentState
+{
+  static_assert(std::is_trivially_copyable<T>::value, "the value must be trivially copyable");
+
+public:
+  /// \brief Opens or creates the segment of the value
+  /// \param[in] name Segment name, starting with '/'
+  /// \throw std::runtime_error If the segment can not be opened or mapped
+  explicit PersistentState(const std::string & name)
+  : segment_(name, sizeof(Layout)),
+    layout_(static_cast<Layout *>(segment_.get_data()))
+  {
+    // a new segment is filled with zeros, a segment of another type is discarded
+    if (layout_->magic != MAGIC || layout_->size != sizeof(T)) {
+      new (&layout_->count) std::atomic<std::uint64_t>(0U);
+      layout_->size = sizeof(T);
+      layout_->magic = MAGIC;
+    }
+  }
+
+  /// \brief Stores a value
+  /// \param[in] value Value
+  void store(const T & value) noexcept
+  {
+    const std::uint64_t count = layout_->count.load(std::memory_order_relaxed);
+    std::memcpy(&layout_->slots[count % 2U], &value, sizeof(T));
+    layout_->count.store(count + 1U, std::memory_order_release);
+  }
+
+  /// \brief Loads the last stored value
+  /// \param[out] value Value
+  /// \return False if no value was stored
+  bool load(T & value) const noexcept
+  {
+    const std::uint64_t count = layout_->count.load(std::memory_order_acquire);
+    if (count == 0U) {
+      return false;
+    }
+    std::memcpy(&value, &layout_->slots[(count - 1U) % 2U], sizeof(T));
+    return true;
+  }
+
+  /// \brief Discards the stored value
+  void clear() noexcept
+  {
+    layout_->count.store(0U, std::memory_order_release);
+  }
+
+  /// \brief Gets the number of stores since the segment was created or cleared
+  /// \return Number of stores
+  std::uint64_t get_num_stores() const noexcept
+  {
+    return layout_->count.load(std::memory_order_acquire);
+  }
+
+private:
+  static constexpr std::uint64_t MAGIC = 0x5045525354415445ULL;
+
+  struct Layout
+  {
+    std::uint64_t magic;
+    std::uint64_t size;
+    std::atomic<std::uint64_t> count;
+    T slots[2];
+  };
+
+  SharedMemorySegment segment_;
+  Layout * layout_;
+};
+
+template<typename T>
+constexpr std::uint64_t PersistentState<T>::MAGIC;
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__PERSISTENT_STATE_HPP_
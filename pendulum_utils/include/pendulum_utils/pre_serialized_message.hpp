@@ -0,0 +1,188 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__PRE_SERIALIZED_MESSAGE_HPP_
+#define PENDULUM_UTILS__PRE_SERIALIZED_MESSAGE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+namespace pendulum
+{
+namespace utils
+{
+/// Size of the CDR encapsulation header which precedes the serialized fields
+constexpr std::size_t CDR_HEADER_SIZE = 4U;
+
+/// \brief Checks if a CDR buffer is encoded in little endian
+/// \param[in] buffer Serialized buffer, starting with the encapsulation header
+/// \return True for little endian, false for big endian
+inline bool is_cdr_little_endian(const std::uint8_t * buffer)
+{
+  // the second byte of the encapsulation is 0x01 (CDR_LE) or 0x03 (PL_CDR_LE) for little endian
+  return (buffer[1] & 0x01U) != 0U;
+}
+
+/// \brief Checks if the host is little endian
+/// \return True for little endian
+inline bool is_host_little_endian()
+{
+  const std::uint16_t value = 1U;
+  std::uint8_t first_byte;
+  std::memcpy(&first_byte, &value, 1U);
+  return first_byte == 1U;
+}
+
+/// \brief Writes a double in a CDR buffer of float64 fields
+/// \param[in,out] buffer Serialized buffer, starting with the encapsulation header
+/// \param[in] index Index of the field
+/// \param[in] value Field value
+/// \param[in] swap Swap the byte order, if the buffer and host byte orders differ
+inline void write_cdr_double(
+  std::uint8_t * buffer, std::size_t index, double value, bool swap) noexcept
+{
+  // the fields are aligned to 8 bytes from the end of the header, so there is no padding
+  std::uint8_t * field = buffer + CDR_HEADER_SIZE + index * sizeof(double);
+  std::memcpy(field, &value, sizeof(double));
+  if (swap) {
+    for (std::size_t i = 0U; i < sizeof(double) / 2U; i++) {
+      const std::uint8_t tmp = field[i];
+      field[i] = field[sizeof(double) - 1U - i];
+      field[sizeof(double) - 1U - i] = tmp;
+    }
+  }
+}
+
+/// \brief Reads a double from a CDR buffer of float64 fields
+/// \param[in] buffer Serialized buffer, starting with the encapsulation header
+/// \param[in] index Index of the field
+/// \param[in] swap Swap the byte order, if the buffer and host byte orders differ
+/// \return Field value
+inline double read_cdr_double(const std::uint8_t * buffer, std::size_t index, bool swap) noexcept
+{
+  std::uint8_t bytes[sizeof(double)];
+  std::memcpy(bytes, buffer + CDR_HEADER_SIZE + index * sizeof(double), sizeof(double));
+  if (swap) {
+    for (std::size_t i = 0U; i < sizeof(double) / 2U; i++) {
+      const std::uint8_t tmp = bytes[i];
+      bytes[i] = bytes[sizeof(double) - 1U - i];
+      bytes[sizeof(double) - 1U - i] = tmp;
+    }
+  }
+  double value;
+  std::memcpy(&value, bytes, sizeof(double));
+  return value;
+}
+
+/// \class This class keeps a serialized message which is updated in place.
+///
+///  The pendulum messages only contain float64 fields, so their serialized layout is fixed: the
+///  CDR header followed by the fields in declaration order. The message is serialized once with
+///  the type support of the middleware, and then every update copies the fields to their known
+///  offsets instead of running the generic serializer again. The serialized message is published
+///  with the serialized overload of publish(). Updates do not allocate memory.
+template<typename MessageT>
+class PreSerializedMessage
+{
+public:
+  /// Number of float64 fields of the message
+  static constexpr std::size_t NUM_FIELDS = sizeof(MessageT) / sizeof(double);
+
+  /// \brief Constructor, serializes the template message
+  /// \param[in] template_message Message with the initial field values
+  /// \throw std::invalid_argument If the message is not made of float64 fields only
+  explicit PreSerializedMessage(const MessageT & template_message = MessageT())
+  : serialized_(CDR_HEADER_SIZE + sizeof(MessageT))
+  {
+    rclcpp::Serialization<MessageT> serialization;
+    serialization.serialize_message(&template_message, &serialized_);
+    const auto & raw = serialized_.get_rcl_serialized_message();
+    if (sizeof(MessageT) % sizeof(double) != 0U ||
+      raw.buffer_length != CDR_HEADER_SIZE + sizeof(MessageT))
+    {
+      throw std::invalid_argument("the message does not have a fixed layout of float64 fields");
+    }
+    buffer_ = raw.buffer;
+    swap_ = is_cdr_little_endian(buffer_) != is_host_little_endian();
+  }
+
+  // the buffer pointer refers to the serialized message of this object
+  PreSerializedMessage(const PreSerializedMessage &) = delete;
+  PreSerializedMessage & operator=(const PreSerializedMessage &) = delete;
+
+  /// \brief Copies all the fields of a message
+  /// \param[in] message Message
+  void update(const MessageT & message) noexcept
+  {
+    // the C++ message holds the same float64 fields in the same order
+    const auto * fields = reinterpret_cast<const std::uint8_t *>(&message);
+    if (!swap_) {
+      std::memcpy(buffer_ + CDR_HEADER_SIZE, fields, NUM_FIELDS * sizeof(double));
+      return;
+    }
+    for (std::size_t i = 0U; i < NUM_FIELDS; i++) {
+      double value;
+      std::memcpy(&value, fields + i * sizeof(double), sizeof(double));
+      write_cdr_double(buffer_, i, value, swap_);
+    }
+  }
+
+  /// \brief Sets a single field
+  /// \param[in] field Pointer to the message member
+  /// \param[in] value Field value
+  void set(double MessageT::* field, double value) noexcept
+  {
+    write_cdr_double(buffer_, field_index(field), value, swap_);
+  }
+
+  /// \brief Gets a single field from the serialized message
+  /// \param[in] field Pointer to the message member
+  /// \return Field value
+  double get(double MessageT::* field) const noexcept
+  {
+    return read_cdr_double(buffer_, field_index(field), swap_);
+  }
+
+  /// \brief Gets the serialized message to publish
+  /// \return Serialized message
+  const rclcpp::SerializedMessage & get_serialized_message() const noexcept
+  {
+    return serialized_;
+  }
+
+private:
+  static std::size_t field_index(double MessageT::* field) noexcept
+  {
+    const MessageT message{};
+    return static_cast<std::size_t>(
+      reinterpret_cast<const std::uint8_t *>(&(message.*field)) -
+      reinterpret_cast<const std::uint8_t *>(&message)) / sizeof(double);
+  }
+
+  rclcpp::SerializedMessage serialized_;
+  std::uint8_t * buffer_;
+  bool swap_;
+};
+
+template<typename MessageT>
+constexpr std::size_t PreSerializedMessage<MessageT>::NUM_FIELDS;
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__PRE_SERIALIZED_MESSAGE_HPP_
@@ -0,0 +1,91 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__THREAD_TIME_ACCOUNTING_HPP_
+#define PENDULUM_UTILS__THREAD_TIME_ACCOUNTING_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include "pendulum_utils/atomic_accumulator.hpp"
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class This class separates the time a callback runs from the time it waits for the CPU.
+///
+///  The monotonic clock and the CPU time of the calling thread are read at the start and at the
+///  end of the callback. The wall time minus the CPU time is the delay caused by the scheduler,
+///  which is not a consequence of the callback code. The voluntary and involuntary context
+///  switches of the thread are read with getrusage, and a callback with at least one involuntary
+///  switch is counted as preempted. The statistics are written by the callback thread only and
+///  can be read from other threads.
+class ThreadTimeAccounting
+{
+public:
+  ThreadTimeAccounting();
+
+  ThreadTimeAccounting(const ThreadTimeAccounting &) = delete;
+  ThreadTimeAccounting & operator=(const ThreadTimeAccounting &) = delete;
+
+  /// \brief Marks the start of the callback, called by the callback thread
+  void begin() noexcept;
+
+  /// \brief Marks the end of the callback and updates the statistics
+  void end() noexcept;
+
+  /// \brief Gets the wall time statistics
+  /// \return Wall time of the callbacks in microseconds
+  const AtomicAccumulator & get_wall_time() const;
+
+  /// \brief Gets the thread CPU time statistics
+  /// \return CPU time of the callbacks in microseconds
+  const AtomicAccumulator & get_cpu_time() const;
+
+  /// \brief Gets the statistics of the wall time minus the CPU time
+  /// \return Involuntary delay of the callbacks in microseconds
+  const AtomicAccumulator & get_delay() const;
+
+  /// \brief Gets the number of callbacks with at least one involuntary context switch
+  /// \return Number of preempted callbacks
+  std::uint64_t get_num_preempted() const;
+
+  /// \brief Gets the voluntary context switches during the callbacks
+  /// \return Number of voluntary context switches, for example blocking in a system call
+  std::uint64_t get_num_voluntary_switches() const;
+
+  /// \brief Gets the involuntary context switches during the callbacks
+  /// \return Number of involuntary context switches, caused by preemption
+  std::uint64_t get_num_involuntary_switches() const;
+
+  /// \brief Resets the statistics, must not run at the same time as end
+  void reset();
+
+private:
+  std::int64_t start_wall_ns_;
+  std::int64_t start_cpu_ns_;
+  std::int64_t start_voluntary_switches_;
+  std::int64_t start_involuntary_switches_;
+  AtomicAccumulator wall_time_;
+  AtomicAccumulator cpu_time_;
+  AtomicAccumulator delay_;
+  std::atomic<std::uint64_t> num_preempted_;
+  std::atomic<std::uint64_t> num_voluntary_switches_;
+  std::atomic<std::uint64_t> num_involuntary_switches_;
+};
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__THREAD_TIME_ACCOUNTING_HPP_
@@ -0,0 +1,142 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__TIMING_WHEEL_HPP_
+#define PENDULUM_UTILS__TIMING_WHEEL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class This class implements a hierarchical timing wheel for a large number of timers.
+///
+///  Time is counted in ticks. The wheel has 4 levels of 64 slots: level 0 holds the timers
+///  expiring in the next 64 ticks, one slot per tick, and every higher level covers 64 times
+///  the range of the previous one. When the ticks reach the start of a higher level slot, its
+///  timers are moved down to the lower levels. Scheduling and cancelling a timer are O(1), and
+///  expiring it is O(1) amortized over the levels it moves through. The timers are intrusive and
+///  owned by the caller, so the wheel does not allocate memory. An occupancy mask per level
+///  gives the next tick with work in O(1), so a thread driving the wheel only wakes up when a
+///  timer expires, and all the timers expiring in the same tick are served in one wake-up.
+class TimingWheel
+{
+public:
+  static constexpr std::size_t LEVELS = 4U;
+  static constexpr std::size_t SLOT_BITS = 6U;
+  static constexpr std::size_t SLOTS = 1U << SLOT_BITS;
+
+  /// Timer entry, owned by the caller and linked in the wheel while it is scheduled
+  struct Timer
+  {
+    /// tick at which the timer expires
+    std::uint64_t expiry = 0U;
+    /// free for the owner, for example to find the object of an expired timer
+    std::size_t id = 0U;
+    // links and position in the wheel
+    Timer * next = nullptr;
+    Timer * prev = nullptr;
+    std::size_t level = 0U;
+    std::size_t slot = 0U;
+  };
+
+  /// \brief Constructor
+  /// \param[in] start_tick Current tick
+  explicit TimingWheel(std::uint64_t start_tick = 0U);
+
+  TimingWheel(const TimingWheel &) = delete;
+  TimingWheel & operator=(const TimingWheel &) = delete;
+
+  /// \brief Schedules a timer, rescheduling it if it is already scheduled
+  /// \param[in,out] timer Timer, must stay valid while it is scheduled
+  /// \param[in] expiry Expiry tick, a tick not after the current one expires in the next tick
+  void schedule(Timer & timer, std::uint64_t expiry);
+
+  /// \brief Cancels a timer, nothing happens if it is not scheduled
+  /// \param[in,out] timer Timer
+  void cancel(Timer & timer);
+
+  /// \brief Checks if a timer is scheduled
+  /// \param[in] timer Timer
+  /// \return True if scheduled
+  static bool is_scheduled(const Timer & timer);
+
+  /// \brief Advances the wheel and calls a function for every expired timer
+  ///
+  ///  Ticks without work are skipped. The function may schedule timers again, including the
+  ///  expired one.
+  /// \param[in] tick New current tick
+  /// \param[in] on_expired Function called with every expired timer, in expiry order
+  /// \return Number of expired timers
+  template<typename Callback>
+  std::size_t advance(std::uint64_t tick, Callback && on_expired)
+  {
+    std::size_t num_expired = 0U;
+    while (current_tick_ < tick) {
+      std::uint64_t next_tick = 0U;
+      if (!get_next_expiry(next_tick) || next_tick > tick) {
+        current_tick_ = tick;
+        break;
+      }
+      // jump to the tick before the next work
+      current_tick_ = next_tick - 1U;
+      step();
+      Timer & head = slots_[0][current_tick_ & (SLOTS - 1U)];
+      while (head.next != &head) {
+        Timer & timer = *head.next;
+        unlink(timer);
+        on_expired(timer);
+        num_expired++;
+      }
+    }
+    return num_expired;
+  }
+
+  /// \brief Gets the next tick where a timer may expire or move to a lower level
+  /// \param[out] tick Next tick with work
+  /// \return False if no timer is scheduled
+  bool get_next_expiry(std::uint64_t & tick) const;
+
+  /// \brief Gets the current tick
+  /// \return Current tick
+  std::uint64_t get_current_tick() const;
+
+  /// \brief Gets the number of scheduled timers
+  /// \return Number of timers
+  std::size_t get_num_timers() const;
+
+private:
+  /// \brief Moves to the next tick and moves down the timers of the higher level slots starting
+  ///  in it
+  void step();
+
+  /// \brief Links a timer in the slot of its expiry
+  void insert(Timer & timer);
+
+  /// \brief Unlinks a timer from its slot
+  void unlink(Timer & timer);
+
+  // circular lists with a sentinel head per slot
+  Timer slots_[LEVELS][SLOTS];
+  // bit i is set if slot i of the level is not empty
+  std::uint64_t occupied_[LEVELS];
+  std::uint64_t current_tick_;
+  std::size_t num_timers_;
+};
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__TIMING_WHEEL_HPP_
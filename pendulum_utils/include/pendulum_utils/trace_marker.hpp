@@ -0,0 +1,94 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__TRACE_MARKER_HPP_
+#define PENDULUM_UTILS__TRACE_MARKER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class This class writes cycle events to the ftrace trace_marker file.
+///
+///  The events appear in the kernel trace next to the scheduler and interrupt events, so a cycle
+///  can be inspected in tools like kernelshark. The file is opened once and the text of every
+///  event is formatted when the object is created, so writing an event only appends the sequence
+///  number and makes one write system call, without allocating memory. If tracefs is not
+///  mounted or not writable, the object is created closed and the writes do nothing. Every event
+///  has its own buffer, so the same event must not be written by two threads at the same time.
+class TraceMarker
+{
+public:
+  enum Event : std::size_t
+  {
+    CYCLE_START,
+    CYCLE_END,
+    PUBLISH,
+    RECEIVE,
+    NUM_EVENTS
+  };
+
+  /// \brief Opens the trace marker file
+  /// \param[in] prefix Text written before every event, for example the node name
+  /// \param[in] path Trace marker file, the tracefs mount points are tried if empty
+  explicit TraceMarker(const std::string & prefix, const std::string & path = "");
+
+  ~TraceMarker();
+
+  TraceMarker(const TraceMarker &) = delete;
+  TraceMarker & operator=(const TraceMarker &) = delete;
+
+  /// \brief Writes an event
+  /// \param[in] event Event
+  /// \param[in] sequence Cycle number, to match the events of the same cycle
+  void write(Event event, std::uint64_t sequence) noexcept;
+
+  /// \brief Gets if the trace marker file is open
+  /// \return True if the events are written
+  bool is_open() const;
+
+  /// \brief Gets the path of the open trace marker file
+  /// \return Path, empty if the file is not open
+  const std::string & get_path() const;
+
+  /// \brief Gets the number of events which could not be written
+  /// \return Number of failed writes, for example when tracing is stopped
+  std::uint64_t get_num_failed() const;
+
+  /// \brief Gets the name of an event
+  /// \param[in] event Event
+  /// \return Name
+  static const char * get_name(Event event);
+
+private:
+  // prefix, event name and up to 20 digits of the sequence
+  static constexpr std::size_t BUFFER_SIZE = 128U;
+
+  int fd_;
+  std::string path_;
+  std::array<std::array<char, BUFFER_SIZE>, NUM_EVENTS> buffers_;
+  // length of the preformatted text of every event
+  std::array<std::size_t, NUM_EVENTS> lengths_;
+  std::atomic<std::uint64_t> num_failed_;
+};
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__TRACE_MARKER_HPP_
@@ -0,0 +1,64 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PENDULUM_UTILS__TSC_CLOCK_HPP_
+#define PENDULUM_UTILS__TSC_CLOCK_HPP_
+
+#include <chrono>
+#include <cstdint>
+
+namespace pendulum
+{
+namespace utils
+{
+/// \class This class is a steady clock read from the CPU time stamp counter.
+///
+///  When the kernel clock source is the time stamp counter, clock_gettime reads it through the
+///  vDSO too and both clocks cost about the same. With a slower clock source, like hpet, this
+///  clock avoids reading it in every call. The counter is converted to the time of
+///  CLOCK_MONOTONIC with a rate calibrated when the clock is first used. Reading the clock never
+///  calibrates it: calibrate must be called again out of the real-time cycles, for example in
+///  the lifecycle transitions, so the time points stay close to the ones of
+///  std::chrono::steady_clock. The counter is only used on x86 processors with an
+///  invariant time stamp counter which the kernel did not find unstable. Otherwise the clock
+///  reads std::chrono::steady_clock, which uses the vDSO.
+class TscClock
+{
+public:
+  using duration = std::chrono::steady_clock::duration;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::steady_clock::time_point;
+  static constexpr bool is_steady = true;
+
+  /// \brief Gets the current time, safe to call from any thread
+  /// \return Time in the std::chrono::steady_clock epoch
+  static time_point now() noexcept;
+
+  /// \brief Gets if the time stamp counter is used
+  /// \return False if the clock falls back to std::chrono::steady_clock
+  static bool is_tsc_enabled() noexcept;
+
+  /// \brief Gets the calibrated time stamp counter frequency
+  /// \return Frequency in Hz, 0 if the time stamp counter is not used
+  static double get_tsc_frequency() noexcept;
+
+  /// \brief Calibrates the time stamp counter rate with the time since the last calibration,
+  ///  not called by now, safe to call from any thread
+  static void calibrate() noexcept;
+};
+}  // namespace utils
+}  // namespace pendulum
+
+#endif  // PENDULUM_UTILS__TSC_CLOCK_HPP_
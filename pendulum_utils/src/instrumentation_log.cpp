@@ -0,0 +1,67 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_utils/instrumentation_log.hpp"
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+
+#include "rclcpp/logging.hpp"
+
+namespace pendulum
+{
+namespace utils
+{
+void log_perf_section(
+  const rclcpp::Logger & logger, const char * name,
+  const PerfCounters & counters, const PerfSection & section)
+{
+  for (std::size_t i = 0U; i < PerfCounters::NUM_COUNTERS; i++) {
+    const auto counter = static_cast<PerfCounters::Counter>(i);
+    if (counters.is_available(counter)) {
+      RCLCPP_INFO(
+        logger, "%s %s: mean = %lf, max = %lf", name, PerfCounters::get_name(counter),
+        section.get(counter).get_mean(), section.get(counter).get_max());
+    }
+  }
+  if (counters.is_available(PerfCounters::CYCLES)) {
+    RCLCPP_INFO(
+      logger, "%s instructions per cycle = %lf", name, section.get_instructions_per_cycle());
+  }
+}
+
+void log_thread_time(
+  const rclcpp::Logger & logger, const char * name, const ThreadTimeAccounting & accounting)
+{
+  RCLCPP_INFO(
+    logger, "%s wall time: mean = %lf us, max = %lf us", name,
+    accounting.get_wall_time().get_mean(), accounting.get_wall_time().get_max());
+  RCLCPP_INFO(
+    logger, "%s CPU time: mean = %lf us, max = %lf us", name,
+    accounting.get_cpu_time().get_mean(), accounting.get_cpu_time().get_max());
+  RCLCPP_INFO(
+    logger, "%s involuntary delay: mean = %lf us, max = %lf us", name,
+    accounting.get_delay().get_mean(), accounting.get_delay().get_max());
+  RCLCPP_INFO(
+    logger,
+    "%s preempted = %" PRIu64 " of %" PRIu64 ", context switches: voluntary = %" PRIu64
+    ", involuntary = %" PRIu64,
+    name, static_cast<uint64_t>(accounting.get_num_preempted()),
+    static_cast<uint64_t>(accounting.get_wall_time().get_count()),
+    static_cast<uint64_t>(accounting.get_num_voluntary_switches()),
+    static_cast<uint64_t>(accounting.get_num_involuntary_switches()));
+}
+}  // namespace utils
+}  // namespace pendulum
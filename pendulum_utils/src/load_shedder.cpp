@@ -0,0 +1,156 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_utils/load_shedder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace pendulum
+{
+namespace utils
+{
+LoadShedder::Config::Config(
+  bool enabled,
+  std::chrono::nanoseconds budget,
+  double shed_threshold,
+  double restore_threshold,
+  std::size_t restore_cycles,
+  std::size_t max_level)
+: enabled(enabled),
+  shed_time(std::chrono::duration_cast<std::chrono::nanoseconds>(budget * shed_threshold)),
+  restore_time(std::chrono::duration_cast<std::chrono::nanoseconds>(budget * restore_threshold)),
+  restore_cycles(restore_cycles),
+  max_level(max_level)
+{
+  if (!(shed_threshold > 0.0 && shed_threshold <= 1.0) ||
+    !(restore_threshold > 0.0 && restore_threshold <= shed_threshold))
+  {
+    throw std::invalid_argument("load shedding thresholds must be 0 < restore <= shed <= 1");
+  }
+  // a decimation factor of 2^max_level must fit in the cycle counter
+  if (max_level == 0U || max_level > 32U) {
+    throw std::invalid_argument("load shedding maximum level must be between 1 and 32");
+  }
+}
+
+bool LoadShedder::Config::is_enabled() const
+{
+  return enabled;
+}
+
+std::chrono::nanoseconds LoadShedder::Config::get_shed_time() const
+{
+  return shed_time;
+}
+
+std::chrono::nanoseconds LoadShedder::Config::get_restore_time() const
+{
+  return restore_time;
+}
+
+std::size_t LoadShedder::Config::get_restore_cycles() const
+{
+  return restore_cycles;
+}
+
+std::size_t LoadShedder::Config::get_max_level() const
+{
+  return max_level;
+}
+
+LoadShedder::LoadShedder(const Config & config)
+: cfg_(config)
+{
+  reset();
+}
+
+void LoadShedder::update(std::chrono::nanoseconds cycle_time)
+{
+  cycle_++;
+  max_cycle_time_ = std::max(max_cycle_time_, cycle_time);
+  if (!cfg_.is_enabled()) {
+    return;
+  }
+  if (cycle_time > cfg_.get_shed_time()) {
+    // react in the same cycle, the control tasks must not miss the next one
+    calm_cycles_ = 0U;
+    if (level_ < cfg_.get_max_level()) {
+      level_++;
+      num_shed_events_++;
+    }
+  } else if (cycle_time < cfg_.get_restore_time() && level_ > 0U) {
+    calm_cycles_++;
+    if (calm_cycles_ >= cfg_.get_restore_cycles()) {
+      calm_cycles_ = 0U;
+      level_--;
+      num_restore_events_++;
+    }
+  } else {
+    calm_cycles_ = 0U;
+  }
+}
+
+bool LoadShedder::allow()
+{
+  const std::uint64_t decimation_mask = (std::uint64_t{1} << level_) - 1U;
+  if (level_ < cfg_.get_max_level() && (cycle_ & decimation_mask) == 0U) {
+    return true;
+  }
+  num_skipped_++;
+  return false;
+}
+
+void LoadShedder::reset()
+{
+  level_ = 0U;
+  calm_cycles_ = 0U;
+  cycle_ = 0U;
+  num_shed_events_ = 0U;
+  num_restore_events_ = 0U;
+  num_skipped_ = 0U;
+  max_cycle_time_ = std::chrono::nanoseconds{0};
+}
+
+const LoadShedder::Config & LoadShedder::get_config() const
+{
+  return cfg_;
+}
+
+std::size_t LoadShedder::get_level() const
+{
+  return level_;
+}
+
+std::uint64_t LoadShedder::get_num_shed_events() const
+{
+  return num_shed_events_;
+}
+
+std::uint64_t LoadShedder::get_num_restore_events() const
+{
+  return num_restore_events_;
+}
+
+std::uint64_t LoadShedder::get_num_skipped() const
+{
+  return num_skipped_;
+}
+
+std::chrono::nanoseconds LoadShedder::get_max_cycle_time() const
+{
+  return max_cycle_time_;
+}
+}  // namespace utils
+}  // namespace pendulum
@@ -0,0 +1,263 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_utils/perf_counters.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+namespace pendulum
+{
+namespace utils
+{
+namespace
+{
+struct CounterEvent
+{
+  std::uint32_t type;
+  std::uint64_t config;
+  const char * name;
+};
+
+constexpr CounterEvent EVENTS[PerfCounters::NUM_COUNTERS] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache_misses"},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch_misses"},
+  {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context_switches"}
+};
+
+int open_event(const CounterEvent & event, int group_fd, bool exclude_kernel)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event.type;
+  attr.config = event.config;
+  attr.exclude_kernel = exclude_kernel ? 1U : 0U;
+  attr.exclude_hv = 1U;
+  if (event.type == PERF_TYPE_HARDWARE) {
+    attr.read_format = PERF_FORMAT_GROUP;
+  }
+  // this thread only, on any cpu
+  return static_cast<int>(
+    syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+inline std::uint64_t rdpmc(std::uint32_t counter) noexcept
+{
+  std::uint32_t low;
+  std::uint32_t high;
+  __asm__ volatile ("rdpmc" : "=a" (low), "=d" (high) : "c" (counter));
+  return (static_cast<std::uint64_t>(high) << 32U) | low;
+}
+#endif
+}  // namespace
+
+PerfCounters::PerfCounters()
+: leader_fd_{-1},
+  group_size_{0U},
+  page_size_{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))},
+  rdpmc_enabled_{false},
+  counts_kernel_{true}
+{
+  fds_.fill(-1);
+  pages_.fill(nullptr);
+  group_index_.fill(NUM_COUNTERS);
+
+  for (std::size_t i = 0U; i < NUM_COUNTERS; i++) {
+    const bool hardware = EVENTS[i].type == PERF_TYPE_HARDWARE;
+    int fd = open_event(EVENTS[i], hardware ? leader_fd_ : -1, !counts_kernel_);
+    if (fd < 0 && counts_kernel_ && (errno == EACCES || errno == EPERM)) {
+      // perf_event_paranoid may only allow counting user space
+      counts_kernel_ = false;
+      fd = open_event(EVENTS[i], hardware ? leader_fd_ : -1, true);
+    }
+    if (fd < 0) {
+      continue;
+    }
+    fds_[i] = fd;
+    if (hardware) {
+      if (leader_fd_ < 0) {
+        leader_fd_ = fd;
+      }
+      group_index_[i] = group_size_++;
+    }
+  }
+
+#if defined(__x86_64__) || defined(__i386__)
+  // rdpmc is only used if every hardware counter can be read with it
+  rdpmc_enabled_ = group_size_ > 0U;
+  for (std::size_t i = 0U; i < NUM_COUNTERS; i++) {
+    if (group_index_[i] == NUM_COUNTERS) {
+      continue;
+    }
+    void * page = mmap(nullptr, page_size_, PROT_READ, MAP_SHARED, fds_[i], 0);
+    if (page == MAP_FAILED) {
+      rdpmc_enabled_ = false;
+      continue;
+    }
+    pages_[i] = page;
+    if (!static_cast<const perf_event_mmap_page *>(page)->cap_user_rdpmc) {
+      rdpmc_enabled_ = false;
+    }
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+  for (std::size_t i = 0U; i < NUM_COUNTERS; i++) {
+    if (pages_[i] != nullptr) {
+      munmap(pages_[i], page_size_);
+    }
+    if (fds_[i] >= 0) {
+      close(fds_[i]);
+    }
+  }
+}
+
+void PerfCounters::read(Values & values) const noexcept
+{
+  values.fill(0U);
+  if (rdpmc_enabled_) {
+    for (std::size_t i = 0U; i < NUM_COUNTERS; i++) {
+      if (pages_[i] != nullptr) {
+        values[i] = read_rdpmc(i);
+      }
+    }
+  } else if (group_size_ > 0U) {
+    // number of counters followed by their values in the order they were added to the group
+    std::uint64_t buffer[NUM_COUNTERS + 1U];
+    const ssize_t size = ::read(leader_fd_, buffer, sizeof(buffer));
+    if (size >= static_cast<ssize_t>(sizeof(std::uint64_t) * (group_size_ + 1U))) {
+      for (std::size_t i = 0U; i < NUM_COUNTERS; i++) {
+        if (group_index_[i] < NUM_COUNTERS) {
+          values[i] = buffer[group_index_[i] + 1U];
+        }
+      }
+    }
+  }
+  // software counters are not in the hardware group and have no rdpmc index
+  if (fds_[CONTEXT_SWITCHES] >= 0) {
+    std::uint64_t value = 0U;
+    if (::read(fds_[CONTEXT_SWITCHES], &value, sizeof(value)) == sizeof(value)) {
+      values[CONTEXT_SWITCHES] = value;
+    }
+  }
+}
+
+std::uint64_t PerfCounters::read_rdpmc(std::size_t counter) const noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  const auto * page = static_cast<const volatile perf_event_mmap_page *>(pages_[counter]);
+  std::uint32_t sequence;
+  std::uint64_t count;
+  // the kernel updates the page under a sequence lock when the counter is rescheduled
+  do {
+    sequence = page->lock;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    const std::uint32_t index = page->index;
+    count = static_cast<std::uint64_t>(page->offset);
+    if (index != 0U) {
+      const std::uint32_t shift = 64U - page->pmc_width;
+      const std::int64_t pmc = static_cast<std::int64_t>(rdpmc(index - 1U) << shift) >> shift;
+      count += static_cast<std::uint64_t>(pmc);
+    }
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  } while (page->lock != sequence);
+  return count;
+#else
+  (void)counter;
+  return 0U;
+#endif
+}
+
+bool PerfCounters::is_available(Counter counter) const
+{
+  return fds_[counter] >= 0;
+}
+
+bool PerfCounters::is_any_available() const
+{
+  for (const int fd : fds_) {
+    if (fd >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PerfCounters::is_rdpmc_enabled() const
+{
+  return rdpmc_enabled_;
+}
+
+bool PerfCounters::counts_kernel() const
+{
+  return counts_kernel_;
+}
+
+const char * PerfCounters::get_name(Counter counter)
+{
+  return counter < NUM_COUNTERS ? EVENTS[counter].name : "unknown";
+}
+
+PerfSection::PerfSection(const PerfCounters & counters)
+: counters_(counters),
+  start_{},
+  end_{}
+{}
+
+void PerfSection::begin() noexcept
+{
+  counters_.read(start_);
+}
+
+void PerfSection::end() noexcept
+{
+  counters_.read(end_);
+  for (std::size_t i = 0U; i < PerfCounters::NUM_COUNTERS; i++) {
+    if (counters_.is_available(static_cast<PerfCounters::Counter>(i))) {
+      accumulators_[i].add(static_cast<double>(end_[i] - start_[i]));
+    }
+  }
+}
+
+const AtomicAccumulator & PerfSection::get(PerfCounters::Counter counter) const
+{
+  return accumulators_[counter];
+}
+
+double PerfSection::get_instructions_per_cycle() const
+{
+  const double cycles = accumulators_[PerfCounters::CYCLES].get_mean();
+  return cycles > 0.0 ? accumulators_[PerfCounters::INSTRUCTIONS].get_mean() / cycles : 0.0;
+}
+
+void PerfSection::reset()
+{
+  for (auto & accumulator : accumulators_) {
+    accumulator.reset();
+  }
+}
+}  // namespace utils
+}  // namespace pendulum
@@ -0,0 +1,96 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_utils/persistent_state.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace pendulum
+{
+namespace utils
+{
+SharedMemorySegment::SharedMemorySegment(const std::string & name, std::size_t size)
+: name_(name), size_(size), data_(nullptr)
+{
+  const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    throw std::runtime_error(
+            "could not open shared memory " + name_ + ": " + std::strerror(errno));
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+    (static_cast<std::size_t>(info.st_size) != size_ &&
+    ftruncate(fd, static_cast<off_t>(size_)) != 0))
+  {
+    const int error = errno;
+    close(fd);
+    throw std::runtime_error(
+            "could not size shared memory " + name_ + ": " + std::strerror(error));
+  }
+  data_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const int error = errno;
+  // the mapping keeps the segment open
+  close(fd);
+  if (data_ == MAP_FAILED) {
+    data_ = nullptr;
+    throw std::runtime_error(
+            "could not map shared memory " + name_ + ": " + std::strerror(error));
+  }
+}
+
+SharedMemorySegment::~SharedMemorySegment()
+{
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+void * SharedMemorySegment::get_data() const
+{
+  return data_;
+}
+
+const std::string & SharedMemorySegment::get_name() const
+{
+  return name_;
+}
+
+bool SharedMemorySegment::remove(const std::string & name)
+{
+  return shm_unlink(name.c_str()) == 0;
+}
+
+std::string SharedMemorySegment::get_node_segment_name(const std::string & node_name)
+{
+  // a segment name has a single '/' at the start
+  std::string name = "/";
+  for (const char c : node_name) {
+    if (c != '/') {
+      name += c;
+    } else if (name.size() > 1U) {
+      name += '_';
+    }
+  }
+  return name + "_state";
+}
+}  // namespace utils
+}  // namespace pendulum
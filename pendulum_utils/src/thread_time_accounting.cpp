@@ -0,0 +1,132 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_utils/thread_time_accounting.hpp"
+
+#include <sys/resource.h>
+#include <time.h>
+
+namespace pendulum
+{
+namespace utils
+{
+namespace
+{
+std::int64_t read_clock_ns(clockid_t clock) noexcept
+{
+  timespec time{};
+  clock_gettime(clock, &time);
+  return static_cast<std::int64_t>(time.tv_sec) * 1000000000LL + time.tv_nsec;
+}
+
+void read_context_switches(std::int64_t & voluntary, std::int64_t & involuntary) noexcept
+{
+  rusage usage{};
+  // RUSAGE_THREAD is Linux specific, the switches are not counted if it fails
+  if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+    voluntary = usage.ru_nvcsw;
+    involuntary = usage.ru_nivcsw;
+  }
+}
+
+void increment(std::atomic<std::uint64_t> & counter, std::uint64_t value) noexcept
+{
+  // single writer
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+}  // namespace
+
+ThreadTimeAccounting::ThreadTimeAccounting()
+: start_wall_ns_{0},
+  start_cpu_ns_{0},
+  start_voluntary_switches_{0},
+  start_involuntary_switches_{0},
+  num_preempted_{0U},
+  num_voluntary_switches_{0U},
+  num_involuntary_switches_{0U}
+{}
+
+void ThreadTimeAccounting::begin() noexcept
+{
+  read_context_switches(start_voluntary_switches_, start_involuntary_switches_);
+  start_cpu_ns_ = read_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+  start_wall_ns_ = read_clock_ns(CLOCK_MONOTONIC);
+}
+
+void ThreadTimeAccounting::end() noexcept
+{
+  // read in the reverse order of begin, so the wall interval contains the CPU interval
+  const std::int64_t wall_ns = read_clock_ns(CLOCK_MONOTONIC) - start_wall_ns_;
+  const std::int64_t cpu_ns = read_clock_ns(CLOCK_THREAD_CPUTIME_ID) - start_cpu_ns_;
+  std::int64_t voluntary = start_voluntary_switches_;
+  std::int64_t involuntary = start_involuntary_switches_;
+  read_context_switches(voluntary, involuntary);
+
+  wall_time_.add(1e-3 * static_cast<double>(wall_ns));
+  cpu_time_.add(1e-3 * static_cast<double>(cpu_ns));
+  // the CPU clock has a coarser resolution on some systems
+  delay_.add(wall_ns > cpu_ns ? 1e-3 * static_cast<double>(wall_ns - cpu_ns) : 0.0);
+  if (voluntary > start_voluntary_switches_) {
+    increment(
+      num_voluntary_switches_, static_cast<std::uint64_t>(voluntary - start_voluntary_switches_));
+  }
+  if (involuntary > start_involuntary_switches_) {
+    increment(
+      num_involuntary_switches_,
+      static_cast<std::uint64_t>(involuntary - start_involuntary_switches_));
+    increment(num_preempted_, 1U);
+  }
+}
+
+const AtomicAccumulator & ThreadTimeAccounting::get_wall_time() const
+{
+  return wall_time_;
+}
+
+const AtomicAccumulator & ThreadTimeAccounting::get_cpu_time() const
+{
+  return cpu_time_;
+}
+
+const AtomicAccumulator & ThreadTimeAccounting::get_delay() const
+{
+  return delay_;
+}
+
+std::uint64_t ThreadTimeAccounting::get_num_preempted() const
+{
+  return num_preempted_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ThreadTimeAccounting::get_num_voluntary_switches() const
+{
+  return num_voluntary_switches_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ThreadTimeAccounting::get_num_involuntary_switches() const
+{
+  return num_involuntary_switches_.load(std::memory_order_relaxed);
+}
+
+void ThreadTimeAccounting::reset()
+{
+  wall_time_.reset();
+  cpu_time_.reset();
+  delay_.reset();
+  num_preempted_ = 0U;
+  num_voluntary_switches_ = 0U;
+  num_involuntary_switches_ = 0U;
+}
+}  // namespace utils
+}  // namespace pendulum
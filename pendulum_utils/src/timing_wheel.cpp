@@ -0,0 +1,166 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_utils/timing_wheel.hpp"
+
+#include <algorithm>
+
+namespace pendulum
+{
+namespace utils
+{
+namespace
+{
+constexpr std::uint64_t SLOT_MASK = TimingWheel::SLOTS - 1U;
+
+/// \brief Gets the distance to the next set bit after a position, cyclically
+/// \return Distance in [1, 64], the position itself is at distance 64
+std::uint64_t distance_to_next_set(std::uint64_t mask, std::uint64_t position)
+{
+  // rotate so that the bit after the position is bit 0
+  const std::uint64_t shift = (position + 1U) & SLOT_MASK;
+  const std::uint64_t rotated = shift == 0U ? mask : (mask >> shift) | (mask << (64U - shift));
+  return static_cast<std::uint64_t>(__builtin_ctzll(rotated)) + 1U;
+}
+}  // namespace
+
+constexpr std::size_t TimingWheel::LEVELS;
+constexpr std::size_t TimingWheel::SLOT_BITS;
+constexpr std::size_t TimingWheel::SLOTS;
+
+TimingWheel::TimingWheel(std::uint64_t start_tick)
+: current_tick_(start_tick), num_timers_(0U)
+{
+  for (std::size_t level = 0U; level < LEVELS; level++) {
+    occupied_[level] = 0U;
+    for (auto & head : slots_[level]) {
+      head.next = &head;
+      head.prev = &head;
+    }
+  }
+}
+
+void TimingWheel::schedule(Timer & timer, std::uint64_t expiry)
+{
+  if (is_scheduled(timer)) {
+    unlink(timer);
+  }
+  // the current tick was already served
+  timer.expiry = std::max(expiry, current_tick_ + 1U);
+  insert(timer);
+}
+
+void TimingWheel::cancel(Timer & timer)
+{
+  if (is_scheduled(timer)) {
+    unlink(timer);
+  }
+}
+
+bool TimingWheel::is_scheduled(const Timer & timer)
+{
+  return timer.next != nullptr;
+}
+
+bool TimingWheel::get_next_expiry(std::uint64_t & tick) const
+{
+  if (num_timers_ == 0U) {
+    return false;
+  }
+  bool found = false;
+  for (std::size_t level = 0U; level < LEVELS; level++) {
+    if (occupied_[level] == 0U) {
+      continue;
+    }
+    // level 0 slots expire, higher level slots move down when the ticks reach their start
+    const std::uint64_t shift = level * SLOT_BITS;
+    const std::uint64_t position = current_tick_ >> shift;
+    const std::uint64_t slot_tick =
+      (position + distance_to_next_set(occupied_[level], position & SLOT_MASK)) << shift;
+    if (!found || slot_tick < tick) {
+      tick = slot_tick;
+      found = true;
+    }
+  }
+  return found;
+}
+
+std::uint64_t TimingWheel::get_current_tick() const
+{
+  return current_tick_;
+}
+
+std::size_t TimingWheel::get_num_timers() const
+{
+  return num_timers_;
+}
+
+void TimingWheel::step()
+{
+  current_tick_++;
+  // find the highest level whose slot starts in this tick and move its timers down, from the
+  // highest level to the lowest one
+  std::size_t top = 0U;
+  while (top + 1U < LEVELS &&
+    (current_tick_ & ((std::uint64_t{1} << ((top + 1U) * SLOT_BITS)) - 1U)) == 0U)
+  {
+    top++;
+  }
+  for (std::size_t level = top; level > 0U; level--) {
+    Timer & head = slots_[level][(current_tick_ >> (level * SLOT_BITS)) & SLOT_MASK];
+    while (head.next != &head) {
+      Timer & timer = *head.next;
+      unlink(timer);
+      insert(timer);
+    }
+  }
+}
+
+void TimingWheel::insert(Timer & timer)
+{
+  const std::uint64_t delta = timer.expiry - current_tick_;
+  std::size_t level = 0U;
+  while (level + 1U < LEVELS && delta >= (std::uint64_t{1} << ((level + 1U) * SLOT_BITS))) {
+    level++;
+  }
+  // timers beyond the range of the wheel wait in the last slot of the top level
+  const std::uint64_t range_end =
+    current_tick_ + (std::uint64_t{1} << (LEVELS * SLOT_BITS)) - 1U;
+  const std::uint64_t slot_tick = std::min(timer.expiry, range_end);
+  timer.level = level;
+  timer.slot = static_cast<std::size_t>((slot_tick >> (level * SLOT_BITS)) & SLOT_MASK);
+
+  Timer & head = slots_[level][timer.slot];
+  timer.next = &head;
+  timer.prev = head.prev;
+  head.prev->next = &timer;
+  head.prev = &timer;
+  occupied_[level] |= std::uint64_t{1} << timer.slot;
+  num_timers_++;
+}
+
+void TimingWheel::unlink(Timer & timer)
+{
+  timer.prev->next = timer.next;
+  timer.next->prev = timer.prev;
+  Timer & head = slots_[timer.level][timer.slot];
+  if (head.next == &head) {
+    occupied_[timer.level] &= ~(std::uint64_t{1} << timer.slot);
+  }
+  timer.next = nullptr;
+  timer.prev = nullptr;
+  num_timers_--;
+}
+}  // namespace utils
+}  // namespace pendulum
@@ -0,0 +1,124 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pendulum_utils/trace_marker.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+namespace pendulum
+{
+namespace utils
+{
+namespace
+{
+constexpr const char * EVENT_NAMES[TraceMarker::NUM_EVENTS] = {
+  "cycle_start", "cycle_end", "publish", "receive"
+};
+
+// tracefs mount point since Linux 4.1, and the older debugfs one
+constexpr const char * TRACE_MARKER_PATHS[] = {
+  "/sys/kernel/tracing/trace_marker",
+  "/sys/kernel/debug/tracing/trace_marker"
+};
+
+// the longest sequence number and the new line
+constexpr std::size_t MAX_SEQUENCE_LENGTH = 21U;
+}  // namespace
+
+TraceMarker::TraceMarker(const std::string & prefix, const std::string & path)
+: fd_{-1},
+  buffers_{},
+  lengths_{},
+  num_failed_{0U}
+{
+  if (path.empty()) {
+    for (const char * default_path : TRACE_MARKER_PATHS) {
+      fd_ = open(default_path, O_WRONLY | O_CLOEXEC);
+      if (fd_ >= 0) {
+        path_ = default_path;
+        break;
+      }
+    }
+  } else {
+    fd_ = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd_ >= 0) {
+      path_ = path;
+    }
+  }
+
+  for (std::size_t i = 0U; i < NUM_EVENTS; i++) {
+    const std::string name = std::string(" ") + EVENT_NAMES[i] + " ";
+    // a long prefix is truncated so the event name and the sequence always fit
+    const std::string text =
+      prefix.substr(0U, BUFFER_SIZE - MAX_SEQUENCE_LENGTH - name.size()) + name;
+    lengths_[i] = text.size();
+    std::memcpy(buffers_[i].data(), text.data(), lengths_[i]);
+  }
+}
+
+TraceMarker::~TraceMarker()
+{
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void TraceMarker::write(Event event, std::uint64_t sequence) noexcept
+{
+  if (fd_ < 0) {
+    return;
+  }
+  // the digits are written in reverse and copied after the preformatted text
+  char digits[MAX_SEQUENCE_LENGTH];
+  std::size_t num_digits = 0U;
+  do {
+    digits[num_digits++] = static_cast<char>('0' + sequence % 10U);
+    sequence /= 10U;
+  } while (sequence > 0U);
+  char * const buffer = buffers_[event].data();
+  std::size_t length = lengths_[event];
+  while (num_digits > 0U) {
+    buffer[length++] = digits[--num_digits];
+  }
+  buffer[length++] = '\n';
+  if (::write(fd_, buffer, length) != static_cast<ssize_t>(length)) {
+    num_failed_.store(num_failed_.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+  }
+}
+
+bool TraceMarker::is_open() const
+{
+  return fd_ >= 0;
+}
+
+const std::string & TraceMarker::get_path() const
+{
+  return path_;
+}
+
+std::uint64_t TraceMarker::get_num_failed() const
+{
+  return num_failed_.load(std::memory_order_relaxed);
+}
+
+const char * TraceMarker::get_name(Event event)
+{
+  return event < NUM_EVENTS ? EVENT_NAMES[event] : "unknown";
+}
+}  // namespace utils
+}  // namespace pendulum
@@ -0,0 +1,67 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include "pendulum_utils/atomic_accumulator.hpp"
+
+using pendulum::utils::AtomicAccumulator;
+
+TEST(TestAtomicAccumulator, statistics)
+{
+  AtomicAccumulator accumulator;
+  EXPECT_EQ(accumulator.get_count(), 0U);
+  EXPECT_EQ(accumulator.get_mean(), 0.0);
+  EXPECT_EQ(accumulator.get_rms(), 0.0);
+  for (const double value : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) {
+    accumulator.add(value);
+  }
+  EXPECT_EQ(accumulator.get_count(), 8U);
+  EXPECT_DOUBLE_EQ(accumulator.get_mean(), 5.0);
+  EXPECT_DOUBLE_EQ(accumulator.get_stddev(), 2.0);
+  EXPECT_DOUBLE_EQ(accumulator.get_rms(), std::sqrt(29.0));
+  EXPECT_DOUBLE_EQ(accumulator.get_min(), 2.0);
+  EXPECT_DOUBLE_EQ(accumulator.get_max(), 9.0);
+  accumulator.reset();
+  EXPECT_EQ(accumulator.get_count(), 0U);
+  EXPECT_TRUE(std::isinf(accumulator.get_max()));
+}
+
+TEST(TestAtomicAccumulator, concurrent_reader)
+{
+  AtomicAccumulator accumulator;
+  std::atomic<bool> done{false};
+  bool monotonic = true;
+  std::thread reader([&accumulator, &done, &monotonic]() {
+      std::uint64_t last = 0U;
+      while (!done) {
+        const std::uint64_t count = accumulator.get_count();
+        monotonic = monotonic && count >= last;
+        last = count;
+        // the maximum of a sample is always visible once it is counted
+        if (count > 0U) {
+          monotonic = monotonic && accumulator.get_max() >= static_cast<double>(count - 1U);
+        }
+      }
+    });
+  for (std::size_t i = 0U; i < 100000U; i++) {
+    accumulator.add(static_cast<double>(i));
+  }
+  done = true;
+  reader.join();
+  EXPECT_TRUE(monotonic);
+  EXPECT_EQ(accumulator.get_count(), 100000U);
+}
@@ -0,0 +1,75 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "pendulum_utils/latest_value_buffer.hpp"
+
+using pendulum::utils::LatestValueBuffer;
+
+namespace
+{
+struct Sample
+{
+  std::uint64_t a;
+  std::uint64_t b;
+};
+}  // namespace
+
+TEST(TestLatestValueBuffer, empty)
+{
+  LatestValueBuffer<Sample> buffer;
+  Sample sample{7U, 7U};
+  EXPECT_EQ(buffer.read(sample), 0U);
+  EXPECT_EQ(sample.a, 7U);
+}
+
+TEST(TestLatestValueBuffer, latest)
+{
+  LatestValueBuffer<Sample> buffer;
+  EXPECT_TRUE(buffer.write(Sample{1U, 1U}));
+  EXPECT_TRUE(buffer.write(Sample{2U, 2U}));
+  Sample sample{};
+  EXPECT_EQ(buffer.read(sample), 2U);
+  EXPECT_EQ(sample.a, 2U);
+  // reading again returns the same version
+  EXPECT_EQ(buffer.read(sample), 2U);
+  EXPECT_EQ(buffer.get_num_dropped(), 0U);
+}
+
+TEST(TestLatestValueBuffer, concurrent)
+{
+  LatestValueBuffer<Sample> buffer;
+  std::atomic<bool> done{false};
+  std::thread writer([&buffer, &done]() {
+      for (std::uint64_t i = 1U; i <= 100000U; i++) {
+        buffer.write(Sample{i, i});
+      }
+      done = true;
+    });
+  // the values are never torn and the versions never go back
+  std::uint64_t last_version = 0U;
+  while (!done) {
+    Sample sample{};
+    const std::uint64_t version = buffer.read(sample);
+    EXPECT_GE(version, last_version);
+    EXPECT_EQ(sample.a, sample.b);
+    last_version = version;
+  }
+  writer.join();
+  Sample sample{};
+  EXPECT_EQ(buffer.read(sample) + buffer.get_num_dropped(), 100000U);
+}
@@ -0,0 +1,105 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include "pendulum_utils/load_shedder.hpp"
+
+using pendulum::utils::LoadShedder;
+using std::chrono::microseconds;
+
+namespace
+{
+// 1 ms budget, shed above 500 us, restore below 250 us after 3 cycles, disable at level 2
+LoadShedder::Config make_config(bool enabled = true)
+{
+  return LoadShedder::Config(enabled, microseconds{1000}, 0.5, 0.25, 3U, 2U);
+}
+
+std::size_t count_allowed(LoadShedder & shedder, std::size_t cycles, microseconds cycle_time)
+{
+  std::size_t allowed = 0U;
+  for (std::size_t i = 0U; i < cycles; i++) {
+    if (shedder.allow()) {
+      allowed++;
+    }
+    shedder.update(cycle_time);
+  }
+  return allowed;
+}
+}  // namespace
+
+TEST(TestLoadShedder, invalid_config)
+{
+  EXPECT_THROW(
+    LoadShedder::Config(true, microseconds{1000}, 1.5, 0.25, 3U, 2U), std::invalid_argument);
+  EXPECT_THROW(
+    LoadShedder::Config(true, microseconds{1000}, 0.5, 0.75, 3U, 2U), std::invalid_argument);
+  EXPECT_THROW(
+    LoadShedder::Config(true, microseconds{1000}, 0.5, 0.25, 3U, 0U), std::invalid_argument);
+}
+
+TEST(TestLoadShedder, headroom)
+{
+  LoadShedder shedder(make_config());
+  EXPECT_EQ(count_allowed(shedder, 10U, microseconds{400}), 10U);
+  EXPECT_EQ(shedder.get_level(), 0U);
+  EXPECT_EQ(shedder.get_num_skipped(), 0U);
+  EXPECT_EQ(shedder.get_max_cycle_time(), microseconds{400});
+}
+
+TEST(TestLoadShedder, progressive_shedding)
+{
+  LoadShedder shedder(make_config());
+  shedder.update(microseconds{600});
+  EXPECT_EQ(shedder.get_level(), 1U);
+  // level 1 decimates by two
+  EXPECT_EQ(count_allowed(shedder, 4U, microseconds{400}), 2U);
+  shedder.update(microseconds{900});
+  shedder.update(microseconds{900});
+  EXPECT_EQ(shedder.get_level(), 2U);
+  EXPECT_EQ(shedder.get_num_shed_events(), 2U);
+  // the maximum level disables the outputs
+  EXPECT_EQ(count_allowed(shedder, 4U, microseconds{900}), 0U);
+  EXPECT_EQ(shedder.get_num_skipped(), 6U);
+}
+
+TEST(TestLoadShedder, restore)
+{
+  LoadShedder shedder(make_config());
+  shedder.update(microseconds{600});
+  shedder.update(microseconds{600});
+  ASSERT_EQ(shedder.get_level(), 2U);
+  // cycles between the thresholds keep the level
+  count_allowed(shedder, 10U, microseconds{300});
+  EXPECT_EQ(shedder.get_level(), 2U);
+  // a level is restored after every 3 calm cycles
+  count_allowed(shedder, 2U, microseconds{100});
+  shedder.update(microseconds{300});
+  count_allowed(shedder, 3U, microseconds{100});
+  EXPECT_EQ(shedder.get_level(), 1U);
+  count_allowed(shedder, 3U, microseconds{100});
+  EXPECT_EQ(shedder.get_level(), 0U);
+  EXPECT_EQ(shedder.get_num_restore_events(), 2U);
+  EXPECT_TRUE(shedder.allow());
+}
+
+TEST(TestLoadShedder, disabled)
+{
+  LoadShedder shedder(make_config(false));
+  EXPECT_EQ(count_allowed(shedder, 10U, microseconds{2000}), 10U);
+  EXPECT_EQ(shedder.get_level(), 0U);
+  EXPECT_EQ(shedder.get_num_shed_events(), 0U);
+}
@@ -0,0 +1,98 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "pendulum_utils/perf_counters.hpp"
+
+using pendulum::utils::PerfCounters;
+using pendulum::utils::PerfSection;
+
+namespace
+{
+double busy_loop(std::size_t iterations)
+{
+  volatile double sum = 0.0;
+  for (std::size_t i = 0U; i < iterations; i++) {
+    sum = sum + static_cast<double>(i);
+  }
+  return sum;
+}
+}  // namespace
+
+TEST(TestPerfCounters, unavailable_counters_read_zero)
+{
+  // the counters are not permitted in every environment, which must not be an error
+  PerfCounters counters;
+  PerfCounters::Values values;
+  values.fill(1U);
+  counters.read(values);
+  for (std::size_t i = 0U; i < PerfCounters::NUM_COUNTERS; i++) {
+    const auto counter = static_cast<PerfCounters::Counter>(i);
+    if (!counters.is_available(counter)) {
+      EXPECT_EQ(values[i], 0U) << PerfCounters::get_name(counter);
+    }
+  }
+  bool hardware = false;
+  for (const auto counter : {PerfCounters::CYCLES, PerfCounters::INSTRUCTIONS,
+      PerfCounters::CACHE_MISSES, PerfCounters::BRANCH_MISSES})
+  {
+    hardware = hardware || counters.is_available(counter);
+  }
+  // rdpmc only reads hardware counters
+  EXPECT_TRUE(hardware || !counters.is_rdpmc_enabled());
+  EXPECT_EQ(std::string(PerfCounters::get_name(PerfCounters::CACHE_MISSES)), "cache_misses");
+}
+
+TEST(TestPerfCounters, section)
+{
+  PerfCounters counters;
+  PerfSection section(counters);
+  for (std::size_t i = 0U; i < 10U; i++) {
+    section.begin();
+    busy_loop(100000U);
+    section.end();
+  }
+  for (std::size_t i = 0U; i < PerfCounters::NUM_COUNTERS; i++) {
+    const auto counter = static_cast<PerfCounters::Counter>(i);
+    // only the available counters are aggregated
+    EXPECT_EQ(section.get(counter).get_count(), counters.is_available(counter) ? 10U : 0U);
+  }
+  if (counters.is_available(PerfCounters::INSTRUCTIONS)) {
+    EXPECT_GE(section.get(PerfCounters::INSTRUCTIONS).get_min(), 100000.0);
+  }
+  if (counters.is_available(PerfCounters::CYCLES) &&
+    counters.is_available(PerfCounters::INSTRUCTIONS))
+  {
+    EXPECT_GT(section.get_instructions_per_cycle(), 0.0);
+  }
+  section.reset();
+  EXPECT_EQ(section.get(PerfCounters::CYCLES).get_count(), 0U);
+}
+
+TEST(TestPerfCounters, context_switches)
+{
+  PerfCounters counters;
+  if (!counters.is_available(PerfCounters::CONTEXT_SWITCHES) || !counters.counts_kernel()) {
+    return;
+  }
+  PerfSection section(counters);
+  section.begin();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  section.end();
+  // a sleeping thread is switched out
+  EXPECT_GE(section.get(PerfCounters::CONTEXT_SWITCHES).get_max(), 1.0);
+}
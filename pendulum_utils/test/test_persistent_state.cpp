@@ -0,0 +1,113 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdint>
+#include <string>
+#include "pendulum_utils/persistent_state.hpp"
+
+using pendulum::utils::PersistentState;
+using pendulum::utils::SharedMemorySegment;
+
+namespace
+{
+struct Snapshot
+{
+  double position;
+  double velocity;
+  std::uint64_t cycle;
+};
+}  // namespace
+
+class TestPersistentState : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    SharedMemorySegment::remove(name);
+  }
+
+  void TearDown() override
+  {
+    SharedMemorySegment::remove(name);
+  }
+
+  const std::string name{"/pendulum_test_state_" + std::to_string(getpid())};
+};
+
+TEST_F(TestPersistentState, empty)
+{
+  PersistentState<Snapshot> state(name);
+  Snapshot snapshot{};
+  EXPECT_FALSE(state.load(snapshot));
+  EXPECT_EQ(state.get_num_stores(), 0U);
+}
+
+TEST_F(TestPersistentState, restart)
+{
+  {
+    PersistentState<Snapshot> state(name);
+    for (std::uint64_t k = 1U; k <= 5U; k++) {
+      state.store(Snapshot{0.1 * static_cast<double>(k), -1.0, k});
+    }
+  }
+  // a new instance, as a restarted process, finds the last value
+  PersistentState<Snapshot> restarted(name);
+  Snapshot snapshot{};
+  ASSERT_TRUE(restarted.load(snapshot));
+  EXPECT_DOUBLE_EQ(snapshot.position, 0.5);
+  EXPECT_DOUBLE_EQ(snapshot.velocity, -1.0);
+  EXPECT_EQ(snapshot.cycle, 5U);
+  EXPECT_EQ(restarted.get_num_stores(), 5U);
+
+  restarted.clear();
+  EXPECT_FALSE(restarted.load(snapshot));
+}
+
+TEST_F(TestPersistentState, other_type_is_discarded)
+{
+  {
+    PersistentState<double> state(name);
+    state.store(1.0);
+  }
+  PersistentState<Snapshot> state(name);
+  Snapshot snapshot{};
+  EXPECT_FALSE(state.load(snapshot));
+}
+
+TEST_F(TestPersistentState, node_segment_name)
+{
+  EXPECT_EQ(
+    SharedMemorySegment::get_node_segment_name("/pendulum_driver"), "/pendulum_driver_state");
+  EXPECT_EQ(
+    SharedMemorySegment::get_node_segment_name("/pendulum_0/pendulum_driver"),
+    "/pendulum_0_pendulum_driver_state");
+  EXPECT_NE(
+    SharedMemorySegment::get_node_segment_name("/pendulum_0/pendulum_controller"),
+    SharedMemorySegment::get_node_segment_name("/pendulum_1/pendulum_controller"));
+}
+
+TEST_F(TestPersistentState, remove)
+{
+  {
+    PersistentState<Snapshot> state(name);
+    state.store(Snapshot{1.0, 2.0, 3U});
+  }
+  EXPECT_TRUE(SharedMemorySegment::remove(name));
+  EXPECT_FALSE(SharedMemorySegment::remove(name));
+  PersistentState<Snapshot> state(name);
+  Snapshot snapshot{};
+  EXPECT_FALSE(state.load(snapshot));
+}
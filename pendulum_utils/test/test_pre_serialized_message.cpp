@@ -0,0 +1,98 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include "pendulum2_msgs/msg/joint_command.hpp"
+#include "pendulum2_msgs/msg/joint_state.hpp"
+#include "pendulum_utils/pre_serialized_message.hpp"
+
+using pendulum::utils::PreSerializedMessage;
+using JointState = pendulum2_msgs::msg::JointState;
+using JointCommand = pendulum2_msgs::msg::JointCommand;
+
+namespace
+{
+JointState deserialize(const rclcpp::SerializedMessage & serialized)
+{
+  rclcpp::Serialization<JointState> serialization;
+  JointState message;
+  serialization.deserialize_message(&serialized, &message);
+  return message;
+}
+}  // namespace
+
+TEST(TestPreSerializedMessage, template_message)
+{
+  JointState message;
+  message.cart_position = 1.5;
+  PreSerializedMessage<JointState> serialized(message);
+  EXPECT_EQ(PreSerializedMessage<JointState>::NUM_FIELDS, 5U);
+  EXPECT_DOUBLE_EQ(serialized.get(&JointState::cart_position), 1.5);
+  EXPECT_DOUBLE_EQ(deserialize(serialized.get_serialized_message()).cart_position, 1.5);
+}
+
+TEST(TestPreSerializedMessage, round_trip)
+{
+  PreSerializedMessage<JointState> serialized;
+  JointState message;
+  message.pole_angle = 3.1;
+  message.pole_velocity = -0.2;
+  message.cart_position = 12.5;
+  message.cart_velocity = -7.25;
+  message.cart_force = 1e-300;
+  serialized.update(message);
+  const JointState result = deserialize(serialized.get_serialized_message());
+  EXPECT_EQ(result.pole_angle, message.pole_angle);
+  EXPECT_EQ(result.pole_velocity, message.pole_velocity);
+  EXPECT_EQ(result.cart_position, message.cart_position);
+  EXPECT_EQ(result.cart_velocity, message.cart_velocity);
+  EXPECT_EQ(result.cart_force, message.cart_force);
+
+  // patching a single field keeps the others
+  serialized.set(&JointState::cart_force, 42.0);
+  const JointState patched = deserialize(serialized.get_serialized_message());
+  EXPECT_EQ(patched.cart_force, 42.0);
+  EXPECT_EQ(patched.cart_velocity, message.cart_velocity);
+
+  // the same bytes as the generic serializer
+  rclcpp::Serialization<JointState> serialization;
+  rclcpp::SerializedMessage reference;
+  message.cart_force = 42.0;
+  serialization.serialize_message(&message, &reference);
+  const auto & expected = reference.get_rcl_serialized_message();
+  const auto & actual = serialized.get_serialized_message().get_rcl_serialized_message();
+  ASSERT_EQ(actual.buffer_length, expected.buffer_length);
+  for (std::size_t i = 0U; i < expected.buffer_length; i++) {
+    EXPECT_EQ(actual.buffer[i], expected.buffer[i]);
+  }
+}
+
+TEST(TestPreSerializedMessage, single_field)
+{
+  PreSerializedMessage<JointCommand> serialized;
+  JointCommand message;
+  message.force = -3.5;
+  serialized.update(message);
+  EXPECT_DOUBLE_EQ(serialized.get(&JointCommand::force), -3.5);
+}
+
+TEST(TestPreSerializedMessage, swapped_byte_order)
+{
+  std::uint8_t buffer[pendulum::utils::CDR_HEADER_SIZE + 2U * sizeof(double)] = {0U, 0U, 0U, 0U};
+  pendulum::utils::write_cdr_double(buffer, 1U, 2.0, true);
+  EXPECT_DOUBLE_EQ(pendulum::utils::read_cdr_double(buffer, 1U, true), 2.0);
+  EXPECT_NE(pendulum::utils::read_cdr_double(buffer, 1U, false), 2.0);
+  EXPECT_FALSE(pendulum::utils::is_cdr_little_endian(buffer));
+}
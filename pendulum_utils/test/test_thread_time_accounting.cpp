@@ -0,0 +1,57 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "pendulum_utils/thread_time_accounting.hpp"
+
+using pendulum::utils::ThreadTimeAccounting;
+
+TEST(TestThreadTimeAccounting, busy_callback)
+{
+  ThreadTimeAccounting accounting;
+  accounting.begin();
+  const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+  while (std::chrono::steady_clock::now() < end) {}
+  accounting.end();
+  EXPECT_EQ(accounting.get_wall_time().get_count(), 1U);
+  EXPECT_GE(accounting.get_wall_time().get_max(), 5000.0);
+  // a busy loop runs most of the time unless the machine is loaded
+  EXPECT_GT(accounting.get_cpu_time().get_max(), 0.0);
+  EXPECT_LE(accounting.get_cpu_time().get_max(), accounting.get_wall_time().get_max() + 1.0);
+  EXPECT_NEAR(
+    accounting.get_delay().get_max(),
+    accounting.get_wall_time().get_max() - accounting.get_cpu_time().get_max(), 1.0);
+}
+
+TEST(TestThreadTimeAccounting, sleeping_callback)
+{
+  ThreadTimeAccounting accounting;
+  for (int i = 0; i < 3; i++) {
+    accounting.begin();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    accounting.end();
+  }
+  EXPECT_EQ(accounting.get_delay().get_count(), 3U);
+  // the thread does not run while it sleeps
+  EXPECT_GE(accounting.get_delay().get_min(), 4000.0);
+  EXPECT_LT(accounting.get_cpu_time().get_max(), 4000.0);
+  // a sleep gives the CPU away voluntarily
+  EXPECT_GE(accounting.get_num_voluntary_switches(), 3U);
+  EXPECT_LE(accounting.get_num_preempted(), 3U);
+  accounting.reset();
+  EXPECT_EQ(accounting.get_delay().get_count(), 0U);
+  EXPECT_EQ(accounting.get_num_voluntary_switches(), 0U);
+}
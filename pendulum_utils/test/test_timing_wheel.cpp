@@ -0,0 +1,140 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "pendulum_utils/timing_wheel.hpp"
+
+using pendulum::utils::TimingWheel;
+
+TEST(TestTimingWheel, expiry_order)
+{
+  TimingWheel wheel(10U);
+  std::vector<TimingWheel::Timer> timers(4U);
+  const std::uint64_t expiries[] = {300U, 12U, 70000U, 5000U};
+  for (std::size_t i = 0U; i < timers.size(); i++) {
+    timers[i].id = i;
+    wheel.schedule(timers[i], expiries[i]);
+  }
+  EXPECT_EQ(wheel.get_num_timers(), 4U);
+
+  std::vector<std::size_t> order;
+  std::vector<std::uint64_t> ticks;
+  const auto num_expired = wheel.advance(
+    100000U, [&order, &ticks, &wheel](TimingWheel::Timer & timer) {
+      order.push_back(timer.id);
+      ticks.push_back(wheel.get_current_tick());
+    });
+  EXPECT_EQ(num_expired, 4U);
+  EXPECT_EQ(order, (std::vector<std::size_t>{1U, 0U, 3U, 2U}));
+  // every timer expires exactly at its tick
+  EXPECT_EQ(ticks, (std::vector<std::uint64_t>{12U, 300U, 5000U, 70000U}));
+  EXPECT_EQ(wheel.get_current_tick(), 100000U);
+  EXPECT_EQ(wheel.get_num_timers(), 0U);
+}
+
+TEST(TestTimingWheel, next_expiry)
+{
+  TimingWheel wheel;
+  std::uint64_t tick = 0U;
+  EXPECT_FALSE(wheel.get_next_expiry(tick));
+  TimingWheel::Timer timer;
+  wheel.schedule(timer, 40U);
+  ASSERT_TRUE(wheel.get_next_expiry(tick));
+  EXPECT_EQ(tick, 40U);
+  // a far timer needs a wake-up when its slot moves down
+  wheel.schedule(timer, 1000U);
+  ASSERT_TRUE(wheel.get_next_expiry(tick));
+  EXPECT_EQ(tick, 960U);
+  EXPECT_EQ(wheel.advance(999U, [](TimingWheel::Timer &) {}), 0U);
+  ASSERT_TRUE(wheel.get_next_expiry(tick));
+  EXPECT_EQ(tick, 1000U);
+}
+
+TEST(TestTimingWheel, beyond_range)
+{
+  // the wheel covers 2^24 ticks, later timers wait in the top level
+  TimingWheel wheel;
+  TimingWheel::Timer timer;
+  wheel.schedule(timer, 40000000U);
+  std::uint64_t expired_at = 0U;
+  wheel.advance(
+    50000000U, [&expired_at, &wheel](TimingWheel::Timer &) {
+      expired_at = wheel.get_current_tick();
+    });
+  EXPECT_EQ(expired_at, 40000000U);
+}
+
+TEST(TestTimingWheel, cancel_and_past_expiry)
+{
+  TimingWheel wheel(100U);
+  TimingWheel::Timer cancelled;
+  TimingWheel::Timer late;
+  wheel.schedule(cancelled, 150U);
+  wheel.schedule(late, 20U);
+  wheel.cancel(cancelled);
+  EXPECT_FALSE(TimingWheel::is_scheduled(cancelled));
+  std::uint64_t expired_at = 0U;
+  EXPECT_EQ(
+    wheel.advance(
+      200U, [&expired_at, &wheel](TimingWheel::Timer &) {
+        expired_at = wheel.get_current_tick();
+      }), 1U);
+  // a timer in the past expires in the next tick
+  EXPECT_EQ(expired_at, 101U);
+}
+
+TEST(TestTimingWheel, periodic_timers)
+{
+  // many periodic timers with different periods, checked against the expected number of
+  // expirations and exact expiry ticks
+  TimingWheel wheel;
+  const std::uint64_t periods[] = {1U, 3U, 10U, 64U, 100U, 4096U, 5000U, 300000U};
+  std::vector<TimingWheel::Timer> timers(400U);
+  std::mt19937 rand_gen(3U);
+  std::vector<std::uint64_t> period_of(timers.size());
+  for (std::size_t i = 0U; i < timers.size(); i++) {
+    timers[i].id = i;
+    period_of[i] = periods[i % 8U];
+    wheel.schedule(timers[i], rand_gen() % period_of[i] + 1U);
+  }
+  std::vector<std::uint64_t> count(timers.size(), 0U);
+  bool on_time = true;
+  const std::uint64_t end = 200000U;
+  // advance in uneven steps
+  for (std::uint64_t tick = 0U; tick < end; tick += rand_gen() % 5000U + 1U) {
+    wheel.advance(
+      tick, [&](TimingWheel::Timer & timer) {
+        on_time = on_time && timer.expiry == wheel.get_current_tick();
+        count[timer.id]++;
+        wheel.schedule(timer, timer.expiry + period_of[timer.id]);
+      });
+  }
+  wheel.advance(
+    end, [&](TimingWheel::Timer & timer) {
+      on_time = on_time && timer.expiry == wheel.get_current_tick();
+      count[timer.id]++;
+      wheel.schedule(timer, timer.expiry + period_of[timer.id]);
+    });
+  EXPECT_TRUE(on_time);
+  for (std::size_t i = 0U; i < timers.size(); i++) {
+    // the expirations in [1, end] of a timer with this period and the first expiry
+    const std::uint64_t first = timers[i].expiry - period_of[i] * count[i];
+    const std::uint64_t expected = first > end ? 0U : (end - first) / period_of[i] + 1U;
+    EXPECT_EQ(count[i], expected) << "timer " << i;
+  }
+  EXPECT_EQ(wheel.get_num_timers(), timers.size());
+}
@@ -0,0 +1,91 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "pendulum_utils/trace_marker.hpp"
+
+using pendulum::utils::TraceMarker;
+
+class TestTraceMarker : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // a regular file stands for the trace marker
+    path = "/tmp/test_trace_marker_" + std::to_string(getpid());
+    std::ofstream file(path);
+  }
+
+  void TearDown() override
+  {
+    std::remove(path.c_str());
+  }
+
+  std::string read_file() const
+  {
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  std::string path;
+};
+
+TEST_F(TestTraceMarker, write_events)
+{
+  {
+    TraceMarker marker("/pendulum_driver", path);
+    ASSERT_TRUE(marker.is_open());
+    EXPECT_EQ(marker.get_path(), path);
+    marker.write(TraceMarker::CYCLE_START, 0U);
+    marker.write(TraceMarker::PUBLISH, 42U);
+    marker.write(TraceMarker::CYCLE_END, 18446744073709551615ULL);
+    marker.write(TraceMarker::RECEIVE, 7U);
+    EXPECT_EQ(marker.get_num_failed(), 0U);
+  }
+  EXPECT_EQ(
+    read_file(),
+    "/pendulum_driver cycle_start 0\n"
+    "/pendulum_driver publish 42\n"
+    "/pendulum_driver cycle_end 18446744073709551615\n"
+    "/pendulum_driver receive 7\n");
+}
+
+TEST_F(TestTraceMarker, long_prefix)
+{
+  {
+    TraceMarker marker(std::string(200U, 'x'), path);
+    marker.write(TraceMarker::CYCLE_START, 123U);
+  }
+  const std::string content = read_file();
+  EXPECT_LE(content.size(), 128U);
+  EXPECT_EQ(content.substr(content.size() - 17U), " cycle_start 123\n");
+}
+
+TEST_F(TestTraceMarker, closed)
+{
+  TraceMarker marker("/pendulum_driver", "/nonexistent/trace_marker");
+  EXPECT_FALSE(marker.is_open());
+  EXPECT_TRUE(marker.get_path().empty());
+  // writing to a closed marker does nothing
+  marker.write(TraceMarker::CYCLE_START, 1U);
+  EXPECT_EQ(marker.get_num_failed(), 0U);
+  EXPECT_STREQ(TraceMarker::get_name(TraceMarker::RECEIVE), "receive");
+}
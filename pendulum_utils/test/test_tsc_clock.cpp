@@ -0,0 +1,73 @@
+// Copyright 2021 Carlos San Vicente
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "pendulum_utils/tsc_clock.hpp"
+
+using pendulum::utils::TscClock;
+
+TEST(TestTscClock, follows_steady_clock)
+{
+  // the time points are in the steady clock epoch whether the counter is used or not
+  const auto steady_before = std::chrono::steady_clock::now();
+  const auto tsc = TscClock::now();
+  const auto steady_after = std::chrono::steady_clock::now();
+  EXPECT_GE(tsc, steady_before - std::chrono::microseconds(100));
+  EXPECT_LE(tsc, steady_after + std::chrono::microseconds(100));
+  if (TscClock::is_tsc_enabled()) {
+    EXPECT_GT(TscClock::get_tsc_frequency(), 1e6);
+  } else {
+    EXPECT_EQ(TscClock::get_tsc_frequency(), 0.0);
+  }
+}
+
+TEST(TestTscClock, measures_durations)
+{
+  const auto tsc_start = TscClock::now();
+  const auto steady_start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const std::chrono::duration<double, std::micro> tsc_elapsed = TscClock::now() - tsc_start;
+  const std::chrono::duration<double, std::micro> steady_elapsed =
+    std::chrono::steady_clock::now() - steady_start;
+  EXPECT_NEAR(tsc_elapsed.count(), steady_elapsed.count(), 100.0);
+}
+
+TEST(TestTscClock, monotonic_across_calibrations)
+{
+  std::vector<std::thread> threads;
+  std::vector<int> monotonic(4U, 1);
+  for (std::size_t i = 0U; i < monotonic.size(); i++) {
+    threads.emplace_back(
+      [&monotonic, i]() {
+        auto last = TscClock::now();
+        for (std::size_t k = 0U; k < 200000U; k++) {
+          if (k % 10000U == 0U) {
+            TscClock::calibrate();
+          }
+          const auto now = TscClock::now();
+          monotonic[i] = monotonic[i] && now >= last;
+          last = now;
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (const int result : monotonic) {
+    EXPECT_TRUE(result);
+  }
+}